@@ -44,6 +44,16 @@ SHARED_LIBS := openvx
 SYS_SHARED_LIBS := $(XML2_LIB)
 include $(FINALE)
 
+_MODULE     := vx_bench
+include $(PRELUDE)
+TARGET      := vx_bench
+TARGETTYPE  := exe
+CSOURCES    := vx_bench.c vx_factory_corners.c vx_factory_pipeline.c vx_factory_edge.c
+IDIRS       := $(HOST_ROOT)/$(OPENVX_SRC)/include $(HOST_ROOT)/$(OPENVX_SRC)/extensions/include
+STATIC_LIBS := vx_xyz_lib openvx-helper
+SHARED_LIBS := openvx
+include $(FINALE)
+
 _MODULE     := vx_example_code
 include $(PRELUDE)
 TARGET      := vx_example_code
@@ -0,0 +1,756 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file vx_bench.c
+ * \example vx_bench.c
+ * \brief Times the example graph factories, and optionally a sample CNN or single NN
+ * layers, and reports latency percentiles, frame rate, per node performance and peak RSS
+ * as JSON.
+ *
+ * Usage: vx_bench [-s WxH]... [-g edge|corners|pipeline]... [-i iterations] [-u warmup]
+ *                 [-o file.json] [-n overfeat|googlenet2 <input> <weights>]
+ *                 [-n alexnet <input> <mean> <weights>] [-l conv3x3|fc]...
+ *
+ * Each layer runs on the same random data as Q7.8 and, when the platform supports F16
+ * tensors, as F16. The layers are large, so e.g. -l conv3x3 -i 5 -u 1 keeps runs short.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vx_graph_factory.h>
+#include <VX/vx_ext_graph.h>
+#if defined(OPENVX_USE_NN)
+#include <stdbool.h>
+#include <network.h>
+#include <VX/vx_khr_nn.h>
+#if defined(EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT)
+#include <conversion_utils.h>
+#endif
+#endif
+
+#if defined(__linux__) || defined(__ANDROID__) || defined(__QNX__) || defined(__APPLE__) || defined(__CYGWIN__)
+#include <time.h>
+#include <sys/resource.h>
+#elif defined(_WIN32) || defined(UNDER_CE)
+#include <windows.h>
+#endif
+
+#define VX_BENCH_MAX_PARAMS     (4)
+#define VX_BENCH_MAX_SIZES      (8)
+#define VX_BENCH_MAX_NODES      (32)
+#define VX_BENCH_ARRAY_CAPACITY (8192)
+
+/*! \brief Describes how to create the graph parameters of a factory graph.
+ * \ingroup group_example
+ */
+typedef struct _vx_bench_graph_t {
+    const vx_char *name;
+    vx_graph_factory_f factory;
+    /*! \brief The image format, or the item type for arrays, of each graph parameter */
+    vx_enum formats[VX_BENCH_MAX_PARAMS];
+} vx_bench_graph_t;
+
+static vx_bench_graph_t graphs[] = {
+    {"edge",     vxEdgeGraphFactory,     {VX_DF_IMAGE_U8, VX_DF_IMAGE_S16}},
+    {"corners",  vxCornersGraphFactory,  {VX_DF_IMAGE_IYUV, VX_TYPE_KEYPOINT}},
+    {"pipeline", vxPipelineGraphFactory, {VX_DF_IMAGE_IYUV, VX_DF_IMAGE_U8}},
+};
+
+/*! \brief The latencies of a benchmark, in nanoseconds.
+ * \ingroup group_example
+ */
+typedef struct _vx_bench_result_t {
+    vx_uint64 *samples;
+    vx_uint32 count;
+    vx_uint64 total;
+} vx_bench_result_t;
+
+static vx_uint64 vxBenchTime(void)
+{
+#if defined(__linux__) || defined(__ANDROID__) || defined(__QNX__) || defined(__APPLE__) || defined(__CYGWIN__)
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (vx_uint64)t.tv_sec * 1000000000ull + (vx_uint64)t.tv_nsec;
+#elif defined(_WIN32) || defined(UNDER_CE)
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (vx_uint64)((double)t.QuadPart * 1000000000.0 / (double)f.QuadPart);
+#endif
+}
+
+/*! \brief Returns the peak resident set size of the process in KiB, or 0 where it is not known. */
+static vx_uint64 vxBenchPeakRSS(void)
+{
+    vx_uint64 kib = 0;
+#if defined(__linux__) || defined(__ANDROID__) || defined(__QNX__) || defined(__APPLE__) || defined(__CYGWIN__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#if defined(__APPLE__)
+        kib = (vx_uint64)usage.ru_maxrss / 1024u; /* bytes on OS X */
+#else
+        kib = (vx_uint64)usage.ru_maxrss;
+#endif
+    }
+#endif
+    return kib;
+}
+
+static int vxBenchCompare(const void *a, const void *b)
+{
+    vx_uint64 x = *(const vx_uint64 *)a;
+    vx_uint64 y = *(const vx_uint64 *)b;
+    return (x > y) - (x < y);
+}
+
+static vx_float64 vxBenchPercentile(vx_bench_result_t *result, vx_uint32 pct)
+{
+    vx_uint32 i = ((result->count - 1u) * pct) / 100u;
+    return (vx_float64)result->samples[i] / 1000000.0;
+}
+
+static void vxBenchPrintLatency(FILE *out, vx_bench_result_t *result)
+{
+    qsort(result->samples, result->count, sizeof(vx_uint64), vxBenchCompare);
+    fprintf(out, "\"p50_ms\":%.4f,\"p99_ms\":%.4f,\"min_ms\":%.4f,\"max_ms\":%.4f,\"fps\":%.2f",
+            vxBenchPercentile(result, 50),
+            vxBenchPercentile(result, 99),
+            vxBenchPercentile(result, 0),
+            vxBenchPercentile(result, 100),
+            result->total ? ((vx_float64)result->count * 1000000000.0 / (vx_float64)result->total) : 0.0);
+}
+
+/*! \brief Fills every plane of an 8 bit image with a textured pattern, so thresholds and
+ * callbacks in the graphs see realistic data.
+ */
+static vx_status vxBenchFillImage(vx_image image)
+{
+    vx_status status = VX_SUCCESS;
+    vx_uint32 width = 0, height = 0;
+    vx_size planes = 0, p;
+
+    status |= vxQueryImage(image, VX_IMAGE_WIDTH, &width, sizeof(width));
+    status |= vxQueryImage(image, VX_IMAGE_HEIGHT, &height, sizeof(height));
+    status |= vxQueryImage(image, VX_IMAGE_PLANES, &planes, sizeof(planes));
+    for (p = 0; (p < planes) && (status == VX_SUCCESS); p++)
+    {
+        vx_rectangle_t rect = {0, 0, width, height};
+        vx_imagepatch_addressing_t addr;
+        vx_map_id map_id;
+        void *base = NULL;
+        vx_uint32 x, y;
+
+        status = vxMapImagePatch(image, &rect, (vx_uint32)p, &map_id, &addr, &base,
+                                 VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+        if (status != VX_SUCCESS)
+            break;
+        for (y = 0; y < addr.dim_y; y += addr.step_y)
+        {
+            for (x = 0; x < addr.dim_x; x += addr.step_x)
+            {
+                vx_uint8 *pixel = (vx_uint8 *)vxFormatImagePatchAddress2d(base, x, y, &addr);
+                *pixel = (vx_uint8)(((x >> 3) ^ (y >> 3)) & 1 ? 200 + ((x * 7 + y * 13) & 31) : (x * y) & 63);
+            }
+        }
+        status = vxUnmapImagePatch(image, map_id);
+    }
+    return status;
+}
+
+/*! \brief Creates an object for each parameter of a factory graph and sets it. */
+static vx_status vxBenchBindGraph(vx_context context, vx_graph graph, vx_bench_graph_t *bench,
+                                  vx_uint32 width, vx_uint32 height,
+                                  vx_reference refs[VX_BENCH_MAX_PARAMS], vx_uint32 *num)
+{
+    vx_status status = VX_SUCCESS;
+    vx_uint32 p;
+
+    status |= vxQueryGraph(graph, VX_GRAPH_NUMPARAMETERS, num, sizeof(*num));
+    if (*num > VX_BENCH_MAX_PARAMS)
+        return VX_ERROR_NOT_SUPPORTED;
+    for (p = 0; (p < *num) && (status == VX_SUCCESS); p++)
+    {
+        vx_parameter param = vxGetGraphParameterByIndex(graph, p);
+        vx_enum type = VX_TYPE_INVALID, dir = VX_INPUT;
+
+        status |= vxQueryParameter(param, VX_PARAMETER_TYPE, &type, sizeof(type));
+        status |= vxQueryParameter(param, VX_PARAMETER_DIRECTION, &dir, sizeof(dir));
+        vxReleaseParameter(&param);
+        if (type == VX_TYPE_IMAGE)
+        {
+            refs[p] = (vx_reference)vxCreateImage(context, width, height, (vx_df_image)bench->formats[p]);
+            status |= vxGetStatus(refs[p]);
+            if ((status == VX_SUCCESS) && (dir == VX_INPUT))
+                status |= vxBenchFillImage((vx_image)refs[p]);
+        }
+        else if (type == VX_TYPE_ARRAY)
+        {
+            refs[p] = (vx_reference)vxCreateArray(context, bench->formats[p], VX_BENCH_ARRAY_CAPACITY);
+            status |= vxGetStatus(refs[p]);
+        }
+        else
+        {
+            printf("Graph %s parameter %u has unsupported type %08x\n", bench->name, p, type);
+            status = VX_ERROR_NOT_SUPPORTED;
+        }
+        if (status == VX_SUCCESS)
+            status |= vxSetGraphParameterByIndex(graph, p, refs[p]);
+    }
+    return status;
+}
+
+static void vxBenchPrintNodes(FILE *out, vx_graph graph)
+{
+    vx_uint32 n, num = 0;
+
+    vxQueryGraph(graph, VX_GRAPH_NUMNODES, &num, sizeof(num));
+    fprintf(out, ",\"nodes\":[");
+    for (n = 0; (n < num) && (n < VX_BENCH_MAX_NODES); n++)
+    {
+        vx_char kernel_name[VX_MAX_KERNEL_NAME] = {0};
+        vx_node node = vxGetGraphNodeByIndex(graph, n, kernel_name);
+        vx_perf_t perf;
+
+        if (node == 0)
+            break;
+        memset(&perf, 0, sizeof(perf));
+        vxQueryNode(node, VX_NODE_PERFORMANCE, &perf, sizeof(perf));
+        fprintf(out, "%s{\"kernel\":\"%s\",\"avg_ms\":%.4f,\"min_ms\":%.4f,\"max_ms\":%.4f,\"runs\":%llu}",
+                n ? "," : "", kernel_name,
+                (vx_float64)perf.avg / 1000000.0,
+                (vx_float64)perf.min / 1000000.0,
+                (vx_float64)perf.max / 1000000.0,
+                (unsigned long long)perf.num);
+        vxReleaseNode(&node);
+    }
+    fprintf(out, "]");
+}
+
+/*! \brief Runs one factory graph at one resolution and writes its JSON object. */
+static vx_status vxBenchGraph(FILE *out, vx_context context, vx_bench_graph_t *bench,
+                              vx_uint32 width, vx_uint32 height,
+                              vx_uint32 warmup, vx_uint32 iterations)
+{
+    vx_status status = VX_SUCCESS;
+    vx_reference refs[VX_BENCH_MAX_PARAMS] = {0};
+    vx_uint32 i, num = 0;
+    vx_bench_result_t result = {NULL, 0, 0};
+    vx_graph graph = bench->factory(context);
+
+    fprintf(out, "{\"graph\":\"%s\",\"width\":%u,\"height\":%u", bench->name, width, height);
+    status = vxGetStatus((vx_reference)graph);
+    if (status == VX_SUCCESS)
+        status = vxBenchBindGraph(context, graph, bench, width, height, refs, &num);
+    if (status == VX_SUCCESS)
+        status = vxVerifyGraph(graph);
+    for (i = 0; (i < warmup) && (status == VX_SUCCESS); i++)
+    {
+        status = vxProcessGraph(graph);
+    }
+    result.samples = (vx_uint64 *)calloc(iterations, sizeof(vx_uint64));
+    if (result.samples == NULL)
+        status = VX_ERROR_NO_MEMORY;
+    for (i = 0; (i < iterations) && (status == VX_SUCCESS); i++)
+    {
+        vx_uint64 start = vxBenchTime();
+        status = vxProcessGraph(graph);
+        result.samples[i] = vxBenchTime() - start;
+        result.total += result.samples[i];
+        result.count++;
+    }
+    fprintf(out, ",\"status\":%d", status);
+    if (result.count > 0)
+    {
+        fprintf(out, ",\"iterations\":%u,", result.count);
+        vxBenchPrintLatency(out, &result);
+        vxBenchPrintNodes(out, graph);
+    }
+    fprintf(out, "}");
+
+    free(result.samples);
+    for (i = 0; i < num; i++)
+    {
+        if (refs[i])
+            vxReleaseReference(&refs[i]);
+    }
+    if (graph)
+        vxReleaseGraph(&graph);
+    return status;
+}
+
+#if defined(OPENVX_USE_NN)
+#define VX_BENCH_MAX_NETWORK_FILES (3)
+#define ALEXNET_MEAN_PLANE_SIZE    (65536)
+
+typedef int (*vx_bench_network_f)(int16_t **data, int16_t *output);
+
+static int vxBenchRunOverfeat(int16_t **data, int16_t *output)
+{
+    return Overfeat(data, VX_TYPE_INT16, Q78_FIXED_POINT_POSITION, false, output);
+}
+
+/*! \brief Alexnet takes the input, one pointer per mean plane and the weights. */
+static int vxBenchRunAlexnet(int16_t **data, int16_t *output)
+{
+    int16_t *planes[5] = {
+        data[0],
+        data[1],
+        data[1] + ALEXNET_MEAN_PLANE_SIZE,
+        data[1] + 2 * ALEXNET_MEAN_PLANE_SIZE,
+        data[2],
+    };
+    return Alexnet(planes, false, output);
+}
+
+static int vxBenchRunGooglenet2(int16_t **data, int16_t *output)
+{
+    return Googlenet2(data, VX_TYPE_INT16, Q78_FIXED_POINT_POSITION, false, false, output);
+}
+
+/*! \brief Describes a sample CNN and the files, in order, its entry point reads.
+ * \ingroup group_example
+ */
+typedef struct _vx_bench_network_t {
+    const vx_char *name;
+    vx_bench_network_f run;
+    vx_uint32 num_files;
+    /*! \brief The number of 16 bit values in each file */
+    size_t sizes[VX_BENCH_MAX_NETWORK_FILES];
+} vx_bench_network_t;
+
+static vx_bench_network_t networks[] = {
+    {"overfeat",   vxBenchRunOverfeat,   2, {160083, 145920872}},
+    {"alexnet",    vxBenchRunAlexnet,    3, {154587, 196608, 60965224}},
+    {"googlenet2", vxBenchRunGooglenet2, 2, {150529, 10129865}},
+};
+
+static int16_t *vxBenchReadFile(const char *filename, size_t count)
+{
+    int16_t *data = NULL;
+    FILE *fp = fopen(filename, "rb");
+    if (fp)
+    {
+        data = (int16_t *)malloc(count * sizeof(int16_t));
+        if (data && fread(data, sizeof(int16_t), count, fp) != count)
+        {
+            printf("%s is shorter than %u values\n", filename, (vx_uint32)count);
+            free(data);
+            data = NULL;
+        }
+        fclose(fp);
+    }
+    else
+    {
+        printf("Failed to open %s\n", filename);
+    }
+    return data;
+}
+
+/*! \brief Runs a sample CNN. The network entry points build and verify their own context
+ * and graph on every call, so the latencies only cover vxProcessGraph and the rest of each
+ * call is reported as the mean setup time.
+ */
+static vx_status vxBenchNetwork(FILE *out, vx_bench_network_t *net, const char *files[],
+                                vx_uint32 warmup, vx_uint32 iterations)
+{
+    vx_status status = VX_SUCCESS;
+    vx_bench_result_t result = {NULL, 0, 0};
+    vx_uint64 setup = 0;
+    int16_t output[1000];
+    int16_t *data[VX_BENCH_MAX_NETWORK_FILES] = {NULL};
+    vx_uint32 i;
+
+    fprintf(out, "{\"network\":\"%s\"", net->name);
+    for (i = 0; i < net->num_files; i++)
+    {
+        data[i] = vxBenchReadFile(files[i], net->sizes[i]);
+        if (data[i] == NULL)
+            status = VX_ERROR_INVALID_PARAMETERS;
+    }
+    for (i = 0; (i < warmup) && (status == VX_SUCCESS); i++)
+    {
+        if (net->run(data, output) != 0)
+            status = VX_FAILURE;
+    }
+    result.samples = (vx_uint64 *)calloc(iterations, sizeof(vx_uint64));
+    if (result.samples == NULL)
+        status = VX_ERROR_NO_MEMORY;
+    for (i = 0; (i < iterations) && (status == VX_SUCCESS); i++)
+    {
+        vx_uint64 start = vxBenchTime();
+        if (net->run(data, output) != 0)
+            status = VX_FAILURE;
+        result.samples[i] = GetLastProcessTime();
+        setup += (vxBenchTime() - start) - result.samples[i];
+        result.total += result.samples[i];
+        result.count++;
+    }
+    fprintf(out, ",\"status\":%d", status);
+    if (result.count > 0)
+    {
+        fprintf(out, ",\"iterations\":%u,\"setup_ms\":%.4f,", result.count,
+                (vx_float64)setup / (vx_float64)result.count / 1000000.0);
+        vxBenchPrintLatency(out, &result);
+    }
+    fprintf(out, "}");
+    free(result.samples);
+    for (i = 0; i < net->num_files; i++)
+        free(data[i]);
+    return status;
+}
+
+#define VX_BENCH_LAYER_TENSORS  (4)
+#define VX_BENCH_MAX_LAYER_DIMS (4)
+
+typedef vx_node (*vx_bench_layer_f)(vx_graph graph, vx_tensor tensors[VX_BENCH_LAYER_TENSORS]);
+
+static vx_node vxBenchConv3x3(vx_graph graph, vx_tensor tensors[VX_BENCH_LAYER_TENSORS])
+{
+    vx_nn_convolution_params_t params = {1, 1, VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_ZERO,
+                                         VX_NN_DS_SIZE_ROUNDING_FLOOR, 0, 0};
+    return vxConvolutionLayer(graph, tensors[0], tensors[1], tensors[2], &params, sizeof(params), tensors[3]);
+}
+
+static vx_node vxBenchFullyConnected(vx_graph graph, vx_tensor tensors[VX_BENCH_LAYER_TENSORS])
+{
+    return vxFullyConnectedLayer(graph, tensors[0], tensors[1], tensors[2],
+                                 VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_ZERO, tensors[3]);
+}
+
+/*! \brief Describes a single NN layer node and the dims of its input, weights, biases and output.
+ * \ingroup group_example
+ */
+typedef struct _vx_bench_layer_t {
+    const vx_char *name;
+    vx_bench_layer_f create;
+    vx_size num_dims[VX_BENCH_LAYER_TENSORS];
+    vx_size dims[VX_BENCH_LAYER_TENSORS][VX_BENCH_MAX_LAYER_DIMS];
+} vx_bench_layer_t;
+
+static vx_bench_layer_t layers[] = {
+    {"conv3x3", vxBenchConv3x3,        {3, 4, 1, 3}, {{15, 15, 256}, {3, 3, 256, 512}, {512}, {15, 15, 512}}},
+    {"fc",      vxBenchFullyConnected, {1, 2, 1, 1}, {{9216}, {9216, 3072}, {3072}, {3072}}},
+};
+
+/*! \brief A tensor format the layers are timed in.
+ * \ingroup group_example
+ */
+typedef struct _vx_bench_format_t {
+    const vx_char *name;
+    vx_enum type;
+    vx_int8 fixed_point_position;
+} vx_bench_format_t;
+
+static vx_bench_format_t formats[] = {
+    {"q78", VX_TYPE_INT16,   Q78_FIXED_POINT_POSITION},
+#if defined(EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT)
+    {"f16", VX_TYPE_FLOAT16, 0},
+#endif
+};
+
+/*! \brief Fills a tensor with values in [-0.25, 0.25]. The values only depend on the seed, so
+ * every format sees the same data.
+ */
+static vx_status vxBenchFillTensor(vx_tensor tensor, vx_size num_dims, const vx_size *dims,
+                                   vx_bench_format_t *format, vx_uint32 seed)
+{
+    vx_status status = VX_SUCCESS;
+    vx_size start[VX_BENCH_MAX_LAYER_DIMS] = {0};
+    vx_size strides[VX_BENCH_MAX_LAYER_DIMS];
+    vx_size d, i, count = 1;
+    vx_int16 *data;
+
+    for (d = 0; d < num_dims; d++)
+    {
+        strides[d] = count * sizeof(vx_int16);
+        count *= dims[d];
+    }
+    data = (vx_int16 *)malloc(count * sizeof(vx_int16));
+    if (data == NULL)
+        return VX_ERROR_NO_MEMORY;
+    for (i = 0; i < count; i++)
+    {
+        vx_int16 q78;
+        seed = seed * 1664525u + 1013904223u;
+        q78 = (vx_int16)((seed >> 16) % 129) - 64;
+#if defined(EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT)
+        if (format->type == VX_TYPE_FLOAT16)
+        {
+            data[i] = (vx_int16)float2half((vx_float32)q78 / (1 << Q78_FIXED_POINT_POSITION));
+            continue;
+        }
+#endif
+        data[i] = q78;
+    }
+    status = vxCopyTensorPatch(tensor, num_dims, start, dims, strides, data, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    free(data);
+    return status;
+}
+
+/*! \brief Runs one layer in one format as a single node graph and writes its JSON object. */
+static vx_status vxBenchLayer(FILE *out, vx_context context, vx_bench_layer_t *layer, vx_bench_format_t *format,
+                              vx_uint32 warmup, vx_uint32 iterations)
+{
+    vx_status status = VX_SUCCESS;
+    vx_tensor tensors[VX_BENCH_LAYER_TENSORS] = {0};
+    vx_bench_result_t result = {NULL, 0, 0};
+    vx_graph graph = vxCreateGraph(context);
+    vx_node node = 0;
+    vx_uint32 i;
+
+    fprintf(out, "{\"layer\":\"%s\",\"format\":\"%s\"", layer->name, format->name);
+    status = vxGetStatus((vx_reference)graph);
+    for (i = 0; (i < VX_BENCH_LAYER_TENSORS) && (status == VX_SUCCESS); i++)
+    {
+        tensors[i] = vxCreateTensor(context, layer->num_dims[i], layer->dims[i], format->type,
+                                    format->fixed_point_position);
+        status = vxGetStatus((vx_reference)tensors[i]);
+        if ((status == VX_SUCCESS) && (i + 1 < VX_BENCH_LAYER_TENSORS))
+            status = vxBenchFillTensor(tensors[i], layer->num_dims[i], layer->dims[i], format, i + 1);
+    }
+    if (status == VX_SUCCESS)
+    {
+        node = layer->create(graph, tensors);
+        status = vxGetStatus((vx_reference)node);
+    }
+    if (status == VX_SUCCESS)
+        status = vxVerifyGraph(graph);
+    for (i = 0; (i < warmup) && (status == VX_SUCCESS); i++)
+    {
+        status = vxProcessGraph(graph);
+    }
+    result.samples = (vx_uint64 *)calloc(iterations, sizeof(vx_uint64));
+    if (result.samples == NULL)
+        status = VX_ERROR_NO_MEMORY;
+    for (i = 0; (i < iterations) && (status == VX_SUCCESS); i++)
+    {
+        vx_uint64 start = vxBenchTime();
+        status = vxProcessGraph(graph);
+        result.samples[i] = vxBenchTime() - start;
+        result.total += result.samples[i];
+        result.count++;
+    }
+    fprintf(out, ",\"status\":%d", status);
+    if (result.count > 0)
+    {
+        fprintf(out, ",\"iterations\":%u,", result.count);
+        vxBenchPrintLatency(out, &result);
+        vxBenchPrintNodes(out, graph);
+    }
+    fprintf(out, "}");
+
+    free(result.samples);
+    if (node)
+        vxReleaseNode(&node);
+    for (i = 0; i < VX_BENCH_LAYER_TENSORS; i++)
+    {
+        if (tensors[i])
+            vxReleaseTensor(&tensors[i]);
+    }
+    if (graph)
+        vxReleaseGraph(&graph);
+    return status;
+}
+#endif
+
+static void vxBenchUsage(void)
+{
+    printf("Usage: vx_bench [-s WxH]... [-g edge|corners|pipeline]... [-i iterations] [-u warmup]\n"
+           "                [-o file.json]"
+#if defined(OPENVX_USE_NN)
+           "\n                [-n overfeat|googlenet2 <input> <weights>] [-n alexnet <input> <mean> <weights>]"
+           "\n                [-l conv3x3|fc]..."
+#endif
+           "\n");
+}
+
+/*! \brief The graph benchmark.
+ * \ingroup group_example
+ */
+int main(int argc, char *argv[])
+{
+    vx_status status = VX_SUCCESS;
+    vx_uint32 widths[VX_BENCH_MAX_SIZES] = {640};
+    vx_uint32 heights[VX_BENCH_MAX_SIZES] = {480};
+    vx_uint32 num_sizes = 0;
+    vx_bool selected[dimof(graphs)] = {vx_false_e};
+    vx_bool any_selected = vx_false_e;
+    vx_uint32 iterations = 100, warmup = 10;
+    const char *filename = NULL;
+    const char *network = NULL;
+#if defined(OPENVX_USE_NN)
+    vx_bench_network_t *net = NULL;
+    const char *files[VX_BENCH_MAX_NETWORK_FILES] = {NULL};
+    vx_bool layer_selected[dimof(layers)] = {vx_false_e};
+    vx_uint32 f, l;
+#endif
+    vx_bool any_layer = vx_false_e;
+    vx_uint32 g, s;
+    vx_bool first = vx_true_e;
+    FILE *out = stdout;
+    int a;
+
+    for (a = 1; a < argc; a++)
+    {
+        if ((strcmp(argv[a], "-s") == 0) && (a + 1 < argc) && (num_sizes < VX_BENCH_MAX_SIZES))
+        {
+            if (sscanf(argv[++a], "%ux%u", &widths[num_sizes], &heights[num_sizes]) == 2)
+                num_sizes++;
+        }
+        else if ((strcmp(argv[a], "-g") == 0) && (a + 1 < argc))
+        {
+            a++;
+            for (g = 0; g < dimof(graphs); g++)
+            {
+                if (strcmp(argv[a], graphs[g].name) == 0)
+                    selected[g] = any_selected = vx_true_e;
+            }
+        }
+        else if ((strcmp(argv[a], "-i") == 0) && (a + 1 < argc))
+            iterations = (vx_uint32)atoi(argv[++a]);
+        else if ((strcmp(argv[a], "-u") == 0) && (a + 1 < argc))
+            warmup = (vx_uint32)atoi(argv[++a]);
+        else if ((strcmp(argv[a], "-o") == 0) && (a + 1 < argc))
+            filename = argv[++a];
+        else if ((strcmp(argv[a], "-n") == 0) && (a + 1 < argc))
+        {
+            network = argv[++a];
+#if defined(OPENVX_USE_NN)
+            for (net = NULL, g = 0; g < dimof(networks); g++)
+            {
+                if (strcmp(network, networks[g].name) == 0)
+                    net = &networks[g];
+            }
+            if (net && (a + (int)net->num_files < argc))
+            {
+                for (f = 0; f < net->num_files; f++)
+                    files[f] = argv[++a];
+            }
+            else
+            {
+                vxBenchUsage();
+                return -1;
+            }
+#endif
+        }
+#if defined(OPENVX_USE_NN)
+        else if ((strcmp(argv[a], "-l") == 0) && (a + 1 < argc))
+        {
+            a++;
+            for (l = 0; l < dimof(layers); l++)
+            {
+                if (strcmp(argv[a], layers[l].name) == 0)
+                    layer_selected[l] = any_layer = vx_true_e;
+            }
+        }
+#endif
+        else
+        {
+            vxBenchUsage();
+            return -1;
+        }
+    }
+    if (num_sizes == 0)
+        num_sizes = 1;
+    if (iterations == 0)
+        iterations = 1;
+    if (filename)
+    {
+        out = fopen(filename, "w");
+        if (out == NULL)
+        {
+            printf("Failed to open %s\n", filename);
+            return -1;
+        }
+    }
+
+    fprintf(out, "{\"iterations\":%u,\"warmup\":%u,\"results\":[\n", iterations, warmup);
+    if ((network == NULL && any_layer == vx_false_e) || any_selected)
+    {
+        vx_context context = vxCreateContext();
+        status = vxGetStatus((vx_reference)context);
+        if (status == VX_SUCCESS)
+        {
+            vxDirective((vx_reference)context, VX_DIRECTIVE_ENABLE_PERFORMANCE);
+            for (g = 0; g < dimof(graphs); g++)
+            {
+                if (any_selected && selected[g] == vx_false_e)
+                    continue;
+                for (s = 0; s < num_sizes; s++)
+                {
+                    if (!first)
+                        fprintf(out, ",\n");
+                    status |= vxBenchGraph(out, context, &graphs[g], widths[s], heights[s], warmup, iterations);
+                    first = vx_false_e;
+                }
+            }
+            vxReleaseContext(&context);
+        }
+        else
+        {
+            printf("Failed to create context!\n");
+        }
+    }
+    if (network)
+    {
+        if (!first)
+            fprintf(out, ",\n");
+#if defined(OPENVX_USE_NN)
+        status |= vxBenchNetwork(out, net, files, warmup, iterations);
+#else
+        fprintf(out, "{\"network\":\"%s\",\"status\":%d}", network, VX_ERROR_NOT_SUPPORTED);
+        status |= VX_ERROR_NOT_SUPPORTED;
+#endif
+        first = vx_false_e;
+    }
+#if defined(OPENVX_USE_NN)
+    if (any_layer)
+    {
+        vx_context context = vxCreateContext();
+        if (vxGetStatus((vx_reference)context) == VX_SUCCESS)
+        {
+            vxDirective((vx_reference)context, VX_DIRECTIVE_ENABLE_PERFORMANCE);
+            for (l = 0; l < dimof(layers); l++)
+            {
+                if (layer_selected[l] == vx_false_e)
+                    continue;
+                for (f = 0; f < dimof(formats); f++)
+                {
+                    if (!first)
+                        fprintf(out, ",\n");
+                    status |= vxBenchLayer(out, context, &layers[l], &formats[f], warmup, iterations);
+                    first = vx_false_e;
+                }
+            }
+            vxReleaseContext(&context);
+        }
+        else
+        {
+            printf("Failed to create context!\n");
+            status |= vxGetStatus((vx_reference)context);
+        }
+    }
+#endif
+    fprintf(out, "\n],\"peak_rss_kib\":%llu}\n", (unsigned long long)vxBenchPeakRSS());
+
+    if (out != stdout)
+        fclose(out);
+    return status;
+}
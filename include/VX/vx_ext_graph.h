@@ -0,0 +1,46 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _VX_EXT_GRAPH_H_
+#define _VX_EXT_GRAPH_H_
+
+/*! \brief The sample implementation's Graph Query Extension.
+ * \file
+ */
+
+#define OPENVX_EXT_GRAPH  "vx_ext_graph"
+
+#include <VX/vx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Retrieves a node of a graph, so that its \ref VX_NODE_PERFORMANCE can be read
+ * when the graph was built by code which did not keep the node handles.
+ * \param [in] graph The graph.
+ * \param [in] index The index of the node, less than \ref VX_GRAPH_NUMNODES.
+ * \param [out] kernel_name If not NULL, receives the name of the node's kernel.
+ * \return The node, which must be released with \ref vxReleaseNode, or 0 if the index is out of range.
+ */
+VX_API_ENTRY vx_node VX_API_CALL vxGetGraphNodeByIndex(vx_graph graph, vx_uint32 index, vx_char kernel_name[VX_MAX_KERNEL_NAME]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _VX_EXT_IX_FILE_H_
+#define _VX_EXT_IX_FILE_H_
+
+/*! \brief The sample implementation's Import Objects from File Extension.
+ * \file
+ */
+
+#define OPENVX_EXT_IX_FILE  "vx_ext_ix_file"
+
+#include <VX/vx.h>
+#include <VX/vx_khr_ix.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Imports objects from a file written with the contents of a \ref vxExportObjectsToMemory blob.
+ * The file is mapped into memory rather than read, and the data of exported tensors is used in place,
+ * so processes importing the same file share its pages until they are written.
+ * The parameters and results are otherwise as for \ref vxImportObjectsFromMemory.
+ * \param [in] context The context.
+ * \param [in] numrefs The number of references to import.
+ * \param [in,out] refs The references to import.
+ * \param [in] uses How to import each reference.
+ * \param [in] filename The name of the file to import from.
+ */
+VX_API_ENTRY vx_import VX_API_CALL vxImportObjectsFromFile(
+    vx_context context,
+    vx_size numrefs,
+    vx_reference *refs,
+    const vx_enum * uses,
+    const vx_char *filename);
+
+/*! \brief As \ref vxImportObjectsFromFile, but from a file that is already open.
+ * \param [in] fd The file descriptor. The caller keeps ownership and may close it on return.
+ */
+VX_API_ENTRY vx_import VX_API_CALL vxImportObjectsFromDescriptor(
+    vx_context context,
+    vx_size numrefs,
+    vx_reference *refs,
+    const vx_enum * uses,
+    int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
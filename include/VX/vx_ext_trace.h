@@ -0,0 +1,61 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _VX_EXT_TRACE_H_
+#define _VX_EXT_TRACE_H_
+
+/*! \brief The sample implementation's Timeline Trace Extension.
+ * \file
+ */
+
+#define OPENVX_EXT_TRACE  "vx_ext_trace"
+
+/*! \brief The environment variable which, when set at context creation, enables tracing
+ * and names the file the trace is written to when the context is released.
+ */
+#define VX_TRACE_FILE_ENV "VX_TRACE_FILE"
+
+#include <VX/vx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Turns recording of the execution timeline on or off.
+ * While on, every thread which runs graphs, nodes, tiles, thread pool work items or
+ * memory maps and copies records begin and end events in a ring buffer of its own.
+ * Turning tracing on discards any events already recorded.
+ * \param [in] context The context.
+ * \param [in] enable vx_true_e to record events.
+ * \return A <tt>\ref vx_status_e</tt> enumeration.
+ */
+VX_API_ENTRY vx_status VX_API_CALL vxEnableTrace(vx_context context, vx_bool enable);
+
+/*! \brief Writes the recorded timeline as Chrome trace-event JSON, which can be loaded
+ * into chrome://tracing or Perfetto. Only the most recent events of each thread are
+ * kept, so a long run yields its tail. The graphs of the context should not be executing.
+ * \param [in] context The context.
+ * \param [in] filename The name of the file to write to.
+ * \return A <tt>\ref vx_status_e</tt> enumeration.
+ */
+VX_API_ENTRY vx_status VX_API_CALL vxExportTraceToFile(vx_context context, const vx_char *filename);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -38,6 +38,7 @@ LOCAL_SRC_FILES :=  c_absdiff.c \
 					c_integralimage.c \
 					c_lut.c \
 					c_magnitude.c \
+					c_parallel.c \
 					c_sobel3x3.c \
 					c_statistics.c 
 LOCAL_C_INCLUDES := $(OPENVX_INC) $(OPENVX_TOP)/$(OPENVX_SRC)/include $(OPENVX_TOP)/debug
@@ -19,10 +19,49 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include <float.h>
 #include <c_model.h>
 
 #define  COLOR_WEIGHT_SIZE_PER_CHANNEL      256
+#define  EXP_NUM_BINS_PER_CHANNEL           (1 << 12)
+
+/*! \brief The least number of rows worth a thread of their own. */
+#define  BILATERAL_ROWS_PER_THREAD          (8)
+
+/*! \brief The head of the weight tables kept in node local data. The taps of the
+ * circular window follow it, as dx[], dy[] and space[], then the colour weights.
+ */
+typedef struct _bilateral_tables_t {
+    vx_bool valid;
+    vx_int32 diameter;
+    vx_float32 sigma_space;
+    vx_float32 sigma_color;
+    vx_enum type;
+    vx_int32 cn;
+    vx_int16 min_value;     /* the range the INT16 colour weights were spread over */
+    vx_int16 max_value;
+    vx_int32 taps;          /* offsets inside the circle, in raster order */
+    vx_float32 scale_index; /* colour difference to INT16 colour weight index */
+} bilateral_tables_t;
+
+typedef struct _bilateral_t {
+    const vx_uint8 *src;
+    vx_uint8 *dst;
+    vx_size xs;             /* strides of a column, a row and a channel */
+    vx_size ys;
+    vx_size cs;
+    vx_int32 width;
+    vx_int32 height;
+    vx_int32 cn;
+    vx_enum type;
+    vx_int32 radius;
+    vx_int32 low_x;
+    vx_int32 high_x;
+    vx_int32 low_y;
+    vx_border_t *border;
+    const bilateral_tables_t *tables;
+} bilateral_t;
 
 static void getMinMax(void* src, vx_size* src_strides, vx_size* dims, vx_size num_of_dims,
                       vx_int16 *max_value, vx_int16 *min_value)
@@ -76,415 +115,411 @@ static void getMinMax(void* src, vx_size* src_strides, vx_size* dims, vx_size nu
     }
 }
 
-static void releaseRes(void *pData)
+static vx_size bilateral_header_size(void)
 {
-    if (NULL != pData)
-    {
-        free(pData);
-    }
-    return;
+    return (sizeof(bilateral_tables_t) + 7) & ~(vx_size)7;
 }
 
-static vx_status calcColorWeight(vx_uint8 cn, vx_float64 gauss_color_coeff, vx_float32 **color_weight)
+static vx_int32 bilateral_color_size(vx_enum type, vx_int32 cn)
 {
-    vx_float32 *tmp_weight = (vx_float32 *)malloc(cn * COLOR_WEIGHT_SIZE_PER_CHANNEL * sizeof(vx_float32));
-    if (NULL == tmp_weight)
-    {
-        return VX_ERROR_NO_MEMORY;
-    }
+    return (type == VX_TYPE_UINT8) ? cn * COLOR_WEIGHT_SIZE_PER_CHANNEL : cn * EXP_NUM_BINS_PER_CHANNEL + 2;
+}
 
-    for (vx_int32 i = 0; i < (cn * COLOR_WEIGHT_SIZE_PER_CHANNEL); i++)
-    {
-        tmp_weight[i] = (vx_float32)exp(i * i * gauss_color_coeff);
-    }
+static const vx_int32 *bilateral_dx(const bilateral_tables_t *t)
+{
+    return (const vx_int32 *)((const vx_uint8 *)t + bilateral_header_size());
+}
 
-    *color_weight = tmp_weight;
+static const vx_int32 *bilateral_dy(const bilateral_tables_t *t)
+{
+    return bilateral_dx(t) + t->diameter * t->diameter;
+}
 
-    return VX_SUCCESS;
+static const vx_float32 *bilateral_space(const bilateral_tables_t *t)
+{
+    return (const vx_float32 *)(bilateral_dy(t) + t->diameter * t->diameter);
 }
 
-static vx_status calcSpaceWeight(vx_int32 diameter, vx_float64 gauss_space_coeff, vx_float32 **space_weight)
+static const vx_float32 *bilateral_color(const bilateral_tables_t *t)
 {
-    vx_int32 radius = diameter / 2;
-    vx_float32 *tmp_weight = (vx_float32 *)malloc(diameter * diameter * sizeof(vx_float32));
-    if (NULL == tmp_weight)
-    {
-        return VX_ERROR_NO_MEMORY;
-    }
+    return bilateral_space(t) + t->diameter * t->diameter;
+}
+
+vx_size BilateralFilterCacheSizeImpl(vx_int32 diameter, vx_enum type, vx_size num_of_dims)
+{
+    vx_int32 cn = (num_of_dims == 2) ? 1 : 3;
+    if (diameter <= 0)
+        return 0;
+    return bilateral_header_size() +
+           (vx_size)diameter * diameter * (2 * sizeof(vx_int32) + sizeof(vx_float32)) +
+           (vx_size)bilateral_color_size(type, cn) * sizeof(vx_float32);
+}
 
-    for (vx_int32 i = -radius; i <= radius; i++)
+/* (re)builds the tables unless the ones kept are for the same parameters */
+static void bilateral_build_tables(bilateral_tables_t *t, vx_int32 diameter, vx_float32 sigma_space, vx_float32 sigma_color,
+                                   vx_enum type, vx_int32 cn, vx_int16 min_value, vx_int16 max_value)
+{
+    vx_float64 gauss_color_coeff = -0.5 / (sigma_color * sigma_color);
+    vx_float64 gauss_space_coeff = -0.5 / (sigma_space * sigma_space);
+    vx_int32 radius = diameter / 2;
+    vx_int32 *dx, *dy;
+    vx_float32 *space, *color;
+    vx_int32 i, j;
+
+    if (t->valid && t->diameter == diameter && t->sigma_space == sigma_space && t->sigma_color == sigma_color &&
+        t->type == type && t->cn == cn && t->min_value == min_value && t->max_value == max_value)
+        return;
+
+    t->diameter = diameter;
+    t->sigma_space = sigma_space;
+    t->sigma_color = sigma_color;
+    t->type = type;
+    t->cn = cn;
+    t->min_value = min_value;
+    t->max_value = max_value;
+    dx = (vx_int32 *)bilateral_dx(t);
+    dy = (vx_int32 *)bilateral_dy(t);
+    space = (vx_float32 *)bilateral_space(t);
+    color = (vx_float32 *)bilateral_color(t);
+
+    t->taps = 0;
+    for (i = -radius; i <= radius; i++)
     {
-        vx_int32 j = -radius;
-        for (; j <= radius; j++)
+        for (j = -radius; j <= radius; j++)
         {
             vx_float64 r = sqrt((vx_float64)i * i + (vx_float64)j * j);
             if (r > radius)
             {
                 continue;
             }
-            tmp_weight[(i + radius) * diameter + (j + radius)] = (vx_float32)exp(r * r * gauss_space_coeff);
+            dy[t->taps] = i;
+            dx[t->taps] = j;
+            space[t->taps] = (vx_float32)exp(r * r * gauss_space_coeff);
+            t->taps++;
         }
     }
 
-    *space_weight = tmp_weight;
+    if (type == VX_TYPE_UINT8)
+    {
+        for (i = 0; i < (cn * COLOR_WEIGHT_SIZE_PER_CHANNEL); i++)
+        {
+            color[i] = (vx_float32)exp(i * i * gauss_color_coeff);
+        }
+        t->scale_index = 0.f;
+    }
+    else
+    {
+        vx_int32 kExpNumBins = EXP_NUM_BINS_PER_CHANNEL * cn;
+        vx_float32 len = (vx_float32)(max_value - min_value) * cn;
+        vx_float32 lastExpVal = 1.f;
+
+        t->scale_index = kExpNumBins / len;
+        for (i = 0; i < (kExpNumBins + 2); i++)
+        {
+            if (lastExpVal > 0.f)
+            {
+                vx_float64 val = i / t->scale_index;
+                color[i] = (vx_float32)exp(val * val * gauss_color_coeff);
+                lastExpVal = color[i];
+            }
+            else
+            {
+                color[i] = 0.f;
+            }
+        }
+    }
+    t->valid = vx_true_e;
+}
 
-    return VX_SUCCESS;
+/* the weight of an INT16 colour difference, interpolated between bins */
+static vx_float32 bilateral_color_s16(const vx_float32 *color, vx_float32 scale_index, vx_int32 diff)
+{
+    vx_float32 alpha = diff * scale_index;
+    vx_int32 idx = (vx_int32)floorf(alpha);
+    alpha -= idx;
+    return color[idx] + alpha * (color[idx + 1] - color[idx]);
 }
 
-static vx_status bilateralFilter_8u(void* src, vx_size* src_strides, vx_size* dims, vx_size num_of_dims,
-                                    vx_int32 diameter, vx_float32 sigma_space, vx_float32 sigma_color,
-                                    void* dst, vx_size* dst_strides, vx_border_t *bordermode)
+/* a single pixel with its window clamped to the image, for the rows and columns near the border */
+static void bilateral_pixel(const bilateral_t *b, vx_int32 x, vx_int32 y)
 {
-    vx_status status = VX_SUCCESS;
-    vx_int32 y = 0, x = 0;
-    vx_int32 radius_y, radius_x;
-    vx_int32 radius = diameter/2;
-    vx_enum border_mode = bordermode->mode;
-    vx_int32 low_x, low_y, high_x, high_y;
-    vx_float32 *color_weight = NULL;
-    vx_float32 *space_weight = NULL;
-    vx_uint8 cn = num_of_dims == 2 ? 1 : 3;
-
-    vx_float64 gauss_color_coeff = -0.5/(sigma_color*sigma_color);
-    vx_float64 gauss_space_coeff = -0.5/(sigma_space*sigma_space);
-
-    status = calcColorWeight(cn, gauss_color_coeff, &color_weight);
-    status |= calcSpaceWeight(diameter, gauss_space_coeff, &space_weight);
-    if (status != VX_SUCCESS)
-    {
-        releaseRes(color_weight);
-        releaseRes(space_weight);
-    }
+    const bilateral_tables_t *t = b->tables;
+    const vx_int32 *dx = bilateral_dx(t), *dy = bilateral_dy(t);
+    const vx_float32 *space = bilateral_space(t), *color = bilateral_color(t);
+    const vx_uint8 *center = b->src + y * b->ys + x * b->xs;
+    vx_float32 sum[3] = { 0, 0, 0 }, wsum = 0;
+    vx_int32 v0[3], c, k;
 
-    if (bordermode->mode == VX_BORDER_UNDEFINED)
+    for (c = 0; c < b->cn; c++)
+        v0[c] = (b->type == VX_TYPE_UINT8) ? center[c * b->cs] : *(const vx_int16 *)(center + c * b->cs);
+
+    for (k = 0; k < t->taps; k++)
     {
-        low_x = radius;
-        high_x = (dims[num_of_dims - 2] >= radius) ? dims[num_of_dims - 2] - radius : 0;
-        low_y = radius;
-        high_y = (dims[num_of_dims - 1] >= radius) ? dims[num_of_dims - 1] - radius : 0;
+        vx_int32 neighbor_x = x + dx[k];
+        vx_int32 neighbor_y = y + dy[k];
+        vx_int32 tmpx = neighbor_x < 0 ? 0 : (neighbor_x > (b->width - 1) ? (b->width - 1) : neighbor_x);
+        vx_int32 tmpy = neighbor_y < 0 ? 0 : (neighbor_y > (b->height - 1) ? (b->height - 1) : neighbor_y);
+        const vx_uint8 *p = b->src + tmpy * b->ys + tmpx * b->xs;
+        vx_bool outside = (vx_bool)(neighbor_x < 0 || neighbor_y < 0);
+        vx_int32 v[3], diff = 0;
+        vx_float32 w;
+
+        /* the single channel U8 filter is the only one to take the far edges as outside too */
+        if (b->type == VX_TYPE_UINT8 && b->cn == 1)
+            outside = (vx_bool)(outside || neighbor_x >= b->width || neighbor_y >= b->height);
+
+        for (c = 0; c < b->cn; c++)
+        {
+            if (outside && b->border->mode == VX_BORDER_MODE_CONSTANT)
+                v[c] = (b->type == VX_TYPE_UINT8) ? b->border->constant_value.U8 : b->border->constant_value.S16;
+            else
+                v[c] = (b->type == VX_TYPE_UINT8) ? p[c * b->cs] : *(const vx_int16 *)(p + c * b->cs);
+            diff += abs(v[c] - v0[c]);
+        }
+
+        if (b->type == VX_TYPE_UINT8)
+            w = space[k] * color[diff];
+        else
+            w = space[k] * bilateral_color_s16(color, t->scale_index, diff);
+        for (c = 0; c < b->cn; c++)
+            sum[c] += v[c] * w;
+        wsum += w;
     }
-    else
+
+    for (c = 0; c < b->cn; c++)
     {
-        low_x = 0;
-        high_x = dims[num_of_dims - 2];
-        low_y = 0;
-        high_y = dims[num_of_dims - 1];
+        vx_uint8 *out = b->dst + y * b->ys + x * b->xs + c * b->cs;
+        if (b->type == VX_TYPE_UINT8)
+            *out = (vx_uint8)roundf(sum[c] / wsum);
+        else
+            *(vx_int16 *)out = (vx_int16)roundf(sum[c] / wsum);
     }
+}
 
-    for (y = low_y ; y < high_y; y++)
+/* pixels [x0, x1) of row y, whose windows lie inside the image. Every tap is applied across the
+ * whole span before the next one, so the loops over x vectorize while each pixel still sums its
+ * taps in the same order as bilateral_pixel */
+static void bilateral_span(const bilateral_t *b, vx_int32 y, vx_int32 x0, vx_int32 x1, vx_float32 *acc)
+{
+    const bilateral_tables_t *t = b->tables;
+    const vx_int32 *dx = bilateral_dx(t), *dy = bilateral_dy(t);
+    const vx_float32 *space = bilateral_space(t), *color = bilateral_color(t);
+    const vx_uint8 *row = b->src + y * b->ys;
+    vx_int32 n = x1 - x0;
+    vx_float32 *wsum = acc, *sum0 = acc + n, *sum1 = acc + 2 * n, *sum2 = acc + 3 * n;
+    vx_size xs = b->xs, cs = b->cs;
+    vx_int32 i, k;
+
+    memset(acc, 0, 4 * n * sizeof(vx_float32));
+    for (k = 0; k < t->taps; k++)
     {
-        if (num_of_dims == 2)
+        const vx_uint8 *c0 = row + x0 * xs;
+        const vx_uint8 *n0 = c0 + dy[k] * (ptrdiff_t)b->ys + dx[k] * (ptrdiff_t)xs;
+        const vx_float32 ws = space[k];
+
+        if (b->type == VX_TYPE_UINT8 && b->cn == 1)
         {
-            for (x = low_x; x < high_x; x++)
+            for (i = 0; i < n; i++)
             {
-                vx_float32 sum = 0, wsum = 0;
-                vx_uint8 val0 = *((vx_uint8 *)src + y * src_strides[1] + x * src_strides[0]);
-                //kernel filter
-                for (radius_y = -radius; radius_y <= radius; radius_y++)
-                {
-                    for (radius_x = -radius; radius_x <= radius; radius_x++)
-                    {
-                        vx_float64 r = sqrt((vx_float64)radius_y * radius_y + (vx_float64)radius_x * radius_x);
-                        if (r > radius)
-                        {
-                            continue;
-                        }
-                        vx_int32 neighbor_x = x + radius_x;
-                        vx_int32 neighbor_y = y + radius_y;
-                        vx_int32 tmpx = neighbor_x < 0 ? 0 : (neighbor_x > (dims[0] - 1) ? (dims[0] - 1) : neighbor_x);
-                        vx_int32 tmpy = neighbor_y < 0 ? 0 : (neighbor_y > (dims[1] - 1) ? (dims[1] - 1) : neighbor_y);
-                        vx_uint8 neighborVal = 0;
-                        neighborVal = *((vx_uint8 *)src + tmpy * src_strides[1] + tmpx * src_strides[0]);
-                        if (neighbor_x < 0 || neighbor_y < 0 || neighbor_x >= dims[0] || neighbor_y >= dims[1])
-                        {
-                            if (border_mode == VX_BORDER_MODE_CONSTANT)
-                            {
-                                neighborVal = bordermode->constant_value.U8;
-                            }
-                        }
-                        vx_float32 w = space_weight[(radius_y + radius) * diameter + (radius_x + radius)] *
-                                       color_weight[abs(neighborVal - val0)];
-                        sum += neighborVal * w;
-                        wsum += w;
-                    }
-                }
-
-                *((vx_uint8 *)dst + y * src_strides[1] + x * src_strides[0]) = (vx_uint8)roundf(sum / wsum);
+                vx_uint8 v = n0[i * xs];
+                vx_float32 w = ws * color[abs(v - c0[i * xs])];
+                sum0[i] += v * w;
+                wsum[i] += w;
             }
         }
-        else
+        else if (b->type == VX_TYPE_UINT8)
         {
-            for (x = low_x; x < high_x; x++)
+            for (i = 0; i < n; i++)
             {
-                vx_float32 sum_b = 0, sum_g = 0, sum_r = 0, wsum = 0;
-                vx_uint8 b0 = *((vx_uint8 *)src + y * src_strides[2] + x * src_strides[1] + 0 * src_strides[0]);
-                vx_uint8 g0 = *((vx_uint8 *)src + y * src_strides[2] + x * src_strides[1] + 1 * src_strides[0]);
-                vx_uint8 r0 = *((vx_uint8 *)src + y * src_strides[2] + x * src_strides[1] + 2 * src_strides[0]);
-                //kernel filter
-                for (radius_y = -radius; radius_y <= radius; radius_y++)
-                {
-                    for (radius_x = -radius; radius_x <= radius; radius_x++)
-                    {
-                        vx_float64 dist = sqrt((vx_float64)radius_y * radius_y + (vx_float64)radius_x * radius_x);
-                        if (dist > radius)
-                        {
-                            continue;
-                        }
-                        vx_int32 neighbor_x = x + radius_x;
-                        vx_int32 neighbor_y = y + radius_y;
-                        vx_int32 tmpx = neighbor_x < 0 ? 0 : (neighbor_x > (dims[1] - 1) ? (dims[1] - 1) : neighbor_x);
-                        vx_int32 tmpy = neighbor_y < 0 ? 0 : (neighbor_y > (dims[2] - 1) ? (dims[2] - 1) : neighbor_y);
-                        vx_uint8 b = 0, g = 0, r = 0;
-                        b = *((vx_uint8 *)src + tmpy * src_strides[2] + tmpx * src_strides[1] + 0 * src_strides[0]);
-                        g = *((vx_uint8 *)src + tmpy * src_strides[2] + tmpx * src_strides[1] + 1 * src_strides[0]);
-                        r = *((vx_uint8 *)src + tmpy * src_strides[2] + tmpx * src_strides[1] + 2 * src_strides[0]);
-                        if (neighbor_x < 0 || neighbor_y < 0)
-                        {
-                            if (border_mode == VX_BORDER_MODE_CONSTANT)
-                            {
-                                b = g = r = bordermode->constant_value.U8;
-                            }
-                        }
-                        vx_float32 w = space_weight[(radius_y + radius) * diameter + (radius_x + radius)] *
-                                       color_weight[abs(b - b0) + abs(g - g0) + abs(r - r0)];
-                        sum_b += b * w;
-                        sum_g += g * w;
-                        sum_r += r * w;
-                        wsum += w;
-                    }
-                }
-
-                *((vx_uint8 *)dst + y * src_strides[2] + x * src_strides[1] + 0 * src_strides[0]) = (vx_uint8)roundf(sum_b / wsum);
-                *((vx_uint8 *)dst + y * src_strides[2] + x * src_strides[1] + 1 * src_strides[0]) = (vx_uint8)roundf(sum_g / wsum);
-                *((vx_uint8 *)dst + y * src_strides[2] + x * src_strides[1] + 2 * src_strides[0]) = (vx_uint8)roundf(sum_r / wsum);
+                const vx_uint8 *p = n0 + i * xs, *q = c0 + i * xs;
+                vx_uint8 v0 = p[0], v1 = p[cs], v2 = p[2 * cs];
+                vx_float32 w = ws * color[abs(v0 - q[0]) + abs(v1 - q[cs]) + abs(v2 - q[2 * cs])];
+                sum0[i] += v0 * w;
+                sum1[i] += v1 * w;
+                sum2[i] += v2 * w;
+                wsum[i] += w;
             }
         }
-    }
-
-    releaseRes(color_weight);
-    releaseRes(space_weight);
-
-    return status;
-}
-
-static vx_status bilateralFilter_s16(void* src, vx_size* src_strides, vx_size* dims, vx_size num_of_dims,
-                                     vx_int32 diameter, vx_float32 sigma_space, vx_float32 sigma_color,
-                                     void* dst, vx_size* dst_strides, vx_border_t *bordermode)
-{
-    vx_status status = VX_FAILURE;
-    vx_int32 y = 0, x = 0;
-    vx_int32 low_x, low_y, high_x, high_y;
-    vx_int32 radius_y, radius_x;
-    vx_int32 radius = diameter/2;
-    vx_enum border_mode = bordermode->mode;
-    vx_uint8 cn = (num_of_dims == 2) ? 1 : 3;
-    vx_int16 minVal = -1;
-    vx_int16 maxVal = 1;
-    vx_int32 kExpNumBinsPerChannel = 1 << 12;
-    vx_float64 gauss_color_coeff = -0.5 / (sigma_color * sigma_color);
-    vx_float64 gauss_space_coeff = -0.5 / (sigma_space * sigma_space);
-    vx_float32 lastExpVal = 1.f;
-    vx_float32 len, scale_index;
-    vx_int32 kExpNumBins;
-    vx_float32 *color_weight, *space_weight;
-
-    getMinMax(src, src_strides, dims, num_of_dims, &maxVal, &minVal);
-    if ((vx_float32)(abs(maxVal - minVal)) < FLT_EPSILON)
-    {
-        if (num_of_dims == 2)
+        else if (b->cn == 1)
         {
-            for (y = 0; y < dims[1]; y++)
+            for (i = 0; i < n; i++)
             {
-                memcpy((vx_int8 *)dst + dst_strides[1] * y,
-                       (vx_int8 *)src + src_strides[1] * y,
-                       dims[0] * src_strides[0]);
+                vx_int16 v = *(const vx_int16 *)(n0 + i * xs);
+                vx_float32 w = ws * bilateral_color_s16(color, t->scale_index, abs(v - *(const vx_int16 *)(c0 + i * xs)));
+                sum0[i] += v * w;
+                wsum[i] += w;
             }
-            status = VX_SUCCESS;
         }
-        else if (num_of_dims == 3)
+        else
         {
-            for (y = 0; y < dims[2]; y++)
+            for (i = 0; i < n; i++)
             {
-                for (x = 0; x < dims[1]; x++)
-                {
-                    memcpy((vx_int8 *)dst + dst_strides[2] * y + dst_strides[1] * x,
-                           (vx_int8 *)src + src_strides[2] * y + src_strides[1] * x,
-                           dims[0] * src_strides[0]);
-                }
+                const vx_uint8 *p = n0 + i * xs, *q = c0 + i * xs;
+                vx_int16 v0 = *(const vx_int16 *)p, v1 = *(const vx_int16 *)(p + cs), v2 = *(const vx_int16 *)(p + 2 * cs);
+                vx_int32 diff = abs(v0 - *(const vx_int16 *)q) + abs(v1 - *(const vx_int16 *)(q + cs)) +
+                                abs(v2 - *(const vx_int16 *)(q + 2 * cs));
+                vx_float32 w = ws * bilateral_color_s16(color, t->scale_index, diff);
+                sum0[i] += v0 * w;
+                sum1[i] += v1 * w;
+                sum2[i] += v2 * w;
+                wsum[i] += w;
             }
-            status = VX_SUCCESS;
         }
-
-        return status;
     }
 
-    //calculation color weight
-    len = (vx_float32)(maxVal - minVal) * cn;
-    kExpNumBins = kExpNumBinsPerChannel * cn;
-    color_weight = (vx_float32 *)malloc((kExpNumBins + 2) * sizeof(vx_float32));
-    if (NULL == color_weight)
+    for (i = 0; i < n; i++)
     {
-        return VX_ERROR_NO_MEMORY;
+        vx_uint8 *out = b->dst + y * b->ys + (x0 + i) * xs;
+        vx_float32 *sums[3];
+        vx_int32 c;
+
+        sums[0] = sum0;
+        sums[1] = sum1;
+        sums[2] = sum2;
+        for (c = 0; c < b->cn; c++)
+        {
+            if (b->type == VX_TYPE_UINT8)
+                out[c * cs] = (vx_uint8)roundf(sums[c][i] / wsum[i]);
+            else
+                *(vx_int16 *)(out + c * cs) = (vx_int16)roundf(sums[c][i] / wsum[i]);
+        }
     }
-    scale_index = kExpNumBins / len;
-    for (vx_uint32 i = 0; i < (kExpNumBins + 2); i++)
+}
+
+static void bilateral_rows(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const bilateral_t *b = (const bilateral_t *)arg;
+    vx_int32 x0 = b->low_x > b->radius ? b->low_x : b->radius;
+    vx_int32 x1 = b->high_x < b->width - b->radius ? b->high_x : b->width - b->radius;
+    vx_float32 *acc = (x1 > x0) ? (vx_float32 *)malloc(4 * (x1 - x0) * sizeof(vx_float32)) : NULL;
+    vx_uint32 r;
+
+    for (r = start; r < end; r++)
     {
-        if (lastExpVal > 0.f)
+        vx_int32 y = b->low_y + (vx_int32)r;
+        vx_int32 x;
+
+        if (acc && y >= b->radius && y < b->height - b->radius)
         {
-            vx_float64 val = i / scale_index;
-            color_weight[i] = (vx_float32)exp(val * val * gauss_color_coeff);
-            lastExpVal = color_weight[i];
+            for (x = b->low_x; x < x0; x++)
+                bilateral_pixel(b, x, y);
+            bilateral_span(b, y, x0, x1, acc);
+            for (x = x1; x < b->high_x; x++)
+                bilateral_pixel(b, x, y);
         }
         else
         {
-            color_weight[i] = 0.f;
+            for (x = b->low_x; x < b->high_x; x++)
+                bilateral_pixel(b, x, y);
         }
     }
-    //calculation space weight
-    space_weight = NULL;
-    status = calcSpaceWeight(diameter, gauss_space_coeff, &space_weight);
-    if (status != VX_SUCCESS)
-    {
-        free(color_weight);
-        return status;
-    }
+    free(acc);
+}
 
-    if (bordermode->mode == VX_BORDER_UNDEFINED)
+vx_status vxBilateralFilter(void* src, vx_size* src_strides, vx_size* dims, vx_size num_of_dims,
+                            vx_int32 diameter, vx_float32 sigma_space, vx_float32 sigma_color,
+                            void* dst, vx_size* dst_strides, vx_enum type, vx_border_t *bordermode,
+                            void *cache, vx_size cache_size)
+{
+    vx_status status = VX_SUCCESS;
+    vx_int32 cn = (num_of_dims == 2) ? 1 : 3;
+    vx_int16 minVal = 0, maxVal = 0;
+    vx_int32 high_y;
+    vx_size size;
+    void *heap = NULL;
+    bilateral_t b;
+
+    // In case of 3 dimensions the 1st dimension of the vx_tensor. Which can be of size 1 or 2.
+    if ((num_of_dims != 3 && num_of_dims != 2) || (num_of_dims == 3 && (dims[0] != 1 && dims[0] != 2)))
     {
-        low_x = radius;
-        high_x = (dims[num_of_dims - 2] >= radius) ? dims[num_of_dims - 2] - radius : 0;
-        low_y = radius;
-        high_y = (dims[num_of_dims - 1] >= radius) ? dims[num_of_dims - 1] - radius : 0;
+        return VX_ERROR_INVALID_PARAMETERS;
     }
-    else
+    if (type != VX_TYPE_UINT8 && type != VX_TYPE_INT16)
     {
-        low_x = 0;
-        high_x = dims[num_of_dims - 2];
-        low_y = 0;
-        high_y = dims[num_of_dims - 1];
+        return status;
     }
 
-    for (y = low_y; y < high_y; y++)
+    if (type == VX_TYPE_INT16)
     {
-        if (num_of_dims == 2)
+        vx_int32 y, x;
+
+        getMinMax(src, src_strides, dims, num_of_dims, &maxVal, &minVal);
+        if ((vx_float32)(abs(maxVal - minVal)) < FLT_EPSILON)
         {
-            for (x = low_x; x < high_x; x++)
+            if (num_of_dims == 2)
             {
-                vx_int16 val0 = *(vx_int16 *)((vx_int8 *)src + y * src_strides[1] + x * src_strides[0]);
-                vx_float32 sum = 0, wsum = 0;
-                //kernel filter
-                for (radius_y = -radius; radius_y <= radius; radius_y++)
+                for (y = 0; y < dims[1]; y++)
                 {
-                    for (radius_x = -radius; radius_x <= radius; radius_x++)
-                    {
-                        vx_float64 r = sqrt((vx_float64)radius_y * radius_y + (vx_float64)radius_x * radius_x);
-                        if (r > radius)
-                        {
-                            continue;
-                        }
-                        vx_int32 neighbor_x = x + radius_x;
-                        vx_int32 neighbor_y = y + radius_y;
-                        vx_int32 tmpx = neighbor_x < 0 ? 0 : (neighbor_x > (dims[0] - 1) ? (dims[0] - 1) : neighbor_x);
-                        vx_int32 tmpy = neighbor_y < 0 ? 0 : (neighbor_y > (dims[1] - 1) ? (dims[1] - 1) : neighbor_y);
-                        vx_int16 val = *(vx_int16 *)((vx_int8 *)src + tmpy * src_strides[1] + tmpx * src_strides[0]);
-                        if (neighbor_x < 0 || neighbor_y < 0)
-                        {
-                            if (border_mode == VX_BORDER_MODE_CONSTANT)
-                            {
-                                val = bordermode->constant_value.S16;
-                            }
-                        }
-
-                        vx_float32 alpha = abs(val - val0) * scale_index;
-                        vx_int32 idx = (vx_int32)floorf(alpha);
-                        alpha -= idx;
-                        vx_float32 w = space_weight[(radius_y + radius) * diameter + (radius_x + radius)] *
-                            (color_weight[idx] + alpha * (color_weight[idx + 1] - color_weight[idx]));
-                        sum += val * w;
-                        wsum += w;
-                    }
+                    memcpy((vx_int8 *)dst + dst_strides[1] * y,
+                           (vx_int8 *)src + src_strides[1] * y,
+                           dims[0] * src_strides[0]);
                 }
-
-                *(vx_int16 *)((vx_uint8 *)dst + y * src_strides[1] + x * src_strides[0]) = (vx_int16)roundf(sum / wsum);
             }
-        }
-        else if (num_of_dims == 3)
-        {
-            for (x = low_x; x < high_x; x++)
+            else
             {
-                vx_float32 sum_b = 0, sum_g = 0, sum_r = 0, wsum = 0;
-                vx_int16 b0 = *(vx_int16 *)((vx_uint8 *)src + y * src_strides[2] + x * src_strides[1] + 0 * src_strides[0]);
-                vx_int16 g0 = *(vx_int16 *)((vx_uint8 *)src + y * src_strides[2] + x * src_strides[1] + 1 * src_strides[0]);
-                vx_int16 r0 = *(vx_int16 *)((vx_uint8 *)src + y * src_strides[2] + x * src_strides[1] + 2 * src_strides[0]);
-                //kernel filter
-                for (radius_y = -radius; radius_y <= radius; radius_y++)
+                for (y = 0; y < dims[2]; y++)
                 {
-                    for (radius_x = -radius; radius_x <= radius; radius_x++)
+                    for (x = 0; x < dims[1]; x++)
                     {
-                        vx_float64 dist = sqrt((vx_float64)radius_y * radius_y + (vx_float64)radius_x * radius_x);
-                        if (dist > radius)
-                        {
-                            continue;
-                        }
-                        vx_int32 neighbor_x = x + radius_x;
-                        vx_int32 neighbor_y = y + radius_y;
-                        vx_int32 tmpx = neighbor_x < 0 ? 0 : (neighbor_x > (dims[1] - 1) ? (dims[1] - 1) : neighbor_x);
-                        vx_int32 tmpy = neighbor_y < 0 ? 0 : (neighbor_y > (dims[2] - 1) ? (dims[2] - 1) : neighbor_y);
-                        vx_int16 b = *(vx_int16 *)((vx_uint8 *)src + tmpy * src_strides[2] + tmpx * src_strides[1] + 0 * src_strides[0]);
-                        vx_int16 g = *(vx_int16 *)((vx_uint8 *)src + tmpy * src_strides[2] + tmpx * src_strides[1] + 1 * src_strides[0]);
-                        vx_int16 r = *(vx_int16 *)((vx_uint8 *)src + tmpy * src_strides[2] + tmpx * src_strides[1] + 2 * src_strides[0]);
-                        if (neighbor_x < 0 || neighbor_y < 0)
-                        {
-                            if (border_mode == VX_BORDER_MODE_CONSTANT)
-                            {
-                                b = g = r = bordermode->constant_value.S16;
-                            }
-                        }
-
-                        vx_float32 alpha = (abs(b- b0) + abs(g - g0) + abs(r - r0)) * scale_index;
-                        vx_int32 idx = (vx_int32)floorf(alpha);
-                        alpha -= idx;
-                        vx_float32 w = space_weight[(radius_y + radius) * diameter + (radius_x + radius)] *
-                            (color_weight[idx] + alpha * (color_weight[idx + 1] - color_weight[idx]));
-                        sum_b += b * w;
-                        sum_g += g * w;
-                        sum_r += r * w;
-                        wsum += w;
+                        memcpy((vx_int8 *)dst + dst_strides[2] * y + dst_strides[1] * x,
+                               (vx_int8 *)src + src_strides[2] * y + src_strides[1] * x,
+                               dims[0] * src_strides[0]);
                     }
                 }
-
-                *(vx_int16 *)((vx_uint8 *)dst + y * src_strides[2] + x * src_strides[1] + 0 * src_strides[0]) = (vx_int16)roundf(sum_b / wsum);
-                *(vx_int16 *)((vx_uint8 *)dst + y * src_strides[2] + x * src_strides[1] + 1 * src_strides[0]) = (vx_int16)roundf(sum_g / wsum);
-                *(vx_int16 *)((vx_uint8 *)dst + y * src_strides[2] + x * src_strides[1] + 2 * src_strides[0]) = (vx_int16)roundf(sum_r / wsum);
             }
+            return VX_SUCCESS;
         }
     }
 
-    free(color_weight);
-    releaseRes(space_weight);
-
-    return status;
-}
-
-vx_status vxBilateralFilter(void* src, vx_size* src_strides, vx_size* dims, vx_size num_of_dims,
-                            vx_int32 diameter, vx_float32 sigma_space, vx_float32 sigma_color,
-                            void* dst, vx_size* dst_strides, vx_enum type, vx_border_t *bordermode)
-{
-    vx_status status = VX_SUCCESS;
-    // In case of 3 dimensions the 1st dimension of the vx_tensor. Which can be of size 1 or 2.
-    if ((num_of_dims != 3 && num_of_dims != 2) || (num_of_dims == 3 && (dims[0] != 1 && dims[0] != 2)))
+    /* the tables live in node local data between calls, unless they no longer fit it */
+    size = BilateralFilterCacheSizeImpl(diameter, type, num_of_dims);
+    if (size == 0)
     {
         return VX_ERROR_INVALID_PARAMETERS;
     }
-
-    if(type == VX_TYPE_UINT8)
+    if (cache == NULL || cache_size < size)
+    {
+        heap = calloc(1, size);
+        if (heap == NULL)
+        {
+            return VX_ERROR_NO_MEMORY;
+        }
+        cache = heap;
+    }
+    bilateral_build_tables((bilateral_tables_t *)cache, diameter, sigma_space, sigma_color, type, cn, minVal, maxVal);
+
+    b.src = (const vx_uint8 *)src;
+    b.dst = (vx_uint8 *)dst;
+    b.xs = src_strides[num_of_dims - 2];
+    b.ys = src_strides[num_of_dims - 1];
+    b.cs = src_strides[0];
+    b.width = (vx_int32)dims[num_of_dims - 2];
+    b.height = (vx_int32)dims[num_of_dims - 1];
+    b.cn = cn;
+    b.type = type;
+    b.radius = diameter / 2;
+    b.border = bordermode;
+    b.tables = (const bilateral_tables_t *)cache;
+    if (bordermode->mode == VX_BORDER_UNDEFINED)
     {
-        status = bilateralFilter_8u(src, src_strides, dims, num_of_dims, diameter, sigma_space, sigma_color, dst, dst_strides, bordermode);
+        b.low_x = b.radius;
+        b.high_x = (b.width >= b.radius) ? b.width - b.radius : 0;
+        b.low_y = b.radius;
+        high_y = (b.height >= b.radius) ? b.height - b.radius : 0;
     }
-    else if(type == VX_TYPE_INT16)
+    else
+    {
+        b.low_x = 0;
+        b.high_x = b.width;
+        b.low_y = 0;
+        high_y = b.height;
+    }
+
+    if (high_y > b.low_y)
     {
-        status = bilateralFilter_s16(src, src_strides, dims, num_of_dims, diameter, sigma_space, sigma_color, dst, dst_strides, bordermode);
+        ParallelForImpl((vx_uint32)(high_y - b.low_y), BILATERAL_ROWS_PER_THREAD, bilateral_rows, &b);
     }
 
+    free(heap);
     return status;
 }
@@ -16,6 +16,8 @@
  */
 
 #include <c_model.h>
+#include <stdlib.h>
+#include <string.h>
 #include <vx_debug.h>
 
 // helpers -------------------------------------------------------------------
@@ -29,28 +31,6 @@ static vx_uint8 usat8(vx_int32 a)
     return (vx_uint8)a;
 }
 
-static void yuv2rgb_bt601(vx_uint8 y, vx_uint8 cb, vx_uint8 cr,
-                          vx_uint8 *r, vx_uint8 *g, vx_uint8 *b)
-{
-    /*
-    R'= Y' + 0.000*U' + 1.403*V'
-    G'= Y' - 0.344*U' - 0.714*V'
-    B'= Y' + 1.773*U' + 0.000*V'
-    */
-    vx_float64 f_y = (vx_float64)y;
-    vx_float64 f_u = (vx_float64)cb - 128;
-    vx_float64 f_v = (vx_float64)cr - 128;
-    vx_float64 f_r = f_y + 0.000f*f_u + 1.403f*f_v;
-    vx_float64 f_g = f_y - 0.344f*f_u - 0.714f*f_v;
-    vx_float64 f_b = f_y + 1.773f*f_u + 0.000f*f_v;
-    vx_int32 i_r = (vx_int32)f_r;
-    vx_int32 i_g = (vx_int32)f_g;
-    vx_int32 i_b = (vx_int32)f_b;
-    *r = usat8(i_r);
-    *g = usat8(i_g);
-    *b = usat8(i_b);
-}
-
 #if 0 /* we don't make 601 yet */
 static void rgb2yuv_bt601(vx_uint8 r, vx_uint8 g, vx_uint8 b,
                           vx_uint8 *y, vx_uint8 *cb, vx_uint8 *cr)
@@ -75,50 +55,6 @@ static void rgb2yuv_bt601(vx_uint8 r, vx_uint8 g, vx_uint8 b,
 }
 #endif
 
-static void yuv2rgb_bt709(vx_uint8 y, vx_uint8 cb, vx_uint8 cr,
-                          vx_uint8 *r, vx_uint8 *g, vx_uint8 *b)
-{
-    /*
-    R'= Y' + 0.0000*U + 1.5748*V
-    G'= Y' - 0.1873*U - 0.4681*V
-    B'= Y' + 1.8556*U + 0.0000*V
-    */
-    vx_float64 f_y = (vx_float64)y;
-    vx_float64 f_u = (vx_float64)cb - 128;
-    vx_float64 f_v = (vx_float64)cr - 128;
-    vx_float64 f_r = f_y + 0.0000f*f_u + 1.5748f*f_v;
-    vx_float64 f_g = f_y - 0.1873f*f_u - 0.4681f*f_v;
-    vx_float64 f_b = f_y + 1.8556f*f_u + 0.0000f*f_v;
-    vx_int32 i_r = (vx_int32)f_r;
-    vx_int32 i_g = (vx_int32)f_g;
-    vx_int32 i_b = (vx_int32)f_b;
-    *r = usat8(i_r);
-    *g = usat8(i_g);
-    *b = usat8(i_b);
-}
-
-static void rgb2yuv_bt709(vx_uint8 r, vx_uint8 g, vx_uint8 b,
-                          vx_uint8 *y, vx_uint8 *cb, vx_uint8 *cr)
-{
-    /*
-    Y'= 0.2126*R' + 0.7152*G' + 0.0722*B'
-    U'=-0.1146*R' - 0.3854*G' + 0.5000*B'
-    V'= 0.5000*R' - 0.4542*G' - 0.0458*B'
-    */
-    vx_float64 f_r = (vx_float64)r;
-    vx_float64 f_g = (vx_float64)g;
-    vx_float64 f_b = (vx_float64)b;
-    vx_float64 f_y = 0 + 0.2126f*f_r + 0.7152f*f_g + 0.0722f*f_b;
-    vx_float64 f_u = 0 - 0.1146f*f_r - 0.3854f*f_g + 0.5000f*f_b;
-    vx_float64 f_v = 0 + 0.5000f*f_r - 0.4542f*f_g - 0.0458f*f_b;
-    vx_int32 i_y = (vx_int32)f_y;
-    vx_int32 i_u = (vx_int32)f_u + 128;
-    vx_int32 i_v = (vx_int32)f_v + 128;
-    *y  = usat8(i_y);
-    *cb = usat8(i_u);
-    *cr = usat8(i_v);
-}
-
 static void yuv2yuv_601to709(vx_uint8 y0, vx_uint8 cb0, vx_uint8 cr0,
                              vx_uint8 *y1, vx_uint8 *cb1, vx_uint8 *cr1)
 {
@@ -141,499 +77,453 @@ static void yuv2yuv_601to709(vx_uint8 y0, vx_uint8 cb0, vx_uint8 cr0,
     *cr1 = usat8(i_cr);
 }
 
-// kernel --------------------------------------------------------------------
+/*! \brief Fraction bits of the conversion tables. Every coefficient is a float, so its
+ * product with an 8 bit value is a multiple of 2^-28, and sums of such products are
+ * exact in this format; the results are the same as the double arithmetic they replace.
+ */
+#define CONVERT_Q (28)
 
-// nodeless version of the ConvertColor kernel
-vx_status vxConvertColor(vx_image src, vx_image dst)
+/*! \brief Rows each thread takes at a time, always a whole number of row pairs. */
+#define CONVERT_ROWS_PER_THREAD (16)
+
+typedef struct _convert_yuv2rgb_t {
+    vx_int64 rv[256];
+    vx_int64 gu[256];
+    vx_int64 gv[256];
+    vx_int64 bu[256];
+} convert_yuv2rgb_t;
+
+typedef struct _convert_rgb2yuv_t {
+    vx_int64 y[3][256];
+    vx_int64 u[3][256];
+    vx_int64 v[3][256];
+} convert_rgb2yuv_t;
+
+typedef struct _convert_t convert_t;
+typedef void (*convert_rows_f)(const convert_t *c, vx_uint32 y0, vx_uint32 y1);
+
+struct _convert_t {
+    convert_rows_f rows;
+    vx_uint32 width;
+    vx_uint32 height;
+    void **src_base;
+    vx_imagepatch_addressing_t *src_addr;
+    void **dst_base;
+    vx_imagepatch_addressing_t *dst_addr;
+    vx_df_image dst_format;
+    /* where the samples of a YUV source are: luma at luma_off + x * luma_step of plane 0,
+     * chroma at cb_off (cr_off) + (x / 2) * chroma_step of cb_plane (cr_plane) */
+    vx_uint32 luma_off, luma_step;
+    vx_uint32 cb_plane, cb_off, cr_plane, cr_off, chroma_step;
+    vx_bool src_422;
+    /* and where they go in a YUV destination, chroma_x_shift is 1 when it is subsampled */
+    vx_uint32 dst_cb_plane, dst_cb_off, dst_cr_plane, dst_cr_off, dst_chroma_step, dst_chroma_x_shift;
+    const convert_yuv2rgb_t *to_rgb;
+    const convert_rgb2yuv_t *to_yuv;
+};
+
+static vx_int64 convert_fixed(vx_float32 coeff, vx_int32 v)
 {
-    vx_imagepatch_addressing_t src_addr[4], dst_addr[4];
-    void *src_base[4] = {NULL};
-    void *dst_base[4] = {NULL};
-    vx_uint32 y, x, p;
-    vx_df_image src_format, dst_format;
-    vx_size src_planes, dst_planes;
-    vx_enum src_space;
-    vx_rectangle_t rect;
+    return (vx_int64)ldexp((vx_float64)coeff * (vx_float64)v, CONVERT_Q);
+}
 
-    vx_status status = VX_SUCCESS;
-    status |= vxQueryImage(src, VX_IMAGE_FORMAT, &src_format, sizeof(src_format));
-    status |= vxQueryImage(dst, VX_IMAGE_FORMAT, &dst_format, sizeof(dst_format));
-    status |= vxQueryImage(src, VX_IMAGE_PLANES, &src_planes, sizeof(src_planes));
-    status |= vxQueryImage(dst, VX_IMAGE_PLANES, &dst_planes, sizeof(dst_planes));
-    status |= vxQueryImage(src, VX_IMAGE_SPACE, &src_space, sizeof(src_space));
-    status = vxGetValidRegionImage(src, &rect);
-    for (p = 0; p < src_planes; p++)
-    {
-        status |= vxAccessImagePatch(src, &rect, p, &src_addr[p], &src_base[p], VX_READ_ONLY);
-        ownPrintImageAddressing(&src_addr[p]);
-    }
-    for (p = 0; p < dst_planes; p++)
+static void convert_build_yuv2rgb(convert_yuv2rgb_t *t, vx_enum space)
+{
+    /*
+    BT.601                              BT.709
+    R'= Y' + 0.000*U' + 1.403*V'        R'= Y' + 0.0000*U + 1.5748*V
+    G'= Y' - 0.344*U' - 0.714*V'        G'= Y' - 0.1873*U - 0.4681*V
+    B'= Y' + 1.773*U' + 0.000*V'        B'= Y' + 1.8556*U + 0.0000*V
+    */
+    vx_bool bt601 = (space == VX_COLOR_SPACE_BT601_525 || space == VX_COLOR_SPACE_BT601_625) ? vx_true_e : vx_false_e;
+    vx_int32 i;
+    for (i = 0; i < 256; i++)
     {
-        status |= vxAccessImagePatch(dst, &rect, p, &dst_addr[p], &dst_base[p], VX_WRITE_ONLY);
-        ownPrintImageAddressing(&dst_addr[p]);
+        t->rv[i] = convert_fixed(bt601 ? 1.403f : 1.5748f, i - 128);
+        t->gu[i] = -convert_fixed(bt601 ? 0.344f : 0.1873f, i - 128);
+        t->gv[i] = -convert_fixed(bt601 ? 0.714f : 0.4681f, i - 128);
+        t->bu[i] = convert_fixed(bt601 ? 1.773f : 1.8556f, i - 128);
     }
-    if (status != VX_SUCCESS)
+}
+
+static void convert_build_rgb2yuv(convert_rgb2yuv_t *t)
+{
+    /*
+    Y'= 0.2126*R' + 0.7152*G' + 0.0722*B'
+    U'=-0.1146*R' - 0.3854*G' + 0.5000*B'
+    V'= 0.5000*R' - 0.4542*G' - 0.0458*B'
+    */
+    vx_int32 i;
+    for (i = 0; i < 256; i++)
     {
-        VX_PRINT(VX_ZONE_ERROR, "Failed to setup images in Color Convert!\n");
+        t->y[0][i] = convert_fixed(0.2126f, i);
+        t->y[1][i] = convert_fixed(0.7152f, i);
+        t->y[2][i] = convert_fixed(0.0722f, i);
+        t->u[0][i] = -convert_fixed(0.1146f, i);
+        t->u[1][i] = -convert_fixed(0.3854f, i);
+        t->u[2][i] = convert_fixed(0.5000f, i);
+        t->v[0][i] = convert_fixed(0.5000f, i);
+        t->v[1][i] = -convert_fixed(0.4542f, i);
+        t->v[2][i] = -convert_fixed(0.0458f, i);
     }
+}
+
+/* truncates toward zero like the (vx_int32) casts of the reference */
+static vx_int32 convert_trunc(vx_int64 v)
+{
+    return (vx_int32)(v >= 0 ? v >> CONVERT_Q : -((-v) >> CONVERT_Q));
+}
+
+static void convert_to_rgb(const convert_yuv2rgb_t *t, vx_uint8 y, vx_uint8 cb, vx_uint8 cr, vx_uint8 *rgb)
+{
+    vx_int64 luma = (vx_int64)y << CONVERT_Q;
+    rgb[0] = usat8(convert_trunc(luma + t->rv[cr]));
+    rgb[1] = usat8(convert_trunc(luma + t->gu[cb] + t->gv[cr]));
+    rgb[2] = usat8(convert_trunc(luma + t->bu[cb]));
+}
+
+static void convert_to_yuv(const convert_rgb2yuv_t *t, const vx_uint8 *rgb, vx_uint8 *y, vx_uint8 *cb, vx_uint8 *cr)
+{
+    *y  = usat8(convert_trunc(t->y[0][rgb[0]] + t->y[1][rgb[1]] + t->y[2][rgb[2]]));
+    *cb = usat8(convert_trunc(t->u[0][rgb[0]] + t->u[1][rgb[1]] + t->u[2][rgb[2]]) + 128);
+    *cr = usat8(convert_trunc(t->v[0][rgb[0]] + t->v[1][rgb[1]] + t->v[2][rgb[2]]) + 128);
+}
+
+static vx_uint8 *convert_row(void *base, const vx_imagepatch_addressing_t *addr, vx_uint32 y)
+{
+    return (vx_uint8 *)base + addr->stride_y * ((addr->scale_y * y) / VX_SCALE_UNITY);
+}
 
-    if ((src_format == VX_DF_IMAGE_RGB) || (src_format == VX_DF_IMAGE_RGBX))
+static void convert_rgb_to_rgb(const convert_t *c, vx_uint32 y0, vx_uint32 y1)
+{
+    vx_uint32 x, y, src_step = c->src_addr[0].stride_x, dst_step = c->dst_addr[0].stride_x;
+    for (y = y0; y < y1; y++)
     {
-        if (dst_format == VX_DF_IMAGE_RGB || dst_format == VX_DF_IMAGE_RGBX)
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *src_rgb = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *dst_rgb = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    dst_rgb[0] = src_rgb[0];
-                    dst_rgb[1] = src_rgb[1];
-                    dst_rgb[2] = src_rgb[2];
-                    if (dst_format == VX_DF_IMAGE_RGBX)
-                        dst_rgb[3] = 255;
-                }
-            }
-        }
-        else if (dst_format == VX_DF_IMAGE_NV12)
+        const vx_uint8 *src = convert_row(c->src_base[0], &c->src_addr[0], y);
+        vx_uint8 *dst = convert_row(c->dst_base[0], &c->dst_addr[0], y);
+        for (x = 0; x < c->width; x++, src += src_step, dst += dst_step)
         {
-            vx_uint8 cb[4];
-            vx_uint8 cr[4];
-            for (y = 0; y < dst_addr[0].dim_y; y+=2)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *rgb[4] = {vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]),
-                                        vxFormatImagePatchAddress2d(src_base[0], x+1, y, &src_addr[0]),
-                                        vxFormatImagePatchAddress2d(src_base[0], x, y+1, &src_addr[0]),
-                                        vxFormatImagePatchAddress2d(src_base[0], x+1, y+1, &src_addr[0])};
-                    vx_uint8 *luma[4] = {vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x+1, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x, y+1, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x+1, y+1, &dst_addr[0])};
-                    vx_uint8 *cbcr = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    rgb2yuv_bt709(rgb[0][0],rgb[0][1],rgb[0][2],&luma[0][0],&cb[0],&cr[0]);
-                    rgb2yuv_bt709(rgb[1][0],rgb[1][1],rgb[1][2],&luma[1][0],&cb[1],&cr[1]);
-                    rgb2yuv_bt709(rgb[2][0],rgb[2][1],rgb[2][2],&luma[2][0],&cb[2],&cr[2]);
-                    rgb2yuv_bt709(rgb[3][0],rgb[3][1],rgb[3][2],&luma[3][0],&cb[3],&cr[3]);
-
-                    cbcr[0] = (cb[0] + cb[1] + cb[2] + cb[3])/4;
-                    cbcr[1] = (cr[0] + cr[1] + cr[2] + cr[3])/4;
-                }
-            }
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            if (dst_step == 4)
+                dst[3] = 255;
         }
-        else if (dst_format == VX_DF_IMAGE_YUV4)
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *rgb  = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *luma = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    vx_uint8 *cb   = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    vx_uint8 *cr   = vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2]);
+    }
+}
 
-                    rgb2yuv_bt709(rgb[0],rgb[1],rgb[2],luma,cb,cr);
-                }
-            }
-        }
-        else if (dst_format == VX_DF_IMAGE_IYUV)
+static void convert_rgb_to_yuv(const convert_t *c, vx_uint32 y0, vx_uint32 y1)
+{
+    vx_uint32 x, y, src_step = c->src_addr[0].stride_x;
+
+    if (c->dst_format == VX_DF_IMAGE_YUV4)
+    {
+        for (y = y0; y < y1; y++)
         {
-            vx_uint8 cb[4];
-            vx_uint8 cr[4];
-            for (y = 0; y < dst_addr[0].dim_y; y+=2)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *rgb[4] = {vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]),
-                                        vxFormatImagePatchAddress2d(src_base[0], x+1, y, &src_addr[0]),
-                                        vxFormatImagePatchAddress2d(src_base[0], x, y+1, &src_addr[0]),
-                                        vxFormatImagePatchAddress2d(src_base[0], x+1, y+1, &src_addr[0])};
-
-                    vx_uint8 *luma[4] = {vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x+1, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x, y+1, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x+1, y+1, &dst_addr[0])};
-
-                    vx_uint8 *cbp = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    vx_uint8 *crp = vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2]);
-
-                    rgb2yuv_bt709(rgb[0][0],rgb[0][1],rgb[0][2],&luma[0][0],&cb[0],&cr[0]);
-                    rgb2yuv_bt709(rgb[1][0],rgb[1][1],rgb[1][2],&luma[1][0],&cb[1],&cr[1]);
-                    rgb2yuv_bt709(rgb[2][0],rgb[2][1],rgb[2][2],&luma[2][0],&cb[2],&cr[2]);
-                    rgb2yuv_bt709(rgb[3][0],rgb[3][1],rgb[3][2],&luma[3][0],&cb[3],&cr[3]);
-
-                    cbp[0] = (uint8_t)(((vx_uint16)cb[0] + (vx_uint16)cb[1] + (vx_uint16)cb[2] + (vx_uint16)cb[3])>>2);
-                    crp[0] = (uint8_t)(((vx_uint16)cr[0] + (vx_uint16)cr[1] + (vx_uint16)cr[2] + (vx_uint16)cr[3])>>2);
-                }
-            }
+            const vx_uint8 *rgb = convert_row(c->src_base[0], &c->src_addr[0], y);
+            vx_uint8 *luma = convert_row(c->dst_base[0], &c->dst_addr[0], y);
+            vx_uint8 *cb = convert_row(c->dst_base[1], &c->dst_addr[1], y);
+            vx_uint8 *cr = convert_row(c->dst_base[2], &c->dst_addr[2], y);
+            for (x = 0; x < c->width; x++, rgb += src_step)
+                convert_to_yuv(c->to_yuv, rgb, &luma[x], &cb[x], &cr[x]);
         }
+        return;
     }
-    else if (src_format == VX_DF_IMAGE_NV21 || src_format == VX_DF_IMAGE_NV12)
+
+    /* 4:2:0, the chroma of each 2x2 block is the mean of its four pixels */
+    for (y = y0; y < y1; y += 2)
     {
-        int u_pix = src_format == VX_DF_IMAGE_NV12 ? 0 : 1;
-        int v_pix = src_format == VX_DF_IMAGE_NV12 ? 1 : 0;
-        if ((dst_format == VX_DF_IMAGE_RGB) || (dst_format == VX_DF_IMAGE_RGBX))
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *luma = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *crcb = vxFormatImagePatchAddress2d(src_base[1], x, y, &src_addr[1]);
-                    vx_uint8 *rgb = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    if (dst_format == VX_DF_IMAGE_RGBX)
-                        rgb[3] = 255;
-
-                    if (src_space == VX_COLOR_SPACE_BT601_525 ||
-                        src_space == VX_COLOR_SPACE_BT601_625)
-                        yuv2rgb_bt601(luma[0],crcb[u_pix],crcb[v_pix],&rgb[0],&rgb[1],&rgb[2]);
-                    else /*if (src_space == VX_COLOR_SPACE_BT709)*/
-                        yuv2rgb_bt709(luma[0],crcb[u_pix],crcb[v_pix],&rgb[0],&rgb[1],&rgb[2]);
-                }
-            }
-        }
-        else if (dst_format == VX_DF_IMAGE_NV12 || dst_format == VX_DF_IMAGE_NV21)
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *luma[2] = {vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0])};
-                    vx_uint8 *cbcr = vxFormatImagePatchAddress2d(src_base[1], x, y, &src_addr[1]);
-                    vx_uint8 *crcb = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    yuv2yuv_601to709(luma[0][0],cbcr[0],cbcr[1],&luma[1][0],&crcb[1],&crcb[0]);
-                }
-            }
-        }
-        else if (dst_format == VX_DF_IMAGE_YUV4)
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *luma = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *crcb = vxFormatImagePatchAddress2d(src_base[1], x, y, &src_addr[1]);
-                    vx_uint8 *yout = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    vx_uint8 *cb   = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    vx_uint8 *cr   = vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2]);
-
-                    yout[0] = luma[0];
-                    cb[0] = crcb[u_pix];
-                    cr[0] = crcb[v_pix];
-                }
-            }
-        }
-        else if (dst_format == VX_DF_IMAGE_IYUV)
+        vx_uint32 yn = y + 1 < c->height ? y + 1 : y;
+        const vx_uint8 *rgb[2] = { convert_row(c->src_base[0], &c->src_addr[0], y),
+                                   convert_row(c->src_base[0], &c->src_addr[0], yn) };
+        vx_uint8 *luma[2] = { convert_row(c->dst_base[0], &c->dst_addr[0], y),
+                              convert_row(c->dst_base[0], &c->dst_addr[0], yn) };
+        vx_uint8 *cbp = convert_row(c->dst_base[c->dst_cb_plane], &c->dst_addr[c->dst_cb_plane], y) + c->dst_cb_off;
+        vx_uint8 *crp = convert_row(c->dst_base[c->dst_cr_plane], &c->dst_addr[c->dst_cr_plane], y) + c->dst_cr_off;
+        for (x = 0; x < c->width; x += 2)
         {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *luma = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *crcb = vxFormatImagePatchAddress2d(src_base[1], x, y, &src_addr[1]);
-                    vx_uint8 *yout = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    vx_uint8 *cb   = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    vx_uint8 *cr   = vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2]);
-
-                    yout[0] = luma[0];
-                    cb[0] = crcb[u_pix];
-                    cr[0] = crcb[v_pix];
-                }
-            }
+            vx_uint32 xn = x + 1 < c->width ? x + 1 : x;
+            vx_uint8 cb[4], cr[4];
+            convert_to_yuv(c->to_yuv, rgb[0] + x * src_step, &luma[0][x], &cb[0], &cr[0]);
+            convert_to_yuv(c->to_yuv, rgb[0] + xn * src_step, &luma[0][xn], &cb[1], &cr[1]);
+            convert_to_yuv(c->to_yuv, rgb[1] + x * src_step, &luma[1][x], &cb[2], &cr[2]);
+            convert_to_yuv(c->to_yuv, rgb[1] + xn * src_step, &luma[1][xn], &cb[3], &cr[3]);
+            cbp[(x >> 1) * c->dst_chroma_step] = (vx_uint8)((cb[0] + cb[1] + cb[2] + cb[3]) / 4);
+            crp[(x >> 1) * c->dst_chroma_step] = (vx_uint8)((cr[0] + cr[1] + cr[2] + cr[3]) / 4);
         }
     }
-    else if (src_format == VX_DF_IMAGE_YUYV)
+}
+
+static void convert_yuv_to_rgb(const convert_t *c, vx_uint32 y0, vx_uint32 y1)
+{
+    vx_uint32 x, y, dst_step = c->dst_addr[0].stride_x;
+    for (y = y0; y < y1; y++)
     {
-        if (dst_format == VX_DF_IMAGE_RGB)
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *yuyv = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *rgb  = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-
-                    if (src_space == VX_COLOR_SPACE_BT601_525 ||
-                        src_space == VX_COLOR_SPACE_BT601_625)
-                    {
-                        yuv2rgb_bt601(yuyv[0],yuyv[1],yuyv[3],&rgb[0],&rgb[1],&rgb[2]);
-                        yuv2rgb_bt601(yuyv[2],yuyv[1],yuyv[3],&rgb[3],&rgb[4],&rgb[5]);
-                    }
-                    else /*if (src_space == VX_COLOR_SPACE_BT709)*/
-                    {
-                        yuv2rgb_bt709(yuyv[0],yuyv[1],yuyv[3],&rgb[0],&rgb[1],&rgb[2]);
-                        yuv2rgb_bt709(yuyv[2],yuyv[1],yuyv[3],&rgb[3],&rgb[4],&rgb[5]);
-                    }
-                }
-            }
-        }
-        else if (dst_format == VX_DF_IMAGE_RGBX)
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *yuyv = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *rgb  = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    rgb[3] = rgb[7] = 255;
-
-                    if (src_space == VX_COLOR_SPACE_BT601_525 ||
-                        src_space == VX_COLOR_SPACE_BT601_625)
-                    {
-                        yuv2rgb_bt601(yuyv[0],yuyv[1],yuyv[3],&rgb[0],&rgb[1],&rgb[2]);
-                        yuv2rgb_bt601(yuyv[2],yuyv[1],yuyv[3],&rgb[4],&rgb[5],&rgb[6]);
-                    }
-                    else /*if (src_space == VX_COLOR_SPACE_BT709)*/
-                    {
-                        yuv2rgb_bt709(yuyv[0],yuyv[1],yuyv[3],&rgb[0],&rgb[1],&rgb[2]);
-                        yuv2rgb_bt709(yuyv[2],yuyv[1],yuyv[3],&rgb[4],&rgb[5],&rgb[6]);
-                    }
-                }
-            }
-        }
-        else if (dst_format == VX_DF_IMAGE_NV12)
+        const vx_uint8 *luma = convert_row(c->src_base[0], &c->src_addr[0], y) + c->luma_off;
+        const vx_uint8 *cb = convert_row(c->src_base[c->cb_plane], &c->src_addr[c->cb_plane], y) + c->cb_off;
+        const vx_uint8 *cr = convert_row(c->src_base[c->cr_plane], &c->src_addr[c->cr_plane], y) + c->cr_off;
+        vx_uint8 *rgb = convert_row(c->dst_base[0], &c->dst_addr[0], y);
+
+        /* each chroma pair is read once for the two pixels sharing it */
+        for (x = 0; x + 1 < c->width; x += 2, rgb += 2 * dst_step)
         {
-            for (y = 0; y < dst_addr[0].dim_y; y+=2)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *yuyv[2] = {vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]),
-                                          vxFormatImagePatchAddress2d(src_base[0], x, y+1, &src_addr[0])};
-                    vx_uint8 *luma[4] = {vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]),
-                                          vxFormatImagePatchAddress2d(dst_base[0], x+1, y, &dst_addr[0]),
-                                          vxFormatImagePatchAddress2d(dst_base[0], x, y+1, &dst_addr[0]),
-                                          vxFormatImagePatchAddress2d(dst_base[0], x+1, y+1, &dst_addr[0])};
-                    vx_uint8 *cbcr = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    luma[0][0] = yuyv[0][0];
-                    luma[1][0] = yuyv[0][2];
-                    luma[2][0] = yuyv[1][0];
-                    luma[3][0] = yuyv[1][2];
-                    cbcr[0] = (yuyv[0][1] + yuyv[1][1])/2;
-                    cbcr[1] = (yuyv[0][3] + yuyv[1][3])/2;
-                }
-            }
+            vx_uint32 k = (x >> 1) * c->chroma_step;
+            convert_to_rgb(c->to_rgb, luma[x * c->luma_step], cb[k], cr[k], rgb);
+            convert_to_rgb(c->to_rgb, luma[(x + 1) * c->luma_step], cb[k], cr[k], rgb + dst_step);
+            if (dst_step == 4)
+                rgb[3] = rgb[7] = 255;
         }
-        else if (dst_format == VX_DF_IMAGE_YUV4)
+        if (x < c->width)
         {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *yuyv = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *luma = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    vx_uint8 *cb   = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    vx_uint8 *cr   = vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2]);
-
-                    luma[0] = yuyv[0];
-                    luma[1] = yuyv[2];
-                    cb[0] = yuyv[1];
-                    cr[0] = yuyv[3];
-                    cb[1] = yuyv[1];
-                    cr[1] = yuyv[3];
-                }
-            }
-        }
-        else if (dst_format == VX_DF_IMAGE_IYUV)
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y+=2)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *yuyv[2] = {vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]),
-                                          vxFormatImagePatchAddress2d(src_base[0], x, y+1, &src_addr[0])};
-                    vx_uint8 *luma[4] = {vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]),
-                                          vxFormatImagePatchAddress2d(dst_base[0], x+1, y, &dst_addr[0]),
-                                          vxFormatImagePatchAddress2d(dst_base[0], x, y+1, &dst_addr[0]),
-                                          vxFormatImagePatchAddress2d(dst_base[0], x+1, y+1, &dst_addr[0])};
-                    vx_uint8 *cb = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    vx_uint8 *cr = vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2]);
-                    luma[0][0] = yuyv[0][0];
-                    luma[1][0] = yuyv[0][2];
-                    luma[2][0] = yuyv[1][0];
-                    luma[3][0] = yuyv[1][2];
-                    cb[0] = (yuyv[0][1] + yuyv[1][1])/2;
-                    cr[0] = (yuyv[0][3] + yuyv[1][3])/2;
-                }
-            }
+            vx_uint32 k = (x >> 1) * c->chroma_step;
+            convert_to_rgb(c->to_rgb, luma[x * c->luma_step], cb[k], cr[k], rgb);
+            if (dst_step == 4)
+                rgb[3] = 255;
         }
     }
-    else if (src_format == VX_DF_IMAGE_UYVY)
+}
+
+static void convert_yuv_to_yuv(const convert_t *c, vx_uint32 y0, vx_uint32 y1)
+{
+    vx_uint32 x, y;
+    for (y = y0; y < y1; y++)
     {
-        if (dst_format == VX_DF_IMAGE_RGB)
+        const vx_uint8 *luma = convert_row(c->src_base[0], &c->src_addr[0], y) + c->luma_off;
+        const vx_uint8 *cb = convert_row(c->src_base[c->cb_plane], &c->src_addr[c->cb_plane], y) + c->cb_off;
+        const vx_uint8 *cr = convert_row(c->src_base[c->cr_plane], &c->src_addr[c->cr_plane], y) + c->cr_off;
+        vx_uint8 *yout = convert_row(c->dst_base[0], &c->dst_addr[0], y);
+        vx_uint8 *cbout = convert_row(c->dst_base[c->dst_cb_plane], &c->dst_addr[c->dst_cb_plane], y) + c->dst_cb_off;
+        vx_uint8 *crout = convert_row(c->dst_base[c->dst_cr_plane], &c->dst_addr[c->dst_cr_plane], y) + c->dst_cr_off;
+
+        for (x = 0; x < c->width; x++)
+            yout[x] = luma[x * c->luma_step];
+
+        if (c->dst_chroma_x_shift == 0)
         {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
+            /* 4:4:4, every pixel takes the chroma of its pair */
+            for (x = 0; x < c->width; x++)
             {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *uyvy = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *rgb  = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-
-                    if (src_space == VX_COLOR_SPACE_BT601_525 ||
-                        src_space == VX_COLOR_SPACE_BT601_625)
-                    {
-                        yuv2rgb_bt601(uyvy[1],uyvy[0],uyvy[2],&rgb[0],&rgb[1],&rgb[2]);
-                        yuv2rgb_bt601(uyvy[3],uyvy[0],uyvy[2],&rgb[3],&rgb[4],&rgb[5]);
-                    }
-                    else /*if (src_space == VX_COLOR_SPACE_BT709)*/
-                    {
-                        yuv2rgb_bt709(uyvy[1],uyvy[0],uyvy[2],&rgb[0],&rgb[1],&rgb[2]);
-                        yuv2rgb_bt709(uyvy[3],uyvy[0],uyvy[2],&rgb[3],&rgb[4],&rgb[5]);
-                    }
-                }
+                cbout[x] = cb[(x >> 1) * c->chroma_step];
+                crout[x] = cr[(x >> 1) * c->chroma_step];
             }
         }
-        else if (dst_format == VX_DF_IMAGE_RGBX)
+        else if ((y & 1) == 0)
         {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
+            if (c->src_422)
             {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
+                /* 4:2:2 to 4:2:0, the mean of the two rows */
+                vx_uint32 yn = y + 1 < c->height ? y + 1 : y;
+                const vx_uint8 *cbn = convert_row(c->src_base[0], &c->src_addr[0], yn) + c->cb_off;
+                const vx_uint8 *crn = convert_row(c->src_base[0], &c->src_addr[0], yn) + c->cr_off;
+                for (x = 0; x < c->width; x += 2)
                 {
-                    vx_uint8 *uyvy = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *rgb  = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    rgb[3] = rgb[7] = 255;
-
-                    if (src_space == VX_COLOR_SPACE_BT601_525 ||
-                        src_space == VX_COLOR_SPACE_BT601_625)
-                    {
-                        yuv2rgb_bt601(uyvy[1],uyvy[0],uyvy[2],&rgb[0],&rgb[1],&rgb[2]);
-                        yuv2rgb_bt601(uyvy[3],uyvy[0],uyvy[2],&rgb[4],&rgb[5],&rgb[6]);
-                    }
-                    else /*if (src_space == VX_COLOR_SPACE_BT709)*/
-                    {
-                        yuv2rgb_bt709(uyvy[1],uyvy[0],uyvy[2],&rgb[0],&rgb[1],&rgb[2]);
-                        yuv2rgb_bt709(uyvy[3],uyvy[0],uyvy[2],&rgb[4],&rgb[5],&rgb[6]);
-                    }
+                    vx_uint32 k = (x >> 1) * c->chroma_step;
+                    cbout[(x >> 1) * c->dst_chroma_step] = (vx_uint8)((cb[k] + cbn[k]) / 2);
+                    crout[(x >> 1) * c->dst_chroma_step] = (vx_uint8)((cr[k] + crn[k]) / 2);
                 }
             }
-        }
-        else if (dst_format == VX_DF_IMAGE_NV12)
-        {
-            for (y = 0; y < dst_addr[0].dim_y; y+=2)
+            else
             {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
+                for (x = 0; x < c->width; x += 2)
                 {
-                    vx_uint8 *uyvy[2] = {vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]),
-                                         vxFormatImagePatchAddress2d(src_base[0], x, y+1, &src_addr[0])};
-                    vx_uint8 *luma[4] = {vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x+1, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x, y+1, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x+1, y+1, &dst_addr[0])};
-                    vx_uint8 *cbcr = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    luma[0][0] = uyvy[0][1];
-                    luma[1][0] = uyvy[0][3];
-                    luma[2][0] = uyvy[1][1];
-                    luma[3][0] = uyvy[1][3];
-                    cbcr[0] = (uyvy[0][0] + uyvy[1][0])/2;
-                    cbcr[1] = (uyvy[0][2] + uyvy[1][2])/2;
+                    cbout[(x >> 1) * c->dst_chroma_step] = cb[(x >> 1) * c->chroma_step];
+                    crout[(x >> 1) * c->dst_chroma_step] = cr[(x >> 1) * c->chroma_step];
                 }
             }
         }
-        else if (dst_format == VX_DF_IMAGE_YUV4)
+    }
+}
+
+/* NV12/NV21 to NV12/NV21 goes through yuv2yuv_601to709, which swaps the chroma order */
+static void convert_nv_to_nv(const convert_t *c, vx_uint32 y0, vx_uint32 y1)
+{
+    vx_uint32 x, y;
+    for (y = y0; y < y1; y++)
+    {
+        const vx_uint8 *luma = convert_row(c->src_base[0], &c->src_addr[0], y);
+        const vx_uint8 *cbcr = convert_row(c->src_base[1], &c->src_addr[1], y);
+        vx_uint8 *yout = convert_row(c->dst_base[0], &c->dst_addr[0], y);
+        vx_uint8 *crcb = convert_row(c->dst_base[1], &c->dst_addr[1], y);
+        for (x = 0; x < c->width; x++)
         {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *uyvy = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *luma = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    vx_uint8 *cb   = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    vx_uint8 *cr   = vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2]);
-
-                    luma[0] = uyvy[1];
-                    luma[1] = uyvy[3];
-                    cb[0] = uyvy[0];
-                    cr[0] = uyvy[2];
-                    cb[1] = uyvy[0];
-                    cr[1] = uyvy[2];
-                }
-            }
+            vx_uint32 k = (x >> 1) * c->chroma_step;
+            vx_uint8 cb1, cr1;
+            yuv2yuv_601to709(luma[x], cbcr[k], cbcr[k + 1], &yout[x], &cb1, &cr1);
+            crcb[k] = cr1;
+            crcb[k + 1] = cb1;
         }
-        else if (dst_format == VX_DF_IMAGE_IYUV)
+    }
+}
+
+static void convert_bands(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const convert_t *c = (const convert_t *)arg;
+    vx_uint32 y0 = start * 2, y1 = end * 2 < c->height ? end * 2 : c->height;
+    c->rows(c, y0, y1);
+}
+
+/* fills in where the samples of a YUV source are, returns vx_false_e for other formats */
+static vx_bool convert_yuv_source(convert_t *c, vx_df_image format)
+{
+    vx_imagepatch_addressing_t *addr = c->src_addr;
+    c->luma_off = 0;
+    c->luma_step = 1;
+    c->src_422 = vx_false_e;
+    switch (format)
+    {
+        case VX_DF_IMAGE_NV12:
+        case VX_DF_IMAGE_NV21:
+            c->cb_plane = c->cr_plane = 1;
+            c->cb_off = format == VX_DF_IMAGE_NV12 ? 0 : 1;
+            c->cr_off = format == VX_DF_IMAGE_NV12 ? 1 : 0;
+            c->chroma_step = addr[1].stride_x;
+            return vx_true_e;
+        case VX_DF_IMAGE_IYUV:
+            c->cb_plane = 1;
+            c->cr_plane = 2;
+            c->cb_off = c->cr_off = 0;
+            c->chroma_step = addr[1].stride_x;
+            return vx_true_e;
+        case VX_DF_IMAGE_YUYV:
+        case VX_DF_IMAGE_UYVY:
+            c->luma_off = format == VX_DF_IMAGE_YUYV ? 0 : 1;
+            c->luma_step = addr[0].stride_x;
+            c->cb_plane = c->cr_plane = 0;
+            c->cb_off = format == VX_DF_IMAGE_YUYV ? 1 : 0;
+            c->cr_off = format == VX_DF_IMAGE_YUYV ? 3 : 2;
+            c->chroma_step = 2 * addr[0].stride_x;
+            c->src_422 = vx_true_e;
+            return vx_true_e;
+        default:
+            return vx_false_e;
+    }
+}
+
+/* fills in where the samples of a YUV destination go, returns vx_false_e for other formats */
+static vx_bool convert_yuv_destination(convert_t *c, vx_df_image format)
+{
+    vx_imagepatch_addressing_t *addr = c->dst_addr;
+    switch (format)
+    {
+        case VX_DF_IMAGE_NV12:
+            c->dst_cb_plane = c->dst_cr_plane = 1;
+            c->dst_cb_off = 0;
+            c->dst_cr_off = 1;
+            c->dst_chroma_step = addr[1].stride_x;
+            c->dst_chroma_x_shift = 1;
+            return vx_true_e;
+        case VX_DF_IMAGE_IYUV:
+        case VX_DF_IMAGE_YUV4:
+            c->dst_cb_plane = 1;
+            c->dst_cr_plane = 2;
+            c->dst_cb_off = c->dst_cr_off = 0;
+            c->dst_chroma_step = addr[1].stride_x;
+            c->dst_chroma_x_shift = format == VX_DF_IMAGE_IYUV ? 1 : 0;
+            return vx_true_e;
+        default:
+            return vx_false_e;
+    }
+}
+
+// kernel --------------------------------------------------------------------
+
+// nodeless version of the ConvertColor kernel
+vx_status vxConvertColor(vx_image src, vx_image dst)
+{
+    vx_imagepatch_addressing_t src_addr[4], dst_addr[4];
+    void *src_base[4] = {NULL};
+    void *dst_base[4] = {NULL};
+    vx_uint32 p;
+    vx_df_image src_format, dst_format;
+    vx_size src_planes, dst_planes;
+    vx_enum src_space;
+    vx_rectangle_t rect;
+    vx_bool is_rgb_src, is_rgb_dst, no_memory = vx_false_e;
+    convert_yuv2rgb_t *to_rgb = NULL;
+    convert_rgb2yuv_t *to_yuv = NULL;
+    convert_t c;
+
+    vx_status status = VX_SUCCESS;
+    status |= vxQueryImage(src, VX_IMAGE_FORMAT, &src_format, sizeof(src_format));
+    status |= vxQueryImage(dst, VX_IMAGE_FORMAT, &dst_format, sizeof(dst_format));
+    status |= vxQueryImage(src, VX_IMAGE_PLANES, &src_planes, sizeof(src_planes));
+    status |= vxQueryImage(dst, VX_IMAGE_PLANES, &dst_planes, sizeof(dst_planes));
+    status |= vxQueryImage(src, VX_IMAGE_SPACE, &src_space, sizeof(src_space));
+    status = vxGetValidRegionImage(src, &rect);
+    for (p = 0; p < src_planes; p++)
+    {
+        status |= vxAccessImagePatch(src, &rect, p, &src_addr[p], &src_base[p], VX_READ_ONLY);
+        ownPrintImageAddressing(&src_addr[p]);
+    }
+    for (p = 0; p < dst_planes; p++)
+    {
+        status |= vxAccessImagePatch(dst, &rect, p, &dst_addr[p], &dst_base[p], VX_WRITE_ONLY);
+        ownPrintImageAddressing(&dst_addr[p]);
+    }
+    if (status != VX_SUCCESS)
+    {
+        VX_PRINT(VX_ZONE_ERROR, "Failed to setup images in Color Convert!\n");
+    }
+
+    memset(&c, 0, sizeof(c));
+    c.width = dst_addr[0].dim_x;
+    c.height = dst_addr[0].dim_y;
+    c.src_base = src_base;
+    c.src_addr = src_addr;
+    c.dst_base = dst_base;
+    c.dst_addr = dst_addr;
+    c.dst_format = dst_format;
+
+    /* pick the row loop for the pair of formats, and the tables it converts through */
+    is_rgb_src = (src_format == VX_DF_IMAGE_RGB || src_format == VX_DF_IMAGE_RGBX) ? vx_true_e : vx_false_e;
+    is_rgb_dst = (dst_format == VX_DF_IMAGE_RGB || dst_format == VX_DF_IMAGE_RGBX) ? vx_true_e : vx_false_e;
+    if (is_rgb_src && is_rgb_dst)
+    {
+        c.rows = convert_rgb_to_rgb;
+    }
+    else if (is_rgb_src && convert_yuv_destination(&c, dst_format))
+    {
+        c.to_yuv = to_yuv = (convert_rgb2yuv_t *)malloc(sizeof(convert_rgb2yuv_t));
+        if (to_yuv)
         {
-            for (y = 0; y < dst_addr[0].dim_y; y+=2)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x+=2)
-                {
-                    vx_uint8 *uyvy[2] = {vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]),
-                                         vxFormatImagePatchAddress2d(src_base[0], x, y+1, &src_addr[0])};
-                    vx_uint8 *luma[4] = {vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x+1, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x, y+1, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x+1, y+1, &dst_addr[0])};
-                    vx_uint8 *cb = vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1]);
-                    vx_uint8 *cr = vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2]);
-                    luma[0][0] = uyvy[0][1];
-                    luma[1][0] = uyvy[0][3];
-                    luma[2][0] = uyvy[1][1];
-                    luma[3][0] = uyvy[1][3];
-                    cb[0] = (uyvy[0][0] + uyvy[1][0])/2;
-                    cr[0] = (uyvy[0][2] + uyvy[1][2])/2;
-                }
-            }
+            convert_build_rgb2yuv(to_yuv);
+            c.rows = convert_rgb_to_yuv;
         }
+        else
+            no_memory = vx_true_e;
     }
-    else if (src_format == VX_DF_IMAGE_IYUV)
+    else if (convert_yuv_source(&c, src_format))
     {
-        if (dst_format == VX_DF_IMAGE_RGB || dst_format == VX_DF_IMAGE_RGBX)
+        if (is_rgb_dst)
         {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
+            c.to_rgb = to_rgb = (convert_yuv2rgb_t *)malloc(sizeof(convert_yuv2rgb_t));
+            if (to_rgb)
             {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *luma = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *cb   = vxFormatImagePatchAddress2d(src_base[1], x, y, &src_addr[1]);
-                    vx_uint8 *cr   = vxFormatImagePatchAddress2d(src_base[2], x, y, &src_addr[2]);
-                    vx_uint8 *rgb  = vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]);
-                    if (dst_format == VX_DF_IMAGE_RGBX)
-                        rgb[3] = 255;
-
-                    /*! \todo restricted range 601 ? */
-                    if (src_space == VX_COLOR_SPACE_BT601_525 ||
-                        src_space == VX_COLOR_SPACE_BT601_625)
-                        yuv2rgb_bt601(luma[0],cb[0],cr[0],&rgb[0],&rgb[1],&rgb[2]);
-                    else /*if (src_space == VX_COLOR_SPACE_BT709)*/
-                        yuv2rgb_bt709(luma[0],cb[0],cr[0],&rgb[0],&rgb[1],&rgb[2]);
-                }
+                convert_build_yuv2rgb(to_rgb, src_space);
+                c.rows = convert_yuv_to_rgb;
             }
+            else
+                no_memory = vx_true_e;
         }
-        else if (dst_format == VX_DF_IMAGE_NV12)
+        else if ((src_format == VX_DF_IMAGE_NV12 || src_format == VX_DF_IMAGE_NV21) &&
+                 (dst_format == VX_DF_IMAGE_NV12 || dst_format == VX_DF_IMAGE_NV21))
         {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *luma = vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]);
-                    vx_uint8 *cb   = vxFormatImagePatchAddress2d(src_base[1], x, y, &src_addr[1]);
-                    vx_uint8 *cr   = vxFormatImagePatchAddress2d(src_base[2], x, y, &src_addr[2]);
-                    vx_uint8 *nv12[2] = {vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1])};
-                    nv12[0][0] = luma[0];
-                    nv12[1][0] = cb[0];
-                    nv12[1][1] = cr[0];
-                }
-            }
+            c.rows = convert_nv_to_nv;
         }
-        else if (dst_format == VX_DF_IMAGE_YUV4)
+        else if (convert_yuv_destination(&c, dst_format) &&
+                 !(src_format == VX_DF_IMAGE_IYUV && dst_format == VX_DF_IMAGE_IYUV))
         {
-            for (y = 0; y < dst_addr[0].dim_y; y++)
-            {
-                for (x = 0; x < dst_addr[0].dim_x; x++)
-                {
-                    vx_uint8 *luma[2] = {vxFormatImagePatchAddress2d(src_base[0], x, y, &src_addr[0]),
-                                         vxFormatImagePatchAddress2d(dst_base[0], x, y, &dst_addr[0])};
-                    vx_uint8 *cb[2]   = {vxFormatImagePatchAddress2d(src_base[1], x, y, &src_addr[1]),
-                                         vxFormatImagePatchAddress2d(dst_base[1], x, y, &dst_addr[1])};
-                    vx_uint8 *cr[2]   = {vxFormatImagePatchAddress2d(src_base[2], x, y, &src_addr[2]),
-                                         vxFormatImagePatchAddress2d(dst_base[2], x, y, &dst_addr[2])};
-                    luma[1][0] = luma[0][0];
-                    cb[1][0] = cb[0][0];
-                    cr[1][0] = cr[0][0];
-                }
-            }
+            c.rows = convert_yuv_to_yuv;
         }
     }
+
+    if (c.rows)
+    {
+        ParallelForImpl((c.height + 1) / 2, CONVERT_ROWS_PER_THREAD / 2, convert_bands, &c);
+    }
+    free(to_rgb);
+    free(to_yuv);
+
     status = VX_SUCCESS;
     for (p = 0; p < src_planes; p++)
     {
@@ -647,6 +537,10 @@ vx_status vxConvertColor(vx_image src, vx_image dst)
     {
         VX_PRINT(VX_ZONE_ERROR, "Failed to set image patches on source or destination\n");
     }
+    if (no_memory)
+    {
+        status = VX_ERROR_NO_MEMORY;
+    }
 
     return status;
 }
@@ -17,30 +17,11 @@
 
 #include <c_model.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-#define PERMUTATIONS 16
 #define APERTURE 3
 
-static vx_uint8 indexes[PERMUTATIONS][9] = {
-    { 0, 1, 2, 3, 4, 5, 6, 7, 8},
-    {15, 0, 1, 2, 3, 4, 5, 6, 7},
-    {14,15, 0, 1, 2, 3, 4, 5, 6},
-    {13,14,15, 0, 1, 2, 3, 4, 5},
-    {12,13,14,15, 0, 1, 2, 3, 4},
-    {11,12,13,14,15, 0, 1, 2, 3},
-    {10,11,12,13,14,15, 0, 1, 2},
-    { 9,10,11,12,13,14,15, 0, 1},
-    { 8, 9,10,11,12,13,14,15, 0},
-    { 7, 8, 9,10,11,12,13,14,15},
-    { 6, 7, 8, 9,10,11,12,13,14},
-    { 5, 6, 7, 8, 9,10,11,12,13},
-    { 4, 5, 6, 7, 8, 9,10,11,12},
-    { 3, 4, 5, 6, 7, 8, 9,10,11},
-    { 2, 3, 4, 5, 6, 7, 8, 9,10},
-    { 1, 2, 3, 4, 5, 6, 7, 8, 9},
-};
-
 /* offsets from "p" */
 static vx_int32 offsets[16][2] = {
     {  0, -3},
@@ -61,72 +42,201 @@ static vx_int32 offsets[16][2] = {
     { -1, -3},
 };
 
+/*! \brief The least number of rows worth a thread of their own. */
+#define FAST9_ROWS_PER_THREAD (16)
+
+/*! \brief Whether the 16 bit circle mask holds 9 contiguous bits, wrapping around.
+ * After each step a bit stays set only where a run of 2, 4, 8 and then 9 set bits starts.
+ */
+static C_KERNEL_INLINE vx_bool fast9_arc(vx_uint32 mask)
+{
+    vx_uint32 m32 = mask | (mask << 16);
+    vx_uint32 r = m32 & (m32 >> 1);
+    r &= r >> 2;
+    r &= r >> 4;
+    r &= m32 >> 8;
+    return (r & 0xFFFF) ? vx_true_e : vx_false_e;
+}
+
+typedef struct _fast9_t {
+    /*! \brief Pixel (0,0), with APERTURE readable pixels around the scanned range */
+    const vx_uint8 *base;
+    vx_int32 stride;
+    /*! \brief The range of pixels which may be corners */
+    vx_int32 x0, x1, y0, y1;
+    vx_int32 circle[16];
+    vx_int32 tolerance;
+    /*! \brief Corner strengths with a one pixel frame, zero where there is no corner */
+    vx_uint8 *scores;
+    vx_int32 score_stride;
+    vx_bool nonmax;
+    /*! \brief Corners per row, then the index of the first corner of each row */
+    vx_size *row_counts;
+    vx_keypoint_t *points;
+    vx_size capacity;
+} fast9_t;
 
-static vx_bool vxIsFastCorner(const vx_uint8* buf, vx_uint8 p, vx_uint8 tolerance)
+/*! \brief The largest tolerance at which the pixel is still a corner. This is the closed form
+ * of the binary search over the arc test: the best arc's smallest difference, less one.
+ */
+static vx_uint8 fast9_strength(const vx_uint8 *c, const vx_int32 circle[16])
 {
-    vx_uint32 i, a;
-    for (a = 0; a < PERMUTATIONS; a++)
+    vx_int32 d[16];
+    vx_int32 best = 0;
+    vx_int32 i, k;
+
+    for (i = 0; i < 16; i++)
+        d[i] = (vx_int32)c[circle[i]] - (vx_int32)c[0];
+    for (i = 0; i < 16; i++)
     {
-        vx_bool isacorner = vx_true_e;
-        for (i = 0; i < dimof(indexes[a]); i++)
+        vx_int32 bright = 255, dark = 255;
+        for (k = 0; k < 9; k++)
         {
-            vx_uint8 j = indexes[a][i];
-            vx_uint8 v = buf[j];
-            if (v <= (p + tolerance))
-            {
-                isacorner = vx_false_e;
-            }
+            vx_int32 v = d[(i + k) & 15];
+            if (v < bright)
+                bright = v;
+            if (-v < dark)
+                dark = -v;
         }
-        if (isacorner == vx_true_e)
-            return isacorner;
-        isacorner = vx_true_e;
-        for (i = 0; i < dimof(indexes[a]); i++)
+        if (bright > best)
+            best = bright;
+        if (dark > best)
+            best = dark;
+    }
+    return (vx_uint8)(best - 1);
+}
+
+static void fast9_score_rows(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const fast9_t *f = (const fast9_t *)arg;
+    const vx_int32 *circle = f->circle;
+    vx_uint32 r;
+
+    for (r = start; r < end; r++)
+    {
+        vx_int32 y = f->y0 + (vx_int32)r;
+        const vx_uint8 *row = f->base + y * f->stride;
+        vx_uint8 *score = f->scores + (y + 1) * f->score_stride + 1;
+        vx_int32 x;
+
+        for (x = f->x0; x < f->x1; x++)
         {
-            vx_uint8 j = indexes[a][i];
-            vx_uint8 v = buf[j];
-            if (v >= (p - tolerance))
+            const vx_uint8 *c = row + x;
+            vx_int32 hi = c[0] + f->tolerance;
+            vx_int32 lo = c[0] - f->tolerance;
+            vx_uint32 bright, dark, i;
+
+            /* an arc of 9 covers two neighbouring points of 1, 5, 9 and 13 */
+            bright = (c[circle[0]] > hi) | ((c[circle[4]] > hi) << 1) | ((c[circle[8]] > hi) << 2) | ((c[circle[12]] > hi) << 3);
+            dark   = (c[circle[0]] < lo) | ((c[circle[4]] < lo) << 1) | ((c[circle[8]] < lo) << 2) | ((c[circle[12]] < lo) << 3);
+            if (((bright & ((bright >> 1) | (bright << 3))) | (dark & ((dark >> 1) | (dark << 3)))) == 0)
+                continue;
+
+            bright = dark = 0;
+            for (i = 0; i < 16; i++)
             {
-                isacorner = vx_false_e;
+                vx_int32 v = c[circle[i]];
+                bright |= (vx_uint32)(v > hi) << i;
+                dark |= (vx_uint32)(v < lo) << i;
             }
+            if (fast9_arc(bright) || fast9_arc(dark))
+                score[x] = fast9_strength(c, circle);
         }
-        if (isacorner == vx_true_e)
-            return isacorner;
     }
-    return vx_false_e;
 }
 
+static C_KERNEL_INLINE vx_bool fast9_is_corner(const fast9_t *f, const vx_uint8 *s)
+{
+    vx_int32 st = f->score_stride;
+    vx_uint8 v = s[0];
+    if (v == 0)
+        return vx_false_e;
+    if (f->nonmax == vx_false_e)
+        return vx_true_e;
+    return (v >= s[-st - 1] && v >= s[-st] && v >= s[-st + 1] && v >= s[-1] &&
+            v >  s[1] && v >  s[st - 1] && v >  s[st] && v >  s[st + 1]) ? vx_true_e : vx_false_e;
+}
 
-static vx_uint8 vxGetFastCornerStrength(vx_int32 x, vx_int32 y, void* src_base,
-                                        vx_imagepatch_addressing_t* src_addr,
-                                        vx_uint8 tolerance)
+static void fast9_count_rows(void *arg, vx_uint32 start, vx_uint32 end)
 {
-    if (x < APERTURE || y < APERTURE || x >= (vx_int32)src_addr->dim_x - APERTURE || y >= (vx_int32)src_addr->dim_y - APERTURE)
-        return 0;
-    {
-    vx_uint8 p = *(vx_uint8*)vxFormatImagePatchAddress2d(src_base, x, y, src_addr);
-    vx_uint8 buf[16];
-    vx_int32 j;
-    vx_uint8 a, b = 255;
+    const fast9_t *f = (const fast9_t *)arg;
+    vx_uint32 r;
 
-    for (j = 0; j < 16; j++)
+    for (r = start; r < end; r++)
     {
-        buf[j] = *(vx_uint8*)vxFormatImagePatchAddress2d(src_base, x+offsets[j][0], y+offsets[j][1], src_addr);
+        vx_int32 y = f->y0 + (vx_int32)r;
+        const vx_uint8 *score = f->scores + (y + 1) * f->score_stride + 1;
+        vx_size count = 0;
+        vx_int32 x;
+        for (x = f->x0; x < f->x1; x++)
+        {
+            if (fast9_is_corner(f, &score[x]))
+                count++;
+        }
+        f->row_counts[r] = count;
     }
+}
 
-    if (!vxIsFastCorner(buf, p, tolerance))
-        return 0;
+static void fast9_write_rows(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const fast9_t *f = (const fast9_t *)arg;
+    vx_uint32 r;
 
-    a = tolerance;
-    while (b - a > 1)
+    for (r = start; r < end; r++)
     {
-        vx_uint8 c = (a + b)/2;
-        if (vxIsFastCorner(buf, p, c))
-            a = c;
-        else
-            b = c;
+        vx_int32 y = f->y0 + (vx_int32)r;
+        const vx_uint8 *score = f->scores + (y + 1) * f->score_stride + 1;
+        vx_size index = f->row_counts[r];
+        vx_int32 x;
+        for (x = f->x0; (x < f->x1) && (index < f->capacity); x++)
+        {
+            if (fast9_is_corner(f, &score[x]))
+            {
+                vx_keypoint_t *kp = &f->points[index++];
+                kp->x = x;
+                kp->y = y;
+                kp->strength = score[x];
+                kp->scale = 0.0f;
+                kp->orientation = 0.0f;
+                kp->tracking_status = 1;
+                kp->error = 0.0f;
+            }
+        }
     }
-    return a;
+}
+
+/*! \brief Copies the image into a buffer with an APERTURE pixel frame filled per the border mode. */
+static vx_uint8 *fast9_pad(void *src_base, vx_imagepatch_addressing_t *src_addr, const vx_border_t *bordermode, vx_int32 *stride)
+{
+    vx_int32 width = (vx_int32)src_addr->dim_x;
+    vx_int32 height = (vx_int32)src_addr->dim_y;
+    vx_int32 pitch = width + 2 * APERTURE;
+    vx_uint8 *padded = (vx_uint8 *)malloc((vx_size)pitch * (height + 2 * APERTURE));
+    vx_int32 x, y;
+
+    if (padded == NULL)
+        return NULL;
+    for (y = -APERTURE; y < height + APERTURE; y++)
+    {
+        vx_uint8 *dst = padded + (y + APERTURE) * pitch + APERTURE;
+        if (bordermode->mode == VX_BORDER_CONSTANT && (y < 0 || y >= height))
+        {
+            memset(dst - APERTURE, bordermode->constant_value.U8, pitch);
+            continue;
+        }
+        {
+            vx_int32 sy = y < 0 ? 0 : (y >= height ? height - 1 : y);
+            const vx_uint8 *src = (const vx_uint8 *)vxFormatImagePatchAddress2d(src_base, 0, sy, src_addr);
+            memcpy(dst, src, width);
+            for (x = 1; x <= APERTURE; x++)
+            {
+                dst[-x] = bordermode->mode == VX_BORDER_CONSTANT ? bordermode->constant_value.U8 : src[0];
+                dst[width - 1 + x] = bordermode->mode == VX_BORDER_CONSTANT ? bordermode->constant_value.U8 : src[width - 1];
+            }
+        }
     }
+    *stride = pitch;
+    return padded;
 }
 
 // nodeless version of the Fast9Corners kernel
@@ -142,7 +252,8 @@ vx_status vxFast9Corners(vx_image src, vx_scalar sens, vx_scalar nonm, vx_array
     vx_size num_corners = 0;
     vx_size dst_capacity = 0;
     vx_map_id map_id = 0;
-    vx_keypoint_t kp;
+    vx_uint8 *padded = NULL;
+    fast9_t f;
 
     vx_status status = vxGetValidRegionImage(src, &rect);
 
@@ -157,62 +268,93 @@ vx_status vxFast9Corners(vx_image src, vx_scalar sens, vx_scalar nonm, vx_array
 
     status |= vxQueryArray(points, VX_ARRAY_CAPACITY, &dst_capacity, sizeof(dst_capacity));
 
-    memset(&kp, 0, sizeof(kp));
+    memset(&f, 0, sizeof(f));
 
     if (status == VX_SUCCESS)
     {
-        /*! \todo implement other Fast9 Corners border modes */
+        vx_int32 width = (vx_int32)src_addr.dim_x;
+        vx_int32 height = (vx_int32)src_addr.dim_y;
+        vx_uint32 rows = 0;
+        vx_int32 j;
+
         if (bordermode->mode == VX_BORDER_UNDEFINED)
         {
-            vx_int32 y, x;
-            for (y = APERTURE; y < (vx_int32)(src_addr.dim_y - APERTURE); y++)
-            {
-                for (x = APERTURE; x < (vx_int32)(src_addr.dim_x - APERTURE); x++)
-                {
-                    vx_uint8 strength = vxGetFastCornerStrength(x, y, src_base, &src_addr, tolerance);
-                    if (strength > 0)
-                    {
-                        if (do_nonmax)
-                        {
-                            if (strength >= vxGetFastCornerStrength(x-1, y-1, src_base, &src_addr, tolerance) &&
-                                strength >= vxGetFastCornerStrength(x, y-1, src_base, &src_addr, tolerance) &&
-                                strength >= vxGetFastCornerStrength(x+1, y-1, src_base, &src_addr, tolerance) &&
-                                strength >= vxGetFastCornerStrength(x-1, y, src_base, &src_addr, tolerance) &&
-                                strength >  vxGetFastCornerStrength(x+1, y, src_base, &src_addr, tolerance) &&
-                                strength >  vxGetFastCornerStrength(x-1, y+1, src_base, &src_addr, tolerance) &&
-                                strength >  vxGetFastCornerStrength(x, y+1, src_base, &src_addr, tolerance) &&
-                                strength >  vxGetFastCornerStrength(x+1, y+1, src_base, &src_addr, tolerance))
-                                ;
-                            else
-                                continue;
-                        }
-                        if (num_corners < dst_capacity)
-                        {
-                            kp.x = x;
-                            kp.y = y;
-                            kp.strength = strength;
-                            kp.scale = 0.0f;
-                            kp.orientation = 0.0f;
-                            kp.tracking_status = 1;
-                            kp.error = 0.0f;
-                            status |= vxAddArrayItems(points, 1, &kp, sizeof(kp));
-                        }
-                        num_corners++;
-                    }
-                }
-            }
+            f.base = (const vx_uint8 *)src_base;
+            f.stride = src_addr.stride_y;
+            f.x0 = APERTURE;
+            f.y0 = APERTURE;
+            f.x1 = width - APERTURE;
+            f.y1 = height - APERTURE;
+        }
+        else if (bordermode->mode == VX_BORDER_CONSTANT || bordermode->mode == VX_BORDER_REPLICATE)
+        {
+            /* every pixel may be a corner, its circle reads the frame */
+            padded = fast9_pad(src_base, &src_addr, bordermode, &f.stride);
+            if (padded == NULL)
+                status = VX_ERROR_NO_MEMORY;
+            else
+                f.base = padded + APERTURE * f.stride + APERTURE;
+            f.x0 = 0;
+            f.y0 = 0;
+            f.x1 = width;
+            f.y1 = height;
         }
         else
         {
             status = VX_ERROR_NOT_IMPLEMENTED;
         }
 
+        if (status == VX_SUCCESS && f.x1 > f.x0 && f.y1 > f.y0)
+        {
+            rows = (vx_uint32)(f.y1 - f.y0);
+            for (j = 0; j < 16; j++)
+                f.circle[j] = offsets[j][1] * f.stride + offsets[j][0];
+            f.tolerance = tolerance;
+            f.nonmax = do_nonmax;
+            f.score_stride = width + 2;
+            f.scores = (vx_uint8 *)calloc((vx_size)f.score_stride * (height + 2), sizeof(vx_uint8));
+            f.row_counts = (vx_size *)calloc(rows, sizeof(vx_size));
+            if (f.scores == NULL || f.row_counts == NULL)
+                status = VX_ERROR_NO_MEMORY;
+        }
+
+        if (status == VX_SUCCESS && rows > 0)
+        {
+            vx_uint32 r;
+
+            ParallelForImpl(rows, FAST9_ROWS_PER_THREAD, fast9_score_rows, &f);
+            ParallelForImpl(rows, FAST9_ROWS_PER_THREAD, fast9_count_rows, &f);
+
+            /* the counts become the index of the first corner of each row */
+            for (r = 0; r < rows; r++)
+            {
+                vx_size count = f.row_counts[r];
+                f.row_counts[r] = num_corners;
+                num_corners += count;
+            }
+            f.capacity = num_corners < dst_capacity ? num_corners : dst_capacity;
+            if (f.capacity > 0)
+            {
+                f.points = (vx_keypoint_t *)calloc(f.capacity, sizeof(vx_keypoint_t));
+                if (f.points == NULL)
+                    status = VX_ERROR_NO_MEMORY;
+            }
+            if (f.points)
+            {
+                ParallelForImpl(rows, FAST9_ROWS_PER_THREAD, fast9_write_rows, &f);
+                status |= vxAddArrayItems(points, f.capacity, f.points, sizeof(vx_keypoint_t));
+            }
+        }
+
         if (s_num_corners)
             status |= vxCopyScalar(s_num_corners, &num_corners, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
 
         status |= vxUnmapImagePatch(src, map_id);
     }
 
+    free(f.points);
+    free(f.row_counts);
+    free(f.scores);
+    free(padded);
     return status;
 }
-
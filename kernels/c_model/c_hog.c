@@ -29,242 +29,486 @@
 #include <c_model.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "tensor_utils.h"
 
 #ifndef min
 #define min(a,b) (a<b?a:b)
 #endif 
-// nodeless version of the Hog Cells kernel
-vx_status vxHogCells(vx_image img, vx_scalar cell_width, vx_scalar cell_height, vx_scalar num_bins, vx_tensor magnitudes, vx_tensor bins)
+
+/*! \brief Gradients of a U8 image lie in [-255, 255], one table row and column for each. */
+#define HOG_GRADIENT_RANGE (511)
+
+/*! \brief Rows of cells each thread takes at a time. */
+#define HOG_CELL_ROWS_PER_BAND (4)
+
+/*! \brief The orientation bin of every gradient pair, kept in node local data.
+ * It is filled from the same atan2f expression the bins were always computed
+ * with, so bins at the boundaries do not move.
+ */
+typedef struct _hog_bin_table_t {
+    vx_bool valid;
+    vx_int32 num_bins;
+    vx_int8 bins[HOG_GRADIENT_RANGE * HOG_GRADIENT_RANGE];
+} hog_bin_table_t;
+
+typedef struct _hog_band_t {
+    vx_int32 lo;            /* index of the first cell the band can reach */
+    vx_int32 cells;
+    vx_int32 *mags;
+    vx_int32 *bins;         /* cells * num_bins + 1, a bin may round up to num_bins */
+} hog_band_t;
+
+typedef struct _hog_cells_t {
+    const vx_uint8 *base;
+    vx_size stride;
+    vx_int32 width;
+    vx_int32 height;
+    vx_int32 cell_w;
+    vx_int32 cell_h;
+    vx_int32 num_bins;
+    vx_int32 num_cellw;
+    vx_float32 area;
+    const vx_int8 *bin_table;
+    hog_band_t *bands;
+} hog_cells_t;
+
+vx_size HogCellsCacheSizeImpl(void)
 {
-    vx_status status = VX_SUCCESS;
-    vx_float32 gx;
-    vx_float32 gy;
-    vx_float32 orientation;
-    vx_float32 magnitude;
-    vx_int8 bin;
-    vx_int32 width, height;
+    return sizeof(hog_bin_table_t);
+}
 
-    vx_int32 cell_w, cell_h, num_orientations;
-    status |= vxCopyScalar(cell_width, &cell_w, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
-    status |= vxCopyScalar(cell_height, &cell_h, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
-    status |= vxCopyScalar(num_bins, &num_orientations, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+static void hog_build_bin_table(hog_bin_table_t *t, vx_int32 num_orientations)
+{
+    float num_div_360 = (float)num_orientations / 360.0f;
+    vx_int32 gx, gy;
+
+    if (t->valid && t->num_bins == num_orientations)
+        return;
+    for (gy = -255; gy <= 255; gy++)
+    {
+        for (gx = -255; gx <= 255; gx++)
+        {
+            vx_float32 orientation = (float)fmod((double)atan2f((vx_float32)gy, (vx_float32)gx + 0.00000000000001f)
+                * (180.0f / 3.14159265f), 360);
+            if (orientation < 0) {
+                orientation += 360;
+            }
+            t->bins[(gy + 255) * HOG_GRADIENT_RANGE + (gx + 255)] = (vx_int8)floor(orientation * num_div_360);
+        }
+    }
+    t->num_bins = num_orientations;
+    t->valid = vx_true_e;
+}
+
+static void hog_cell_bands(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    hog_cells_t *h = (hog_cells_t *)arg;
+    vx_uint32 b;
+
+    for (b = start; b < end; b++)
+    {
+        hog_band_t *band = &h->bands[b];
+        vx_int32 y0 = (vx_int32)b * HOG_CELL_ROWS_PER_BAND * h->cell_h;
+        vx_int32 y1 = min(y0 + HOG_CELL_ROWS_PER_BAND * h->cell_h, h->height);
+        vx_int32 bin_count = band->cells * h->num_bins + 1;
+        vx_int32 i, j;
+
+        band->mags = (vx_int32 *)calloc(band->cells, sizeof(vx_int32));
+        band->bins = (vx_int32 *)calloc(bin_count, sizeof(vx_int32));
+        if (band->mags == NULL || band->bins == NULL)
+            continue;   /* reported from the band after the loop */
+
+        for (j = y0; j < y1; j++)
+        {
+            const vx_uint8 *row = h->base + j * h->stride;
+            const vx_uint8 *above = h->base + (j - 1 < 0 ? 0 : j - 1) * h->stride;
+            const vx_uint8 *below = h->base + (j + 1 >= h->height ? h->height - 1 : j + 1) * h->stride;
+            vx_int32 cell = (j / h->cell_h) * h->num_cellw - band->lo;
+            vx_int32 cx = 0;
+
+            for (i = 0; i < h->width; i++)
+            {
+                vx_int32 x1 = i - 1 < 0 ? 0 : i - 1;
+                vx_int32 x2 = i + 1 >= h->width ? h->width - 1 : i + 1;
+                vx_int32 gx = row[x2] - row[x1];
+                vx_int32 gy = below[i] - above[i];
+                /* magnitude and bin together; the squares are exact in float */
+                vx_int32 magnitude = (vx_int16)(sqrtf((vx_float32)(gx * gx + gy * gy)) / h->area);
+                vx_int32 bin = h->bin_table[(gy + 255) * HOG_GRADIENT_RANGE + (gx + 255)];
+                vx_int32 bin_index = (cell + cx) * h->num_bins + bin;
+
+                band->mags[cell + cx] += magnitude;
+                if (bin_index >= 0 && bin_index < bin_count)
+                    band->bins[bin_index] += magnitude;
+                if ((i + 1) % h->cell_w == 0)
+                    cx++;
+            }
+        }
+    }
+}
 
+/* adds up the bands, wrapping indexes past the end of the tensor around as the element
+ * positions always have, and stores the sums */
+static void hog_store(void *data, const vx_size *dims, const vx_size *strides, vx_size dim_num,
+                      const vx_int32 *sums, vx_size count)
+{
+    vx_size total = ComputeNumberOfElements(dims, dim_num);
+    vx_int32 *acc;
+    vx_size i;
+
+    if (total == 0)
+        return;
+    acc = (vx_int32 *)calloc(total, sizeof(vx_int32));
+    if (acc == NULL)
+        return;
+    for (i = 0; i < count; i++)
+        acc[i % total] += sums[i];
+    for (i = 0; i < total; i++)
+    {
+        vx_size pos = ComputeGlobalPositionsFromIndex(i, dims, strides, dim_num, &pos);
+        *(vx_int16 *)((vx_int8 *)data + pos) = (vx_int16)acc[i];
+    }
+    free(acc);
+}
+
+// nodeless version of the Hog Cells kernel
+vx_status vxHogCells(vx_image img, vx_scalar cell_width, vx_scalar cell_height, vx_scalar num_bins, vx_tensor magnitudes, vx_tensor bins,
+                     void *cache, vx_size cache_size)
+{
+    vx_status status = VX_SUCCESS;
+    vx_int32 cell_w = 0, cell_h = 0, num_orientations = 0;
     void *src_base = NULL;
-    vx_imagepatch_addressing_t src_addr;
+    vx_imagepatch_addressing_t src_addr = VX_IMAGEPATCH_ADDR_INIT;
     vx_rectangle_t rect;
-    status |= vxGetValidRegionImage(img, &rect);
-    status |= vxAccessImagePatch(img, &rect, 0, &src_addr, &src_base, VX_READ_ONLY);
-    width = src_addr.dim_x;
-    height = src_addr.dim_y;
+    vx_map_id map_id = 0;
+    void *heap = NULL;
+    hog_cells_t h;
 
     void* magnitudes_data = NULL;
     void* bins_data = NULL;
     vx_size magnitudes_dim_num = 0, magnitudes_dims[MAX_NUM_OF_DIMENSIONS] = { 0 }, magnitudes_strides[MAX_NUM_OF_DIMENSIONS] = { 0 };
     vx_size bins_dim_num = 0, bins_dims[MAX_NUM_OF_DIMENSIONS] = { 0 }, bins_strides[MAX_NUM_OF_DIMENSIONS] = { 0 };
 
+    memset(&h, 0, sizeof(h));
+    status |= vxCopyScalar(cell_width, &cell_w, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxCopyScalar(cell_height, &cell_h, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxCopyScalar(num_bins, &num_orientations, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    if (status != VX_SUCCESS || cell_w <= 0 || cell_h <= 0 || num_orientations <= 0)
+        return VX_ERROR_INVALID_PARAMETERS;
+
+    if (cache == NULL || cache_size < sizeof(hog_bin_table_t))
+    {
+        heap = calloc(1, sizeof(hog_bin_table_t));
+        if (heap == NULL)
+            return VX_ERROR_NO_MEMORY;
+        cache = heap;
+    }
+    hog_build_bin_table((hog_bin_table_t *)cache, num_orientations);
+
+    status |= vxGetValidRegionImage(img, &rect);
+    status |= vxMapImagePatch(img, &rect, 0, &map_id, &src_addr, &src_base, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (status != VX_SUCCESS)
+    {
+        free(heap);
+        return status;
+    }
+
     status |= AllocatePatch(magnitudes, &magnitudes_dim_num, magnitudes_dims, magnitudes_strides, &magnitudes_data, VX_WRITE_ONLY);
     status |= AllocatePatch(bins, &bins_dim_num, bins_dims, bins_strides, &bins_data, VX_WRITE_ONLY);
 
-    float num_div_360 = (float)num_orientations / 360.0f;
-    vx_int32 num_cellw = (vx_int32)floor(((vx_float64)width) / ((vx_float64)cell_w));
-    for (int j = 0; j < height; j++) {
-        for (int i = 0; i < width; i++) {
-
-            //calculating gx and gy
-            int x1 = i - 1 < 0 ? 0 : i - 1;
-            int x2 = i + 1 >= width ? width - 1 : i + 1;
-            vx_uint8 *gx1 = vxFormatImagePatchAddress2d(src_base, x1, j, &src_addr);
-            vx_uint8 *gx2 = vxFormatImagePatchAddress2d(src_base, x2, j, &src_addr);
-            gx = (vx_float32)(*gx2 - *gx1);
-
-            int y1 = j - 1 < 0 ? 0 : j - 1;
-            int y2 = j + 1 >= height ? height - 1 : j + 1;
-            vx_uint8 *gy1 = vxFormatImagePatchAddress2d(src_base, i, y1, &src_addr);
-            vx_uint8 *gy2 = vxFormatImagePatchAddress2d(src_base, i, y2, &src_addr);
-            gy = (vx_float32)(*gy2 - *gy1);
-
-            //calculating mag and orientation
-            magnitude = sqrtf(powf(gx, 2) + powf(gy, 2));
-            orientation = (float)fmod((double)atan2f(gy, gx + 0.00000000000001f)
-                * (180.0f / 3.14159265f), 360);
-            if (orientation < 0) {
-                orientation += 360;
+    h.base = (const vx_uint8 *)src_base;
+    h.stride = src_addr.stride_y;
+    h.width = src_addr.dim_x;
+    h.height = src_addr.dim_y;
+    h.cell_w = cell_w;
+    h.cell_h = cell_h;
+    h.num_bins = num_orientations;
+    h.num_cellw = (vx_int32)floor(((vx_float64)h.width) / ((vx_float64)cell_w));
+    h.area = (float)(cell_w * cell_h);
+    h.bin_table = ((const hog_bin_table_t *)cache)->bins;
+
+    if (status == VX_SUCCESS && h.width > 0 && h.height > 0)
+    {
+        /* a pixel past the last whole cell of a row counts toward the first cell of the next
+         * row, so each band gets sums of its own over every cell it can reach */
+        vx_int32 cell_rows = (h.height + cell_h - 1) / cell_h;
+        vx_uint32 num_bands = (vx_uint32)((cell_rows + HOG_CELL_ROWS_PER_BAND - 1) / HOG_CELL_ROWS_PER_BAND);
+        vx_int32 total_cells = 0;
+        vx_int32 *mags = NULL, *hist = NULL;
+        vx_uint32 b;
+
+        h.bands = (hog_band_t *)calloc(num_bands, sizeof(hog_band_t));
+        if (h.bands == NULL)
+            status = VX_ERROR_NO_MEMORY;
+        for (b = 0; b < num_bands && status == VX_SUCCESS; b++)
+        {
+            vx_int32 y0 = (vx_int32)b * HOG_CELL_ROWS_PER_BAND * cell_h;
+            vx_int32 y1 = min(y0 + HOG_CELL_ROWS_PER_BAND * cell_h, h.height);
+            vx_int32 hi = ((y1 - 1) / cell_h) * h.num_cellw + (h.width - 1) / cell_w + 1;
+            h.bands[b].lo = (y0 / cell_h) * h.num_cellw;
+            h.bands[b].cells = hi - h.bands[b].lo;
+            if (hi > total_cells)
+                total_cells = hi;
+        }
+
+        if (status == VX_SUCCESS)
+        {
+            ParallelForImpl(num_bands, 1, hog_cell_bands, &h);
+            mags = (vx_int32 *)calloc(total_cells, sizeof(vx_int32));
+            hist = (vx_int32 *)calloc((vx_size)total_cells * num_orientations + 1, sizeof(vx_int32));
+            if (mags == NULL || hist == NULL)
+                status = VX_ERROR_NO_MEMORY;
+            for (b = 0; b < num_bands; b++)
+            {
+                if (h.bands[b].mags == NULL || h.bands[b].bins == NULL)
+                    status = VX_ERROR_NO_MEMORY;
             }
+        }
+        if (status == VX_SUCCESS)
+        {
+            for (b = 0; b < num_bands; b++)
+            {
+                const hog_band_t *band = &h.bands[b];
+                vx_int32 k;
+                for (k = 0; k < band->cells; k++)
+                    mags[band->lo + k] += band->mags[k];
+                for (k = 0; k < band->cells * num_orientations + 1; k++)
+                    hist[band->lo * num_orientations + k] += band->bins[k];
+            }
+            hog_store(magnitudes_data, magnitudes_dims, magnitudes_strides, magnitudes_dim_num, mags, total_cells);
+            hog_store(bins_data, bins_dims, bins_strides, bins_dim_num, hist, (vx_size)total_cells * num_orientations + 1);
+        }
 
-            //calculating bin.
-            bin = (vx_int8)floor(orientation * num_div_360);
-
-            //calculating which cell it belongs to
-            vx_int32 cellx = i / cell_w;
-            vx_int32 celly = j / cell_h;
-            vx_int32 magnitudes_index = celly * num_cellw + cellx;
-            vx_int32 bins_index = (celly * num_cellw + cellx) * num_orientations + bin;
-            vx_size magnitudes_pos = ComputeGlobalPositionsFromIndex(magnitudes_index, magnitudes_dims, magnitudes_strides, magnitudes_dim_num, &magnitudes_pos);
-            vx_size bins_pos = ComputeGlobalPositionsFromIndex(bins_index, bins_dims, bins_strides, bins_dim_num, &bins_pos);
-            void *mag_ptr = (vx_int8 *)magnitudes_data + magnitudes_pos;
-            void *bins_ptr = (vx_int8 *)bins_data + bins_pos;
-            // Magnitude for each pixel is averaged over the cell area.
-            *(vx_int16 *)(mag_ptr) = *(vx_int16 *)(mag_ptr)+(vx_int16)(magnitude / (float)(cell_w * cell_h));
-            *(vx_int16 *)(bins_ptr) = *(vx_int16 *)(bins_ptr)+(vx_int16)(magnitude / (float)(cell_w * cell_h));
+        for (b = 0; h.bands && b < num_bands; b++)
+        {
+            free(h.bands[b].mags);
+            free(h.bands[b].bins);
         }
+        free(h.bands);
+        free(hist);
+        free(mags);
     }
 
     status |= ReleasePatch(magnitudes, magnitudes_dim_num, magnitudes_dims, magnitudes_strides, &magnitudes_data, VX_WRITE_ONLY);
     status |= ReleasePatch(bins, bins_dim_num, bins_dims, bins_strides, &bins_data, VX_WRITE_ONLY);
-    status |= vxCommitImagePatch(img, &rect, 0, &src_addr, src_base);
+    status |= vxUnmapImagePatch(img, map_id);
+    free(heap);
 
     return status;
 }
 
+typedef struct _hog_blocks_t {
+    const vx_int16 *mags;
+    const vx_int16 *bins;
+    vx_size mags_count;
+    vx_size bins_count;
+    const vx_hog_t *params;
+    vx_int32 n_cellsx;
+    vx_int32 cells_per_block_w;
+    vx_int32 cells_per_block_h;
+    vx_int32 block_len;
+    const vx_int32 *origins;    /* first cell of each distinct block */
+    vx_int16 *blocks;           /* block_len normalized features per distinct block */
+} hog_blocks_t;
+
+/* L2-Hys: L2-Norm -> clip at threshold -> renormalize, for the block whose top left cell is cell */
+static void hog_normalize_block(const hog_blocks_t *hb, vx_int32 cell, vx_int16 *out)
+{
+    const vx_hog_t *p = hb->params;
+    vx_float32 sum = 0;
+    vx_float32 renorm_sum = 0;
+    vx_int32 x, y, k, n = 0;
+
+    // Accumulate squared-magnitudes for all the cells in this block
+    for (y = 0; y < hb->cells_per_block_h; y++)
+    {
+        for (x = 0; x < hb->cells_per_block_w; x++)
+        {
+            vx_size idx = (vx_size)(cell + (y * hb->n_cellsx + x));
+            vx_int16 m = idx < hb->mags_count ? hb->mags[idx] : 0;
+            sum += m * m;
+        }
+    }
+    sum = sqrtf(sum + 0.00000000000001f);
+
+    // Normalize each cell histogram bin value using L2-Norm and then clip at threshold
+    for (y = 0; y < hb->cells_per_block_h; y++)
+    {
+        for (x = 0; x < hb->cells_per_block_w; x++)
+        {
+            vx_size binIdx_cell = (vx_size)(cell + (y * hb->n_cellsx + x)) * p->num_bins;
+            for (k = 0; k < p->num_bins; k++)
+            {
+                vx_int16 bin = (binIdx_cell + k) < hb->bins_count ? hb->bins[binIdx_cell + k] : 0;
+                float hist = min(bin / sum, p->threshold);
+                out[n] = (vx_int16)(hist * powf(2, 8)); // Bitshift for storing as INT16, Q78 feature tensor
+                renorm_sum += (out[n] / powf(2, 8)) * (out[n] / powf(2, 8));
+                n++;
+            }
+        }
+    }
+
+    renorm_sum = sqrtf(renorm_sum + 0.00000000000001f);
+
+    // Renormalize the whole block feature vector
+    for (k = 0; k < n; k++)
+    {
+        vx_float32 feature_val = ((vx_float32)out[k]) / powf(2, 8);
+        out[k] = (vx_int16)((feature_val / renorm_sum) * powf(2, 8));
+    }
+}
+
+static void hog_normalize_blocks(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const hog_blocks_t *hb = (const hog_blocks_t *)arg;
+    vx_uint32 i;
+
+    for (i = start; i < end; i++)
+        hog_normalize_block(hb, hb->origins[i], hb->blocks + (vx_size)i * hb->block_len);
+}
+
 vx_status vxHogFeatures(vx_image img, vx_tensor magnitudes, vx_tensor bins, vx_array hog_params, vx_scalar hog_param_size, vx_tensor features)
 {
     vx_status status;
     void* magnitudes_data = NULL;
     void* bins_data = NULL;
     void* features_data = NULL;
-    vx_uint32 block_index_count = 0;
-
+    vx_hog_t params;
+    vx_size hog_params_length = 0;
     vx_size hog_param_size_t;
+    vx_rectangle_t src_rect;
+    vx_int32 width, height;
+    vx_int32 *slots = NULL;         /* distinct block of each cell, or -1 */
+    vx_int32 *origins = NULL;
+    vx_int32 *window_blocks = NULL; /* distinct block of every block of every window, in output order */
+    vx_int16 *blocks = NULL;
+    vx_int32 num_distinct = 0;
+    hog_blocks_t hb;
+
     vx_size magnitudes_dim_num = 0, magnitudes_dims[MAX_NUM_OF_DIMENSIONS] = { 0 }, magnitudes_strides[MAX_NUM_OF_DIMENSIONS] = { 0 };
     vx_size bins_dim_num = 0, bins_dims[MAX_NUM_OF_DIMENSIONS] = { 0 }, bins_strides[MAX_NUM_OF_DIMENSIONS] = { 0 };
     vx_size features_dim_num = 0, features_dims[MAX_NUM_OF_DIMENSIONS] = { 0 }, features_strides[MAX_NUM_OF_DIMENSIONS] = { 0 };
 
+    status = vxQueryArray(hog_params, VX_ARRAY_NUMITEMS, &hog_params_length, sizeof(hog_params_length));
+    if (status != VX_SUCCESS || hog_params_length == 0)
+        return VX_ERROR_INVALID_PARAMETERS;
+    status |= vxCopyArrayRange(hog_params, 0, 1, sizeof(params), &params, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxCopyScalar(hog_param_size, &hog_param_size_t, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxGetValidRegionImage(img, &src_rect);
+    if (status != VX_SUCCESS)
+        return status;
+    width = (vx_int32)(src_rect.end_x - src_rect.start_x);
+    height = (vx_int32)(src_rect.end_y - src_rect.start_y);
+
     status = AllocatePatch(magnitudes, &magnitudes_dim_num, magnitudes_dims, magnitudes_strides, &magnitudes_data, VX_READ_ONLY);
     status |= AllocatePatch(bins, &bins_dim_num, bins_dims, bins_strides, &bins_data, VX_READ_ONLY);
     status |= AllocatePatch(features, &features_dim_num, features_dims, features_strides, &features_data, VX_WRITE_ONLY);
 
-    vx_size hog_params_stride = 0;
-    void *hog_params_ptr = NULL;
-    vx_map_id hog_params_map_id;
-    vx_size hog_params_length;
-    vxQueryArray(hog_params, VX_ARRAY_NUMITEMS, &hog_params_length, sizeof(hog_params_length));
-    vxMapArrayRange(hog_params, 0, hog_params_length, &hog_params_map_id,
-        &hog_params_stride, &hog_params_ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    vx_hog_t *hog_params_t = (vx_hog_t *)hog_params_ptr;
-    status |= vxCopyScalar(hog_param_size, &hog_param_size_t, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
-
-    vx_int32 width, height;
+    vx_int32 n_cellsx = width / params.cell_width;
+    vx_int32 n_cellsy = height / params.cell_height;
+    vx_int32 cells_per_block_w = params.block_width / params.cell_width;
+    vx_int32 cells_per_block_h = params.block_height / params.cell_height;
+    vx_int32 num_windowsW = (width - params.window_width) / params.window_stride + 1;
+    vx_int32 num_windowsH = (height - params.window_height) / params.window_stride + 1;
+    vx_int32 blocks_per_window_w = (params.window_width - params.block_width) / params.block_stride + 1;
+    vx_int32 blocks_per_window_h = (params.window_height - params.block_height) / params.block_stride + 1;
+    vx_int32 blocks_per_window = blocks_per_window_w * blocks_per_window_h;
+    vx_int32 block_len = cells_per_block_w * cells_per_block_h * params.num_bins;
+    vx_int32 num_windows = num_windowsW > 0 && num_windowsH > 0 ? num_windowsW * num_windowsH : 0;
+    vx_int32 num_cells = n_cellsx * n_cellsy;
+    vx_size features_count = ComputeNumberOfElements(features_dims, features_dim_num);
+
+    if (status == VX_SUCCESS && num_windows > 0 && blocks_per_window > 0 && block_len > 0)
+    {
+        window_blocks = (vx_int32 *)malloc((vx_size)num_windows * blocks_per_window * sizeof(vx_int32));
+        origins = (vx_int32 *)malloc((vx_size)num_windows * blocks_per_window * sizeof(vx_int32));
+        slots = (vx_int32 *)malloc((num_cells > 0 ? num_cells : 1) * sizeof(vx_int32));
+        if (window_blocks == NULL || origins == NULL || slots == NULL)
+            status = VX_ERROR_NO_MEMORY;
+    }
 
-    vx_rectangle_t src_rect;
-    vx_imagepatch_addressing_t src_addr = VX_IMAGEPATCH_ADDR_INIT;
-    void *src_base = NULL;
-    status |= vxGetValidRegionImage(img, &src_rect);
-    status |= vxAccessImagePatch(img, &src_rect, 0, &src_addr, (void **)&src_base, VX_READ_AND_WRITE);
-    width = src_addr.dim_x;
-    height = src_addr.dim_y;
-
-    vx_int32 num_blockW = width / hog_params_t->cell_width - 1;
-    vx_int32 num_blockH = height / hog_params_t->cell_height - 1;
-    vx_int32 n_cellsx = width / hog_params_t->cell_width;
-    vx_int32 n_cellsy = height / hog_params_t->cell_height;
-    vx_int32 cells_per_block_w = hog_params_t->block_width / hog_params_t->cell_width;
-    vx_int32 cells_per_block_h = hog_params_t->block_height / hog_params_t->cell_height;
-    vx_int32 num_windowsW = (width - hog_params_t->window_width) / hog_params_t->window_stride + 1;
-    vx_int32 num_windowsH = (height - hog_params_t->window_height) / hog_params_t->window_stride + 1;
-    vx_int32 blocks_per_window_w = (hog_params_t->window_width - hog_params_t->block_width) / hog_params_t->block_stride + 1;
-    vx_int32 blocks_per_window_h = (hog_params_t->window_height - hog_params_t->block_height) / hog_params_t->block_stride + 1;
-
-    // The below for-loop implements the following for each window:
-    // 1. Normalizes the histograms at block level using it's cells' magnitudes (L2-Sys)
-    // 2. Calculates HoG Descriptors for each window of the image, which is 
-    // the concatenated descriptors of all the blocks contained in it.
-    //
-    // Note: Windows in an image, blocks in a window and cells in a block, 
-    // are all processed in a row-major order. Cell bins are addressed in row-major 
-    // spanning the entire image. E.g. An image 24x16 has 6 cells of size 8x8. Bin Idx 0-8 
-    // for top left cell, 9-17 for next cell to the right, 18-26 for last cell on top row.
-    // For next row, cell's Bin Idx are 27-35, 36-44, 44-52.
-    for (vx_int32 winH = 0; winH < num_windowsH; winH++)
+    if (window_blocks && origins && slots)
     {
-        for (vx_int32 winW = 0; winW < num_windowsW; winW++)
+        vx_int32 w = 0;
+        for (vx_int32 c = 0; c < num_cells; c++)
+            slots[c] = -1;
+
+        // Windows in an image, blocks in a window and cells in a block, are all processed
+        // in a row-major order. Cell bins are addressed in row-major spanning the entire
+        // image. Overlapping windows share blocks, so each distinct block (named by its
+        // top left cell) is normalized once and copied into every window holding it.
+        for (vx_int32 winH = 0; winH < num_windowsH; winH++)
         {
-            // Indexes corresponding to the first cell (top left) of window and block
-            vx_uint64 binIdx_blk, binIdx_win;
-            vx_uint64 binIdx_cell, magIdx_cell;
-            binIdx_win = (winH*(n_cellsx*hog_params_t->window_stride / hog_params_t->cell_height) +
-                winW * (hog_params_t->window_stride / hog_params_t->cell_width))*hog_params_t->num_bins;
-
-            for (vx_int32 blkH = 0; blkH < blocks_per_window_h; blkH++)
+            for (vx_int32 winW = 0; winW < num_windowsW; winW++, w++)
             {
-                for (vx_int32 blkW = 0; blkW < blocks_per_window_w; blkW++)
-                {
-                    binIdx_blk = binIdx_win + (blkH*(n_cellsx*hog_params_t->block_stride / hog_params_t->cell_height)*hog_params_t->num_bins) +
-                        (blkW*hog_params_t->block_stride / hog_params_t->cell_height)*hog_params_t->num_bins;
-
-                    vx_float32 sum = 0;
-                    vx_float32 renorm_sum = 0;
-                    vx_uint32 renorm_block_index_st = block_index_count;
+                // Index of the first cell (top left) of window and block
+                vx_int32 cell_win = winH*(n_cellsx*params.window_stride / params.cell_height) +
+                    winW * (params.window_stride / params.cell_width);
 
-                    // Accumulate squared-magnitudes for all the cells in this block
-                    for (vx_int32 y = 0; y < cells_per_block_h; y++)
+                for (vx_int32 blkH = 0; blkH < blocks_per_window_h; blkH++)
+                {
+                    for (vx_int32 blkW = 0; blkW < blocks_per_window_w; blkW++)
                     {
-                        for (vx_int32 x = 0; x < cells_per_block_w; x++)
+                        vx_int32 cell = cell_win + blkH*(n_cellsx*params.block_stride / params.cell_height) +
+                            (blkW*params.block_stride / params.cell_height);
+                        vx_int32 slot;
+
+                        if (cell >= 0 && cell < num_cells && slots[cell] >= 0)
                         {
-                            magIdx_cell = (binIdx_blk / hog_params_t->num_bins) + (y*n_cellsx + x);
-                            void *mag_ptr = (vx_int16 *)magnitudes_data + magIdx_cell;
-                            sum += (*(vx_int16 *)mag_ptr) * (*(vx_int16 *)mag_ptr);
+                            slot = slots[cell];
                         }
-                    }
-                    // Square root of sum-of-squares of cell magnitudes for L2-Norm
-                    // For a block with 4 cells with mag m: sqrt( m1^2 + m2^2 + m3^2 + m4^2)
-                    sum = sqrtf(sum + 0.00000000000001f);
-
-                    // Calculate HoG Descriptor for the current block from its cell histograms 
-                    for (vx_int32 y = 0; y < cells_per_block_h; y++)
-                    {
-                        for (vx_int32 x = 0; x < cells_per_block_w; x++)
+                        else
                         {
-                            binIdx_cell = binIdx_blk + (y*n_cellsx + x)*hog_params_t->num_bins;
-
-                            for (vx_int32 k = 0; k < hog_params_t->num_bins; k++)
-                            {
-                                // Bin index for the current cell
-                                vx_int32 bins_index = binIdx_cell + k;
-                                vx_int32 block_index;
-
-                                block_index = block_index_count;
-
-                                // L2-Sys (at block level) = L2-Norm -> clip at threshold -> renormalize
-
-                                // Normalize each cell histogram bin value using L2-Norm and then clip at threshold
-                                // using square root of sum-of-squares of cell magnitudes calculated above
-                                float hist = min((vx_int16)(*((vx_int16 *)bins_data + bins_index)) / sum, hog_params_t->threshold);
-                                vx_int16 *features_ptr = (vx_int16 *)features_data + block_index;
-                                hist = hist * powf(2, 8); // Bitshift for storing as INT16, Q78 feature tensor
-                                *features_ptr = (vx_int16)hist;
-                                block_index_count++;
-                            } // End for num_bins
-                        } // End for cell_w
-                    } // End for cell_h
-
-                    // Renormalize the block histogram after L2-Norm and clipping to get L2-Hys
-                    vx_uint32 renorm_block_index_end = block_index_count;
-
-                    // Sum of squares of the block feature vector
-                    for (vx_uint32 renorm_count = renorm_block_index_st; renorm_count < renorm_block_index_end; renorm_count++) {
-                        vx_int16 *features_ptr = (vx_int16 *)features_data + renorm_count;
-                        vx_float32 feature_val = *features_ptr / powf(2, 8);	// Convert INT16 Q78 tensor value to float
-                        renorm_sum += (feature_val * feature_val);
+                            slot = num_distinct++;
+                            origins[slot] = cell;
+                            if (cell >= 0 && cell < num_cells)
+                                slots[cell] = slot;
+                        }
+                        window_blocks[w * blocks_per_window + blkH * blocks_per_window_w + blkW] = slot;
                     }
+                }
+            }
+        }
 
-                    renorm_sum = sqrtf(renorm_sum + 0.00000000000001f);			// Sqrt of 'sum of squares' for renormalization
+        blocks = (vx_int16 *)malloc((vx_size)num_distinct * block_len * sizeof(vx_int16));
+        if (blocks == NULL)
+            status = VX_ERROR_NO_MEMORY;
+    }
 
-                    // Renormalize the whole block feature vector
-                    for (vx_uint32 renorm_count = renorm_block_index_st; renorm_count < renorm_block_index_end; renorm_count++) {
-                        vx_int16 *features_ptr = (vx_int16 *)features_data + renorm_count;
-                        vx_float32 feature_val = ((vx_float32)*features_ptr) / powf(2, 8);	// Convert INT16 Q78 tensor value to float
-                        *features_ptr = (vx_int16)((feature_val / renorm_sum) * powf(2, 8));	// Renormalize and Bitshift for INT16, Q78 feature tensor
-                    }
-                }	// End for BlkW
-            }	// End for BlkH
-        }	// End for winW
-    }	// End for winH
+    if (blocks)
+    {
+        vx_size i, count = (vx_size)num_windows * blocks_per_window;
+
+        hb.mags = (const vx_int16 *)magnitudes_data;
+        hb.bins = (const vx_int16 *)bins_data;
+        hb.mags_count = ComputeNumberOfElements(magnitudes_dims, magnitudes_dim_num);
+        hb.bins_count = ComputeNumberOfElements(bins_dims, bins_dim_num);
+        hb.params = &params;
+        hb.n_cellsx = n_cellsx;
+        hb.cells_per_block_w = cells_per_block_w;
+        hb.cells_per_block_h = cells_per_block_h;
+        hb.block_len = block_len;
+        hb.origins = origins;
+        hb.blocks = blocks;
+        ParallelForImpl((vx_uint32)num_distinct, 16, hog_normalize_blocks, &hb);
+
+        // Concatenate the descriptors of the blocks of each window
+        for (i = 0; i < count; i++)
+        {
+            vx_size first = i * block_len;
+            vx_size len = (first + block_len <= features_count) ? (vx_size)block_len :
+                          (first < features_count ? features_count - first : 0);
+            memcpy((vx_int16 *)features_data + first, blocks + (vx_size)window_blocks[i] * block_len, len * sizeof(vx_int16));
+        }
+    }
 
-    status |= vxCommitImagePatch(img, &src_rect, 0, &src_addr, src_base);
-    status |= vxUnmapArrayRange(hog_params, hog_params_map_id);
+    free(blocks);
+    free(slots);
+    free(origins);
+    free(window_blocks);
     status |= ReleasePatch(magnitudes, magnitudes_dim_num, magnitudes_dims, magnitudes_strides, &magnitudes_data, VX_READ_ONLY);
     status |= ReleasePatch(bins, bins_dim_num, bins_dims, bins_strides, &bins_data, VX_READ_ONLY);
     status |= ReleasePatch(features, features_dim_num, features_dims, features_strides, &features_data, VX_WRITE_ONLY);
     return status;
-}
\ No newline at end of file
+}
@@ -16,6 +16,7 @@
 */
 
 #include <stdlib.h>
+#include <string.h>
 #include <c_model.h>
 
 #define VX_PI   3.1415926535897932384626433832795
@@ -36,152 +37,276 @@ unsigned vx_rng_next()
 
 vx_int32 vx_rng_uniform(vx_int32 a, vx_int32 b) { return a == b ? a : (vx_int32)(vx_rng_next() % (b - a) + a); }
 
-// nodeless version of the HoughLines Probabilistic kernel
-vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array lines_array, vx_scalar num_lines)
+/*! \brief The least number of rows worth a thread of their own. */
+#define HOUGH_ROWS_PER_THREAD (16)
+
+/*! \brief Lines are handed to the output array this many at a time. */
+#define HOUGH_LINES_BATCH (64)
+
+typedef struct _hough_t {
+    const vx_uint8 *base;
+    vx_imagepatch_addressing_t addr;
+    vx_df_image format;
+    vx_rectangle_t valid;
+    vx_uint32 width;
+    vx_uint32 height;
+    vx_int32 numangle;
+    vx_int32 numrho;
+    vx_int32 *accum;        /* numangle x numrho votes */
+    vx_float32 *cos_tab;    /* cos(n * theta) / rho */
+    vx_float32 *sin_tab;    /* sin(n * theta) / rho */
+    vx_int32 *bins;         /* accum index of each angle for the current point */
+    vx_size *row_counts;    /* non-zero points of each row, then the index of its first one */
+    vx_coordinates2d_t *nzloc;
+    vx_uint8 *mask;
+} hough_t;
+
+static void hough_dims(vx_uint32 width, vx_uint32 height, const vx_hough_lines_p_t *params,
+                       vx_int32 *numangle, vx_int32 *numrho)
 {
-    vx_status status = VX_FAILURE;
-    vx_coordinates2d_t pt;
-
-    vx_size param_hough_lines_array_stride = 0;
-    void *param_hough_lines_array_ptr = NULL;
-    vx_map_id param_hough_lines_array_map_id;
-    vx_size param_hough_lines_array_length;
+    *numangle = (vx_int32)(((vx_float32)VX_PI) / params->theta);
+    *numrho = vxRound(((width + height) * 2 + 1) / params->rho);
+}
 
-    vxQueryArray(param_hough_lines_array, VX_ARRAY_NUMITEMS, &param_hough_lines_array_length, sizeof(param_hough_lines_array_length));
-    vxMapArrayRange(param_hough_lines_array, 0, param_hough_lines_array_length, &param_hough_lines_array_map_id,
-                    &param_hough_lines_array_stride, &param_hough_lines_array_ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    vx_hough_lines_p_t *param_hough_lines = (vx_hough_lines_p_t *)param_hough_lines_array_ptr;
+vx_size HoughLinesPScratchSizeImpl(vx_uint32 width, vx_uint32 height, const vx_hough_lines_p_t *params)
+{
+    vx_int32 numangle = 0, numrho = 0;
+
+    if (params->theta <= 0.0f || params->rho <= 0.0f)
+        return 0;
+    hough_dims(width, height, params, &numangle, &numrho);
+    if (numangle <= 0 || numrho <= 0)
+        return 0;
+
+    /* see hough_layout, the row counts go first so that every block stays aligned */
+    return (vx_size)height * sizeof(vx_size) +
+           (vx_size)numangle * numrho * sizeof(vx_int32) +
+           (vx_size)width * height * sizeof(vx_coordinates2d_t) +
+           (vx_size)numangle * (2 * sizeof(vx_float32) + sizeof(vx_int32)) +
+           (((vx_size)width * height + 3) & ~(vx_size)3);
+}
 
-    vx_float32 irho = 1 / param_hough_lines->rho;
+static void hough_layout(hough_t *h, void *scratch)
+{
+    vx_uint8 *ptr = (vx_uint8 *)scratch;
+    vx_size cells = (vx_size)h->width * h->height;
+
+    h->row_counts = (vx_size *)ptr;
+    ptr += h->height * sizeof(vx_size);
+    h->accum = (vx_int32 *)ptr;
+    ptr += (vx_size)h->numangle * h->numrho * sizeof(vx_int32);
+    h->nzloc = (vx_coordinates2d_t *)ptr;
+    ptr += cells * sizeof(vx_coordinates2d_t);
+    h->cos_tab = (vx_float32 *)ptr;
+    ptr += h->numangle * sizeof(vx_float32);
+    h->sin_tab = (vx_float32 *)ptr;
+    ptr += h->numangle * sizeof(vx_float32);
+    h->bins = (vx_int32 *)ptr;
+    ptr += h->numangle * sizeof(vx_int32);
+    h->mask = ptr;
+}
 
-    vx_df_image format = 0;
-    vx_uint32 width = 0, height = 0;
-    vxQueryImage(img, VX_IMAGE_FORMAT, &format, sizeof(format));
-    vxQueryImage(img, VX_IMAGE_WIDTH,  &width,  sizeof(width));
-    vxQueryImage(img, VX_IMAGE_HEIGHT, &height, sizeof(height));
+/* builds the mask of a band of rows and counts their non-zero points */
+static void hough_count_rows(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const hough_t *h = (const hough_t *)arg;
+    vx_uint32 y;
 
-    if (format != VX_DF_IMAGE_U1 && format != VX_DF_IMAGE_U8)
+    for (y = start; y < end; y++)
     {
-        status = VX_FAILURE;
-        return status;
-    }
-
-    vx_rectangle_t src_rect, src_full_rect = {0, 0, width, height};
-    vx_imagepatch_addressing_t src_addr = VX_IMAGEPATCH_ADDR_INIT;
-    void *src_base = NULL;
+        const vx_uint8 *data = (const vx_uint8 *)h->base + y * h->addr.stride_y;
+        vx_uint8 *m = h->mask + (vx_size)y * h->width;
+        vx_size count = 0;
+        vx_uint32 x;
 
-    status = vxGetValidRegionImage(img, &src_rect);
-    status |= vxAccessImagePatch(img, &src_full_rect, 0, &src_addr, (void **)&src_base, VX_READ_AND_WRITE);
+        memset(m, 0, h->width);
+        if (y >= h->valid.start_y && y < h->valid.end_y)
+        {
+            if (h->format == VX_DF_IMAGE_U1)
+            {
+                for (x = h->valid.start_x; x < h->valid.end_x; x++)
+                {
+                    m[x] = (vx_uint8)((data[x / 8] >> (x % 8)) & 1);
+                    count += m[x];
+                }
+            }
+            else
+            {
+                /* no branches, so this vectorizes */
+                for (x = h->valid.start_x; x < h->valid.end_x; x++)
+                {
+                    m[x] = (vx_uint8)(data[x] != 0);
+                    count += m[x];
+                }
+            }
+        }
+        h->row_counts[y] = count;
+    }
+}
 
-    int numangle = (int)(((vx_float32)VX_PI) / param_hough_lines->theta);
-    int numrho = vxRound(((width + height) * 2 + 1) / param_hough_lines->rho);
+static void hough_write_rows(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const hough_t *h = (const hough_t *)arg;
+    vx_uint32 y;
 
-    vx_rng((vx_uint64)-1);
+    for (y = start; y < end; y++)
+    {
+        const vx_uint8 *m = h->mask + (vx_size)y * h->width;
+        vx_coordinates2d_t *pt = h->nzloc + h->row_counts[y];
+        vx_uint32 x;
 
-    vx_context context_houghlines_internal = vxCreateContext();
-    vx_array accum = vxCreateArray(context_houghlines_internal, VX_TYPE_INT32, numrho * numangle);
-    vx_array mask = vxCreateArray(context_houghlines_internal, VX_TYPE_UINT8, width * height);
-    vx_array trigtab = vxCreateArray(context_houghlines_internal, VX_TYPE_FLOAT32, numangle * 2);
-    vx_array nzloc = vxCreateArray(context_houghlines_internal, VX_TYPE_COORDINATES2D, width * height);
+        for (x = 0; x < h->width; x++)
+        {
+            if (m[x])
+            {
+                pt->x = x;
+                pt->y = y;
+                pt++;
+            }
+        }
+    }
+}
 
-    vx_size accum_stride = 0;
-    void *accum_ptr = NULL;
-    vx_map_id accum_map_id;
+/* the accumulator index of every angle for the point (x, y), rounded exactly as vxRound does */
+static void hough_bins(const hough_t *h, vx_int32 x, vx_int32 y)
+{
+    const vx_float32 fx = (vx_float32)x, fy = (vx_float32)y;
+    const vx_int32 offset = (h->numrho - 1) / 2;
+    vx_int32 n;
 
-    for (int i = 0; i < numrho * numangle; i++)
+    for (n = 0; n < h->numangle; n++)
     {
-        vx_int32 num = 0;
-        vxAddArrayItems(accum, 1, &num, VX_TYPE_INT32);
+        vx_float64 v = (vx_float64)(fx * h->cos_tab[n] + fy * h->sin_tab[n]);
+        h->bins[n] = n * h->numrho + (vx_int32)(v + (v >= 0 ? 0.5 : -0.5)) + offset;
     }
-    vxMapArrayRange(accum, 0, numrho * numangle, &accum_map_id, &accum_stride, &accum_ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    vx_int32 *accum_p = (vx_int32 *)accum_ptr;
+}
 
-    for (int n = 0; n < numangle; n++)
+/* adds as many of the pending lines as there is room for, lines beyond the capacity are
+ * dropped without an error, as when they were added one at a time */
+static vx_status hough_flush_lines(vx_array lines_array, vx_line2d_t *lines, vx_size *count, vx_size *room)
+{
+    vx_status status = VX_SUCCESS;
+    vx_size n = *count < *room ? *count : *room;
+    if (n > 0)
     {
-        vx_float32 cos_v = (vx_float32)(cos((vx_float64)n * (param_hough_lines->theta)) * irho);
-        vx_float32 sin_v = (vx_float32)(sin((vx_float64)n * (param_hough_lines->theta)) * irho);
-        vxAddArrayItems(trigtab, 1, &cos_v, sizeof(vx_float32));
-        vxAddArrayItems(trigtab, 1, &sin_v, sizeof(vx_float32));
+        status = vxAddArrayItems(lines_array, n, lines, sizeof(vx_line2d_t));
+        *room -= n;
     }
+    *count = 0;
+    return status;
+}
 
-    vx_size trigtab_stride = 0;
-    void *trigtab_ptr = NULL;
-    vx_map_id trigtab_map_id;
-    vxMapArrayRange(trigtab, 0, numangle * 2, &trigtab_map_id, &trigtab_stride, &trigtab_ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    vx_float32 *trigtab_p = (vx_float32 *)trigtab_ptr;
-    const vx_float32* ttab = &trigtab_p[0];
-
-    vx_int32 nzcount = 0;
+// nodeless version of the HoughLines Probabilistic kernel
+vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array lines_array, vx_scalar num_lines,
+                        void *scratch, vx_size scratch_size)
+{
+    vx_status status = VX_SUCCESS;
+    vx_hough_lines_p_t params;
+    vx_size num_params = 0;
+    vx_size size = 0;
+    void *heap = NULL;
+    vx_rectangle_t src_full_rect;
+    vx_map_id map_id = 0;
+    vx_line2d_t lines[HOUGH_LINES_BATCH];
+    vx_size lines_pending = 0;
+    vx_size lines_capacity = 0;
+    vx_size lines_items = 0;
+    vx_size lines_room = 0;
     vx_size lines_num = 0;
-
-    // stage 1. collect non-zero image points
-    for (pt.y = 0; pt.y < (vx_uint32)height; pt.y++)
+    vx_int32 nzcount = 0;
+    vx_uint32 y;
+    vx_int32 n;
+    hough_t h;
+
+    memset(&h, 0, sizeof(h));
+    status |= vxQueryArray(param_hough_lines_array, VX_ARRAY_NUMITEMS, &num_params, sizeof(num_params));
+    if (status != VX_SUCCESS || num_params == 0)
+        return VX_ERROR_INVALID_PARAMETERS;
+    status |= vxCopyArrayRange(param_hough_lines_array, 0, 1, sizeof(params), &params, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+
+    status |= vxQueryArray(lines_array, VX_ARRAY_CAPACITY, &lines_capacity, sizeof(lines_capacity));
+    status |= vxQueryArray(lines_array, VX_ARRAY_NUMITEMS, &lines_items, sizeof(lines_items));
+    lines_room = lines_capacity > lines_items ? lines_capacity - lines_items : 0;
+
+    status |= vxQueryImage(img, VX_IMAGE_FORMAT, &h.format, sizeof(h.format));
+    status |= vxQueryImage(img, VX_IMAGE_WIDTH,  &h.width,  sizeof(h.width));
+    status |= vxQueryImage(img, VX_IMAGE_HEIGHT, &h.height, sizeof(h.height));
+    if (status != VX_SUCCESS || (h.format != VX_DF_IMAGE_U1 && h.format != VX_DF_IMAGE_U8))
+        return VX_FAILURE;
+
+    size = HoughLinesPScratchSizeImpl(h.width, h.height, &params);
+    if (size == 0)
+        return VX_ERROR_INVALID_PARAMETERS;
+
+    /* the parameters may have been changed since the node was initialized */
+    if (scratch == NULL || scratch_size < size)
     {
-        const vx_uint8* data = (vx_uint8*)vxFormatImagePatchAddress2d(src_base, 0, pt.y, &src_addr);
-        for (pt.x = 0; pt.x < (vx_uint32)width; pt.x++)
-        {
-            vx_uint8 mdata_in = 0;
-            vx_bool pxl_is_valid = vx_false_e, pxl_is_non_zero = vx_false_e;
+        heap = malloc(size);
+        if (heap == NULL)
+            return VX_ERROR_NO_MEMORY;
+        scratch = heap;
+    }
+    hough_dims(h.width, h.height, &params, &h.numangle, &h.numrho);
+    hough_layout(&h, scratch);
 
-            if (pt.y >= src_rect.start_y && pt.y < src_rect.end_y && pt.x >= src_rect.start_x && pt.x < src_rect.end_x)
-                pxl_is_valid = vx_true_e;
+    memset(h.accum, 0, (vx_size)h.numangle * h.numrho * sizeof(vx_int32));
+    for (n = 0; n < h.numangle; n++)
+    {
+        vx_float32 irho = 1 / params.rho;
+        h.cos_tab[n] = (vx_float32)(cos((vx_float64)n * params.theta) * irho);
+        h.sin_tab[n] = (vx_float32)(sin((vx_float64)n * params.theta) * irho);
+    }
 
-            if (pxl_is_valid && format == VX_DF_IMAGE_U1)
-                pxl_is_non_zero = (data[pt.x / 8] & (1 << (pt.x % 8))) ? vx_true_e : vx_false_e;
-            else if (pxl_is_valid)  // format == VX_DF_IMAGE_U8
-                pxl_is_non_zero =  data[pt.x] ? vx_true_e : vx_false_e;
+    // stage 1. collect non-zero image points
+    src_full_rect.start_x = 0;
+    src_full_rect.start_y = 0;
+    src_full_rect.end_x = h.width;
+    src_full_rect.end_y = h.height;
+    status |= vxGetValidRegionImage(img, &h.valid);
+    status |= vxMapImagePatch(img, &src_full_rect, 0, &map_id, &h.addr, (void **)&h.base,
+                              VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (status == VX_SUCCESS)
+    {
+        ParallelForImpl(h.height, HOUGH_ROWS_PER_THREAD, hough_count_rows, &h);
 
-            if (pxl_is_non_zero)
-            {
-                mdata_in = 1;
-                vxAddArrayItems(nzloc, 1, &pt, sizeof(vx_coordinates2d_t));
-                nzcount++;
-            }
-            vxAddArrayItems(mask, 1, &mdata_in, sizeof(vx_uint8));
+        /* the counts become the index of the first point of each row, keeping raster order */
+        for (y = 0; y < h.height; y++)
+        {
+            vx_size count = h.row_counts[y];
+            h.row_counts[y] = (vx_size)nzcount;
+            nzcount += (vx_int32)count;
         }
+        ParallelForImpl(h.height, HOUGH_ROWS_PER_THREAD, hough_write_rows, &h);
+        status |= vxUnmapImagePatch(img, map_id);
     }
 
-    vx_size nzloc_stride = 0;
-    void *nzloc_ptr = NULL;
-    vx_map_id nzloc_map_id;
-
-    vx_size mask_stride = 0;
-    void *mask_ptr = NULL;
-    vx_map_id mask_map_id;
-
-    vxMapArrayRange(mask, 0, width * height, &mask_map_id, &mask_stride, &mask_ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    vxMapArrayRange(nzloc, 0, nzcount, &nzloc_map_id, &nzloc_stride, &nzloc_ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    vx_uint8 *mask_p = (vx_uint8 *)mask_ptr;
-    vx_coordinates2d_t *nzloc_p = (vx_coordinates2d_t *)nzloc_ptr;
+    vx_rng((vx_uint64)-1);
 
-    vx_uint8* mdata0 = mask_p;
     // stage 2. process all the points in random order
-    for (; nzcount > 0; nzcount--)
+    for (; (status == VX_SUCCESS) && (nzcount > 0); nzcount--)
     {
         // choose random point out of the remaining ones
         vx_int32 idx = vx_rng_uniform(0, nzcount);
-        vx_int32 max_val = param_hough_lines->threshold - 1, max_n = 0;
-        vx_coordinates2d_t point = nzloc_p[idx];
+        vx_int32 max_val = params.threshold - 1, max_n = 0;
+        vx_coordinates2d_t point = h.nzloc[idx];
         vx_coordinates2d_t line_end[2];
         vx_float32 a, b;
-        vx_int32* adata = accum_p;
         vx_int32 i = point.y, j = point.x, k, x0, y0, dx0, dy0, xflag;
         vx_int32 good_line;
         const vx_int32 shift = 16;
 
         // "remove" it by overriding it with the last element
-        nzloc_p[idx] = nzloc_p[nzcount - 1];
+        h.nzloc[idx] = h.nzloc[nzcount - 1];
 
         // check if it has been excluded already (i.e. belongs to some other line)
-        if (!mdata0[i*width + j])
+        if (!h.mask[i*h.width + j])
             continue;
 
         // update accumulator, find the most probable line
-        for (vx_int32 n = 0; n < numangle; n++, adata += numrho)
+        hough_bins(&h, j, i);
+        for (n = 0; n < h.numangle; n++)
         {
-            vx_int32 r = vxRound(j * ttab[n * 2] + i * ttab[n * 2 + 1]);
-            r += (numrho - 1) / 2;
-            vx_int32 val = ++adata[r];
+            vx_int32 val = ++h.accum[h.bins[n]];
             if (max_val < val)
             {
                 max_val = val;
@@ -190,13 +315,13 @@ vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array
         }
 
         // if it is too "weak" candidate, continue with another point
-        if (max_val < param_hough_lines->threshold)
+        if (max_val < params.threshold)
             continue;
 
         // from the current point walk in each direction
         // along the found line and extract the line segment
-        a = -ttab[max_n * 2 + 1];
-        b = ttab[max_n * 2];
+        a = -h.sin_tab[max_n];
+        b = h.cos_tab[max_n];
         x0 = j;
         y0 = i;
         if (fabs(a) > fabs(b))
@@ -239,10 +364,10 @@ vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array
                     i1 = y;
                 }
 
-                if (j1 < 0 || j1 >= (vx_int32)width || i1 < 0 || i1 >= (vx_int32)height)
+                if (j1 < 0 || j1 >= (vx_int32)h.width || i1 < 0 || i1 >= (vx_int32)h.height)
                     break;
 
-                mdata = mdata0 + i1*width + j1;
+                mdata = h.mask + i1*h.width + j1;
 
                 // for each non-zero point:
                 //    update line end,
@@ -254,13 +379,13 @@ vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array
                     line_end[k].y = i1;
                     line_end[k].x = j1;
                 }
-                else if (++gap > param_hough_lines->line_gap)
+                else if (++gap > params.line_gap)
                     break;
             }
         }
 
-        good_line = abs((int)line_end[1].x - (int)line_end[0].x) >= param_hough_lines->line_length ||
-                    abs((int)line_end[1].y - (int)line_end[0].y) >= param_hough_lines->line_length;
+        good_line = abs((int)line_end[1].x - (int)line_end[0].x) >= params.line_length ||
+                    abs((int)line_end[1].y - (int)line_end[0].y) >= params.line_length;
 
         for (k = 0; k < 2; k++)
         {
@@ -287,7 +412,7 @@ vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array
                     i1 = y;
                 }
 
-                mdata = mdata0 + i1*width + j1;
+                mdata = h.mask + i1*h.width + j1;
 
                 // for each non-zero point:
                 //    update line end,
@@ -297,13 +422,9 @@ vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array
                 {
                     if (good_line)
                     {
-                        adata = accum_p;
-                        for (vx_int32 n = 0; n < numangle; n++, adata += numrho)
-                        {
-                            vx_int32 r = vxRound(j1 * ttab[n * 2] + i1 * ttab[n * 2 + 1]);
-                            r += (numrho - 1) / 2;
-                            adata[r]--;
-                        }
+                        hough_bins(&h, j1, i1);
+                        for (n = 0; n < h.numangle; n++)
+                            h.accum[h.bins[n]]--;
                     }
                     *mdata = 0;
                 }
@@ -315,40 +436,31 @@ vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array
 
         if (good_line)
         {
-            vx_line2d_t lines;
+            vx_line2d_t *line = &lines[lines_pending++];
             if ((line_end[0].x > line_end[1].x) || (line_end[0].x == line_end[1].x && line_end[0].y > line_end[1].y))
             {
-                lines.start_x = (vx_float32)line_end[1].x;
-                lines.start_y = (vx_float32)line_end[1].y;
-                lines.end_x = (vx_float32)line_end[0].x;
-                lines.end_y = (vx_float32)line_end[0].y;
+                line->start_x = (vx_float32)line_end[1].x;
+                line->start_y = (vx_float32)line_end[1].y;
+                line->end_x = (vx_float32)line_end[0].x;
+                line->end_y = (vx_float32)line_end[0].y;
             }
             else
             {
-                lines.start_x = (vx_float32)line_end[0].x;
-                lines.start_y = (vx_float32)line_end[0].y;
-                lines.end_x = (vx_float32)line_end[1].x;
-                lines.end_y = (vx_float32)line_end[1].y;
+                line->start_x = (vx_float32)line_end[0].x;
+                line->start_y = (vx_float32)line_end[0].y;
+                line->end_x = (vx_float32)line_end[1].x;
+                line->end_y = (vx_float32)line_end[1].y;
             }
-            vxAddArrayItems(lines_array, 1, &lines, sizeof(vx_line2d_t));
             lines_num++;
+            if (lines_pending == HOUGH_LINES_BATCH)
+                status |= hough_flush_lines(lines_array, lines, &lines_pending, &lines_room);
         }
     }
+    status |= hough_flush_lines(lines_array, lines, &lines_pending, &lines_room);
 
-    vxCopyScalar(num_lines, &lines_num, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
-
-    status |= vxUnmapArrayRange(accum, accum_map_id);
-    status |= vxUnmapArrayRange(mask, mask_map_id);
-    status |= vxUnmapArrayRange(trigtab, trigtab_map_id);
-    status |= vxUnmapArrayRange(nzloc, nzloc_map_id);
-    status |= vxUnmapArrayRange(param_hough_lines_array, param_hough_lines_array_map_id);
-    status |= vxCommitImagePatch(img, &src_full_rect, 0, &src_addr, src_base);
-
-    vxReleaseArray(&accum);
-    vxReleaseArray(&mask);
-    vxReleaseArray(&trigtab);
-    vxReleaseArray(&nzloc);
+    if (num_lines)
+        status |= vxCopyScalar(num_lines, &lines_num, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
 
-    vxReleaseContext(&context_houghlines_internal);
-    return VX_SUCCESS;
+    free(heap);
+    return status;
 }
@@ -16,6 +16,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_NUM_OF_DIMENSIONS   6
 #define PWL_NORM_NUM_SEGMENTS   64
@@ -64,6 +65,9 @@ static int_fast32_t getSizeofType(enum TensorCFmt fmt)
         case TENSOR_C_FMT_Q78: return sizeof(int16_t);
         case TENSOR_C_FMT_U8: return sizeof(uint8_t);
         case TENSOR_C_FMT_S8: return sizeof(int8_t);
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+        case TENSOR_C_FMT_F16: return sizeof(uint16_t);
+#endif
         default: assert(0); return 1;
     }
 }
@@ -103,6 +107,30 @@ static C_KERNEL_INLINE void storeRawIntValue(enum TensorCFmt fmt, int_fast32_t v
 }
 
 
+// Whole rows of loadValueAsRawInt/storeRawIntValue, with the format switch
+// out of the loop
+static void loadRawIntRow(enum TensorCFmt fmt, const char * ptr, size_t stride, size_t n, int32_t * dst)
+{
+    switch(fmt)
+    {
+        case TENSOR_C_FMT_Q78: for (size_t i = 0; i < n; ++i) dst[i] = *(const int16_t *)(ptr + i * stride); break;
+        case TENSOR_C_FMT_U8: for (size_t i = 0; i < n; ++i) dst[i] = *(const uint8_t *)(ptr + i * stride); break;
+        case TENSOR_C_FMT_S8: for (size_t i = 0; i < n; ++i) dst[i] = *(const int8_t *)(ptr + i * stride); break;
+        default: assert(0);
+    }
+}
+
+static void storeRawIntRow(enum TensorCFmt fmt, const int32_t * src, size_t n, char * ptr, size_t stride)
+{
+    switch(fmt)
+    {
+        case TENSOR_C_FMT_Q78: for (size_t i = 0; i < n; ++i) *(int16_t *)(ptr + i * stride) = src[i]; break;
+        case TENSOR_C_FMT_U8: for (size_t i = 0; i < n; ++i) *(uint8_t *)(ptr + i * stride) = src[i]; break;
+        case TENSOR_C_FMT_S8: for (size_t i = 0; i < n; ++i) *(int8_t *)(ptr + i * stride) = src[i]; break;
+        default: assert(0);
+    }
+}
+
 static C_KERNEL_INLINE float value2Float(enum TensorCFmt fmt, int_fast32_t val)
 {
     switch(fmt)
@@ -178,6 +206,63 @@ static C_KERNEL_INLINE int_fast32_t quantize(enum TensorCFmt fmt, float val)
     return wrapOrSat(fmt, val, false);
 }
 
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+
+// F16 has no raw int form: the NN kernels compute it in float, and convert
+// whole rows where they can, for half2floatRow/float2halfRow to vectorize.
+static C_KERNEL_INLINE float loadHalfValue(const void * ptr)
+{
+    return half2float(*(const uint16_t *)ptr);
+}
+
+static C_KERNEL_INLINE void storeHalfValue(float val, /*OUT*/ void * ptr)
+{
+    *(uint16_t *)ptr = float2half(val);
+}
+
+static void loadHalfRow(const char * ptr, size_t stride, size_t n, float * dst)
+{
+    if (stride == sizeof(uint16_t))
+    {
+        half2floatRow((const uint16_t *)ptr, n, dst);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = loadHalfValue(ptr + i * stride);
+}
+
+static void storeHalfRow(const float * src, size_t n, char * ptr, size_t stride)
+{
+    if (stride == sizeof(uint16_t))
+    {
+        float2halfRow(src, n, (uint16_t *)ptr);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i)
+        storeHalfValue(src[i], ptr + i * stride);
+}
+
+// The first dim_num dims of td, at ptr, as dense floats
+static void loadHalfBlock(const char * ptr, tensor_desc_t td, size_t dim_num, float * dst)
+{
+    size_t rows = 1;
+    for (size_t i = 1; i < dim_num; ++i)
+        rows *= td.dims[i];
+
+    for (size_t r = 0; r < rows; ++r)
+    {
+        size_t offset = 0, rest = r;
+        for (size_t i = 1; i < dim_num; ++i)
+        {
+            offset += td.strides[i] * (rest % td.dims[i]);
+            rest /= td.dims[i];
+        }
+        loadHalfRow(ptr + offset, td.strides[0], td.dims[0], dst + r * td.dims[0]);
+    }
+}
+
+#endif
+
 
 /****************************************************************************
  *                                                                          *
@@ -185,6 +270,273 @@ static C_KERNEL_INLINE int_fast32_t quantize(enum TensorCFmt fmt, float val)
  *                                                                          *
  ***************************************************************************/
 
+// Convolution runs one (batch, ofm) output plane per item
+typedef struct _convolution_t
+{
+    enum TensorCFmt fmt;
+    const char * in;
+    const char * weight;
+    const char * bias;
+    char * out;
+    tensor_desc_t input;
+    tensor_desc_t weights;
+    tensor_desc_t biases;
+    tensor_desc_t output;
+    size_t pad_x, pad_y;
+    size_t stride_x, stride_y;
+    size_t dilation_x, dilation_y;
+    bool wrap;
+    bool to_ne;
+} convolution_t;
+
+static void convolutionPlanes(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const convolution_t * cv = (const convolution_t *)arg;
+    const enum TensorCFmt fmt = cv->fmt;
+    const tensor_desc_t input = cv->input, weight = cv->weights, bias = cv->biases, output = cv->output;
+    const size_t pad_x = cv->pad_x, pad_y = cv->pad_y;
+    const size_t stride_x = cv->stride_x, stride_y = cv->stride_y;
+    const size_t dilation_x = cv->dilation_x, dilation_y = cv->dilation_y;
+    const bool wrap = cv->wrap, to_ne = cv->to_ne;
+
+    const size_t input_w = input.dims[0];
+    const size_t input_h = input.dims[1];
+    const size_t input_c = input.dims[2];
+
+    const size_t weight_w = weight.dims[0];
+    const size_t weight_h = weight.dims[1];
+
+    const bool bias_present = !!bias.dim_num;
+    const bool bias_shared = bias.dim_num == 1;
+
+    const size_t output_w = output.dims[0];
+    const size_t output_h = output.dims[1];
+    const size_t output_c = output.dims[2];
+
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        const size_t b = item / output_c, ofm = item % output_c;
+        const char * in_b_ptr = cv->in + (b ? input.strides[3] * b : 0);
+        char * out_b_ptr = cv->out + (b ? output.strides[3] * b : 0);
+
+        for (size_t y = 0; y < output_h; ++y)
+        for (size_t x = 0; x < output_w; ++x)
+        {
+            int32_t sum = 0;
+            if (bias_present)
+            {
+                const size_t bias_byte_offset =
+                    bias_shared
+                    ? (bias.strides[0] * ofm)
+                    : (bias.strides[2] * ofm + bias.strides[1] * y + bias.strides[0] * x);
+
+                sum = loadValueAsRawInt(fmt, cv->bias + bias_byte_offset);
+            }
+        
+            const size_t xx = x * stride_x;
+            const size_t yy = y * stride_y;
+
+            for (size_t ifm = 0; ifm < input_c; ++ifm)
+            {
+                for (size_t w_y = 0; w_y < weight_h; ++w_y)
+                for (size_t w_x = 0; w_x < weight_w; ++w_x)
+                {
+                    const size_t tmp_x = xx + w_x * (dilation_x + 1) + dilation_x;
+                    const size_t tmp_y = yy + w_y * (dilation_y + 1) + dilation_y;
+
+                    if (tmp_x >= pad_x && tmp_x < input_w + pad_x &&
+                        tmp_y >= pad_y && tmp_y < input_h + pad_y)
+                    {
+                        const size_t input_byte_offset =
+                            input.strides[2] * ifm +
+                            input.strides[1] * (tmp_y - pad_y) +
+                            input.strides[0] * (tmp_x - pad_x);
+                        const size_t weight_byte_offset =
+                            weight.strides[3] * ofm +
+                            weight.strides[2] * ifm +
+                            weight.strides[1] * w_y +
+                            weight.strides[0] * w_x;
+
+                        const int_fast32_t i_val = loadValueAsRawInt(fmt, in_b_ptr + input_byte_offset);
+                        const int_fast32_t w_val = loadValueAsRawInt(fmt, cv->weight + weight_byte_offset);
+
+                        // This is ok since all of them fit into int32_t
+                        sum = applyWrapRoundingToAccum(fmt, i_val * w_val, wrap, to_ne) + sum;
+                    }
+                }
+                sum = wrapOrSat(fmt, sum, wrap);
+            }
+
+            // The step here could be added to the loops instead of recalcing
+            // if, but does the compiler fail to hoist them out???
+            const size_t output_byte_offset =
+                output.strides[2] * ofm +
+                output.strides[1] * y +
+                output.strides[0] * x;
+            storeRawIntValue(fmt, sum, out_b_ptr + output_byte_offset);
+        }
+    }
+}
+
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+
+// F16 convolution accumulates in float, each output in the same (ifm, w_y,
+// w_x) order as convolutionHalfOutput. The input is converted once, each plane
+// converts the weights of its ofm and then adds every tap along whole rows.
+typedef struct _convolution_half_t
+{
+    const convolution_t * cv;
+    const float * in;   // the input as dense floats, or NULL
+} convolution_half_t;
+
+static float convolutionHalfOutput(const convolution_t * cv, size_t b, size_t ofm, size_t x, size_t y)
+{
+    const tensor_desc_t input = cv->input, weight = cv->weights, bias = cv->biases;
+    const size_t input_w = input.dims[0], input_h = input.dims[1], input_c = input.dims[2];
+    const size_t weight_w = weight.dims[0], weight_h = weight.dims[1];
+    const char * in_b_ptr = cv->in + (b ? input.strides[3] * b : 0);
+
+    float sum = 0.f;
+    if (bias.dim_num)
+    {
+        const size_t bias_byte_offset =
+            bias.dim_num == 1
+            ? (bias.strides[0] * ofm)
+            : (bias.strides[2] * ofm + bias.strides[1] * y + bias.strides[0] * x);
+
+        sum = loadHalfValue(cv->bias + bias_byte_offset);
+    }
+
+    for (size_t ifm = 0; ifm < input_c; ++ifm)
+    for (size_t w_y = 0; w_y < weight_h; ++w_y)
+    for (size_t w_x = 0; w_x < weight_w; ++w_x)
+    {
+        const size_t tmp_x = x * cv->stride_x + w_x * (cv->dilation_x + 1) + cv->dilation_x;
+        const size_t tmp_y = y * cv->stride_y + w_y * (cv->dilation_y + 1) + cv->dilation_y;
+
+        if (tmp_x >= cv->pad_x && tmp_x < input_w + cv->pad_x &&
+            tmp_y >= cv->pad_y && tmp_y < input_h + cv->pad_y)
+        {
+            const size_t input_byte_offset =
+                input.strides[2] * ifm +
+                input.strides[1] * (tmp_y - cv->pad_y) +
+                input.strides[0] * (tmp_x - cv->pad_x);
+            const size_t weight_byte_offset =
+                weight.strides[3] * ofm +
+                weight.strides[2] * ifm +
+                weight.strides[1] * w_y +
+                weight.strides[0] * w_x;
+
+            sum += loadHalfValue(in_b_ptr + input_byte_offset) * loadHalfValue(cv->weight + weight_byte_offset);
+        }
+    }
+    return sum;
+}
+
+// The outputs [*start, *after) whose tap at off lands in the input, that is
+// pad <= x * stride + off < input_sz + pad
+static void convolutionHalfTapRange(size_t off, size_t pad, size_t input_sz, size_t stride, size_t output_sz,
+                                    size_t * start, size_t * after)
+{
+    if (stride == 0)
+    {
+        *start = 0;
+        *after = (off >= pad && off < input_sz + pad) ? output_sz : 0;
+        return;
+    }
+    *start = off >= pad ? 0 : (pad - off + stride - 1) / stride;
+    *after = off >= input_sz + pad ? 0 : MIN(output_sz, (input_sz + pad - off + stride - 1) / stride);
+}
+
+static void convolutionHalfPlanes(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const convolution_half_t * ch = (const convolution_half_t *)arg;
+    const convolution_t * cv = ch->cv;
+    const tensor_desc_t input = cv->input, weight = cv->weights, bias = cv->biases, output = cv->output;
+
+    const size_t input_w = input.dims[0];
+    const size_t input_h = input.dims[1];
+    const size_t input_c = input.dims[2];
+
+    const size_t weight_w = weight.dims[0];
+    const size_t weight_h = weight.dims[1];
+
+    const size_t output_w = output.dims[0];
+    const size_t output_h = output.dims[1];
+    const size_t output_c = output.dims[2];
+
+    float * weights = (float *)malloc(weight_w * weight_h * input_c * sizeof(float));
+    float * acc = (float *)malloc(output_w * sizeof(float));
+    const bool scratch = ch->in && weights && acc;
+
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        const size_t b = item / output_c, ofm = item % output_c;
+        char * out_ptr = cv->out + (b ? output.strides[3] * b : 0) + output.strides[2] * ofm;
+
+        if (!scratch)
+        {
+            for (size_t y = 0; y < output_h; ++y)
+            for (size_t x = 0; x < output_w; ++x)
+            {
+                storeHalfValue(convolutionHalfOutput(cv, b, ofm, x, y), out_ptr + output.strides[1] * y + output.strides[0] * x);
+            }
+            continue;
+        }
+
+        const float * in_b = ch->in + input_w * input_h * input_c * b;
+        loadHalfBlock(cv->weight + weight.strides[3] * ofm, weight, 3, weights);
+
+        for (size_t y = 0; y < output_h; ++y)
+        {
+            if (bias.dim_num == 1)
+            {
+                const float bias_val = loadHalfValue(cv->bias + bias.strides[0] * ofm);
+                for (size_t x = 0; x < output_w; ++x)
+                    acc[x] = bias_val;
+            }
+            else if (bias.dim_num)
+            {
+                loadHalfRow(cv->bias + bias.strides[2] * ofm + bias.strides[1] * y, bias.strides[0], output_w, acc);
+            }
+            else
+            {
+                for (size_t x = 0; x < output_w; ++x)
+                    acc[x] = 0.f;
+            }
+
+            for (size_t ifm = 0; ifm < input_c; ++ifm)
+            for (size_t w_y = 0; w_y < weight_h; ++w_y)
+            {
+                const size_t tmp_y = y * cv->stride_y + w_y * (cv->dilation_y + 1) + cv->dilation_y;
+                if (tmp_y < cv->pad_y || tmp_y >= input_h + cv->pad_y)
+                    continue;
+
+                const float * in_row = in_b + (ifm * input_h + tmp_y - cv->pad_y) * input_w;
+                const float * w_row = weights + (ifm * weight_h + w_y) * weight_w;
+
+                for (size_t w_x = 0; w_x < weight_w; ++w_x)
+                {
+                    const size_t off = w_x * (cv->dilation_x + 1) + cv->dilation_x;
+                    const float w_val = w_row[w_x];
+                    size_t x_start, x_after;
+
+                    convolutionHalfTapRange(off, cv->pad_x, input_w, cv->stride_x, output_w, &x_start, &x_after);
+                    for (size_t x = x_start; x < x_after; ++x)
+                        acc[x] += w_val * in_row[x * cv->stride_x + off - cv->pad_x];
+                }
+            }
+
+            storeHalfRow(acc, output_w, out_ptr + output.strides[1] * y, output.strides[0]);
+        }
+    }
+
+    free(weights);
+    free(acc);
+}
+
+#endif
+
 void ConvolutionKernelImpl(
         enum TensorCFmt fmt,
         const void * input_ptr, tensor_desc_t input,
@@ -197,7 +549,11 @@ void ConvolutionKernelImpl(
         size_t dilation_x, size_t dilation_y,
         void * output_ptr, tensor_desc_t output)
 {
-    assert(fmt == TENSOR_C_FMT_Q78 || fmt == TENSOR_C_FMT_U8 || fmt == TENSOR_C_FMT_S8);
+    assert(fmt == TENSOR_C_FMT_Q78 || fmt == TENSOR_C_FMT_U8 || fmt == TENSOR_C_FMT_S8
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+           || fmt == TENSOR_C_FMT_F16
+#endif
+           );
 
     assert(input.dim_num == 3 || input.dim_num == 4);
     assert(weight.dim_num == 4);
@@ -248,121 +604,78 @@ void ConvolutionKernelImpl(
     assertStridesModSizeof(fmt, bias);
     assertStridesModSizeof(fmt, output);
 
-    // Input and output pointers for the current batch being processed,
-    // Note: The compiler should've been able to hoist this out... And
-    // there's a bunch of other possible hoising iopportunities here.
-    const char * in_b_ptr = input_ptr;
-    char * out_b_ptr = output_ptr;
-
-    for (size_t b = 0; b < output_b; ++b, in_b_ptr += input.strides[3], out_b_ptr += output.strides[3])
-    for (size_t ofm = 0; ofm < output_c; ++ofm)
-    for (size_t y = 0; y < output_h; ++y)
-    for (size_t x = 0; x < output_w; ++x)
+    convolution_t cv;
+    cv.fmt = fmt;
+    cv.in = input_ptr;
+    cv.weight = weight_ptr;
+    cv.bias = bias_ptr;
+    cv.out = output_ptr;
+    cv.input = input;
+    cv.weights = weight;
+    cv.biases = bias;
+    cv.output = output;
+    cv.pad_x = pad_x;
+    cv.pad_y = pad_y;
+    cv.stride_x = stride_x;
+    cv.stride_y = stride_y;
+    cv.dilation_x = dilation_x;
+    cv.dilation_y = dilation_y;
+    cv.wrap = wrap;
+    cv.to_ne = to_ne;
+
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+    if (fmt == TENSOR_C_FMT_F16)
     {
-        int32_t sum = 0;
-        if (bias_present)
-        {
-            const size_t bias_byte_offset =
-                bias_shared
-                ? (bias.strides[0] * ofm)
-                : (bias.strides[2] * ofm + bias.strides[1] * y + bias.strides[0] * x);
-
-            sum = loadValueAsRawInt(fmt, (char *)bias_ptr + bias_byte_offset);
-        }
-        
-        const size_t xx = x * stride_x;
-        const size_t yy = y * stride_y;
+        const size_t input_size = input_w * input_h * input_c;
+        float * in = (float *)malloc(input_size * input_b * sizeof(float));
 
-        for (size_t ifm = 0; ifm < input_c; ++ifm)
+        for (size_t b = 0; in && b < input_b; ++b)
         {
-            for (size_t w_y = 0; w_y < weight_h; ++w_y)
-            for (size_t w_x = 0; w_x < weight_w; ++w_x)
-            {
-                const size_t tmp_x = xx + w_x * (dilation_x + 1) + dilation_x;
-                const size_t tmp_y = yy + w_y * (dilation_y + 1) + dilation_y;
-
-                if (tmp_x >= pad_x && tmp_x < input_w + pad_x &&
-                    tmp_y >= pad_y && tmp_y < input_h + pad_y)
-                {
-                    const size_t input_byte_offset =
-                        input.strides[2] * ifm +
-                        input.strides[1] * (tmp_y - pad_y) +
-                        input.strides[0] * (tmp_x - pad_x);
-                    const size_t weight_byte_offset =
-                        weight.strides[3] * ofm +
-                        weight.strides[2] * ifm +
-                        weight.strides[1] * w_y +
-                        weight.strides[0] * w_x;
-
-                    const int_fast32_t i_val = loadValueAsRawInt(fmt, in_b_ptr + input_byte_offset);
-                    const int_fast32_t w_val = loadValueAsRawInt(fmt, (char *)weight_ptr + weight_byte_offset);
-
-                    // This is ok since all of them fit into int32_t
-                    sum = applyWrapRoundingToAccum(fmt, i_val * w_val, wrap, to_ne) + sum;
-                }
-            }
-            sum = wrapOrSat(fmt, sum, wrap);
+            loadHalfBlock((const char *)input_ptr + (b ? input.strides[3] * b : 0), input, 3, in + input_size * b);
         }
 
-        // The step here could be added to the loops instead of recalcing
-        // if, but does the compiler fail to hoist them out???
-        const size_t output_byte_offset =
-            output.strides[2] * ofm +
-            output.strides[1] * y +
-            output.strides[0] * x;
-        storeRawIntValue(fmt, sum, out_b_ptr + output_byte_offset);
+        convolution_half_t ch;
+        ch.cv = &cv;
+        ch.in = in;
+
+        ParallelForImpl((vx_uint32)(output_b * output_c), 1, convolutionHalfPlanes, &ch);
+        free(in);
+        return;
     }
+#endif
+
+    ParallelForImpl((vx_uint32)(output_b * output_c), 1, convolutionPlanes, &cv);
 }
 
-void FullyConnectedKernelImpl(
-        enum TensorCFmt fmt,
-        const void * input_ptr, tensor_desc_t input,
-        const void * weight_ptr, tensor_desc_t weight,
-        const void * bias_ptr, tensor_desc_t bias,
-        bool wrap,  // true for WRAP, else SATURATE
-        bool to_ne, // true for ROUND_TO_NE, else ROUND_TO_ZERO
-        void * output_ptr, tensor_desc_t output)
+// Fully connected runs groups of (batch, ofm) outputs per item
+#define FULLY_CONNECTED_OFMS_PER_THREAD (16)
+
+typedef struct _fully_connected_t
 {
-    assert (fmt == TENSOR_C_FMT_Q78 || fmt == TENSOR_C_FMT_U8 || fmt == TENSOR_C_FMT_S8);
+    enum TensorCFmt fmt;
+    const char * in;
+    const char * weight;
+    const char * bias;
+    char * out;
+    tensor_desc_t input;
+    tensor_desc_t weights;
+    tensor_desc_t biases;
+    tensor_desc_t output;
+    bool wrap;
+    bool to_ne;
+} fully_connected_t;
+
+static void fullyConnectedOfms(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const fully_connected_t * fc = (const fully_connected_t *)arg;
+    const enum TensorCFmt fmt = fc->fmt;
+    const tensor_desc_t input = fc->input, weight = fc->weights, bias = fc->biases, output = fc->output;
+    const bool wrap = fc->wrap, to_ne = fc->to_ne;
 
     const size_t batch_dim_num = output.dim_num - 1;
-    assert (batch_dim_num >= 0 && batch_dim_num <= 3);
-
     const size_t core_dim_num = input.dim_num - batch_dim_num;
-    assert ((core_dim_num == 1 && weight.dim_num == 2) ||
-            (core_dim_num == 3 && (weight.dim_num == 2 || weight.dim_num == 4)));
-
-    assert (bias.dim_num == !!bias_ptr);
     const bool bias_present = !!bias.dim_num;
 
-    if (core_dim_num == 1)
-    {
-        assert (weight.dims[0] == input.dims[0]);
-    }
-    else if (weight.dim_num == 2)
-    {
-        assert (weight.dims[0] == input.dims[0] * input.dims[1] * input.dims[2]);
-    }
-    else
-    {
-        assert (weight.dims[0] == input.dims[0]);
-        assert (weight.dims[1] == input.dims[1]);
-        assert (weight.dims[2] == input.dims[2]);
-    }
-
-    assert (weight.dims[weight.dim_num - 1] == output.dims[0]);
-    assert (!bias_present || bias.dims[0] == output.dims[0]);
-
-    for (size_t i = 0; i < batch_dim_num; ++i)
-    {
-        assert (output.dims[i + 1] == input.dims[i + core_dim_num]);
-    }
-
-    assertStridesModSizeof(fmt, input);
-    assertStridesModSizeof(fmt, weight);
-    assertStridesModSizeof(fmt, bias);
-    assertStridesModSizeof(fmt, output);
-
     const size_t tmp_batch_dims[3] =
     {
         (batch_dim_num > 0 ? output.dims[1] : 1),
@@ -379,13 +692,15 @@ void FullyConnectedKernelImpl(
 
     const size_t ofm_num = output.dims[0];
 
-    for (size_t b2 = 0; b2 < tmp_batch_dims[2]; ++b2)
-    for (size_t b1 = 0; b1 < tmp_batch_dims[1]; ++b1)
-    for (size_t b0 = 0; b0 < tmp_batch_dims[0]; ++b0)
-    for (size_t ofm = 0; ofm < ofm_num; ++ofm)
+    for (vx_uint32 item = start; item < end; ++item)
     {
+        const size_t ofm = item % ofm_num;
+        const size_t b0 = item / ofm_num % tmp_batch_dims[0];
+        const size_t b1 = item / ofm_num / tmp_batch_dims[0] % tmp_batch_dims[1];
+        const size_t b2 = item / ofm_num / tmp_batch_dims[0] / tmp_batch_dims[1];
+
         int_fast32_t sum =
-            bias_present ? loadValueAsRawInt(fmt, (char *)bias_ptr + bias.strides[0] * ofm) : 0;
+            bias_present ? loadValueAsRawInt(fmt, fc->bias + bias.strides[0] * ofm) : 0;
 
         for (size_t ifm = 0; ifm < tmp_input_dims[2]; ++ifm)
         for (size_t y = 0; y < tmp_input_dims[1]; ++y)
@@ -417,8 +732,8 @@ void FullyConnectedKernelImpl(
                 (core_dim_num == 3 ? input.strides[1] * y : 0) +
                 (core_dim_num == 3 ? input.strides[0] * x : 0);
 
-            const int_fast32_t w_val = loadValueAsRawInt(fmt, (char *)weight_ptr + weight_byte_offset);
-            const int_fast32_t i_val = loadValueAsRawInt(fmt, (char *)input_ptr + input_byte_offset);
+            const int_fast32_t w_val = loadValueAsRawInt(fmt, fc->weight + weight_byte_offset);
+            const int_fast32_t i_val = loadValueAsRawInt(fmt, fc->in + input_byte_offset);
 
             // This is ok since all of them fit into int32_t
             sum = applyWrapRoundingToAccum(fmt, i_val * w_val, wrap, to_ne) + sum;
@@ -432,21 +747,510 @@ void FullyConnectedKernelImpl(
             (batch_dim_num > 0 ? output.strides[1] * b0 : 0) +
             output.strides[0] * ofm;
 
-        storeRawIntValue(fmt, sum, (char *)output_ptr + output_byte_offset);
+        storeRawIntValue(fmt, sum, fc->out + output_byte_offset);
     }
 }
 
-void PoolingKernelImpl(
-        enum TensorCFmt fmt,
-        const void * input_ptr, tensor_desc_t input,
-        bool max_pooling,   // MAX vs AVG pooling
-        size_t size_x, size_t size_y,
-        size_t pad_x, size_t pad_y,
-        size_t stride_x, size_t stride_y,
-        void * output_ptr, tensor_desc_t output)
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+
+// F16 fully connected accumulates in float, in the (ifm, y, x) order of
+// fullyConnectedHalfOutput. The inputs are converted once into dense rows in
+// that order, and each item converts the weights of one ofm and runs them
+// over every batch.
+typedef struct _fully_connected_half_t
 {
-    assert(input.dim_num == 3 || input.dim_num == 4);
-    assert(output.dim_num == input.dim_num);
+    const fully_connected_t * fc;
+    const float * in;   // the inputs as dense rows of core_size, or NULL
+    size_t core_size;
+    size_t batch_count;
+    size_t batch_dims[3];
+} fully_connected_half_t;
+
+static size_t fullyConnectedBatchOffset(tensor_desc_t td, size_t first, size_t batch_dim_num, const size_t b[3])
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < batch_dim_num; ++i)
+        offset += td.strides[first + i] * b[i];
+    return offset;
+}
+
+static float fullyConnectedHalfOutput(const fully_connected_t * fc, size_t ofm, const size_t b[3])
+{
+    const tensor_desc_t input = fc->input, weight = fc->weights, bias = fc->biases, output = fc->output;
+    const size_t batch_dim_num = output.dim_num - 1;
+    const size_t core_dim_num = input.dim_num - batch_dim_num;
+
+    const size_t tmp_input_dims[3] =
+    {
+        (core_dim_num == 3 ? input.dims[0] : 1),
+        (core_dim_num == 3 ? input.dims[1] : 1),
+        input.dims[core_dim_num - 1],
+    };
+
+    const char * in_b_ptr = fc->in + fullyConnectedBatchOffset(input, core_dim_num, batch_dim_num, b);
+    float sum = bias.dim_num ? loadHalfValue(fc->bias + bias.strides[0] * ofm) : 0.f;
+
+    for (size_t ifm = 0; ifm < tmp_input_dims[2]; ++ifm)
+    for (size_t y = 0; y < tmp_input_dims[1]; ++y)
+    for (size_t x = 0; x < tmp_input_dims[0]; ++x)
+    {
+        size_t weight_byte_offset = weight.strides[weight.dim_num-1] * ofm;
+        if (core_dim_num == 1)
+        {
+            weight_byte_offset += weight.strides[0] * ifm;
+        }
+        else if (weight.dim_num == 2)
+        {
+            const size_t count = x + tmp_input_dims[0] * (y + tmp_input_dims[1] * ifm);
+            weight_byte_offset += weight.strides[0] * count;
+        }
+        else
+        {
+            weight_byte_offset +=
+                weight.strides[2] * ifm +
+                weight.strides[1] * y +
+                weight.strides[0] * x;
+        }
+
+        const size_t input_byte_offset =
+            input.strides[core_dim_num - 1] * ifm +
+            (core_dim_num == 3 ? input.strides[1] * y : 0) +
+            (core_dim_num == 3 ? input.strides[0] * x : 0);
+
+        sum += loadHalfValue(fc->weight + weight_byte_offset) * loadHalfValue(in_b_ptr + input_byte_offset);
+    }
+    return sum;
+}
+
+static void fullyConnectedHalfOfms(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const fully_connected_half_t * fh = (const fully_connected_half_t *)arg;
+    const fully_connected_t * fc = fh->fc;
+    const tensor_desc_t weight = fc->weights, bias = fc->biases, output = fc->output;
+    const size_t batch_dim_num = output.dim_num - 1;
+
+    float * weights = (float *)malloc(fh->core_size * sizeof(float));
+    const bool scratch = fh->in && weights;
+
+    for (vx_uint32 ofm = start; ofm < end; ++ofm)
+    {
+        if (scratch)
+        {
+            if (weight.dim_num == 2)
+                loadHalfRow(fc->weight + weight.strides[1] * ofm, weight.strides[0], fh->core_size, weights);
+            else
+                loadHalfBlock(fc->weight + weight.strides[3] * ofm, weight, 3, weights);
+        }
+
+        const float bias_val = bias.dim_num ? loadHalfValue(fc->bias + bias.strides[0] * ofm) : 0.f;
+
+        for (size_t i = 0; i < fh->batch_count; ++i)
+        {
+            const size_t b[3] =
+            {
+                i % fh->batch_dims[0],
+                i / fh->batch_dims[0] % fh->batch_dims[1],
+                i / fh->batch_dims[0] / fh->batch_dims[1],
+            };
+
+            float sum;
+            if (scratch)
+            {
+                const float * in = fh->in + fh->core_size * i;
+
+                sum = bias_val;
+                for (size_t k = 0; k < fh->core_size; ++k)
+                    sum += weights[k] * in[k];
+            }
+            else
+            {
+                sum = fullyConnectedHalfOutput(fc, ofm, b);
+            }
+
+            storeHalfValue(sum, fc->out + fullyConnectedBatchOffset(output, 1, batch_dim_num, b) + output.strides[0] * ofm);
+        }
+    }
+
+    free(weights);
+}
+
+#endif
+
+void FullyConnectedKernelImpl(
+        enum TensorCFmt fmt,
+        const void * input_ptr, tensor_desc_t input,
+        const void * weight_ptr, tensor_desc_t weight,
+        const void * bias_ptr, tensor_desc_t bias,
+        bool wrap,  // true for WRAP, else SATURATE
+        bool to_ne, // true for ROUND_TO_NE, else ROUND_TO_ZERO
+        void * output_ptr, tensor_desc_t output)
+{
+    assert (fmt == TENSOR_C_FMT_Q78 || fmt == TENSOR_C_FMT_U8 || fmt == TENSOR_C_FMT_S8
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+            || fmt == TENSOR_C_FMT_F16
+#endif
+            );
+
+    const size_t batch_dim_num = output.dim_num - 1;
+    assert (batch_dim_num >= 0 && batch_dim_num <= 3);
+
+    const size_t core_dim_num = input.dim_num - batch_dim_num;
+    assert ((core_dim_num == 1 && weight.dim_num == 2) ||
+            (core_dim_num == 3 && (weight.dim_num == 2 || weight.dim_num == 4)));
+
+    assert (bias.dim_num == !!bias_ptr);
+    const bool bias_present = !!bias.dim_num;
+
+    if (core_dim_num == 1)
+    {
+        assert (weight.dims[0] == input.dims[0]);
+    }
+    else if (weight.dim_num == 2)
+    {
+        assert (weight.dims[0] == input.dims[0] * input.dims[1] * input.dims[2]);
+    }
+    else
+    {
+        assert (weight.dims[0] == input.dims[0]);
+        assert (weight.dims[1] == input.dims[1]);
+        assert (weight.dims[2] == input.dims[2]);
+    }
+
+    assert (weight.dims[weight.dim_num - 1] == output.dims[0]);
+    assert (!bias_present || bias.dims[0] == output.dims[0]);
+
+    for (size_t i = 0; i < batch_dim_num; ++i)
+    {
+        assert (output.dims[i + 1] == input.dims[i + core_dim_num]);
+    }
+
+    assertStridesModSizeof(fmt, input);
+    assertStridesModSizeof(fmt, weight);
+    assertStridesModSizeof(fmt, bias);
+    assertStridesModSizeof(fmt, output);
+
+    fully_connected_t fc;
+    fc.fmt = fmt;
+    fc.in = input_ptr;
+    fc.weight = weight_ptr;
+    fc.bias = bias_ptr;
+    fc.out = output_ptr;
+    fc.input = input;
+    fc.weights = weight;
+    fc.biases = bias;
+    fc.output = output;
+    fc.wrap = wrap;
+    fc.to_ne = to_ne;
+
+    size_t batch_count = 1;
+    for (size_t i = 0; i < batch_dim_num; ++i)
+        batch_count *= output.dims[i + 1];
+
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+    if (fmt == TENSOR_C_FMT_F16)
+    {
+        fully_connected_half_t fh;
+        fh.fc = &fc;
+        fh.core_size = 1;
+        for (size_t i = 0; i < core_dim_num; ++i)
+            fh.core_size *= input.dims[i];
+        fh.batch_count = batch_count;
+        for (size_t i = 0; i < 3; ++i)
+            fh.batch_dims[i] = i < batch_dim_num ? output.dims[i + 1] : 1;
+
+        float * in = (float *)malloc(fh.core_size * batch_count * sizeof(float));
+        for (size_t i = 0; in && i < batch_count; ++i)
+        {
+            const size_t b[3] =
+            {
+                i % fh.batch_dims[0],
+                i / fh.batch_dims[0] % fh.batch_dims[1],
+                i / fh.batch_dims[0] / fh.batch_dims[1],
+            };
+            const char * in_b_ptr = (const char *)input_ptr + fullyConnectedBatchOffset(input, core_dim_num, batch_dim_num, b);
+
+            if (core_dim_num == 1)
+                loadHalfRow(in_b_ptr, input.strides[0], fh.core_size, in + fh.core_size * i);
+            else
+                loadHalfBlock(in_b_ptr, input, 3, in + fh.core_size * i);
+        }
+        fh.in = in;
+
+        ParallelForImpl((vx_uint32)output.dims[0], FULLY_CONNECTED_OFMS_PER_THREAD, fullyConnectedHalfOfms, &fh);
+        free(in);
+        return;
+    }
+#endif
+
+    ParallelForImpl((vx_uint32)(batch_count * output.dims[0]), FULLY_CONNECTED_OFMS_PER_THREAD, fullyConnectedOfms, &fc);
+}
+
+// Pooling runs one (batch, channel) plane per item. The input is seen as
+// padded with the identity of the op (the lowest value for MAX, 0 for AVG),
+// which is what clipping each window to the input amounts to. The windows are
+// then separable: MAX slides with the van Herk/Gil-Werman block maxima and AVG
+// with prefix sums, in rows and then in columns, at O(1) per output.
+typedef struct _pooling_t
+{
+    enum TensorCFmt fmt;
+    const char * in;
+    char * out;
+    tensor_desc_t input;
+    tensor_desc_t output;
+    bool max_pooling;
+    size_t size_x, size_y;
+    size_t pad_x, pad_y;
+    size_t stride_x, stride_y;
+    size_t padded_w, padded_h;
+} pooling_t;
+
+static C_KERNEL_INLINE int32_t poolingAverage(enum TensorCFmt fmt, int32_t sum, size_t size_x, size_t size_y)
+{
+    //result = conversion_24_8(result / (int16_t)(size_x * size_y));
+    return CLAMP(sum / (size_x * size_y), getMinValue(fmt), getMaxValue(fmt));
+}
+
+// Maxima over blocks of k lines, from the start of each block (g) and up to
+// its end (h). The window [s, s + k) is then MAX(h[s], g[s + k - 1]).
+// Lines are width values wide and stored one after the other.
+static void poolingBlockMax(const int32_t * src, size_t n, size_t width, size_t k, int32_t * g, int32_t * h)
+{
+    for (size_t i = 0; i < n; ++i)
+    for (size_t x = 0; x < width; ++x)
+    {
+        int32_t v = src[i * width + x];
+        g[i * width + x] = (i % k == 0) ? v : MAX(g[(i - 1) * width + x], v);
+    }
+    for (size_t i = n; i-- > 0; )
+    for (size_t x = 0; x < width; ++x)
+    {
+        int32_t v = src[i * width + x];
+        h[i * width + x] = (i % k == k - 1 || i == n - 1) ? v : MAX(h[(i + 1) * width + x], v);
+    }
+}
+
+// One output computed from its window clipped to the input, as a reduction.
+static int32_t poolingWindow(const pooling_t * p, const char * in_ptr, size_t x, size_t y)
+{
+    const size_t input_w = p->input.dims[0], input_h = p->input.dims[1];
+    int32_t result = p->max_pooling ? getMinValue(p->fmt) : 0;
+
+    const size_t xx_start = CLAMP(x * p->stride_x,             p->pad_x, input_w + p->pad_x) - p->pad_x;
+    const size_t xx_after = CLAMP(x * p->stride_x + p->size_x, p->pad_x, input_w + p->pad_x) - p->pad_x;
+
+    const size_t yy_start = CLAMP(y * p->stride_y,             p->pad_y, input_h + p->pad_y) - p->pad_y;
+    const size_t yy_after = CLAMP(y * p->stride_y + p->size_y, p->pad_y, input_h + p->pad_y) - p->pad_y;
+
+    for (size_t yy = yy_start; yy < yy_after; ++yy)
+    for (size_t xx = xx_start; xx < xx_after; ++xx)
+    {
+        const int32_t i_val = loadValueAsRawInt(p->fmt, in_ptr + p->input.strides[1] * yy + p->input.strides[0] * xx);
+
+        result = p->max_pooling? MAX(result, i_val) : (result + i_val);
+    }
+
+    if (!p->max_pooling)
+    {
+        result = poolingAverage(p->fmt, result, p->size_x, p->size_y);
+    }
+    return result;
+}
+
+static void poolingPlanes(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    pooling_t * p = (pooling_t *)arg;
+    const size_t input_w = p->input.dims[0], input_h = p->input.dims[1];
+    const size_t output_w = p->output.dims[0], output_h = p->output.dims[1];
+    const size_t channels = p->output.dims[2];
+    const size_t lx = p->padded_w, ly = p->padded_h;
+    const int32_t identity = p->max_pooling ? getMinValue(p->fmt) : 0;
+
+    // row: a padded input row and its g/h. cols: the row results of every
+    // padded row and their g/h. sums: prefix sums of a row, then of cols.
+    int32_t * row = (int32_t *)malloc(3 * lx * sizeof(int32_t));
+    int32_t * cols = (int32_t *)malloc(3 * ly * output_w * sizeof(int32_t));
+    int64_t * sums = (int64_t *)malloc((MAX(lx, ly * output_w) + output_w) * sizeof(int64_t));
+    int32_t * out_row = (int32_t *)malloc(output_w * sizeof(int32_t));
+    const bool scratch = row && cols && sums && out_row;
+
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        const size_t b = item / channels, c = item % channels;
+        const char * in_ptr = p->in + p->input.strides[3] * b + p->input.strides[2] * c;
+        char * out_ptr = p->out + p->output.strides[3] * b + p->output.strides[2] * c;
+
+        if (!scratch || (output_w == 1 && output_h == 1))
+        {
+            // a single window (global pooling), or no memory for the sliding one
+            for (size_t y = 0; y < output_h; ++y)
+            for (size_t x = 0; x < output_w; ++x)
+            {
+                int32_t result = poolingWindow(p, in_ptr, x, y);
+                storeRawIntValue(p->fmt, result, out_ptr + p->output.strides[1] * y + p->output.strides[0] * x);
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < lx; ++i)
+            row[i] = identity;
+
+        // Windows along every padded row
+        for (size_t py = 0; py < ly; ++py)
+        {
+            int32_t * h_out = cols + py * output_w;
+
+            if (py < p->pad_y || py >= p->pad_y + input_h)
+            {
+                for (size_t x = 0; x < output_w; ++x)
+                    h_out[x] = identity;
+                continue;
+            }
+            loadRawIntRow(p->fmt, in_ptr + p->input.strides[1] * (py - p->pad_y), p->input.strides[0], input_w, row + p->pad_x);
+
+            if (p->max_pooling)
+            {
+                const int32_t * g = row + lx;
+                const int32_t * h = row + 2 * lx;
+                poolingBlockMax(row, lx, 1, p->size_x, row + lx, row + 2 * lx);
+                for (size_t x = 0; x < output_w; ++x)
+                {
+                    size_t s = x * p->stride_x;
+                    h_out[x] = MAX(h[s], g[s + p->size_x - 1]);
+                }
+            }
+            else
+            {
+                sums[0] = 0;
+                for (size_t i = 0; i < lx; ++i)
+                    sums[i + 1] = sums[i] + row[i];
+                for (size_t x = 0; x < output_w; ++x)
+                    h_out[x] = (int32_t)(sums[x * p->stride_x + p->size_x] - sums[x * p->stride_x]);
+            }
+        }
+
+        // Then along the columns of those
+        if (p->max_pooling)
+        {
+            const int32_t * g = cols + ly * output_w;
+            const int32_t * h = cols + 2 * ly * output_w;
+            poolingBlockMax(cols, ly, output_w, p->size_y, cols + ly * output_w, cols + 2 * ly * output_w);
+            for (size_t y = 0; y < output_h; ++y)
+            {
+                size_t s = y * p->stride_y;
+                for (size_t x = 0; x < output_w; ++x)
+                    out_row[x] = MAX(h[s * output_w + x], g[(s + p->size_y - 1) * output_w + x]);
+                storeRawIntRow(p->fmt, out_row, output_w, out_ptr + p->output.strides[1] * y, p->output.strides[0]);
+            }
+        }
+        else
+        {
+            for (size_t x = 0; x < output_w; ++x)
+                sums[x] = 0;
+            for (size_t py = 0; py < ly; ++py)
+            for (size_t x = 0; x < output_w; ++x)
+                sums[(py + 1) * output_w + x] = sums[py * output_w + x] + cols[py * output_w + x];
+            for (size_t y = 0; y < output_h; ++y)
+            {
+                const int64_t * top = sums + y * p->stride_y * output_w;
+                const int64_t * bottom = sums + (y * p->stride_y + p->size_y) * output_w;
+                for (size_t x = 0; x < output_w; ++x)
+                    out_row[x] = poolingAverage(p->fmt, (int32_t)(bottom[x] - top[x]), p->size_x, p->size_y);
+                storeRawIntRow(p->fmt, out_row, output_w, out_ptr + p->output.strides[1] * y, p->output.strides[0]);
+            }
+        }
+    }
+
+    free(row);
+    free(cols);
+    free(sums);
+    free(out_row);
+}
+
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+
+// F16 pooling reduces the clipped windows in float, over the plane converted
+// once per item (or, with no memory for it, straight from the tensor). AVG
+// divides by the full window size, like the integer formats.
+static float poolingHalfWindow(const pooling_t * p, const float * plane, const char * in_ptr, size_t x, size_t y)
+{
+    const size_t input_w = p->input.dims[0], input_h = p->input.dims[1];
+    float result = p->max_pooling ? -65504.f : 0.f;   // the lowest F16
+
+    const size_t xx_start = CLAMP(x * p->stride_x,             p->pad_x, input_w + p->pad_x) - p->pad_x;
+    const size_t xx_after = CLAMP(x * p->stride_x + p->size_x, p->pad_x, input_w + p->pad_x) - p->pad_x;
+
+    const size_t yy_start = CLAMP(y * p->stride_y,             p->pad_y, input_h + p->pad_y) - p->pad_y;
+    const size_t yy_after = CLAMP(y * p->stride_y + p->size_y, p->pad_y, input_h + p->pad_y) - p->pad_y;
+
+    for (size_t yy = yy_start; yy < yy_after; ++yy)
+    for (size_t xx = xx_start; xx < xx_after; ++xx)
+    {
+        const float i_val = plane
+            ? plane[input_w * yy + xx]
+            : loadHalfValue(in_ptr + p->input.strides[1] * yy + p->input.strides[0] * xx);
+
+        result = p->max_pooling ? MAX(result, i_val) : (result + i_val);
+    }
+
+    if (!p->max_pooling)
+    {
+        result /= (float)(p->size_x * p->size_y);
+    }
+    return result;
+}
+
+static void poolingHalfPlanes(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const pooling_t * p = (const pooling_t *)arg;
+    const size_t output_w = p->output.dims[0], output_h = p->output.dims[1];
+    const size_t channels = p->output.dims[2];
+
+    float * plane = (float *)malloc(p->input.dims[0] * p->input.dims[1] * sizeof(float));
+    float * out_row = (float *)malloc(output_w * sizeof(float));
+
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        const size_t b = item / channels, c = item % channels;
+        const char * in_ptr = p->in + p->input.strides[3] * b + p->input.strides[2] * c;
+        char * out_ptr = p->out + p->output.strides[3] * b + p->output.strides[2] * c;
+
+        if (plane && out_row)
+        {
+            loadHalfBlock(in_ptr, p->input, 2, plane);
+            for (size_t y = 0; y < output_h; ++y)
+            {
+                for (size_t x = 0; x < output_w; ++x)
+                    out_row[x] = poolingHalfWindow(p, plane, in_ptr, x, y);
+                storeHalfRow(out_row, output_w, out_ptr + p->output.strides[1] * y, p->output.strides[0]);
+            }
+        }
+        else
+        {
+            for (size_t y = 0; y < output_h; ++y)
+            for (size_t x = 0; x < output_w; ++x)
+            {
+                storeHalfValue(poolingHalfWindow(p, NULL, in_ptr, x, y), out_ptr + p->output.strides[1] * y + p->output.strides[0] * x);
+            }
+        }
+    }
+
+    free(plane);
+    free(out_row);
+}
+
+#endif
+
+void PoolingKernelImpl(
+        enum TensorCFmt fmt,
+        const void * input_ptr, tensor_desc_t input,
+        bool max_pooling,   // MAX vs AVG pooling
+        size_t size_x, size_t size_y,
+        size_t pad_x, size_t pad_y,
+        size_t stride_x, size_t stride_y,
+        void * output_ptr, tensor_desc_t output)
+{
+    assert(input.dim_num == 3 || input.dim_num == 4);
+    assert(output.dim_num == input.dim_num);
 
     const size_t input_w = input.dims[0];
     const size_t input_h = input.dims[1];
@@ -466,6 +1270,8 @@ void PoolingKernelImpl(
     //TODO: verify this is enforced by the input/output validators
     assert(output_c == input_c);
     assert(output_b == input_b);
+    (void)input_c;
+    (void)input_b;
 
     // Since we calc offsets manually and cast to (int16_t *), we expect the-
     // alignment to be correct already
@@ -474,49 +1280,171 @@ void PoolingKernelImpl(
 
     //TODO: previously there was a 1d/3d stride for ofm but there's no 1D pool, right?
 
-    // Input and output pointers for the current batch being processed,
-    // Note: The compiler should've been able to hoist this out... And
-    // there's a bunch of other possible hoising iopportunities here.
-    const char * in_b_ptr = input_ptr;
-    char * out_b_ptr = output_ptr;
+    pooling_t p;
+    p.fmt = fmt;
+    p.in = input_ptr;
+    p.out = output_ptr;
+    p.input = input;
+    p.output = output;
+    p.max_pooling = max_pooling;
+    p.size_x = size_x;
+    p.size_y = size_y;
+    p.pad_x = pad_x;
+    p.pad_y = pad_y;
+    p.stride_x = stride_x;
+    p.stride_y = stride_y;
+    p.padded_w = MAX(input_w + 2 * pad_x, (output_w - 1) * stride_x + size_x);
+    p.padded_h = MAX(input_h + 2 * pad_y, (output_h - 1) * stride_y + size_y);
+
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+    if (fmt == TENSOR_C_FMT_F16)
+    {
+        ParallelForImpl((vx_uint32)(output_b * output_c), 1, poolingHalfPlanes, &p);
+        return;
+    }
+#endif
 
-    for (size_t b = 0; b < output_b; ++b, in_b_ptr += input.strides[3], out_b_ptr += output.strides[3])
-    for (size_t c = 0; c < output_c; ++c)
-    for (size_t y = 0; y < output_h; ++y)
-    for (size_t x = 0; x < output_w; ++x)
+    ParallelForImpl((vx_uint32)(output_b * output_c), 1, poolingPlanes, &p);
+}
+
+// Softmax runs a group of batch rows per item, each in three passes over
+// the key dim: the max, the sum of exp(x - max) and the normalized output.
+// Inputs are fixed point, so x - max is a whole number of raw units and
+// exp comes from two tables, for its integer and its fractional part, to
+// within a couple of float ulps. Past exp(-255) everything is 0 anyway.
+//
+// Subtracting the max keeps the sum within [1, key_sz]; without it the sum
+// overflows to inf as soon as an input reaches 89.
+#define SOFTMAX_BATCH_DIMS          (5)
+#define SOFTMAX_EXP_TABLE_SIZE      (256)
+#define SOFTMAX_ROWS_PER_THREAD     (16)
+
+typedef struct _softmax_t
+{
+    enum TensorCFmt fmt;
+    const char * in;
+    char * out;
+    size_t key_sz;
+    size_t key_in_stride;
+    size_t key_out_stride;
+    size_t batch_sz[SOFTMAX_BATCH_DIMS];
+    size_t batch_in_strides[SOFTMAX_BATCH_DIMS];
+    size_t batch_out_strides[SOFTMAX_BATCH_DIMS];
+    uint32_t frac_bits;
+    float exp_int[SOFTMAX_EXP_TABLE_SIZE];
+    float exp_frac[SOFTMAX_EXP_TABLE_SIZE];
+} softmax_t;
+
+static C_KERNEL_INLINE float softmaxExp(const softmax_t * sm, uint32_t d)
+{
+    const uint32_t i = d >> sm->frac_bits;
+
+    return i < SOFTMAX_EXP_TABLE_SIZE ?
+        sm->exp_int[i] * sm->exp_frac[d & ((1u << sm->frac_bits) - 1)] : 0.f;
+}
+
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+
+// F16 rows are computed in float with expf, in the same three passes, and
+// in row when there is memory for it.
+static void softmaxHalfRow(const softmax_t * sm, const char * in_ptr, char * out_ptr, float * row)
+{
+    if (row)
     {
-        int32_t result = max_pooling ? getMinValue(fmt) : 0;
+        loadHalfRow(in_ptr, sm->key_in_stride, sm->key_sz, row);
+    }
 
-        const size_t xx_start = CLAMP(x * stride_x,          pad_x, input_w + pad_x) - pad_x;
-        const size_t xx_after = CLAMP(x * stride_x + size_x, pad_x, input_w + pad_x) - pad_x;
+    float max_val = -INFINITY;
+    for (size_t i = 0; i < sm->key_sz; ++i)
+    {
+        max_val = MAX(max_val, row ? row[i] : loadHalfValue(in_ptr + sm->key_in_stride * i));
+    }
 
-        const size_t yy_start = CLAMP(y * stride_y,          pad_y, input_h + pad_y) - pad_y;
-        const size_t yy_after = CLAMP(y * stride_y + size_y, pad_y, input_h + pad_y) - pad_y;
+    float sum = 0.f;
+    for (size_t i = 0; i < sm->key_sz; ++i)
+    {
+        const float e = expf((row ? row[i] : loadHalfValue(in_ptr + sm->key_in_stride * i)) - max_val);
+
+        if (row)
+            row[i] = e;
+        sum += e;
+    }
+
+    const float scale = 1.f / sum;
+    if (row)
+    {
+        for (size_t i = 0; i < sm->key_sz; ++i)
+            row[i] *= scale;
+        storeHalfRow(row, sm->key_sz, out_ptr, sm->key_out_stride);
+        return;
+    }
+    for (size_t i = 0; i < sm->key_sz; ++i)
+    {
+        const float e = expf(loadHalfValue(in_ptr + sm->key_in_stride * i) - max_val);
+
+        storeHalfValue(e * scale, out_ptr + sm->key_out_stride * i);
+    }
+}
+
+#endif
+
+static void softmaxRows(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const softmax_t * sm = (const softmax_t *)arg;
+    const enum TensorCFmt fmt = sm->fmt;
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+    float * row = fmt == TENSOR_C_FMT_F16 ? (float *)malloc(sm->key_sz * sizeof(float)) : NULL;
+#endif
 
-        for (size_t yy = yy_start; yy < yy_after; ++yy)
-        for (size_t xx = xx_start; xx < xx_after; ++xx)
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        const char * in_b_ptr = sm->in;
+        char * out_b_ptr = sm->out;
+
+        size_t rest = item;
+        for (size_t i = 0; i < SOFTMAX_BATCH_DIMS; ++i)
         {
-            const size_t input_byte_offset =
-                input.strides[2] * c +
-                input.strides[1] * yy +
-                input.strides[0] * xx;
-            const int32_t i_val = loadValueAsRawInt(fmt, in_b_ptr + input_byte_offset);
+            const size_t b = rest % sm->batch_sz[i];
+            rest /= sm->batch_sz[i];
 
-            result = max_pooling? MAX(result, i_val) : (result + i_val);
+            in_b_ptr += sm->batch_in_strides[i] * b;
+            out_b_ptr += sm->batch_out_strides[i] * b;
         }
 
-        if (!max_pooling)
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+        if (fmt == TENSOR_C_FMT_F16)
         {
-            //result = conversion_24_8(result / (int16_t)(size_x * size_y));
-            result = CLAMP(result / (size_x * size_y), getMinValue(fmt), getMaxValue(fmt));
+            softmaxHalfRow(sm, in_b_ptr, out_b_ptr, row);
+            continue;
         }
+#endif
 
-        const size_t output_byte_offset =
-            output.strides[2] * c +
-            output.strides[1] * y +
-            output.strides[0] * x;
-        storeRawIntValue(fmt, result, out_b_ptr + output_byte_offset);
+        int_fast32_t max_val = getMinValue(fmt);
+        for (size_t i = 0; i < sm->key_sz; ++i)
+        {
+            max_val = MAX(max_val, loadValueAsRawInt(fmt, in_b_ptr + sm->key_in_stride * i));
+        }
+
+        float sum = 0.f;
+        for (size_t i = 0; i < sm->key_sz; ++i)
+        {
+            const int_fast32_t in = loadValueAsRawInt(fmt, in_b_ptr + sm->key_in_stride * i);
+
+            sum += softmaxExp(sm, (uint32_t)(max_val - in));
+        }
+
+        const float scale = 1.f / sum;
+        for (size_t i = 0; i < sm->key_sz; ++i)
+        {
+            const int_fast32_t in = loadValueAsRawInt(fmt, in_b_ptr + sm->key_in_stride * i);
+
+            storeRawIntValue(fmt, quantize(fmt, softmaxExp(sm, (uint32_t)(max_val - in)) * scale), out_b_ptr + sm->key_out_stride * i);
+        }
     }
+
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+    free(row);
+#endif
 }
 
 void SoftmaxKernelImpl(
@@ -546,15 +1474,9 @@ void SoftmaxKernelImpl(
     size_t key_sz = 0;
     size_t key_in_stride = 0;
 
-#ifdef SOFTMAX_ALLOW_EXTRA_DIMS
-    size_t batch_sz[5] = { 1, 1, 1, 1, 1 };
-    size_t batch_in_strides[5] = { 0 };
-    size_t batch_out_strides[5] = { 0 };
-#else
-    size_t batch_sz[3] = { 1, 1, 1 };
-    size_t batch_in_strides[3] = { 0 };
-    size_t batch_out_strides[3] = { 0 };
-#endif
+    size_t batch_sz[SOFTMAX_BATCH_DIMS] = { 1, 1, 1, 1, 1 };
+    size_t batch_in_strides[SOFTMAX_BATCH_DIMS] = { 0 };
+    size_t batch_out_strides[SOFTMAX_BATCH_DIMS] = { 0 };
 
 #if 1
     {
@@ -618,122 +1540,133 @@ void SoftmaxKernelImpl(
     }
 #endif
 
-// The main loop calculation can be done with a double accumulator, float with
-// value normalization (exp(val-max_val)) to avoid getting to inf or plain -
-// float. Leaving all 3 here for result comparision, since the spec has nothing
-// about required accumulator width.
-//
-// Note: For U8, S8 all 3 will result in the same results. But for Q78, because
-//       summing exp(127) is quite large for a single precision float, using it
-//       may already result in inf within the summation causing all values to
-//       0 after softmax! And obviously for F32, the change of getting there is
-//       even higher.
-//
-// Set to 0 for float, 1 for double, 2 for float with norm.
-#define SOFTMAX_ACCUM_TYPE 0
-
-#ifdef SOFTMAX_ALLOW_EXTRA_DIMS
-    for (size_t b4 = 0; b4 < batch_sz[4]; ++b4)
-    for (size_t b3 = 0; b3 < batch_sz[3]; ++b3)
-#endif
-    for (size_t b2 = 0; b2 < batch_sz[2]; ++b2)
-    for (size_t b1 = 0; b1 < batch_sz[1]; ++b1)
-    for (size_t b0 = 0; b0 < batch_sz[0]; ++b0)
-    {
-        // Input and output pointers for the current batch being processed.
-        const char * in_b_ptr = (char*)input_ptr +
-            batch_in_strides[2] * b2 +
-            batch_in_strides[1] * b1 +
-            batch_in_strides[0] * b0;
-        char * out_b_ptr = (char*)output_ptr +
-            batch_out_strides[2] * b2 +
-            batch_out_strides[1] * b1 +
-            batch_out_strides[0] * b0;
+    softmax_t sm;
+    sm.fmt = fmt;
+    sm.in = input_ptr;
+    sm.out = output_ptr;
+    sm.key_sz = key_sz;
+    sm.key_in_stride = key_in_stride;
+    sm.key_out_stride = output.strides[input.dim_num > 2 ? 2 : 0];
+    memcpy(sm.batch_sz, batch_sz, sizeof(batch_sz));
+    memcpy(sm.batch_in_strides, batch_in_strides, sizeof(batch_in_strides));
+    memcpy(sm.batch_out_strides, batch_out_strides, sizeof(batch_out_strides));
+
+    // exp(-d) for the distance d below the max in raw units, split in its
+    // integer and Q78 fractional parts (U8 and S8 have no fractional part)
+    sm.frac_bits = fmt == TENSOR_C_FMT_Q78 ? Q78_FIXED_POINT_POSITION : 0;
+    for (size_t i = 0; i < SOFTMAX_EXP_TABLE_SIZE; ++i)
+    {
+        sm.exp_int[i] = expf(-(float)i);
+        sm.exp_frac[i] = expf(-(float)i / (1 << sm.frac_bits));
+    }
 
-#ifdef SOFTMAX_ALLOW_EXTRA_DIMS
-            in_b_ptr += batch_in_strides[4] * b4 + batch_in_strides[3] * b3;
-            out_b_ptr += batch_out_strides[4] * b4 + batch_out_strides[3] * b3;
-#endif
+    size_t batch_count = 1;
+    for (size_t i = 0; i < SOFTMAX_BATCH_DIMS; ++i)
+        batch_count *= batch_sz[i];
 
-#if SOFTMAX_ACCUM_TYPE == 0
-        float sum = 0.f;
+    ParallelForImpl((vx_uint32)batch_count, SOFTMAX_ROWS_PER_THREAD, softmaxRows, &sm);
+}
 
-        for (size_t i = 0; i < key_sz; ++i)
-        {
-            const int_fast32_t in = loadValueAsRawInt(fmt, in_b_ptr + key_in_stride * i);
-            float in_val = unquantize(fmt, in);
 
-            sum += expf(in_val);
-        }
 
-        for (size_t i = 0; i < key_sz; ++i)
-        {
-            const int_fast32_t in = loadValueAsRawInt(fmt, in_b_ptr + key_in_stride * i);
-            float in_val = unquantize(fmt, in);
+/****************************************************************************
+ *                                                                          *
+ *                          SampleROIPoolingKernel                          *
+ *                                                                          *
+ ***************************************************************************/
 
-            storeRawIntValue(fmt, quantize(fmt, expf(in_val) / sum), out_b_ptr + key_in_stride * i);
-        }
-#elif SOFTMAX_ACCUM_TYPE == 1
-        double sum = 0.;
+// ROI pooling runs one (batch, roi, channel) output plane per item.
+typedef struct _roi_pooling_t
+{
+    enum TensorCFmt fmt;
+    const char * data;
+    const char * rois;
+    char * out;
+    tensor_desc_t in0;
+    tensor_desc_t in1;
+    tensor_desc_t output;
+} roi_pooling_t;
+
+static void roiPoolingPlanes(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const roi_pooling_t * p = (const roi_pooling_t *)arg;
+    const enum TensorCFmt fmt = p->fmt;
+    const tensor_desc_t in0 = p->in0;
+    const tensor_desc_t in1 = p->in1;
+    const tensor_desc_t out = p->output;
 
-        for (size_t i = 0; i < key_sz; ++i)
-        {
-            const int16_t * in_ptr = (int16_t *)(in_b_ptr + key_in_stride * i);
-            float in_val = UNQUANTIZE(*in_ptr);
+    const size_t data_w = in0.dims[0];
+    const size_t data_h = in0.dims[1];
 
-            sum += exp(in_val);
-        }
+    const size_t out_w = out.dims[0];
+    const size_t out_h = out.dims[1];
+    const size_t out_c = out.dims[2];
+    const size_t out_r = out.dims[3];
 
-        for (size_t i = 0; i < key_sz; ++i)
-        {
-            const int16_t * in_ptr = (int16_t *)(in_b_ptr + key_in_stride * i);
-            float in_val = UNQUANTIZE(*in_ptr);
+    //TODO: add comment about templating over the format outside of the loops
 
-            int16_t * out_ptr = (int16_t *)(out_b_ptr + key_in_stride * i);
-            *out_ptr = QUANTIZE(exp(in_val) / sum);
-        }
-#elif SOFTMAX_ACCUM_TYPE == 2
-        float max_val = -FLT_MAX;
-        float sum = 0.f;
+    const int lowest_val = getMinValue(fmt);
 
-        for (size_t i = 0; i < key_sz; ++i)
-        {
-            const int16_t * in_ptr = (int16_t *)(in_b_ptr + key_in_stride * i);
-            float in_val = UNQUANTIZE(*in_ptr);
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        const size_t c = item % out_c;
+        const size_t r = (item / out_c) % out_r;
+        const size_t b = item / out_c / out_r;
 
-            max_val = MAX(max_val, in_val);
-        }
-        
-        // Note: It may be benificial to cache the exponents
-        for (size_t i = 0; i < key_sz; ++i)
-        {
-            const int16_t * in_ptr = (int16_t *)(in_b_ptr + key_in_stride * i);
-            float in_val = UNQUANTIZE(*in_ptr);
+        const char * roi_b_ptr = p->rois + in1.strides[1] * r + in1.strides[2] * b;
 
-            sum += expf(in_val - max_val);
-        }
+        const int roi_x0 = loadValueAsRawInt(fmt, roi_b_ptr + in1.strides[0] * 0);
+        const int roi_y0 = loadValueAsRawInt(fmt, roi_b_ptr + in1.strides[0] * 1);
+        const int roi_x1 = loadValueAsRawInt(fmt, roi_b_ptr + in1.strides[0] * 2);
+        const int roi_y1 = loadValueAsRawInt(fmt, roi_b_ptr + in1.strides[0] * 3);
 
-        for (size_t i = 0; i < key_sz; ++i)
-        {
-            const int16_t * in_ptr = (int16_t *)(in_b_ptr + key_in_stride * i);
-            float in_val = UNQUANTIZE(*in_ptr);
+        // The final coordinate is within the ROI => +1
+        // And we treat malformed dimensions as 1
+        const int roi_w = MAX(roi_x1 - roi_x0, 0) + 1;
+        const int roi_h = MAX(roi_y1 - roi_y0, 0) + 1;
 
-            int16_t * out_ptr = (int16_t *)(out_b_ptr + key_in_stride * i);
-            *out_ptr = QUANTIZE(expf(in_val - max_val) / sum);
-        }
-#else
-#error SOFTMAX_ACCUM_TYPE must be 0..2
-#endif
-    }
-}
+        const char * data_b_ptr = p->data + in0.strides[3] * b + in0.strides[2] * c;
+        char * out_c_ptr = p->out + out.strides[4] * b + out.strides[3] * r + out.strides[2] * c;
 
+        for (size_t y = 0; y < out_h; ++y)
+        for (size_t x = 0; x < out_w; ++x)
+        {
+            // Note that "after" is rounded up else we get the last cell,
+            // instead of the cell beyond.
+            //
+            // For ex. with src being a 6 cell row and dst being a 4 cell one:
+            // >>> [((x + 0) * 6) // 4 for x in range(4)]   # "begin" values
+            // [0, 1, 3, 4]                                 # as expected
+            // >>> [((x + 1) * 6) // 4 for x in range(4)]   # "after" values
+            // [1, 3, 4, 6]                                 # [2, 3, 5, 6] expected!
+            const int dx_begin = ((x + 0) * roi_w) / out_w;
+            const int dy_begin = ((y + 0) * roi_h) / out_h;
+            const int dx_after = ((x + 1) * roi_w + (out_w - 1)) / out_w;
+            const int dy_after = ((y + 1) * roi_h + (out_h - 1)) / out_h;
+
+            // clamp in case roi_x or roi_y were unreasonable
+            const int x_begin = CLAMP(roi_x0 + dx_begin, 0, data_w);
+            const int y_begin = CLAMP(roi_y0 + dy_begin, 0, data_h);
+            const int x_after = CLAMP(roi_x0 + dx_after, 0, data_w);
+            const int y_after = CLAMP(roi_y0 + dy_after, 0, data_h);
+
+            // If there's no values for the current roi, we default to 0
+            const bool non_empty = (x_begin < x_after && y_begin < y_after);
+            int res = non_empty ? lowest_val : 0;
+
+            for (int yy = y_begin; yy < y_after; ++yy)
+            for (int xx = x_begin; xx < x_after; ++xx)
+            {
+                const void * val_ptr = data_b_ptr + in0.strides[1] * yy + in0.strides[0] * xx;
+                int val = loadValueAsRawInt(fmt, val_ptr);
 
+                res = MAX(res, val);
+            }
 
-/****************************************************************************
- *                                                                          *
- *                          SampleROIPoolingKernel                          *
- *                                                                          *
- ***************************************************************************/
+            storeRawIntValue(fmt, res, out_c_ptr + out.strides[1] * y + out.strides[0] * x);
+        }
+    }
+}
 
 void ROIPoolingKernelImpl(
         enum TensorCFmt fmt,
@@ -745,8 +1678,6 @@ void ROIPoolingKernelImpl(
             (in0.dim_num == 4 && in1.dim_num == 3 && out.dim_num == 5));
 
     // format: [batch][channels][height][width]
-    const size_t data_w = in0.dims[0];
-    const size_t data_h = in0.dims[1];
     const size_t data_c = in0.dims[2];
     const size_t data_b = in0.dim_num == 4 ? in0.dims[3]: 1;
 
@@ -756,8 +1687,6 @@ void ROIPoolingKernelImpl(
     const size_t rois_b = in1.dim_num == 3 ? in1.dims[2] : 1;
 
     // format: [batch][roi_count][channels][height][width]
-    const size_t out_w = out.dims[0];
-    const size_t out_h = out.dims[1];
     const size_t out_c = out.dims[2];
     const size_t out_r = out.dims[3];
     const size_t out_b = out.dim_num == 5 ? out.dims[4] : 1;
@@ -768,76 +1697,227 @@ void ROIPoolingKernelImpl(
     assert(rois_r == out_r);
 
     //TODO: missing assert on strides % base type size
-    //TODO: add comment about templating over the format outside of the loops
 
-    const int lowest_val = getMinValue(fmt);
+    roi_pooling_t p;
+    p.fmt = fmt;
+    p.data = in0_ptr;
+    p.rois = in1_ptr;
+    p.out = out_ptr;
+    p.in0 = in0;
+    p.in1 = in1;
+    p.output = out;
+
+    ParallelForImpl((vx_uint32)(out_b * out_r * out_c), 1, roiPoolingPlanes, &p);
+}
+
+
+/****************************************************************************
+ *                                                                          *
+ *                          SampleDeconvolutionKernel                       *
+ *                                                                          *
+ ***************************************************************************/
 
-    for (size_t b = 0; b < out_b; ++b)
-    for (size_t r = 0; r < out_r; ++r)
-    for (size_t c = 0; c < out_c; ++c)
-    for (size_t y = 0; y < out_h; ++y)
-    for (size_t x = 0; x < out_w; ++x)
+// Deconvolution runs one (batch, ofm) output plane per item, row by row.
+// Output x only sees the taps w_x for which x + w_x - start_x_pad lands on
+// an input sample, so rather than testing every tap against every output,
+// each (ifm, w_y, w_x) scatters an input row into the output positions it
+// feeds (col2im of the weights^T x input products, or a sub-pixel
+// convolution per output phase). Every product is rounded and overflowed
+// on its own and the sum is overflowed after each ifm, so the products
+// can't be reduced over ifm first: the ifm sum stays in the outer loop and
+// each ifm gets its own row of partial sums.
+typedef struct _deconvolution_t
+{
+    enum TensorCFmt fmt;
+    const char * in;
+    const char * weight;
+    const char * bias;
+    char * out;
+    tensor_desc_t input;
+    tensor_desc_t weights;
+    tensor_desc_t biases;
+    tensor_desc_t output;
+    size_t upscale_x, upscale_y;
+    size_t start_x_pad, start_y_pad;
+    bool wrap;
+    bool to_ne;
+} deconvolution_t;
+
+// dst[i * step] += the rounded and overflowed src[i] * w, for i < n
+static void deconvolutionScatterRow(
+        enum TensorCFmt fmt, bool wrap, bool to_ne,
+        const int32_t * src, size_t n, int32_t w,
+        int32_t * dst, size_t step)
+{
+    switch(fmt)
     {
-        const char * roi_b_ptr = (char*)in1_ptr + in1.strides[1] * r + in1.strides[2] * b;
+        case TENSOR_C_FMT_Q78:
+            for (size_t i = 0; i < n; ++i)
+                dst[i * step] += applyWrapRoundingToAccum(TENSOR_C_FMT_Q78, src[i] * w, wrap, to_ne);
+            break;
+        case TENSOR_C_FMT_U8:
+            for (size_t i = 0; i < n; ++i)
+                dst[i * step] += applyWrapRoundingToAccum(TENSOR_C_FMT_U8, src[i] * w, wrap, to_ne);
+            break;
+        case TENSOR_C_FMT_S8:
+            for (size_t i = 0; i < n; ++i)
+                dst[i * step] += applyWrapRoundingToAccum(TENSOR_C_FMT_S8, src[i] * w, wrap, to_ne);
+            break;
+        default: assert(0);
+    }
+}
 
-        const int roi_x0 = loadValueAsRawInt(fmt, roi_b_ptr + in1.strides[0] * 0);
-        const int roi_y0 = loadValueAsRawInt(fmt, roi_b_ptr + in1.strides[0] * 1);
-        const int roi_x1 = loadValueAsRawInt(fmt, roi_b_ptr + in1.strides[0] * 2);
-        const int roi_y1 = loadValueAsRawInt(fmt, roi_b_ptr + in1.strides[0] * 3);
+// The sum of one output, tap by tap. Only used when the rows can't be allocated.
+static int32_t deconvolutionOutput(const deconvolution_t * d, size_t b, size_t ofm, size_t x, size_t y)
+{
+    const tensor_desc_t input = d->input, weight = d->weights, bias = d->biases;
+    const size_t input_w = input.dims[0], input_h = input.dims[1], input_c = input.dims[2];
+    const size_t weight_w = weight.dims[0], weight_h = weight.dims[1];
 
-        // The final coordinate is within the ROI => +1
-        // And we treat malformed dimensions as 1
-        const int roi_w = MAX(roi_x1 - roi_x0, 0) + 1;
-        const int roi_h = MAX(roi_y1 - roi_y0, 0) + 1;
+    int32_t sum = 0;
+    if (bias.dim_num)
+    {
+        const size_t bias_byte_offset =
+            bias.dim_num == 1
+            ? (bias.strides[0] * ofm)
+            : (bias.strides[2] * ofm + bias.strides[1] * y + bias.strides[0] * x);
+
+        sum = loadValueAsRawInt(d->fmt, d->bias + bias_byte_offset);
+    }
 
-        // Note that "after" is rounded up else we get the last cell,
-        // instead of the cell beyond.
-        //
-        // For ex. with src being a 6 cell row and dst being a 4 cell one:
-        // >>> [((x + 0) * 6) // 4 for x in range(4)]   # "begin" values
-        // [0, 1, 3, 4]                                 # as expected
-        // >>> [((x + 1) * 6) // 4 for x in range(4)]   # "after" values
-        // [1, 3, 4, 6]                                 # [2, 3, 5, 6] expected!
-        const int dx_begin = ((x + 0) * roi_w) / out_w;
-        const int dy_begin = ((y + 0) * roi_h) / out_h;
-        const int dx_after = ((x + 1) * roi_w + (out_w - 1)) / out_w;
-        const int dy_after = ((y + 1) * roi_h + (out_h - 1)) / out_h;
-
-        // clamp in case roi_x or roi_y were unreasonable
-        const int x_begin = CLAMP(roi_x0 + dx_begin, 0, data_w);
-        const int y_begin = CLAMP(roi_y0 + dy_begin, 0, data_h);
-        const int x_after = CLAMP(roi_x0 + dx_after, 0, data_w);
-        const int y_after = CLAMP(roi_y0 + dy_after, 0, data_h);
-
-        const char * data_b_ptr = (char*)in0_ptr + in0.strides[3] * b + in0.strides[2] * c;
-
-        // If there's no values for the current roi, we default to 0
-        const bool non_empty = (x_begin < x_after && y_begin < y_after);
-        int res = non_empty ? lowest_val : 0;
-
-        for (int yy = y_begin; yy < y_after; ++yy)
-        for (int xx = x_begin; xx < x_after; ++xx)
+    for (size_t ifm = 0; ifm < input_c; ++ifm)
+    {
+        for (size_t w_y = 0; w_y < weight_h; ++w_y)
+        for (size_t w_x = 0; w_x < weight_w; ++w_x)
         {
-            const void * val_ptr = data_b_ptr + in0.strides[1] * yy + in0.strides[0] * xx;
-            int val = loadValueAsRawInt(fmt, val_ptr);
+            if (x + w_x >= d->start_x_pad && x + w_x < input_w + d->start_x_pad &&
+                y + w_y >= d->start_y_pad && y + w_y < input_h + d->start_y_pad)
+            {
+                const size_t xx = x + w_x - d->start_x_pad;
+                const size_t yy = y + w_y - d->start_y_pad;
 
-            res = MAX(res, val);
-        }
+                if (xx % d->upscale_x == 0 && yy % d->upscale_y == 0)
+                {
+                    const size_t input_byte_offset =
+                        (b ? input.strides[3] * b : 0) +
+                        input.strides[2] * ifm +
+                        input.strides[1] * (yy / d->upscale_y) +
+                        input.strides[0] * (xx / d->upscale_x);
+                    const size_t weight_byte_offset =
+                        weight.strides[3] * ofm +
+                        weight.strides[2] * ifm +
+                        weight.strides[1] * w_y +
+                        weight.strides[0] * w_x;
 
-        const size_t output_byte_offset =
-            out.strides[4] * b +
-            out.strides[3] * r + out.strides[2] * c +
-            out.strides[1] * y + out.strides[0] * x;
-        storeRawIntValue(fmt, res, (char*)out_ptr + output_byte_offset);
+                    const int_fast32_t i_val = loadValueAsRawInt(d->fmt, d->in + input_byte_offset);
+                    const int_fast32_t w_val = loadValueAsRawInt(d->fmt, d->weight + weight_byte_offset);
+
+                    // This is ok since all of them fit into int32_t
+                    sum = applyWrapRoundingToAccum(d->fmt, i_val * w_val, d->wrap, d->to_ne) + sum;
+                }
+            }
+        }
+        sum = wrapOrSat(d->fmt, sum, d->wrap);
     }
+    return sum;
 }
 
+static void deconvolutionPlanes(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const deconvolution_t * d = (const deconvolution_t *)arg;
+    const enum TensorCFmt fmt = d->fmt;
+    const tensor_desc_t input = d->input, weight = d->weights, bias = d->biases, output = d->output;
 
-/****************************************************************************
- *                                                                          *
- *                          SampleDeconvolutionKernel                       *
- *                                                                          *
- ***************************************************************************/
+    const size_t input_w = input.dims[0], input_h = input.dims[1], input_c = input.dims[2];
+    const size_t weight_w = weight.dims[0], weight_h = weight.dims[1];
+    const size_t output_w = output.dims[0], output_h = output.dims[1], output_c = output.dims[2];
+    const size_t ux = d->upscale_x, uy = d->upscale_y;
+
+    // As in the tap test, an upscaled sample position has to be below
+    // input_w (rather than (input_w - 1) * ux + 1), so only the first
+    // samples_x input columns, and rows yy / uy with yy < input_h, are read
+    const size_t samples_x = (input_w + ux - 1) / ux;
+
+    int32_t * acc = (int32_t *)malloc(output_w * sizeof(int32_t));
+    int32_t * part = (int32_t *)malloc(output_w * sizeof(int32_t));
+    int32_t * row = (int32_t *)malloc(input_w * sizeof(int32_t));
+
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        const size_t b = item / output_c, ofm = item % output_c;
+        const char * in_b_ptr = d->in + (b ? input.strides[3] * b : 0);
+        char * out_ptr = d->out + (b ? output.strides[3] * b : 0) + output.strides[2] * ofm;
+
+        if (!acc || !part || !row)
+        {
+            for (size_t y = 0; y < output_h; ++y)
+            for (size_t x = 0; x < output_w; ++x)
+                storeRawIntValue(fmt, deconvolutionOutput(d, b, ofm, x, y), out_ptr + output.strides[1] * y + output.strides[0] * x);
+            continue;
+        }
+
+        for (size_t y = 0; y < output_h; ++y)
+        {
+            if (!bias.dim_num)
+            {
+                memset(acc, 0, output_w * sizeof(int32_t));
+            }
+            else if (bias.dim_num == 1)
+            {
+                const int32_t bias_val = loadValueAsRawInt(fmt, d->bias + bias.strides[0] * ofm);
+                for (size_t x = 0; x < output_w; ++x)
+                    acc[x] = bias_val;
+            }
+            else
+            {
+                loadRawIntRow(fmt, d->bias + bias.strides[2] * ofm + bias.strides[1] * y, bias.strides[0], output_w, acc);
+            }
+
+            for (size_t ifm = 0; ifm < input_c; ++ifm)
+            {
+                memset(part, 0, output_w * sizeof(int32_t));
+
+                for (size_t w_y = 0; w_y < weight_h; ++w_y)
+                {
+                    if (y + w_y < d->start_y_pad || y + w_y >= input_h + d->start_y_pad)
+                        continue;
+
+                    const size_t yy = y + w_y - d->start_y_pad;
+                    if (yy % uy)
+                        continue;
+
+                    loadRawIntRow(fmt, in_b_ptr + input.strides[2] * ifm + input.strides[1] * (yy / uy),
+                                  input.strides[0], samples_x, row);
+
+                    const char * w_ptr = d->weight + weight.strides[3] * ofm + weight.strides[2] * ifm + weight.strides[1] * w_y;
+
+                    for (size_t w_x = 0; w_x < weight_w; ++w_x)
+                    {
+                        // Sample ix feeds x = ix * ux + start_x_pad - w_x, for 0 <= x < output_w
+                        const size_t first = w_x > d->start_x_pad ? (w_x - d->start_x_pad + ux - 1) / ux : 0;
+                        const size_t x0 = first * ux + d->start_x_pad - w_x;
+                        if (first >= samples_x || x0 >= output_w)
+                            continue;
+
+                        const size_t n = MIN(samples_x - first, (output_w - x0 + ux - 1) / ux);
+                        const int32_t w_val = loadValueAsRawInt(fmt, w_ptr + weight.strides[0] * w_x);
+
+                        deconvolutionScatterRow(fmt, d->wrap, d->to_ne, row + first, n, w_val, part + x0, ux);
+                    }
+                }
+
+                for (size_t x = 0; x < output_w; ++x)
+                    acc[x] = wrapOrSat(fmt, acc[x] + part[x], d->wrap);
+            }
+
+            storeRawIntRow(fmt, acc, output_w, out_ptr + output.strides[1] * y, output.strides[0]);
+        }
+    }
+
+    free(acc);
+    free(part);
+    free(row);
+}
 
 void DeconvolutionKernelImpl(
         enum TensorCFmt fmt,
@@ -920,72 +2000,24 @@ void DeconvolutionKernelImpl(
     assertStridesModSizeof(fmt, bias);
     assertStridesModSizeof(fmt, output);
 
-    // Input and output pointers for the current batch being processed,
-    // Note: The compiler should've been able to hoist this out... And
-    // there's a bunch of other possible hoising iopportunities here.
-    const char * in_b_ptr = input_ptr;
-    char * out_b_ptr = output_ptr;
-
-    for (size_t b = 0; b < output_b; ++b)
-    for (size_t ofm = 0; ofm < output_c; ++ofm)
-    for (size_t y = 0; y < output_h; ++y)
-    for (size_t x = 0; x < output_w; ++x)
-    {
-        int32_t sum = 0;
-        if (bias_present)
-        {
-            const size_t bias_byte_offset =
-                bias_shared
-                ? (bias.strides[0] * ofm)
-                : (bias.strides[2] * ofm + bias.strides[1] * y + bias.strides[0] * x);
-
-            sum = loadValueAsRawInt(fmt, (char *)bias_ptr + bias_byte_offset);
-        }
-        
-        for (size_t ifm = 0; ifm < input_c; ++ifm)
-        {
-            for (size_t w_y = 0; w_y < weight_h; ++w_y)
-            for (size_t w_x = 0; w_x < weight_w; ++w_x)
-            {
-                if (x + w_x >= start_x_pad && x + w_x < input_w + start_x_pad &&
-                    y + w_y >= start_y_pad && y + w_y < input_h + start_y_pad)
-                {
-                    const size_t xx = x + w_x - start_x_pad;
-                    const size_t yy = y + w_y - start_y_pad;
-
-                    if (xx % upscale_x == 0 && yy % upscale_y == 0)
-                    {
-                        const size_t input_byte_offset =
-                            (b ? input.strides[3] * b : 0) +
-                            input.strides[2] * ifm +
-                            input.strides[1] * (yy / upscale_y) +
-                            input.strides[0] * (xx / upscale_x);
-                        const size_t weight_byte_offset =
-                            weight.strides[3] * ofm +
-                            weight.strides[2] * ifm +
-                            weight.strides[1] * w_y +
-                            weight.strides[0] * w_x;
-
-                        const int_fast32_t i_val = loadValueAsRawInt(fmt, in_b_ptr + input_byte_offset);
-                        const int_fast32_t w_val = loadValueAsRawInt(fmt, (char *)weight_ptr + weight_byte_offset);
-
-                        // This is ok since all of them fit into int32_t
-                        sum = applyWrapRoundingToAccum(fmt, i_val * w_val, wrap, to_ne) + sum;
-                    }
-                }
-            }
-            sum = wrapOrSat(fmt, sum, wrap);
-        }
-
-        // The step here could be added to the loops instead of recalcing
-        // if, but does the compiler fail to hoist them out???
-        const size_t output_byte_offset =
-            (b ? output.strides[3] * b : 0) +
-            output.strides[2] * ofm +
-            output.strides[1] * y +
-            output.strides[0] * x;
-        storeRawIntValue(fmt, sum, out_b_ptr + output_byte_offset);
-    }
+    deconvolution_t d;
+    d.fmt = fmt;
+    d.in = input_ptr;
+    d.weight = weight_ptr;
+    d.bias = bias_ptr;
+    d.out = output_ptr;
+    d.input = input;
+    d.weights = weight;
+    d.biases = bias;
+    d.output = output;
+    d.upscale_x = upscale_x;
+    d.upscale_y = upscale_y;
+    d.start_x_pad = start_x_pad;
+    d.start_y_pad = start_y_pad;
+    d.wrap = wrap;
+    d.to_ne = to_ne;
+
+    ParallelForImpl((vx_uint32)(output_b * output_c), 1, deconvolutionPlanes, &d);
 }
 
 typedef struct _pwl_table
@@ -1165,120 +2197,282 @@ static void destroyPwlLutN(pwl_table *table)
 
 
 
-vx_status NNNormalizationKernelImpl(vx_tensor inputs, vx_scalar type_scalar, vx_scalar norm_size_scalar, vx_scalar alpha_scalar, vx_scalar beta_scalar, vx_tensor outputs)
+// pwl3 clamps its input to [table[0], table[1]], which are 0 and 32767 for
+// every beta, so the whole curve fits in a table over the non-negative Q7.8 values.
+#define NORM_LUT_SIZE           (1 << 15)
+#define NORM_ROWS_PER_THREAD    (4)
+
+// Node local data of the normalization layer, rebuilt when its parameters change.
+typedef struct _norm_cache_t
+{
+    vx_bool valid;
+    vx_enum type;
+    vx_size norm_size;
+    vx_float32 alpha;
+    vx_float32 beta;
+    vx_int16 scaling_factor;
+    vx_int16 lut[NORM_LUT_SIZE];
+} norm_cache_t;
+
+typedef struct _norm_t
+{
+    const vx_int16 *in;
+    vx_int16 *out;
+    const norm_cache_t *cache;
+    vx_int32 iw, ih, num_ifms, norm_size;
+    vx_size in_strides[4];      // in elements
+    vx_size out_strides[4];
+    // One entry per item, set at the first item of a range that could not get
+    // its scratch rows, so no two threads write the same entry
+    vx_bool *no_memory;
+} norm_t;
+
+vx_size NNNormalizationCacheSizeImpl(void)
+{
+    return sizeof(norm_cache_t);
+}
+
+static vx_status norm_build_cache(norm_cache_t *cache, vx_enum type, vx_size norm_size, vx_float32 alpha, vx_float32 beta)
+{
+    if (cache->valid && cache->type == type && cache->norm_size == norm_size &&
+        cache->alpha == alpha && cache->beta == beta)
+        return VX_SUCCESS;
+
+    pwl_table *table = createPwlNormLut(beta);
+    if (table == NULL)
+        return VX_ERROR_NO_MEMORY;
+
+    for (vx_int32 v = 0; v < NORM_LUT_SIZE; v++)
+        cache->lut[v] = pwl3(v, table, vx_false_e);
+    destroyPwlLutN(table);
+
+    if (type == VX_NN_NORMALIZATION_ACROSS_MAPS)
+        cache->scaling_factor = quantize_q78(sqrt(alpha/(vx_uint32)norm_size), 8);
+    else
+        cache->scaling_factor = quantize_q78(sqrt(alpha)/norm_size, 8);
+    cache->type = type;
+    cache->norm_size = norm_size;
+    cache->alpha = alpha;
+    cache->beta = beta;
+    cache->valid = vx_true_e;
+    return VX_SUCCESS;
+}
+
+vx_status NNNormalizationCacheInitImpl(vx_scalar type_scalar, vx_scalar norm_size_scalar, vx_scalar alpha_scalar, vx_scalar beta_scalar,
+        void *cache, vx_size cache_size)
 {
-    vx_int16 *pinput, *poutput;
-    vx_int32 min_ifm, max_ifm, num_ifms, min_allowed_ifm, max_allowed_ifm;
-    vx_size num_dims_in,num_dims_out, batch_size, iw, ih;
-    vx_size offset;
     vx_status status = VX_SUCCESS;
     vx_enum norm_type;
     vx_size norm_size;
     vx_float32 alpha_f, beta_f;
-    //vx_int16 alpha, beta, k = QUANTIZE(1.0);
-    vx_size input_dimensions[MAX_NUM_OF_DIMENSIONS] = {0}, input_stride[MAX_NUM_OF_DIMENSIONS] = {0};
-    vx_size output_dimensions[MAX_NUM_OF_DIMENSIONS] = {0}, output_stride[MAX_NUM_OF_DIMENSIONS] = {0};
-    status |= AllocatePatch (inputs, &num_dims_in, input_dimensions, input_stride, (void**)&pinput, VX_READ_ONLY);
-    status |= AllocatePatch (outputs, &num_dims_out, output_dimensions, output_stride,(void**)&poutput, VX_WRITE_ONLY);
 
+    if (cache == NULL || cache_size < sizeof(norm_cache_t))
+        return VX_ERROR_INVALID_PARAMETERS;
     status |= vxCopyScalar(type_scalar, &norm_type, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
     status |= vxCopyScalar(norm_size_scalar, &norm_size, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
     status |= vxCopyScalar(alpha_scalar, &alpha_f, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
     status |= vxCopyScalar(beta_scalar, &beta_f, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
-    //alpha = float2short(alpha_f);
-    //beta = float2short(beta_f);
-
-    batch_size = num_dims_in > 3 ? (input_dimensions[3]) : 1;
+    if (status == VX_SUCCESS)
+        status = norm_build_cache((norm_cache_t *)cache, norm_type, norm_size, alpha_f, beta_f);
+    return status;
+}
 
+// Adds (or removes) the squared scaled inputs of one row to the window sums.
+// Sums wrap like the 32 bit accumulator they replace.
+static void norm_accumulate(vx_uint32 *sums, const vx_int16 *in, vx_size stride, vx_int32 n, vx_int16 scaling_factor, vx_bool add)
+{
+    for (vx_int32 x = 0; x < n; x++)
+    {
+        vx_int32 scaled_input = mul_truncate((vx_int32)in[x * stride] * scaling_factor, 8);
+        vx_uint32 sq = (vx_uint32)(scaled_input * scaled_input);
+        sums[x] = add ? sums[x] + sq : sums[x] - sq;
+    }
+}
 
-    num_ifms = input_dimensions[2];
-    ih = input_dimensions[1];
-    iw = input_dimensions[0];
+static void norm_store(const norm_t *n, const vx_uint32 *sums, const vx_int16 *in, vx_int16 *out)
+{
+    for (vx_int32 x = 0; x < n->iw; x++)
+    {
+        vx_int16 v = mul_truncate((vx_int32)sums[x], 8);
+        vx_int16 tmp2 = n->cache->lut[v < 0 ? 0 : v];
+        out[x * n->out_strides[0]] = mul_truncate((vx_int32)in[x * n->in_strides[0]] * tmp2, 8);
+    }
+}
 
-    min_allowed_ifm = 0;
-    max_allowed_ifm = num_ifms;
+// One item per (batch, y) row. The window over the maps slides: the map
+// entering is added and the one leaving is subtracted.
+static void norm_across_rows(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    norm_t *n = (norm_t *)arg;
+    const vx_int32 half = n->norm_size / 2;
+    vx_uint32 *sums = (vx_uint32 *)malloc(n->iw * sizeof(vx_uint32));
 
-    // Host code - create the PWC LUT
-    pwl_table *table = createPwlNormLut(beta_f);
-    if (table == NULL)
+    if (sums == NULL)
     {
-        return VX_ERROR_NO_MEMORY;
+        n->no_memory[start] = vx_true_e;
+        return;
     }
-    vx_int16 scaling_factor;
 
-    // Normalizing
-    if (norm_type == VX_NN_NORMALIZATION_ACROSS_MAPS)
+    for (vx_uint32 item = start; item < end; item++)
     {
-        scaling_factor = quantize_q78(sqrt(alpha_f/(vx_uint32)norm_size), 8);
-        for (vx_uint32 batch_iter = 0; batch_iter < batch_size; batch_iter++)
+        vx_size b = item / n->ih, y = item % n->ih;
+        const vx_int16 *in = n->in + b * n->in_strides[3] + y * n->in_strides[1];
+        vx_int16 *out = n->out + b * n->out_strides[3] + y * n->out_strides[1];
+        vx_int32 lo = 0, hi = -1;
+
+        memset(sums, 0, n->iw * sizeof(vx_uint32));
+        for (vx_int32 ifm = 0; ifm < n->num_ifms; ifm++)
         {
-            for (vx_int32 ifm = 0; ifm < (vx_int32)num_ifms; ifm++)
+            vx_int32 max_ifm = MIN(ifm + half, n->num_ifms - 1);
+            vx_int32 min_ifm = MAX(ifm - half, 0);
+
+            for (; hi < max_ifm; )
             {
-                max_ifm = ((ifm + (vx_int32)norm_size / 2) >(max_allowed_ifm - 1) ? (max_allowed_ifm - 1) : (ifm + norm_size / 2));
-                min_ifm = ((ifm - (vx_int32)norm_size / 2 < min_allowed_ifm) ? min_allowed_ifm : (ifm - norm_size / 2));
-                for (vx_int32 y = 0; y < (int)ih; y++)
-                {
-                    for (vx_int32 x = 0; x < (int)iw; x++)
-                    {
-                        // Scaling factor is expected to be a small number by definition, so 32 bits are more than enough
-                        vx_int32 pwl_in = 0;
-                        for (vx_int32 curr_ifm = min_ifm; curr_ifm <= max_ifm; curr_ifm++)
-                        {
-                            offset = (batch_iter * (vx_int32)input_stride[3] + curr_ifm * (vx_int32)input_stride[2] + y * (vx_int32)input_stride[1] + x * (vx_int32)input_stride[0]) / 2; //TODO: Assuming 16 bits elements
-                            vx_int16 scaled_input = mul_truncate((vx_int32)pinput[offset] * scaling_factor, 8);
-                            vx_int32 scaled_input_sq = (vx_int32)scaled_input * scaled_input;
-                            pwl_in += scaled_input_sq;
-                        }
-
-                        offset = (batch_iter * input_stride[3] + ifm * input_stride[2] + y * input_stride[1] + x * input_stride[0]) / 2; //TODO: Assuming 16 bits elements
-                        vx_int16 tmp2 = pwl3(mul_truncate(pwl_in, 8), table, vx_false_e);
-                        poutput[offset] = mul_truncate((vx_int32)pinput[offset] * tmp2, 8);
-                       // printf ("offset %d pwl_in %d tmp2 %d output %d\n", offset, pwl_in, (int)tmp2, (int)poutput[offset]);
-                    }
-                }
+                hi++;
+                norm_accumulate(sums, in + hi * n->in_strides[2], n->in_strides[0], n->iw, n->cache->scaling_factor, vx_true_e);
             }
+            for (; lo < min_ifm; lo++)
+                norm_accumulate(sums, in + lo * n->in_strides[2], n->in_strides[0], n->iw, n->cache->scaling_factor, vx_false_e);
+
+            norm_store(n, sums, in + ifm * n->in_strides[2], out + ifm * n->out_strides[2]);
         }
     }
-    else // VX_NN_NORMALIZATION_SAME_MAP
+    free(sums);
+}
+
+// One item per (batch, map) plane. The square window is summed as a sliding
+// row sum followed by a sliding column sum, both clipped to the plane.
+static void norm_same_planes(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    norm_t *n = (norm_t *)arg;
+    const vx_int32 half = n->norm_size / 2;
+    const vx_int32 iw = n->iw, ih = n->ih;
+    vx_uint32 *rows = (vx_uint32 *)malloc(((vx_size)ih + 2) * iw * sizeof(vx_uint32));
+
+    if (rows == NULL)
+    {
+        n->no_memory[start] = vx_true_e;
+        return;
+    }
+
+    vx_uint32 *sq = rows + (vx_size)ih * iw;
+    vx_uint32 *sums = sq + iw;
+
+    for (vx_uint32 item = start; item < end; item++)
     {
-        scaling_factor = quantize_q78(sqrt(alpha_f)/norm_size, 8);
-        for (vx_uint32 batch_iter = 0; batch_iter < batch_size; batch_iter++)
+        vx_size b = item / n->num_ifms, ifm = item % n->num_ifms;
+        const vx_int16 *in = n->in + b * n->in_strides[3] + ifm * n->in_strides[2];
+        vx_int16 *out = n->out + b * n->out_strides[3] + ifm * n->out_strides[2];
+
+        for (vx_int32 y = 0; y < ih; y++)
         {
-            for (vx_int32 ifm = 0; ifm < num_ifms; ifm++)
+            vx_uint32 *h = rows + (vx_size)y * iw;
+            vx_uint32 acc = 0;
+
+            memset(sq, 0, iw * sizeof(vx_uint32));
+            norm_accumulate(sq, in + y * n->in_strides[1], n->in_strides[0], iw, n->cache->scaling_factor, vx_true_e);
+            for (vx_int32 k = -half; k < n->norm_size - half; k++)
+                if (k >= 0 && k < iw)
+                    acc += sq[k];
+            for (vx_int32 x = 0; x < iw; x++)
             {
-                for (vx_int32 y = 0; y < (int)ih; y++)
-                {
-                    for (vx_int32 x = 0; x < (int)iw; x++)
-                    {
-                        vx_int32 pwl_in = 0;
-                        for (vx_uint32 ny = 0; ny < norm_size; ny++)
-                        {
-                            for (vx_uint32 nx = 0; nx < norm_size; nx++)
-                            {
-                                vx_int32 currXind = x - (norm_size / 2) + nx;
-                                vx_int32 currYind = y - (norm_size / 2) + ny;
-                                if ((currYind >= 0) && (currXind >= 0) && (currYind < (int)ih) && (currXind < (int)iw))
-                                {
-                                    offset = (batch_iter * input_stride[3] + ifm*input_stride[2] +
-                                        currYind*input_stride[1] + currXind * input_stride[0]) / 2; //TODO: Assuming 16 bits elements
-                                    vx_int32 scaled_input = mul_truncate((vx_int32)pinput[offset] * scaling_factor, 8);
-                                    vx_int32 scaled_input_sq = (vx_int32)scaled_input * scaled_input;
-                                    pwl_in += scaled_input_sq;
-                                }
-                            }
-                        }
-
-                        offset = (batch_iter * input_stride[3] + ifm * input_stride[2] + y * input_stride[1] + x * input_stride[0]) / 2; //TODO: Assuming 16 bits elements
-                        vx_int16 tmp2 = pwl3(mul_truncate(pwl_in, 8), table, vx_false_e);
-                        poutput[offset] = mul_truncate((vx_int32)pinput[offset] * tmp2, 8);
-                    }
-                }
+                vx_int32 leave = x - half, enter = x - half + n->norm_size;
+                h[x] = acc;
+                if (leave >= 0 && leave < iw)
+                    acc -= sq[leave];
+                if (enter >= 0 && enter < iw)
+                    acc += sq[enter];
             }
         }
+
+        memset(sums, 0, iw * sizeof(vx_uint32));
+        for (vx_int32 k = -half; k < n->norm_size - half; k++)
+            if (k >= 0 && k < ih)
+                for (vx_int32 x = 0; x < iw; x++)
+                    sums[x] += rows[(vx_size)k * iw + x];
+        for (vx_int32 y = 0; y < ih; y++)
+        {
+            vx_int32 leave = y - half, enter = y - half + n->norm_size;
+            norm_store(n, sums, in + y * n->in_strides[1], out + y * n->out_strides[1]);
+            if (leave >= 0 && leave < ih)
+                for (vx_int32 x = 0; x < iw; x++)
+                    sums[x] -= rows[(vx_size)leave * iw + x];
+            if (enter >= 0 && enter < ih)
+                for (vx_int32 x = 0; x < iw; x++)
+                    sums[x] += rows[(vx_size)enter * iw + x];
+        }
     }
+    free(rows);
+}
 
-    // Destroy PWC LUT
-    destroyPwlLutN(table);
+vx_status NNNormalizationKernelImpl(vx_tensor inputs, vx_scalar type_scalar, vx_scalar norm_size_scalar, vx_scalar alpha_scalar, vx_scalar beta_scalar, vx_tensor outputs,
+        void *cache, vx_size cache_size)
+{
+    vx_int16 *pinput = NULL, *poutput = NULL;
+    vx_size num_dims_in,num_dims_out, batch_size;
+    vx_status status = VX_SUCCESS;
+    vx_enum norm_type;
+    vx_size norm_size;
+    vx_float32 alpha_f, beta_f;
+    vx_size input_dimensions[MAX_NUM_OF_DIMENSIONS] = {0}, input_stride[MAX_NUM_OF_DIMENSIONS] = {0};
+    vx_size output_dimensions[MAX_NUM_OF_DIMENSIONS] = {0}, output_stride[MAX_NUM_OF_DIMENSIONS] = {0};
+    norm_cache_t *table = (norm_cache_t *)cache;
+    status |= AllocatePatch (inputs, &num_dims_in, input_dimensions, input_stride, (void**)&pinput, VX_READ_ONLY);
+    status |= AllocatePatch (outputs, &num_dims_out, output_dimensions, output_stride,(void**)&poutput, VX_WRITE_ONLY);
+
+    status |= vxCopyScalar(type_scalar, &norm_type, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxCopyScalar(norm_size_scalar, &norm_size, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxCopyScalar(alpha_scalar, &alpha_f, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxCopyScalar(beta_scalar, &beta_f, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+
+    // Without node local data the PWL table is built for this call only
+    if (table == NULL || cache_size < sizeof(norm_cache_t))
+    {
+        table = (norm_cache_t *)calloc(1, sizeof(norm_cache_t));
+        if (table == NULL)
+            status = VX_ERROR_NO_MEMORY;
+    }
+    if (status == VX_SUCCESS)
+        status = norm_build_cache(table, norm_type, norm_size, alpha_f, beta_f);
+
+    if (status == VX_SUCCESS)
+    {
+        norm_t n;
+        vx_size items;
+
+        batch_size = num_dims_in > 3 ? (input_dimensions[3]) : 1;
+        n.in = pinput;
+        n.out = poutput;
+        n.cache = table;
+        n.iw = (vx_int32)input_dimensions[0];
+        n.ih = (vx_int32)input_dimensions[1];
+        n.num_ifms = (vx_int32)input_dimensions[2];
+        n.norm_size = (vx_int32)norm_size;
+        for (vx_size i = 0; i < 4; i++)
+        {
+            n.in_strides[i] = input_stride[i] / sizeof(vx_int16); //TODO: Assuming 16 bits elements
+            n.out_strides[i] = output_stride[i] / sizeof(vx_int16);
+        }
+
+        items = batch_size * (norm_type == VX_NN_NORMALIZATION_ACROSS_MAPS ? n.ih : n.num_ifms);
+        n.no_memory = (vx_bool *)calloc(items ? items : 1, sizeof(vx_bool));
+        if (n.no_memory == NULL)
+            status = VX_ERROR_NO_MEMORY;
+        else if (norm_type == VX_NN_NORMALIZATION_ACROSS_MAPS)
+            ParallelForImpl((vx_uint32)items, NORM_ROWS_PER_THREAD, norm_across_rows, &n);
+        else // VX_NN_NORMALIZATION_SAME_MAP
+            ParallelForImpl((vx_uint32)items, 1, norm_same_planes, &n);
+
+        for (vx_size i = 0; n.no_memory && i < items; i++)
+        {
+            if (n.no_memory[i])
+                status = VX_ERROR_NO_MEMORY;
+        }
+        free(n.no_memory);
+    }
+
+    if (table != (norm_cache_t *)cache)
+        free(table);
 
     status |= ReleasePatch (inputs, num_dims_in, input_dimensions, input_stride, (void**)&pinput, VX_READ_ONLY);
     status |= ReleasePatch (outputs, num_dims_out, output_dimensions, output_stride, (void**)&poutput, VX_WRITE_ONLY);
@@ -1287,6 +2481,58 @@ vx_status NNNormalizationKernelImpl(vx_tensor inputs, vx_scalar type_scalar, vx_
 }
 
 
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+
+// The same functions as below, on F16 rows converted to float
+static C_KERNEL_INLINE float activationHalfValue(vx_enum func, float val)
+{
+    switch (func)
+    {
+    case VX_NN_ACTIVATION_HYPERBOLIC_TAN: return tanhf(val);
+    case VX_NN_ACTIVATION_RELU: return val > 0.f ? val : 0.f;
+    case VX_NN_ACTIVATION_LOGISTIC: return 1.f / (1.f + expf(-val));
+    default: return 0.f;
+    }
+}
+
+static void activationHalf(
+        const char * in_ptr, tensor_desc_t input,
+        vx_enum func,
+        char * out_ptr, tensor_desc_t output)
+{
+    const size_t output_w = output.dims[0];
+    const size_t output_h = output.dim_num > 1 ? output.dims[1] : 1;
+    const size_t output_c = output.dim_num > 2 ? output.dims[2] : 1;
+    const size_t output_b = output.dim_num > 3 ? output.dims[3] : 1;
+
+    float * row = (float *)malloc(output_w * sizeof(float));
+
+    for (size_t b = 0; b < output_b; ++b)
+    for (size_t c = 0; c < output_c; ++c)
+    for (size_t y = 0; y < output_h; ++y)
+    {
+        const char * in_row = in_ptr + input.strides[3] * b + input.strides[2] * c + input.strides[1] * y;
+        char * out_row = out_ptr + output.strides[3] * b + output.strides[2] * c + output.strides[1] * y;
+
+        if (row)
+        {
+            loadHalfRow(in_row, input.strides[0], output_w, row);
+            for (size_t x = 0; x < output_w; ++x)
+                row[x] = activationHalfValue(func, row[x]);
+            storeHalfRow(row, output_w, out_row, output.strides[0]);
+        }
+        else
+        {
+            for (size_t x = 0; x < output_w; ++x)
+                storeHalfValue(activationHalfValue(func, loadHalfValue(in_row + input.strides[0] * x)), out_row + output.strides[0] * x);
+        }
+    }
+
+    free(row);
+}
+
+#endif
+
 void ActivationKernelImpl(
         enum TensorCFmt fmt,
         const void * input_ptr, tensor_desc_t input,
@@ -1321,6 +2567,13 @@ void ActivationKernelImpl(
     assertStridesModSizeof (fmt, input);
     assertStridesModSizeof (fmt, output);
 
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+    if (fmt == TENSOR_C_FMT_F16)
+    {
+        activationHalf(input_ptr, input, func, output_ptr, output);
+        return;
+    }
+#endif
 
     //TODO: previously there was a 1d/3d stride for ofm but there's no 1D pool, right?
 
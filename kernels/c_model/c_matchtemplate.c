@@ -156,12 +156,14 @@ vxCompareBlocksL2_8u( const vx_uint8 * vec1, const vx_uint8 * vec2, int len )
 vx_int64
 vxCompareBlocksL2_Square_8u( const vx_uint8 * vec1, const vx_uint8 * vec2, int len )
 {
-    int i, s = 0;
+    int i;
+    vx_int64 s = 0;
     vx_int64 sum = 0;
     for( i = 0; i <= len - 4; i += 4 )
     {
-        int v = vec1[i] * vec2[i];
-        int e = v * v ;
+        /* a square of a product of two bytes does not fit an int */
+        vx_int64 v = vec1[i] * vec2[i];
+        vx_int64 e = v * v ;
         v = vec1[i + 1] * vec2[i + 1];
         e += v * v ;
         v = vec1[i + 2] * vec2[i + 2];
@@ -172,709 +174,529 @@ vxCompareBlocksL2_Square_8u( const vx_uint8 * vec1, const vx_uint8 * vec2, int l
     }
     for( ; i < len; i++ )
     {
-        int v = vec1[i] * vec2[i];
+        vx_int64 v = vec1[i] * vec2[i];
         s += v * v ;
     }
     return sum + s;
 }
 
-int vx_align(vx_uint32 size)
-{
-    return (size + 16 + 32 - 1) & -32;
-}
-void vxCalculateBufferSizes( vx_uint32 src_width, vx_uint32 src_height,
-                         vx_uint32 template_width, vx_uint32 template_height,
-                         vx_int32 is_centered, vx_int32 is_normed,
-                         vx_int32 *imgBufSize, vx_int32 *templBufSize,
-                         vx_int32 *sumBufSize, vx_int32 *sqsumBufSize,
-                         vx_int32 *resNumBufSize, vx_int32 *resDenomBufSize )
-{
-    vx_int32 depth = 1;
-
-    *imgBufSize = vx_align( (template_width * src_height + src_width) * depth );
-    *templBufSize = vx_align( template_width * template_height * depth );
-    *resNumBufSize = vx_align( (src_height - template_height + 1) * sizeof( vx_int64 ));
-
-    if( is_centered || is_normed )
-    {
-        *sumBufSize = vx_align( src_height * sizeof( vx_float64 ));
-        *sqsumBufSize = vx_align( src_height * sizeof( vx_float64 ));
-        *resDenomBufSize = vx_align( (src_height - template_height + 1) *
-                                  (is_centered + is_normed) * sizeof( vx_float64 ));
-    }
-}
-vx_status vxMatchTemplateGetBufSize( vx_uint32 src_width, vx_uint32 src_height,
-                            vx_uint32 template_width, vx_uint32 template_height,
-                            int *bufferSize, int is_centered, int is_normed )
+/*! \brief Templates with at least this many pixels are correlated in the frequency domain. */
+#define MATCH_FFT_MIN_WINDOW (32 * 32)
+
+#define MATCH_PI 3.1415926535897932384626433832795
+
+/*! \brief The least number of result rows worth a thread of their own. */
+#define MATCH_ROWS_PER_THREAD (8)
+
+typedef struct _match_complex_t {
+    vx_float64 re;
+    vx_float64 im;
+} match_complex_t;
+
+typedef struct _match_t {
+    vx_int32 method;
+    const vx_uint8 *src;
+    vx_size src_stride;
+    vx_int32 src_width;
+    vx_int32 src_height;
+    const vx_uint8 *templ;      /* contiguous, templ_width bytes per row */
+    vx_int32 templ_width;
+    vx_int32 templ_height;
+    vx_uint8 *dst;
+    vx_size dst_stride;
+    vx_int32 res_width;
+    vx_int32 res_height;
+    vx_float64 winCoeff;
+    vx_float64 templCoeff;
+    vx_int64 templSqsum;
+    vx_int64 *sqsum;            /* integral image of I^2, (src_width + 1) x (src_height + 1) */
+    /* the frequency domain path, correlating block_x x block_y tiles (overlap-save) */
+    vx_uint32 block_x;
+    vx_uint32 block_y;
+    vx_uint32 step_x;           /* results each tile yields across and down */
+    vx_uint32 step_y;
+    vx_uint32 tiles_x;
+    match_complex_t *templ_spectrum;
+    match_complex_t *twiddles;  /* for the longer of the two axes */
+    vx_uint32 twiddle_len;
+    vx_uint32 *bitrev_x;
+    vx_uint32 *bitrev_y;
+    vx_bool *failed;            /* per tile row, set at the first row of a range without scratch */
+} match_t;
+
+/* sum of I^2 under the template placed at (x, y) */
+static vx_int64 match_window_sqsum(const match_t *m, vx_int32 x, vx_int32 y)
 {
-    int imgBufSize = 0, templBufSize = 0, sumBufSize = 0, sqsumBufSize = 0,
-        resNumBufSize = 0, resDenomBufSize = 0;
-
-    if( !bufferSize )
-        return VX_FAILURE;
-    *bufferSize = 0;
-
-    vxCalculateBufferSizes(src_width, src_height, template_width, template_height,
-                            is_centered, is_normed,
-                            &imgBufSize, &templBufSize,
-                            &sumBufSize, &sqsumBufSize, &resNumBufSize, &resDenomBufSize );
-
-    *bufferSize = imgBufSize + templBufSize + sumBufSize + sqsumBufSize +
-        resNumBufSize + resDenomBufSize;
-
-    return VX_SUCCESS;
+    vx_size stride = (vx_size)m->src_width + 1;
+    const vx_int64 *top = m->sqsum + y * stride;
+    const vx_int64 *bottom = m->sqsum + (y + m->templ_height) * stride;
+    return bottom[x + m->templ_width] - bottom[x] - top[x + m->templ_width] + top[x];
 }
 
-vx_status vxMatchTemplateEntry(const vx_image source_image,
-                       const vx_uint32 src_width, const vx_uint32 src_height,
-                       const vx_image template_image,
-                       const vx_uint32 template_width, const vx_uint32 template_height,
-                       vx_image output,
-                       void *pBuffer,
-                       vx_int32 is_centered, vx_int32 is_normed,
-                       void **imgBuf, void **templBuf,
-                       void **sumBuf, void **sqsumBuf, void **resNum, void **resDenom )
+/* num is the method's own sum; aux is the sum of (I*T)^2 for L2_NORM */
+static void match_store(const match_t *m, vx_int32 x, vx_int32 y, vx_int64 num, vx_int64 aux)
 {
-    vx_status status = VX_SUCCESS;
-    vx_int32 templBufSize = 0, imgBufSize = 0,
-             sumBufSize = 0, sqsumBufSize = 0, resNumBufSize = 0, resDenomBufSize = 0;
-    vx_uint32 i;
-    (void)output;
-
-    char *buffer = (char *) pBuffer;
-
-    if( !pBuffer )
-        return VX_FAILURE;
-
-    vxCalculateBufferSizes(src_width, src_height, template_width, template_height,
-                             is_centered, is_normed,
-                             &imgBufSize, &templBufSize,
-                             &sumBufSize, &sqsumBufSize, &resNumBufSize, &resDenomBufSize );
-    *templBuf = buffer;
-    buffer += templBufSize;
+    vx_int16 *dst = (vx_int16 *)(m->dst + y * m->dst_stride) + x;
+    vx_float64 res;
 
-    *imgBuf = buffer;
-    buffer += imgBufSize;
-
-    *resNum = buffer;
-    buffer += resNumBufSize;
-
-    if( is_centered || is_normed )
-    {
-        if( sumBuf )
-            *sumBuf = buffer;
-        buffer += sumBufSize;
-
-        if( sqsumBuf )
-            *sqsumBuf = buffer;
-        buffer += sqsumBufSize;
-
-        if( resDenom )
-            *resDenom = buffer;
-        buffer += resDenomBufSize;
-    }
-    void* src;
-    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT, template_addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_map_id source_map_id = 0, template_map_id = 0;
-    vx_rectangle_t source_rect, template_rect;
-    status |= vxGetValidRegionImage(source_image, &source_rect);
-    if( status != VX_SUCCESS ) return status;
-    src = NULL;
-    status = vxMapImagePatch(source_image, &source_rect, 0, &source_map_id, &addr, &src, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0);
-    if( status != VX_SUCCESS ) return status;
-
-    for (i = 0; i < src_height; i++)
+    switch (m->method)
     {
-        vx_uint8* srcp = vxFormatImagePatchAddress1d(src, i * src_width, &addr);
-        memcpy((vx_uint8*)(*imgBuf) + i * template_width, srcp, template_width);
-    }
-    status |= vxUnmapImagePatch(source_image, source_map_id);
-
-    status |= vxGetValidRegionImage(template_image, &template_rect);
-    if( status != VX_SUCCESS ) return status;
-    src = NULL;
-    status = vxMapImagePatch(template_image, &template_rect, 0, &template_map_id, &template_addr, &src, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0);
-    if( status != VX_SUCCESS ) return status;
-    for (i = 0; i < template_height; i++)
-    {
-        vx_uint8* srcp = vxFormatImagePatchAddress1d(src, i * template_width, &template_addr);
-        memcpy((vx_uint8*)(*templBuf) + i * template_width, srcp, template_width);
+        case VX_COMPARE_HAMMING:
+        case VX_COMPARE_L1:
+            *dst = (vx_int16)(m->winCoeff * (vx_float64)num);
+            break;
+        case VX_COMPARE_L2:
+        case VX_COMPARE_CCORR:
+            *dst = (vx_int16)(vx_int64)(m->winCoeff * (vx_float64)num);
+            break;
+        case VX_COMPARE_L2_NORM:
+            *dst = (vx_int16)((vx_float64)num / sqrt((vx_float64)aux));
+            break;
+        case VX_COMPARE_CCORR_NORM:
+        default:
+            res = ((vx_float64)num) * m->templCoeff *
+                vxInvSqrt64d( fabs( (vx_float64)match_window_sqsum(m, x, y) ) + FLT_EPSILON );
+            res *= pow(2, 15);
+            *dst = (vx_int16)res;
+            break;
     }
-    status = vxUnmapImagePatch(template_image, template_map_id);
-    return status;
 }
 
-vx_status matchTemplate_HAMMING(const vx_image source_image, vx_uint32 src_width, vx_uint32 src_height,
-               const vx_image template_image, vx_uint32 template_width, vx_uint32 template_height,
-               vx_image result_image, void *pBuffer)
+static void match_direct_rows(void *arg, vx_uint32 start, vx_uint32 end)
 {
-    vx_status status = VX_SUCCESS;
-    vx_uint8 *imgBuf = 0;
-    vx_uint8 *templBuf = 0;
-    vx_int64 *resNum = 0;
-    vx_int32 winLen = template_width * template_height;
-    vx_float64 winCoeff = 1. / (winLen + DBL_EPSILON);
-    vx_int32 result_width = src_width - template_width + 1;
-    vx_int32 result_height = src_height - template_height + 1;
-    vx_int32 x, y;
+    const match_t *m = (const match_t *)arg;
+    vx_int32 tw = m->templ_width;
+    vx_uint32 y;
 
-    vx_status result = vxMatchTemplateEntry(source_image, src_width, src_height,
-                                             template_image, template_width, template_height,
-                                             result_image, pBuffer,
-                                             0, 0,
-                                             (void **) &imgBuf, (void **) &templBuf,
-                                             0, 0,
-                                             (void **) &resNum, 0 );
-    if( result != VX_SUCCESS ) return result;
-    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_imagepatch_addressing_t result_addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_map_id map_id = 0;
-    vx_map_id result_map_id = 0;
-    vx_rectangle_t rect;
-    vx_rectangle_t result_rect;
-    vx_uint8 *src = NULL;
-    vx_int16 *result_src = NULL;
-    vx_size source_x = 0;
-    status |= vxGetValidRegionImage(source_image, &rect);
-    status |= vxMapImagePatch(source_image, &rect, 0, &map_id, &addr, (void**)&src, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-    status |= vxGetValidRegionImage(result_image, &result_rect);
-    status |= vxMapImagePatch(result_image, &result_rect, 0, &result_map_id, &result_addr, (void**)&result_src, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-    /* main loop - through x coordinate of the result */
-    for( x = 0; x < result_width; x++ )
+    for (y = start; y < end; y++)
     {
-        vx_uint8 *imgPtr = imgBuf + x;
-        /* update sums and image band buffer */
-        if( x > 0 )
+        vx_int32 x;
+        for (x = 0; x < m->res_width; x++)
         {
-            source_x = x + template_width - 1;
-            vx_uint8 *dst = imgPtr - 1;
-            dst += template_width;
-            for( y = 0; y < (vx_int32)src_height; y++, source_x+=src_width, dst += template_width )
+            const vx_uint8 *img = m->src + y * m->src_stride + x;
+            const vx_uint8 *t = m->templ;
+            vx_int64 num = 0, aux = 0;
+            vx_int32 r;
+
+            /* one template row at a time, straight from the mapped image */
+            for (r = 0; r < m->templ_height; r++, img += m->src_stride, t += tw)
             {
-                vx_uint8* srcp = vxFormatImagePatchAddress1d(src, (vx_int32)source_x, &addr);
-                dst[0] = srcp[0];
+                switch (m->method)
+                {
+                    case VX_COMPARE_HAMMING:
+                        num += vxCompareBlocksHamming_8u(img, t, tw);
+                        break;
+                    case VX_COMPARE_L1:
+                        num += vxCompareBlocksL1_8u(img, t, tw);
+                        break;
+                    case VX_COMPARE_L2:
+                        num += vxCompareBlocksL2_8u(img, t, tw);
+                        break;
+                    case VX_COMPARE_L2_NORM:
+                        num += vxCompareBlocksL2_8u(img, t, tw);
+                        aux += vxCompareBlocksL2_Square_8u(img, t, tw);
+                        break;
+                    case VX_COMPARE_CCORR:
+                    case VX_COMPARE_CCORR_NORM:
+                    default:
+                        num += vxCrossCorr_8u(img, t, tw);
+                        break;
+                }
             }
+            match_store(m, x, (vx_int32)y, num, aux);
         }
-
-        for( y = 0; y < result_height; y++, imgPtr += template_width )
-        {
-            resNum[y] = vxCompareBlocksHamming_8u( imgPtr, templBuf, winLen );
-        }
-
-        for( y = 0; y < result_height; y++ )
-        {
-            vx_float64 res = winCoeff * ((vx_float64) resNum[y]);
-            vx_int16 *result_srcp = vxFormatImagePatchAddress1d(result_src, x+y*result_width, &result_addr);
-            *result_srcp = (vx_int16)res;
-        }
-    }
-    if (status == VX_SUCCESS)
-    {
-        status |= vxUnmapImagePatch(source_image, map_id);
-        status |= vxUnmapImagePatch(result_image, result_map_id);
     }
-    return status;
 }
 
-vx_status matchTemplate_COMPARE_L1(const vx_image source_image, vx_uint32 src_width, vx_uint32 src_height,
-               const vx_image template_image, vx_uint32 template_width, vx_uint32 template_height,
-               vx_image result_image, void *pBuffer)
+/* in place radix-2 transform of n points, n a power of two up to twiddle_len;
+ * the inverse is not scaled */
+static void match_fft_1d(const match_t *m, match_complex_t *a, vx_uint32 n,
+                         const vx_uint32 *bitrev, vx_bool inverse)
 {
-    vx_status status = VX_SUCCESS;
-    vx_uint8 *imgBuf = 0;
-    vx_uint8 *templBuf = 0;
-    vx_int64 *resNum = 0;
-    vx_int32 winLen = template_width * template_height;
-    vx_float64 winCoeff = 1. / (winLen + DBL_EPSILON);
-    vx_int32 result_width = src_width - template_width + 1;
-    vx_int32 result_height = src_height - template_height + 1;
-    vx_int32 x, y;
+    vx_uint32 i, len;
 
-    vx_status result = vxMatchTemplateEntry(source_image, src_width, src_height,
-                                             template_image, template_width, template_height,
-                                             result_image, pBuffer,
-                                             0, 0,
-                                             (void **) &imgBuf, (void **) &templBuf,
-                                             0, 0,
-                                             (void **) &resNum, 0 );
-    if( result != VX_SUCCESS ) return result;
-    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_imagepatch_addressing_t result_addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_map_id map_id = 0;
-    vx_map_id result_map_id = 0;
-    vx_rectangle_t rect;
-    vx_rectangle_t result_rect;
-    vx_uint8 *src = NULL;
-    vx_int16 *result_src = NULL;
-    vx_size source_x = 0;
-    status |= vxGetValidRegionImage(source_image, &rect);
-    status |= vxMapImagePatch(source_image, &rect, 0, &map_id, &addr, (void**)&src, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-
-    status |= vxGetValidRegionImage(result_image, &result_rect);
-    status |= vxMapImagePatch(result_image, &result_rect, 0, &result_map_id, &result_addr, (void**)&result_src, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-    /* main loop - through x coordinate of the result */
-    for( x = 0; x < result_width; x++ )
+    for (i = 0; i < n; i++)
     {
-        vx_uint8 *imgPtr = imgBuf + x;
-        /* update sums and image band buffer */
-        if( x > 0 )
-        {
-            source_x = x + template_width - 1;
-            vx_uint8 *dst = imgPtr - 1;
-            dst += template_width;
-
-            for( y = 0; y < (vx_int32)src_height; y++, source_x+=src_width, dst += template_width )
-            {
-                vx_uint8* srcp = vxFormatImagePatchAddress1d(src, (vx_int32) source_x, &addr);
-                dst[0] = srcp[0];
-            }
-        }
-
-        for( y = 0; y < result_height; y++, imgPtr += template_width )
-        {
-            vx_int64 res = vxCompareBlocksL1_8u( imgPtr, templBuf, winLen );
-            resNum[y] = res;
-        }
-
-        for( y = 0; y < result_height; y++ )
+        vx_uint32 j = bitrev[i];
+        if (i < j)
         {
-            vx_float64 res = winCoeff * ((vx_float64)resNum[y]);
-            vx_int16 *result_srcp = vxFormatImagePatchAddress2d(result_src, x, y, &result_addr);
-            *result_srcp = (vx_int16)res;
+            match_complex_t t = a[i];
+            a[i] = a[j];
+            a[j] = t;
         }
     }
-
-    if (status == VX_SUCCESS)
+    for (len = 2; len <= n; len <<= 1)
     {
-        status |= vxUnmapImagePatch(source_image, map_id);
-        status |= vxUnmapImagePatch(result_image, result_map_id);
+        vx_uint32 half = len / 2, step = m->twiddle_len / len;
+        for (i = 0; i < n; i += len)
+        {
+            vx_uint32 k;
+            for (k = 0; k < half; k++)
+            {
+                match_complex_t w = m->twiddles[k * step];
+                match_complex_t *u = &a[i + k], *v = &a[i + k + half];
+                vx_float64 vr, vi;
+
+                if (inverse)
+                    w.im = -w.im;
+                vr = v->re * w.re - v->im * w.im;
+                vi = v->re * w.im + v->im * w.re;
+                v->re = u->re - vr;
+                v->im = u->im - vi;
+                u->re += vr;
+                u->im += vi;
+            }
+        }
     }
-
-    return status;
 }
 
-vx_status matchTemplate_COMPARE_L2(const vx_image source_image, vx_uint32 src_width, vx_uint32 src_height,
-               const vx_image template_image, vx_uint32 template_width, vx_uint32 template_height,
-               vx_image result_image, void *pBuffer)
+static void match_fft_2d(const match_t *m, match_complex_t *a, match_complex_t *column, vx_bool inverse)
 {
-    vx_status status = VX_SUCCESS;
-    vx_uint8 *imgBuf = 0;
-    vx_uint8 *templBuf = 0;
-    vx_int64 *resNum = 0;
-    vx_int32 winLen = template_width * template_height;
-    vx_float64 winCoeff = 1. / (winLen + DBL_EPSILON);
-    vx_int32 result_width = src_width - template_width + 1;
-    vx_int32 result_height = src_height - template_height + 1;
-    vx_int32 x, y;
+    vx_uint32 nx = m->block_x, ny = m->block_y;
+    vx_uint32 x, y;
 
-    vx_status result = vxMatchTemplateEntry(source_image, src_width, src_height,
-                                             template_image, template_width, template_height,
-                                             result_image, pBuffer,
-                                             0, 0,
-                                             (void **) &imgBuf, (void **) &templBuf,
-                                             0, 0,
-                                             (void **) &resNum, 0 );
-    if( result != VX_SUCCESS ) return result;
-    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_imagepatch_addressing_t result_addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_map_id map_id = 0;
-    vx_map_id result_map_id = 0;
-    vx_rectangle_t rect;
-    vx_rectangle_t result_rect;
-    vx_uint8 *src = NULL;
-    vx_int16 *result_src = NULL;
-    vx_size source_x = 0;
-    status |= vxGetValidRegionImage(source_image, &rect);
-    status |= vxMapImagePatch(source_image, &rect, 0, &map_id, &addr, (void**)&src, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-
-    status |= vxGetValidRegionImage(result_image, &result_rect);
-    status |= vxMapImagePatch(result_image, &result_rect, 0, &result_map_id, &result_addr, (void**)&result_src, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-    /* main loop - through x coordinate of the result */
-    for( x = 0; x < result_width; x++ )
+    for (y = 0; y < ny; y++)
+        match_fft_1d(m, a + y * nx, nx, m->bitrev_x, inverse);
+    for (x = 0; x < nx; x++)
     {
-        vx_uint8 *imgPtr = imgBuf + x;
-        /* update sums and image band buffer */
-        if( x > 0 )
-        {
-            source_x = x + template_width - 1;
-            vx_uint8 *dst = imgPtr - 1;
-            dst += template_width;
-
-            for( y = 0; y < (vx_int32)src_height; y++, source_x += src_width, dst += template_width )
-            {
-                vx_uint8* srcp = vxFormatImagePatchAddress1d(src, (vx_int32)source_x, &addr);
-                dst[0] = srcp[0];
-            }
-        }
+        for (y = 0; y < ny; y++)
+            column[y] = a[y * nx + x];
+        match_fft_1d(m, column, ny, m->bitrev_y, inverse);
+        for (y = 0; y < ny; y++)
+            a[y * nx + x] = column[y];
+    }
+}
 
-        for( y = 0; y < result_height; y++, imgPtr += template_width )
-        {
-            vx_int64 res = vxCompareBlocksL2_8u(imgPtr, templBuf, winLen);
-            resNum[y] = res;
-        }
+/* rounds the unscaled inverse transform back to the integer sum it stands for */
+static vx_int64 match_round(vx_float64 value, vx_float64 scale)
+{
+    return (vx_int64)floor(value * scale + 0.5);
+}
 
-        for( y = 0; y < result_height; y++ )
-        {
-            vx_int64 res = (vx_int64)(winCoeff * ((vx_float64) resNum[y]));
-            vx_int16 *result_srcp = vxFormatImagePatchAddress1d(result_src, x+y*result_width, &result_addr);
-            *result_srcp = (vx_int16)res;
-        }
-    }
-    if (status == VX_SUCCESS)
+static void match_fft_store(const match_t *m, vx_uint32 bx, vx_uint32 by, vx_int64 cc)
+{
+    vx_int64 num = cc;
+    if (m->method == VX_COMPARE_L2)
     {
-        status |= vxUnmapImagePatch(source_image, map_id);
-        status |= vxUnmapImagePatch(result_image, result_map_id);
+        /* sum (I - T)^2 = sum I^2 - 2 sum I*T + sum T^2 */
+        num = match_window_sqsum(m, (vx_int32)bx, (vx_int32)by) - 2 * cc + m->templSqsum;
     }
-    return status;
+    match_store(m, (vx_int32)bx, (vx_int32)by, num, 0);
 }
 
-vx_status matchTemplate_CCORR(const vx_image source_image, vx_uint32 src_width, vx_uint32 src_height,
-               const vx_image template_image, vx_uint32 template_width, vx_uint32 template_height,
-               vx_image result_image, void *pBuffer)
+/* loads the tile at (bx, by) as the real part and, when pair is set, the next
+ * tile across as the imaginary part, so a single transform serves both */
+static void match_load_tile(const match_t *m, match_complex_t *z, vx_uint32 bx, vx_uint32 by, vx_bool pair)
 {
-    vx_status status = VX_SUCCESS;
-    vx_uint8 *imgBuf = 0;
-    vx_uint8 *templBuf = 0;
-    vx_int64 *resNum = 0;
-    vx_int32 winLen = template_width * template_height;
-    vx_float64 winCoeff = 1. / (winLen + DBL_EPSILON);
-    vx_int32 result_width = src_width - template_width + 1;
-    vx_int32 result_height = src_height - template_height + 1;
-    vx_int32 x, y;
+    vx_uint32 nx = m->block_x, ny = m->block_y;
+    vx_uint32 u, v;
 
-    vx_status result = vxMatchTemplateEntry(source_image, src_width, src_height,
-                                             template_image, template_width, template_height,
-                                             result_image, pBuffer,
-                                             0, 0,
-                                             (void **) &imgBuf, (void **) &templBuf,
-                                             0, 0,
-                                             (void **) &resNum, 0 );
-    if( result != VX_SUCCESS ) return result;
-    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_map_id map_id = 0;
-    vx_map_id result_map_id = 0;
-    vx_rectangle_t rect;
-    vx_rectangle_t result_rect;
-    vx_uint8 *src = NULL;
-    vx_int16 *result_src = NULL;
-    vx_size source_x = 0;
-    status |= vxGetValidRegionImage(source_image, &rect);
-    status |= vxMapImagePatch(source_image, &rect, 0, &map_id, &addr, (void**)&src, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-
-    vx_imagepatch_addressing_t result_addr = VX_IMAGEPATCH_ADDR_INIT;
-    status |= vxGetValidRegionImage(result_image, &result_rect);
-    status |= vxMapImagePatch(result_image, &result_rect, 0, &result_map_id, &result_addr, (void**)&result_src, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-
-    /* main loop - through x coordinate of the result */
-    for( x = 0; x < result_width; x++ )
+    for (v = 0; v < ny; v++)
     {
-        vx_uint8 *imgPtr = imgBuf + x;
-        /* update sums and image band buffer */
-        if( x > 0 )
+        vx_uint32 row = by + v;
+        const vx_uint8 *img = m->src + row * m->src_stride;
+        match_complex_t *zr = z + v * nx;
+        for (u = 0; u < nx; u++)
         {
-            source_x = x + template_width - 1;
-            vx_uint8 *dst = imgPtr - 1;
-            dst += template_width;
-
-            for( y = 0; y < (vx_int32)src_height; y++, source_x+=src_width, dst += template_width )
+            vx_uint32 col = bx + u, col2 = bx + m->step_x + u;
+            vx_float64 p = 0.0, q = 0.0;
+            if (row < (vx_uint32)m->src_height)
             {
-                vx_uint8* srcp = vxFormatImagePatchAddress1d(src, (vx_uint32)source_x, &addr);
-                dst[0] = srcp[0];
+                if (col < (vx_uint32)m->src_width)
+                    p = img[col];
+                if (pair && col2 < (vx_uint32)m->src_width)
+                    q = img[col2];
             }
+            zr[u].re = p;
+            zr[u].im = q;
         }
-
-        for( y = 0; y < result_height; y++, imgPtr += template_width )
-        {
-            resNum[y] = vxCrossCorr_8u( imgPtr, templBuf, winLen );
-        }
-
-        for( y = 0; y < result_height; y++ )
-        {
-            vx_int64 res = (vx_int64)(winCoeff * ((vx_float64) resNum[y]));
-            vx_int16 *result_srcp = vxFormatImagePatchAddress1d(result_src, x+y*result_width, &result_addr);
-            *result_srcp = (vx_int16)res;
-        }
-    }
-    if (status == VX_SUCCESS)
-    {
-        status |= vxUnmapImagePatch(source_image, map_id);
-        status |= vxUnmapImagePatch(result_image, result_map_id);
     }
-    return status;
 }
 
-vx_status matchTemplate_COMPARE_L2_NORM(const vx_image source_image, vx_uint32 src_width, vx_uint32 src_height,
-               const vx_image template_image, vx_uint32 template_width, vx_uint32 template_height,
-               vx_image result_image, void *pBuffer)
+static void match_fft_rows(void *arg, vx_uint32 start, vx_uint32 end)
 {
-    vx_status status = VX_SUCCESS;
-    vx_uint8 *imgBuf = 0;
-    vx_uint8 *templBuf = 0;
-    vx_int64 *sqsumBuf = 0;
-    vx_int64 *resNum = 0;
-    vx_int32 winLen = template_width * template_height;
-    vx_int32 result_width = src_width - template_width + 1;
-    vx_int32 result_height = src_height - template_height + 1;
-    vx_int32 x, y;
-
-    vx_status result = vxMatchTemplateEntry(source_image, src_width, src_height,
-                                             template_image, template_width, template_height,
-                                             result_image, pBuffer,
-                                             0, 1,
-                                             (void **) &imgBuf, (void **) &templBuf,
-                                             0, (void **)&sqsumBuf,
-                                             (void **) &resNum, 0 );
-    if( result != VX_SUCCESS ) return result;
-    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_imagepatch_addressing_t result_addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_map_id map_id = 0;
-    vx_map_id result_map_id = 0;
-    vx_rectangle_t rect;
-    vx_rectangle_t result_rect;
-    vx_uint8 *src = NULL;
-    vx_int16 *result_src = NULL;
-    vx_size source_x = 0;
-    status |= vxGetValidRegionImage(source_image, &rect);
-    status |= vxMapImagePatch(source_image, &rect, 0, &map_id, &addr, (void**)&src, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS )
-        return status;
+    match_t *m = (match_t *)arg;
+    vx_uint32 nx = m->block_x, ny = m->block_y;
+    vx_float64 scale = 1.0 / ((vx_float64)nx * ny);
+    match_complex_t *z = (match_complex_t *)malloc(nx * ny * sizeof(match_complex_t));
+    match_complex_t *column = (match_complex_t *)malloc(ny * sizeof(match_complex_t));
+    vx_uint32 ty;
+
+    if (z == NULL || column == NULL)
+    {
+        m->failed[start] = vx_true_e;
+        start = end;
+    }
 
-    status |= vxGetValidRegionImage(result_image, &result_rect);
-    status |= vxMapImagePatch(result_image, &result_rect, 0, &result_map_id, &result_addr, (void**)&result_src, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS )
-        return status;
-    /* main loop - through x coordinate of the result */
-    for( x = 0; x < result_width; x++ )
+    for (ty = start; ty < end; ty++)
     {
-        vx_uint8 *imgPtr = imgBuf + x;
-        /* update sums and image band buffer */
-        if( x > 0 )
+        vx_uint32 by = ty * m->step_y;
+        vx_uint32 tx;
+
+        for (tx = 0; tx < m->tiles_x; tx += 2)
         {
-            source_x = x + template_width - 1;
-            vx_uint8 *dst = imgPtr - 1;
+            vx_uint32 bx = tx * m->step_x;
+            vx_bool pair = (vx_bool)(tx + 1 < m->tiles_x);
+            vx_uint32 k, u, v;
 
-            dst += template_width;
+            match_load_tile(m, z, bx, by, pair);
+            match_fft_2d(m, z, column, vx_false_e);
+            for (k = 0; k < nx * ny; k++)
+            {
+                /* (A + iB) T* keeps the two tiles apart in the real and imaginary parts */
+                const match_complex_t *t = &m->templ_spectrum[k];
+                match_complex_t p = z[k];
+                z[k].re = p.re * t->re + p.im * t->im;
+                z[k].im = p.im * t->re - p.re * t->im;
+            }
+            match_fft_2d(m, z, column, vx_true_e);
 
-            for( y = 0; y < (vx_int32)src_height; y++, source_x+=src_width, dst += template_width )
+            /* only the first step_x x step_y results of a tile have not wrapped around */
+            for (v = 0; v < m->step_y && by + v < (vx_uint32)m->res_height; v++)
             {
-                vx_uint8* srcp = vxFormatImagePatchAddress1d(src, (vx_uint32)source_x, &addr);
-                dst[0] = srcp[0];
+                const match_complex_t *pr = z + v * nx;
+                for (u = 0; u < m->step_x && bx + u < (vx_uint32)m->res_width; u++)
+                {
+                    match_fft_store(m, bx + u, by + v, match_round(pr[u].re, scale));
+                    if (pair && bx + m->step_x + u < (vx_uint32)m->res_width)
+                        match_fft_store(m, bx + m->step_x + u, by + v, match_round(pr[u].im, scale));
+                }
             }
         }
+    }
 
-        for( y = 0; y < result_height; y++, imgPtr += template_width )
-        {
-            vx_int64 res_L2 =  vxCompareBlocksL2_8u(imgPtr, templBuf, winLen);
-            vx_int64 res =  vxCompareBlocksL2_Square_8u(imgPtr, templBuf, winLen);
-            resNum[y] = res;
-            sqsumBuf[y] = res_L2;
-        }
+    free(column);
+    free(z);
+}
 
-        for( y = 0; y < result_height; y++ )
-        {
-            vx_float64 res = ((vx_float64)sqsumBuf[y]/sqrt((vx_float64)resNum[y]));
-            vx_int16 *result_srcp = vxFormatImagePatchAddress2d(result_src, x, y, &result_addr);
-            *result_srcp = (vx_int16)res;
-        }
-    }
-    if (status == VX_SUCCESS)
-    {
-        status |= vxUnmapImagePatch(source_image, map_id);
-        status |= vxUnmapImagePatch(result_image, result_map_id);
-    }
-    return status;
+/* the tile length along an axis the template spans dim pixels of */
+static vx_uint32 match_fft_length(vx_uint32 dim)
+{
+    vx_uint32 n = 64;
+    while (n < 4 * dim && n < 512)
+        n <<= 1;
+    while (n < 2 * dim)
+        n <<= 1;
+    return n;
 }
 
-vx_status matchTemplate_COMPARE_CCORR_NORM(const vx_image source_image, vx_uint32 src_width, vx_uint32 src_height,
-               const vx_image template_image, vx_uint32 template_width, vx_uint32 template_height,
-               vx_image result_image, void *pBuffer)
+static vx_uint32 *match_fft_bitrev(vx_uint32 n)
 {
-    vx_status status = VX_SUCCESS;
-    vx_uint8 *imgBuf = 0;
-    vx_uint8 *templBuf = 0;
-    vx_int64 *sqsumBuf = 0;
-    vx_int64 *resNum = 0;
-    vx_int64 *resDenom = 0;
-    vx_float64 templCoeff = 0;
-    vx_int32 winLen = template_width * template_height;
-    vx_int32 result_width = src_width - template_width + 1;
-    vx_int32 result_height = src_height - template_height + 1;
-    vx_int32 x, y;
+    vx_uint32 *bitrev = (vx_uint32 *)malloc(n * sizeof(vx_uint32));
+    vx_uint32 bits = 0, i, k;
 
-    vx_status result = vxMatchTemplateEntry(source_image, src_width, src_height,
-                                             template_image, template_width, template_height,
-                                             result_image, pBuffer,
-                                             0, 1,
-                                             (void **) &imgBuf, (void **) &templBuf,
-                                             0, (void **)&sqsumBuf,
-                                             (void **) &resNum, (void **) &resDenom );
-    if( result != VX_SUCCESS ) return result;
-    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
-    vx_map_id map_id = 0;
-    vx_map_id result_map_id = 0;
-    vx_rectangle_t rect;
-    vx_rectangle_t result_rect;
-    vx_uint8 *src = NULL;
-    vx_int16 *result_src = NULL;
-    vx_size source_x = 0;
-    status |= vxGetValidRegionImage(source_image, &rect);
-    status |= vxMapImagePatch(source_image, &rect, 0, &map_id, &addr, (void**)&src, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-
-    vx_imagepatch_addressing_t result_addr = VX_IMAGEPATCH_ADDR_INIT;
-    status |= vxGetValidRegionImage(result_image, &result_rect);
-    status |= vxMapImagePatch(result_image, &result_rect, 0, &result_map_id, &result_addr, (void**)&result_src, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
-    if( status != VX_SUCCESS ) return status;
-
-    /* calc common statistics for template and image */
+    for (k = n; k > 1; k >>= 1)
+        bits++;
+    for (i = 0; bitrev && i < n; i++)
     {
-        //compute sqrt{sum_{grave{x},grave{y}}^{w,h} T(grave{x},grave{y})^2}
-        vx_uint8 *rowPtr = (vx_uint8 *) imgBuf;
-        vx_int64 templSqsum =vxCrossCorr_8u( templBuf, templBuf, winLen );
-
-        templCoeff = (vx_float64) templSqsum;
-        templCoeff = vxInvSqrt64d( fabs( templCoeff ) + FLT_EPSILON );
+        vx_uint32 r = 0;
+        for (k = 0; k < bits; k++)
+            r |= ((i >> k) & 1) << (bits - 1 - k);
+        bitrev[i] = r;
+    }
+    return bitrev;
+}
 
-        //compute sum_{grave{x},grave{y}}^{w,h} I(x+grave{x},y+grave{y})^2
-        for( y = 0; y < (vx_int32)src_height; y++, rowPtr += template_width )
-        {
-            sqsumBuf[y] = vxCrossCorr_8u( rowPtr, rowPtr, template_width );
-        }
+static vx_status match_fft_setup(match_t *m)
+{
+    vx_uint32 nx, ny, i, k;
+    match_complex_t *column;
+
+    nx = match_fft_length((vx_uint32)m->templ_width);
+    ny = match_fft_length((vx_uint32)m->templ_height);
+    m->block_x = nx;
+    m->block_y = ny;
+    m->step_x = nx - m->templ_width + 1;
+    m->step_y = ny - m->templ_height + 1;
+    m->tiles_x = (m->res_width + m->step_x - 1) / m->step_x;
+    m->twiddle_len = nx > ny ? nx : ny;
+    m->twiddles = (match_complex_t *)malloc(m->twiddle_len / 2 * sizeof(match_complex_t));
+    m->bitrev_x = match_fft_bitrev(nx);
+    m->bitrev_y = match_fft_bitrev(ny);
+    m->templ_spectrum = (match_complex_t *)calloc(nx * ny, sizeof(match_complex_t));
+    column = (match_complex_t *)malloc(ny * sizeof(match_complex_t));
+    if (m->twiddles == NULL || m->bitrev_x == NULL || m->bitrev_y == NULL ||
+        m->templ_spectrum == NULL || column == NULL)
+    {
+        free(column);
+        return VX_ERROR_NO_MEMORY;
     }
 
-    /* main loop - through x coordinate of the result */
-    for( x = 0; x < result_width; x++ )
+    for (i = 0; i < m->twiddle_len / 2; i++)
     {
-        vx_int64 sqsum = 0;
-        vx_uint8 *imgPtr = imgBuf + x;
-        /* update sums and image band buffer */
-        if( x > 0 )
-        {
-            source_x = x + template_width - 1;
-            vx_uint8 *dst = imgPtr - 1;
-            vx_int32 out_val = dst[0];
-            dst += template_width;
+        m->twiddles[i].re = cos(-2.0 * MATCH_PI * i / m->twiddle_len);
+        m->twiddles[i].im = sin(-2.0 * MATCH_PI * i / m->twiddle_len);
+    }
 
-            for( y = 0; y < (vx_int32)src_height; y++, source_x+=src_width, dst += template_width )
-            {
-                vx_uint8* srcp = vxFormatImagePatchAddress1d(src, (vx_uint32)source_x, &addr);
+    /* the template sits in the top left corner */
+    for (i = 0; i < (vx_uint32)m->templ_height; i++)
+    {
+        for (k = 0; k < (vx_uint32)m->templ_width; k++)
+            m->templ_spectrum[i * nx + k].re = m->templ[i * m->templ_width + k];
+    }
+    match_fft_2d(m, m->templ_spectrum, column, vx_false_e);
 
-                vx_int32 in_val = srcp[0];
-                sqsumBuf[y] += (in_val - out_val) * (in_val + out_val);
-                out_val = dst[0];
-                dst[0] = (vx_uint8) in_val;
-            }
-        }
-        //for specific x, compute sqsum from row 0 to row template_height-1
-        for( y = 0; y < (vx_int32)template_height; y++ )
-        {
-            sqsum += sqsumBuf[y];
-        }
+    free(column);
+    return VX_SUCCESS;
+}
 
-        for( y = 0; y < result_height; y++, imgPtr += template_width )
-        {
-            //compute sum_{grave{x},grave{y}}^{w,h} T(grave{x},grave{y}) * I(x+grave{x},y+grave{y})
-            vx_int64 res = vxCrossCorr_8u( imgPtr, templBuf, winLen );
-            if( y > 0 )
-            {
-                //move sqsum down
-                sqsum -= sqsumBuf[y - 1];
-                sqsum += sqsumBuf[y + template_height - 1];
-            }
-            resNum[y] = res;
-            resDenom[y] = sqsum;
-        }
+static vx_status match_build_sqsum(match_t *m)
+{
+    vx_size stride = (vx_size)m->src_width + 1;
+    vx_int32 x, y;
 
-        for( y = 0; y < result_height; y++ )
+    m->sqsum = (vx_int64 *)calloc(stride * (m->src_height + 1), sizeof(vx_int64));
+    if (m->sqsum == NULL)
+        return VX_ERROR_NO_MEMORY;
+    for (y = 0; y < m->src_height; y++)
+    {
+        const vx_uint8 *img = m->src + y * m->src_stride;
+        const vx_int64 *above = m->sqsum + y * stride;
+        vx_int64 *row = m->sqsum + (y + 1) * stride;
+        vx_int64 sum = 0;
+        for (x = 0; x < m->src_width; x++)
         {
-            vx_float64 res = ((vx_float64) resNum[y]) * templCoeff *
-                vxInvSqrt64d( fabs( (vx_float64) resDenom[y] ) + FLT_EPSILON );
-
-            res *= pow(2, 15);
-            vx_int16 *result_srcp = vxFormatImagePatchAddress1d(result_src, x+y*result_width, &result_addr);
-            *result_srcp = (vx_int16)res;
+            sum += img[x] * img[x];
+            row[x + 1] = above[x + 1] + sum;
         }
     }
-    if (status == VX_SUCCESS)
-    {
-        status |= vxUnmapImagePatch(source_image, map_id);
-        status |= vxUnmapImagePatch(result_image, result_map_id);
-    }
-    return status;
+    return VX_SUCCESS;
 }
 
 vx_status vxMatchTemplate(vx_image src, vx_image template_image, vx_scalar matchingMethod, vx_image output)
 {
     vx_status status = VX_SUCCESS;
-    vx_uint32 src_width;
-    vx_uint32 src_height;
-    vx_uint32 template_width;
-    vx_uint32 template_height;
-    vxQueryImage(src, VX_IMAGE_WIDTH, &src_width, sizeof(vx_uint32));
-    vxQueryImage(src, VX_IMAGE_HEIGHT, &src_height, sizeof(vx_uint32));
-    vxQueryImage(template_image, VX_IMAGE_WIDTH, &template_width, sizeof(vx_uint32));
-    vxQueryImage(template_image, VX_IMAGE_HEIGHT, &template_height, sizeof(vx_uint32));
-
-    int bufferSize;
-    vxMatchTemplateGetBufSize(src_width, src_height, template_width, template_height, &bufferSize, 1, 1 );
-
-    void* pBuffer = malloc( bufferSize );
-    vx_int32 matchMethod = 0;
-    vxCopyScalar(matchingMethod, &matchMethod, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
-    switch(matchMethod)
+    vx_uint32 src_width = 0, src_height = 0;
+    vx_uint32 template_width = 0, template_height = 0;
+    vx_uint32 out_width = 0, out_height = 0;
+    vx_imagepatch_addressing_t src_addr = VX_IMAGEPATCH_ADDR_INIT;
+    vx_imagepatch_addressing_t templ_addr = VX_IMAGEPATCH_ADDR_INIT;
+    vx_imagepatch_addressing_t dst_addr = VX_IMAGEPATCH_ADDR_INIT;
+    vx_map_id src_map_id = 0, templ_map_id = 0, dst_map_id = 0;
+    vx_rectangle_t rect;
+    void *src_base = NULL, *templ_base = NULL, *dst_base = NULL;
+    vx_uint8 *templ = NULL;
+    vx_bool use_fft;
+    vx_uint32 y;
+    match_t m;
+
+    memset(&m, 0, sizeof(m));
+    status |= vxQueryImage(src, VX_IMAGE_WIDTH, &src_width, sizeof(vx_uint32));
+    status |= vxQueryImage(src, VX_IMAGE_HEIGHT, &src_height, sizeof(vx_uint32));
+    status |= vxQueryImage(template_image, VX_IMAGE_WIDTH, &template_width, sizeof(vx_uint32));
+    status |= vxQueryImage(template_image, VX_IMAGE_HEIGHT, &template_height, sizeof(vx_uint32));
+    status |= vxQueryImage(output, VX_IMAGE_WIDTH, &out_width, sizeof(vx_uint32));
+    status |= vxQueryImage(output, VX_IMAGE_HEIGHT, &out_height, sizeof(vx_uint32));
+    status |= vxCopyScalar(matchingMethod, &m.method, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    if (status != VX_SUCCESS)
+        return status;
+    if (template_width == 0 || template_height == 0 || template_width > src_width || template_height > src_height)
+        return VX_ERROR_INVALID_PARAMETERS;
+    switch (m.method)
     {
         case VX_COMPARE_HAMMING:
-            {
-                matchTemplate_HAMMING(src, src_width, src_height,
-                        template_image, template_width, template_height,
-                        output, pBuffer);
-                break;
-            }
         case VX_COMPARE_L1:
-            {
-                matchTemplate_COMPARE_L1(src, src_width, src_height,
-                        template_image, template_width, template_height,
-                        output, pBuffer);
-                break;
-            }
         case VX_COMPARE_L2:
-            {
-                matchTemplate_COMPARE_L2(src, src_width, src_height,
-                        template_image, template_width, template_height,
-                        output, pBuffer);
-                break;
-            }
         case VX_COMPARE_CCORR:
-            {
-                matchTemplate_CCORR(src, src_width, src_height,
-                        template_image, template_width, template_height,
-                        output, pBuffer);
-                break;
-            }
         case VX_COMPARE_L2_NORM:
+        case VX_COMPARE_CCORR_NORM:
+            break;
+        default:
+            return VX_ERROR_INVALID_PARAMETERS;
+    }
+
+    m.src_width = (vx_int32)src_width;
+    m.src_height = (vx_int32)src_height;
+    m.templ_width = (vx_int32)template_width;
+    m.templ_height = (vx_int32)template_height;
+    m.res_width = (vx_int32)(src_width - template_width + 1 < out_width ? src_width - template_width + 1 : out_width);
+    m.res_height = (vx_int32)(src_height - template_height + 1 < out_height ? src_height - template_height + 1 : out_height);
+    m.winCoeff = 1. / (template_width * template_height + DBL_EPSILON);
+
+    /* the template is small, keep a contiguous copy of it */
+    templ = (vx_uint8 *)malloc(template_width * template_height);
+    if (templ == NULL)
+        return VX_ERROR_NO_MEMORY;
+    rect.start_x = 0;
+    rect.start_y = 0;
+    rect.end_x = template_width;
+    rect.end_y = template_height;
+    status = vxMapImagePatch(template_image, &rect, 0, &templ_map_id, &templ_addr, &templ_base, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (status == VX_SUCCESS)
+    {
+        for (y = 0; y < template_height; y++)
+            memcpy(templ + y * template_width, (vx_uint8 *)templ_base + y * templ_addr.stride_y, template_width);
+        status = vxUnmapImagePatch(template_image, templ_map_id);
+    }
+    if (status != VX_SUCCESS)
+    {
+        free(templ);
+        return status;
+    }
+    m.templ = templ;
+    m.templSqsum = vxCrossCorr_8u(templ, templ, m.templ_width * m.templ_height);
+    m.templCoeff = vxInvSqrt64d( fabs( (vx_float64)m.templSqsum ) + FLT_EPSILON );
+
+    rect.end_x = src_width;
+    rect.end_y = src_height;
+    status = vxMapImagePatch(src, &rect, 0, &src_map_id, &src_addr, &src_base, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (status == VX_SUCCESS)
+    {
+        rect.end_x = out_width;
+        rect.end_y = out_height;
+        status = vxMapImagePatch(output, &rect, 0, &dst_map_id, &dst_addr, &dst_base, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+        if (status == VX_SUCCESS)
+        {
+            m.src = (const vx_uint8 *)src_base;
+            m.src_stride = src_addr.stride_y;
+            m.dst = (vx_uint8 *)dst_base;
+            m.dst_stride = dst_addr.stride_y;
+
+            /* the correlations take the frequency domain once the template is large;
+             * Hamming and L1 have no product to transform, and the sum of (I*T)^2 that
+             * L2_NORM divides by is kept exact on the direct path */
+            use_fft = (vx_bool)((m.method == VX_COMPARE_L2 || m.method == VX_COMPARE_CCORR ||
+                                 m.method == VX_COMPARE_CCORR_NORM) &&
+                                template_width * template_height >= MATCH_FFT_MIN_WINDOW);
+
+            if (m.method == VX_COMPARE_CCORR_NORM || (use_fft && m.method == VX_COMPARE_L2))
+                status = match_build_sqsum(&m);
+
+            if (status == VX_SUCCESS && use_fft)
             {
-                matchTemplate_COMPARE_L2_NORM(src, src_width, src_height,
-                        template_image, template_width, template_height,
-                        output, pBuffer);
-                break;
+                status = match_fft_setup(&m);
+                if (status == VX_SUCCESS)
+                {
+                    vx_uint32 tiles_y = (m.res_height + m.step_y - 1) / m.step_y;
+                    vx_uint32 ty;
+
+                    m.failed = (vx_bool *)calloc(tiles_y ? tiles_y : 1, sizeof(vx_bool));
+                    if (m.failed == NULL)
+                        status = VX_ERROR_NO_MEMORY;
+                    else
+                        ParallelForImpl(tiles_y, 1, match_fft_rows, &m);
+                    for (ty = 0; m.failed && ty < tiles_y; ty++)
+                    {
+                        if (m.failed[ty])
+                            status = VX_ERROR_NO_MEMORY;
+                    }
+                }
             }
-        case VX_COMPARE_CCORR_NORM:
+            else if (status == VX_SUCCESS)
             {
-                matchTemplate_COMPARE_CCORR_NORM(src, src_width, src_height,
-                        template_image, template_width, template_height,
-                        output, pBuffer);
-                break;
+                ParallelForImpl((vx_uint32)m.res_height, MATCH_ROWS_PER_THREAD, match_direct_rows, &m);
             }
+            status |= vxUnmapImagePatch(output, dst_map_id);
+        }
+        status |= vxUnmapImagePatch(src, src_map_id);
     }
-    free(pBuffer);
+
+    free(m.failed);
+    free(m.templ_spectrum);
+    free(m.bitrev_y);
+    free(m.bitrev_x);
+    free(m.twiddles);
+    free(m.sqsum);
+    free(templ);
     return status;
 }
-
@@ -59,6 +59,23 @@
 extern "C" {
 #endif
 
+/*! \brief The body of a parallel loop, called with a range [start, end) of its iterations.
+ */
+typedef void (*c_parallel_f)(void *arg, vx_uint32 start, vx_uint32 end);
+
+/*! \brief Splits [0, count) into contiguous ranges of at least grain iterations and runs
+ * them on up to TARGET_NUM_CORES threads, the calling thread included. Returns when all are done.
+ * A loop started from inside a body runs on its calling thread.
+ */
+void ParallelForImpl(vx_uint32 count, vx_uint32 grain, c_parallel_f body, void *arg);
+
+/*! \brief Starts the worker threads ParallelForImpl shares, which stay up until
+ * ParallelForDeinit. Until then ParallelForImpl runs on the calling thread alone.
+ */
+void ParallelForInit(vx_context context);
+
+void ParallelForDeinit(void);
+
 vx_status vxAbsDiff(vx_image in1, vx_image in2, vx_image output);
 
 vx_status vxAccumulate(vx_image input, vx_image accum);
@@ -99,7 +116,13 @@ vx_status vxIntegralImage(vx_image src, vx_image dst);
 vx_status vxTableLookup(vx_image src, vx_lut lut, vx_image dst);
 
 vx_status vxMeanStdDev(vx_image input, vx_scalar mean, vx_scalar stddev);
-vx_status vxMinMaxLoc(vx_image input, vx_scalar minVal, vx_scalar maxVal, vx_array minLoc, vx_array maxLoc, vx_scalar minCount, vx_scalar maxCount);
+/*! \brief The bytes of scratch memory vxMinMaxLoc needs for an image of width x height
+ * and location arrays of the given capacities.
+ */
+vx_size MinMaxLocScratchSizeImpl(vx_uint32 width, vx_uint32 height, vx_size min_capacity, vx_size max_capacity);
+
+vx_status vxMinMaxLoc(vx_image input, vx_scalar minVal, vx_scalar maxVal, vx_array minLoc, vx_array maxLoc, vx_scalar minCount, vx_scalar maxCount,
+                      void *scratch, vx_size scratch_size);
 vx_status vxWeightedAverage(vx_image img1, vx_scalar alpha, vx_image img2, vx_image output);
 vx_status vxErode3x3(vx_image src, vx_image dst, vx_border_t *bordermode);
 vx_status vxDilate3x3(vx_image src, vx_image dst, vx_border_t *bordermode);
@@ -112,7 +135,10 @@ vx_status vxOpticalFlowPyrLK(/*p1, p2, p3...*/);
 
 vx_status vxPhase(vx_image grad_x, vx_image grad_y, vx_image output);
 
-vx_status vxScaleImage(vx_image src_image, vx_image dst_image, vx_scalar stype, vx_border_t *bordermode, vx_float64 *interm, vx_size size);
+/*! \brief The bytes of node local data vxScaleImage keeps its coordinate tables in. */
+vx_size ScaleImageCacheSizeImpl(vx_uint32 dst_width, vx_uint32 dst_height);
+
+vx_status vxScaleImage(vx_image src_image, vx_image dst_image, vx_scalar stype, vx_border_t *bordermode, void *cache, vx_size size);
 
 vx_status vxSobel3x3(vx_image input, vx_image grad_x, vx_image grad_y, vx_border_t *bordermode);
 
@@ -150,6 +176,9 @@ enum TensorCFmt
     TENSOR_C_FMT_Q78,
     TENSOR_C_FMT_U8,
     TENSOR_C_FMT_S8,
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+    TENSOR_C_FMT_F16,   // IEEE half, computed in float by the NN kernels
+#endif
 };
 
 void ElementwiseTensorOpImpl(
@@ -168,6 +197,7 @@ vx_status TransposeTensorKernelImpl(
         vx_scalar sc_dim2,
         vx_tensor out,
         vx_size el_size);
+
 vx_status vxTensorMultiply(vx_tensor in0, vx_tensor in1, vx_scalar scale_param, vx_scalar opolicy_param, vx_scalar rpolicy_param, vx_tensor output);
 vx_status vxTensorMultiplyF16(vx_tensor in0, vx_tensor in1, vx_scalar scale_param, vx_scalar opolicy_param, vx_scalar rpolicy_param, vx_tensor output);
 vx_status vxTensorAdd(vx_tensor in0, vx_tensor in1, vx_scalar policy_param, vx_tensor output);
@@ -214,7 +244,18 @@ void SampleSoftmaxQ78Kernel(
         const void * input_ptr, tensor_desc_t input,
         void * output_ptr, tensor_desc_t output);
 
-vx_status NNNormalizationKernelImpl(vx_tensor inputs, vx_scalar type_scalar, vx_scalar norm_size_scalar, vx_scalar alpha_scalar, vx_scalar beta_scalar, vx_tensor outputs);
+/*! \brief The bytes of node local data NNNormalizationKernelImpl keeps its PWL table in.
+ */
+vx_size NNNormalizationCacheSizeImpl(void);
+
+/*! \brief Builds the PWL table for the given normalization parameters into node local data
+ * of NNNormalizationCacheSizeImpl bytes, ahead of the first NNNormalizationKernelImpl call.
+ */
+vx_status NNNormalizationCacheInitImpl(vx_scalar type_scalar, vx_scalar norm_size_scalar, vx_scalar alpha_scalar, vx_scalar beta_scalar,
+        void *cache, vx_size cache_size);
+
+vx_status NNNormalizationKernelImpl(vx_tensor inputs, vx_scalar type_scalar, vx_scalar norm_size_scalar, vx_scalar alpha_scalar, vx_scalar beta_scalar, vx_tensor outputs,
+        void *cache, vx_size cache_size);
 
 void ROIPoolingKernelImpl(
         enum TensorCFmt fmt,
@@ -265,16 +306,32 @@ void ActivationKernelImpl(
         float a, float b,
         void * output_ptr, tensor_desc_t output);
 
+/*! \brief The bytes of node local data vxBilateralFilter keeps its weight tables in,
+ * or 0 when the diameter is not usable.
+ */
+vx_size BilateralFilterCacheSizeImpl(vx_int32 diameter, vx_enum type, vx_size num_of_dims);
+
 vx_status vxBilateralFilter(void* src, vx_size* src_strides, vx_size* dims, vx_size num_of_dims,
         vx_int32 diameter, vx_float32 sigmaSpace, vx_float32 sigmaValues,
-        void* dst, vx_size* dst_strides, vx_enum type, vx_border_t *bordermode);
+        void* dst, vx_size* dst_strides, vx_enum type, vx_border_t *bordermode,
+        void *cache, vx_size cache_size);
 
-vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array lines_array, vx_scalar num_lines);
+/*! \brief The bytes of scratch memory vxHoughLinesP needs for an image of width x height,
+ * or 0 when the parameters are not usable.
+ */
+vx_size HoughLinesPScratchSizeImpl(vx_uint32 width, vx_uint32 height, const vx_hough_lines_p_t *params);
+
+vx_status vxHoughLinesP(vx_image img, vx_array param_hough_lines_array, vx_array lines_array, vx_scalar num_lines,
+                        void *scratch, vx_size scratch_size);
 
 vx_status vxScalarOperation(vx_scalar scalar_operation, vx_scalar a, vx_scalar b, vx_scalar output);
 vx_status vxSelect(vx_scalar condition, vx_reference true_value, vx_reference false_value, vx_reference output);
 
-vx_status vxHogCells(vx_image img, vx_scalar cell_width, vx_scalar cell_height, vx_scalar num_bins, vx_tensor magnitudes, vx_tensor bins);
+/*! \brief The bytes of node local data vxHogCells keeps its orientation bin table in. */
+vx_size HogCellsCacheSizeImpl(void);
+
+vx_status vxHogCells(vx_image img, vx_scalar cell_width, vx_scalar cell_height, vx_scalar num_bins, vx_tensor magnitudes, vx_tensor bins,
+                     void *cache, vx_size cache_size);
 vx_status vxHogFeatures(vx_image img, vx_tensor magnitudes, vx_tensor bins, vx_array hog_params, vx_scalar hog_param_size, vx_tensor features);
 
 #ifdef __cplusplus
@@ -0,0 +1,124 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <c_model.h>
+#include <vx_internal.h>
+
+#if defined(_WIN32) || defined(UNDER_CE)
+#define C_PARALLEL_THREAD_LOCAL __declspec(thread)
+#else
+#define C_PARALLEL_THREAD_LOCAL __thread
+#endif
+
+#if !defined(TARGET_NUM_CORES) || (TARGET_NUM_CORES < 1)
+#define C_PARALLEL_THREADS (1)
+#else
+#define C_PARALLEL_THREADS (TARGET_NUM_CORES)
+#endif
+
+typedef struct _c_parallel_range_t {
+    c_parallel_f body;
+    void *arg;
+    vx_uint32 start;
+    vx_uint32 end;
+    /*! \brief Posted once the range is done */
+    vx_sem_t *done;
+} c_parallel_range_t;
+
+/*! \brief The workers ParallelForImpl runs on besides the calling thread, or NULL. */
+static vx_threadpool_t *c_parallel_pool = NULL;
+
+/*! \brief Set while a thread runs a range, so a nested loop runs inline instead of
+ * waiting on workers which may all be busy with the outer loop.
+ */
+static C_PARALLEL_THREAD_LOCAL vx_bool c_parallel_busy = vx_false_e;
+
+static vx_bool c_parallel_worker(vx_threadpool_worker_t *worker)
+{
+    c_parallel_range_t *range = (c_parallel_range_t *)worker->data->v1;
+    c_parallel_busy = vx_true_e;
+    range->body(range->arg, range->start, range->end);
+    c_parallel_busy = vx_false_e;
+    ownSemPost(range->done);
+    return vx_true_e;
+}
+
+void ParallelForInit(vx_context context)
+{
+    if ((C_PARALLEL_THREADS > 1) && (c_parallel_pool == NULL))
+    {
+        c_parallel_pool = ownCreateThreadpool(C_PARALLEL_THREADS - 1, VX_INT_MAX_QUEUE_DEPTH,
+                                              sizeof(c_parallel_range_t), c_parallel_worker, context);
+    }
+}
+
+void ParallelForDeinit(void)
+{
+    ownDestroyThreadpool(&c_parallel_pool);
+}
+
+void ParallelForImpl(vx_uint32 count, vx_uint32 grain, c_parallel_f body, void *arg)
+{
+    c_parallel_range_t ranges[C_PARALLEL_THREADS];
+    vx_value_set_t items[C_PARALLEL_THREADS];
+    vx_bool issued[C_PARALLEL_THREADS];
+    vx_uint32 num = (grain > 0) ? count / grain : count;
+    vx_uint32 t;
+    vx_sem_t done;
+
+    if (num > C_PARALLEL_THREADS)
+        num = C_PARALLEL_THREADS;
+    if ((num <= 1) || (c_parallel_pool == NULL) || c_parallel_busy ||
+        (ownCreateSem(&done, 0) == vx_false_e))
+    {
+        if (count > 0)
+            body(arg, 0, count);
+        return;
+    }
+
+    for (t = 0; t < num; t++)
+    {
+        ranges[t].body = body;
+        ranges[t].arg = arg;
+        ranges[t].start = (vx_uint32)(((vx_uint64)count * t) / num);
+        ranges[t].end = (vx_uint32)(((vx_uint64)count * (t + 1)) / num);
+        ranges[t].done = &done;
+        issued[t] = vx_false_e;
+        if (t == 0)
+            continue;
+        items[t].v1 = (vx_value_t)&ranges[t];
+        items[t].v2 = 0;
+        items[t].v3 = 0;
+        issued[t] = ownIssueThreadpool(c_parallel_pool, &items[t], 1);
+    }
+
+    /* the calling thread takes the first range, and any range the pool did not accept */
+    c_parallel_busy = vx_true_e;
+    body(arg, ranges[0].start, ranges[0].end);
+    for (t = 1; t < num; t++)
+    {
+        if (issued[t] == vx_false_e)
+            body(arg, ranges[t].start, ranges[t].end);
+    }
+    c_parallel_busy = vx_false_e;
+    for (t = 1; t < num; t++)
+    {
+        if (issued[t])
+            ownSemWait(&done);
+    }
+    ownDestroySem(&done);
+}
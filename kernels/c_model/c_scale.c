@@ -16,6 +16,8 @@
  */
 
 #include <c_model.h>
+#include <stdlib.h>
+#include <string.h>
 
 // helpers
 
@@ -118,128 +120,252 @@ static vx_bool read_pixel_16s(void *base, vx_imagepatch_addressing_t *addr,
 }
 
 
-static vx_status vxNearestScaling(vx_image src_image, vx_image dst_image, const vx_border_t *borders)
-{
-    vx_status status = VX_SUCCESS;
-    vx_int32 x1, y1, x2, y2;
-    void *src_base = NULL, *dst_base = NULL;
-    vx_rectangle_t src_rect, dst_rect;
-    vx_imagepatch_addressing_t src_addr, dst_addr;
-    vx_uint32 w1 = 0, h1 = 0, w2 = 0, h2 = 0;
-    vx_float32 wr, hr;
-    vx_df_image format = 0;
+/*! \brief Rows of the destination each thread takes at a time. */
+#define SCALE_ROWS_PER_THREAD (16)
 
-    vxQueryImage(src_image, VX_IMAGE_WIDTH, &w1, sizeof(w1));
-    vxQueryImage(src_image, VX_IMAGE_HEIGHT, &h1, sizeof(h1));
-    vxQueryImage(src_image, VX_IMAGE_FORMAT, &format, sizeof(format));
+/*! \brief The source coordinates of every destination column and row, kept in node
+ * local data. They only change with the sizes, the valid region, the format or the
+ * interpolation, so a node scaling a stream of frames computes them once.
+ */
+typedef struct _scale_tables_t {
+    vx_bool valid;
+    vx_uint32 key[10];
+    vx_int32 *x1;       /* left (nearest) source column of each destination column */
+    vx_int32 *y1;       /* top (nearest) source row of each destination row */
+    vx_float32 *s;      /* horizontal weight of the right column, bilinear only */
+    vx_float32 *t;      /* vertical weight of the bottom row, bilinear only */
+} scale_tables_t;
+
+typedef struct _scale_t {
+    void *src_base;
+    vx_imagepatch_addressing_t *src_addr;
+    void *dst_base;
+    vx_imagepatch_addressing_t *dst_addr;
+    const vx_border_t *borders;
+    vx_df_image format;
+    vx_uint32 shift_x_u1;
+    vx_uint32 w2;
+    const scale_tables_t *tables;
+    vx_uint32 kx, ky;   /* exact 2:1 or 4:1 downscale factors, 0 when not */
+} scale_t;
+
+vx_size ScaleImageCacheSizeImpl(vx_uint32 dst_width, vx_uint32 dst_height)
+{
+    return sizeof(scale_tables_t) + (vx_size)(dst_width + dst_height) * (sizeof(vx_int32) + sizeof(vx_float32));
+}
 
-    vxQueryImage(dst_image, VX_IMAGE_WIDTH, &w2, sizeof(w2));
-    vxQueryImage(dst_image, VX_IMAGE_HEIGHT, &h2, sizeof(h2));
+static void scale_layout(scale_tables_t *tables, vx_uint32 w2, vx_uint32 h2)
+{
+    vx_uint8 *p = (vx_uint8 *)(tables + 1);
+    tables->x1 = (vx_int32 *)p;   p += w2 * sizeof(vx_int32);
+    tables->y1 = (vx_int32 *)p;   p += h2 * sizeof(vx_int32);
+    tables->s  = (vx_float32 *)p; p += w2 * sizeof(vx_float32);
+    tables->t  = (vx_float32 *)p;
+}
 
-    dst_rect.start_x = dst_rect.start_y = 0;
-    dst_rect.end_x = w2;
-    dst_rect.end_y = h2;
+/* the same float steps as were taken for every pixel, once per coordinate */
+static void scale_axis(vx_uint32 n2, vx_float32 ratio, vx_uint32 start, vx_uint32 shift_u1, vx_enum type, vx_int32 *i1, vx_float32 *frac)
+{
+    vx_uint32 i2;
+    for (i2 = 0; i2 < n2; i2++)
+    {
+        vx_float32 src = ((vx_float32)i2 + 0.5f)*ratio - 0.5f;
+        vx_float32 src_min;
+
+        // Switch to coordinates in the mapped image patch
+        src = src - start + shift_u1;
+        src_min = floorf(src);
+        i1[i2] = (vx_int32)src_min;
+        frac[i2] = src - src_min;
+        if (type == VX_INTERPOLATION_NEAREST_NEIGHBOR && frac[i2] >= 0.5f)
+            i1[i2]++;
+    }
+}
 
-    status = VX_SUCCESS;
-    status |= vxGetValidRegionImage(src_image, &src_rect);
-    status |= vxAccessImagePatch(src_image, &src_rect, 0, &src_addr, &src_base, VX_READ_ONLY);
-    status |= vxAccessImagePatch(dst_image, &dst_rect, 0, &dst_addr, &dst_base, VX_WRITE_ONLY);
+static void scale_build(scale_tables_t *tables, const vx_uint32 key[10], vx_uint32 w1, vx_uint32 h1, vx_uint32 w2, vx_uint32 h2,
+                        const vx_rectangle_t *src_rect, vx_df_image format, vx_enum type)
+{
+    vx_float32 wr = (vx_float32)w1/(vx_float32)w2;
+    vx_float32 hr = (vx_float32)h1/(vx_float32)h2;
+
+    scale_layout(tables, w2, h2);
+    if (tables->valid && memcmp(tables->key, key, sizeof(tables->key)) == 0)
+        return;
+    scale_axis(w2, wr, src_rect->start_x, format == VX_DF_IMAGE_U1 ? src_rect->start_x % 8 : 0, type, tables->x1, tables->s);
+    scale_axis(h2, hr, src_rect->start_y, 0, type, tables->y1, tables->t);
+    memcpy(tables->key, key, sizeof(tables->key));
+    tables->valid = vx_true_e;
+}
 
-    wr = (vx_float32)w1/(vx_float32)w2;
-    hr = (vx_float32)h1/(vx_float32)h2;
+static void scale_nearest_rows(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const scale_t *c = (const scale_t *)arg;
+    const vx_imagepatch_addressing_t *src_addr = c->src_addr;
+    vx_uint32 x2, y2;
 
-    for (y2 = 0; y2 < (vx_int32)h2; y2++)
+    for (y2 = start; y2 < end; y2++)
     {
-        for (x2 = 0; x2 < (vx_int32)w2; x2++)
+        vx_int32 y1 = c->tables->y1[y2];
+        vx_bool row_in = (y1 >= 0 && y1 < (vx_int32)src_addr->dim_y) ? vx_true_e : vx_false_e;
+        vx_uint8 *src_row = (vx_uint8 *)c->src_base + (row_in ? y1 : 0) * src_addr->stride_y;
+        vx_uint8 *dst_row = (vx_uint8 *)c->dst_base + y2 * c->dst_addr->stride_y;
+
+        for (x2 = 0; x2 < c->w2; x2++)
         {
-            if (VX_DF_IMAGE_U1 == format)
+            vx_int32 x1 = c->tables->x1[x2];
+            vx_bool in = (row_in && x1 >= 0 && x1 < (vx_int32)src_addr->dim_x) ? vx_true_e : vx_false_e;
+            if (VX_DF_IMAGE_U1 == c->format)
             {
                 vx_uint8 v = 0;
-                vx_uint8 *dst = (vx_uint8*)vxFormatImagePatchAddress2d(dst_base, x2, y2, &dst_addr);
-                vx_float32 x_src = ((vx_float32)x2 + 0.5f)*wr - 0.5f;
-                vx_float32 y_src = ((vx_float32)y2 + 0.5f)*hr - 0.5f;
-
-                // Switch to coordinates in the mapped image patch
-                x_src = x_src - src_rect.start_x + src_rect.start_x % 8;
-                y_src = y_src - src_rect.start_y;
-                vx_float32 x_min = floorf(x_src);
-                vx_float32 y_min = floorf(y_src);
-                x1 = (vx_int32)x_min;
-                y1 = (vx_int32)y_min;
-
-                if (x_src - x_min >= 0.5f)
-                    x1++;
-                if (y_src - y_min >= 0.5f)
-                    y1++;
-
-                if (dst && vx_true_e == read_pixel_1u(src_base, &src_addr, x1, y1, borders, &v, src_rect.start_x % 8))
+                vx_uint8 *dst = &dst_row[x2 / 8];
+                if (vx_true_e == read_pixel_1u(c->src_base, (vx_imagepatch_addressing_t *)src_addr, x1, y1, c->borders, &v, c->shift_x_u1))
                     *dst = (*dst & ~(1 << (x2 % 8))) | (v << (x2 % 8));
             }
-            else if (VX_DF_IMAGE_U8 == format)
+            else if (VX_DF_IMAGE_U8 == c->format)
             {
                 vx_uint8 v = 0;
-                vx_uint8 *dst = (vx_uint8*)vxFormatImagePatchAddress2d(dst_base, x2, y2, &dst_addr);
-                vx_float32 x_src = ((vx_float32)x2 + 0.5f)*wr - 0.5f;
-                vx_float32 y_src = ((vx_float32)y2 + 0.5f)*hr - 0.5f;
-
-                // Switch to coordinates in the mapped image patch
-                x_src = x_src - src_rect.start_x;
-                y_src = y_src - src_rect.start_y;
-                vx_float32 x_min = floorf(x_src);
-                vx_float32 y_min = floorf(y_src);
-                x1 = (vx_int32)x_min;
-                y1 = (vx_int32)y_min;
-
-                if (x_src - x_min >= 0.5f)
-                    x1++;
-                if (y_src - y_min >= 0.5f)
-                    y1++;
-                //printf("x2,y2={%u,%u} => x1,y1={%u,%u}\n", x2,y2,x1,y1);
-                if (dst && vx_true_e == read_pixel_8u(src_base, &src_addr, x1, y1, borders, &v))
-                    *dst = v;
+                if (in)
+                    dst_row[x2 * c->dst_addr->stride_x] = src_row[x1 * src_addr->stride_x];
+                else if (vx_true_e == read_pixel_8u(c->src_base, (vx_imagepatch_addressing_t *)src_addr, x1, y1, c->borders, &v))
+                    dst_row[x2 * c->dst_addr->stride_x] = v;
             }
             else
             {
                 vx_int16 v = 0;
-                vx_int16* dst = (vx_int16*)vxFormatImagePatchAddress2d(dst_base, x2, y2, &dst_addr);
-                vx_float32 x_src = ((vx_float32)x2 + 0.5f)*wr - 0.5f;
-                vx_float32 y_src = ((vx_float32)y2 + 0.5f)*hr - 0.5f;
-
-                // Switch to coordinates in the mapped image patch
-                x_src = x_src - src_rect.start_x;
-                y_src = y_src - src_rect.start_y;
-                vx_float32 x_min = floorf(x_src);
-                vx_float32 y_min = floorf(y_src);
-                x1 = (vx_int32)x_min;
-                y1 = (vx_int32)y_min;
-
-                if (x_src - x_min >= 0.5f)
-                    x1++;
-                if (y_src - y_min >= 0.5f)
-                    y1++;
-
-                if (dst && vx_true_e == read_pixel_16s(src_base, &src_addr, x1, y1, borders, &v))
-                    *dst = v;
+                if (in)
+                    *(vx_int16 *)&dst_row[x2 * c->dst_addr->stride_x] = *(vx_int16 *)&src_row[x1 * src_addr->stride_x];
+                else if (vx_true_e == read_pixel_16s(c->src_base, (vx_imagepatch_addressing_t *)src_addr, x1, y1, c->borders, &v))
+                    *(vx_int16 *)&dst_row[x2 * c->dst_addr->stride_x] = v;
             }
         }
     }
+}
 
-    status |= vxCommitImagePatch(src_image, NULL, 0, &src_addr, src_base);
-    status |= vxCommitImagePatch(dst_image, &dst_rect, 0, &dst_addr, dst_base);
+static vx_float32 bilinear_value(vx_float32 s, vx_float32 t, vx_uint8 tl, vx_uint8 tr, vx_uint8 bl, vx_uint8 br)
+{
+    return (1 - s) * (1 - t) * tl +
+           (    s) * (1 - t) * tr +
+           (1 - s) * (    t) * bl +
+           (    s) * (    t) * br;
+}
 
-    return VX_SUCCESS;
+/* a destination pixel whose taps are not all inside the source, or of a U1 image */
+static vx_bool bilinear_border_pixel(const scale_t *c, vx_int32 x1, vx_int32 y1, vx_float32 s, vx_float32 t, vx_uint8 *out)
+{
+    vx_imagepatch_addressing_t *src_addr = c->src_addr;
+    vx_uint8 tl = 0, tr = 0, bl = 0, br = 0;
+    vx_bool defined_tl, defined_tr, defined_bl, defined_br;
+    if (c->format == VX_DF_IMAGE_U1)
+    {
+        defined_tl = read_pixel_1u(c->src_base, src_addr, x1 + 0, y1 + 0, c->borders, &tl, c->shift_x_u1);
+        defined_tr = read_pixel_1u(c->src_base, src_addr, x1 + 1, y1 + 0, c->borders, &tr, c->shift_x_u1);
+        defined_bl = read_pixel_1u(c->src_base, src_addr, x1 + 0, y1 + 1, c->borders, &bl, c->shift_x_u1);
+        defined_br = read_pixel_1u(c->src_base, src_addr, x1 + 1, y1 + 1, c->borders, &br, c->shift_x_u1);
+    }
+    else
+    {
+        defined_tl = read_pixel_8u(c->src_base, src_addr, x1 + 0, y1 + 0, c->borders, &tl);
+        defined_tr = read_pixel_8u(c->src_base, src_addr, x1 + 1, y1 + 0, c->borders, &tr);
+        defined_bl = read_pixel_8u(c->src_base, src_addr, x1 + 0, y1 + 1, c->borders, &bl);
+        defined_br = read_pixel_8u(c->src_base, src_addr, x1 + 1, y1 + 1, c->borders, &br);
+    }
+    vx_bool defined = defined_tl & defined_tr & defined_bl & defined_br;
+    if (defined == vx_false_e)
+    {
+        vx_bool defined_any = defined_tl | defined_tr | defined_bl | defined_br;
+        if (defined_any)
+        {
+            if ((defined_tl == vx_false_e || defined_tr == vx_false_e) && fabs(t - 1.0) <= 0.001)
+                defined_tl = defined_tr = vx_true_e;
+            else if ((defined_bl == vx_false_e || defined_br == vx_false_e) && fabs(t - 0.0) <= 0.001)
+                defined_bl = defined_br = vx_true_e;
+            if ((defined_tl == vx_false_e || defined_bl == vx_false_e) && fabs(s - 1.0) <= 0.001)
+                defined_tl = defined_bl = vx_true_e;
+            else if ((defined_tr == vx_false_e || defined_br == vx_false_e) && fabs(s - 0.0) <= 0.001)
+                defined_tr = defined_br = vx_true_e;
+            defined = defined_tl & defined_tr & defined_bl & defined_br;
+        }
+    }
+
+    if (defined == vx_true_e)
+    {
+        vx_float32 ref = bilinear_value(s, t, tl, tr, bl, br);
+        if (c->format == VX_DF_IMAGE_U1)   // Rounding instead of thresholding for U1 images
+            ref = ref + 0.5f;
+
+        if (c->format == VX_DF_IMAGE_U8 && ref > 255)
+            *out = 255;
+        else if (c->format == VX_DF_IMAGE_U1 && ref > 1)
+            *out = 1;
+        else
+            *out = (vx_uint8)ref;
+    }
+    return defined;
+}
+
+static void scale_bilinear_rows(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const scale_t *c = (const scale_t *)arg;
+    const vx_imagepatch_addressing_t *src_addr = c->src_addr;
+    vx_uint32 x2, y2;
+
+    for (y2 = start; y2 < end; y2++)
+    {
+        vx_int32 y1 = c->tables->y1[y2];
+        vx_float32 t = c->tables->t[y2];
+        vx_uint8 *dst_row = (vx_uint8 *)c->dst_base + y2 * c->dst_addr->stride_y;
+
+        if (c->kx)
+        {
+            /* exact 2:1 and 4:1 land halfway between two taps on both axes, where the
+             * weights are all 1/4 and the float sum is exact */
+            const vx_uint8 *r0 = (const vx_uint8 *)c->src_base + (c->ky * y2 + c->ky / 2 - 1) * src_addr->stride_y;
+            const vx_uint8 *r1 = r0 + src_addr->stride_y;
+            for (x2 = 0; x2 < c->w2; x2++)
+            {
+                vx_uint32 x = c->kx * x2 + c->kx / 2 - 1;
+                dst_row[x2] = (vx_uint8)((r0[x] + r0[x + 1] + r1[x] + r1[x + 1]) >> 2);
+            }
+            continue;
+        }
+
+        vx_bool rows_in = (c->format == VX_DF_IMAGE_U8 && y1 >= 0 && y1 + 1 < (vx_int32)src_addr->dim_y) ? vx_true_e : vx_false_e;
+        const vx_uint8 *r0 = (const vx_uint8 *)c->src_base + (rows_in ? y1 : 0) * src_addr->stride_y;
+        const vx_uint8 *r1 = r0 + src_addr->stride_y;
+
+        for (x2 = 0; x2 < c->w2; x2++)
+        {
+            vx_int32 x1 = c->tables->x1[x2];
+            vx_float32 s = c->tables->s[x2];
+            vx_uint8 v = 0;
+
+            if (rows_in && x1 >= 0 && x1 + 1 < (vx_int32)src_addr->dim_x)
+            {
+                vx_float32 ref = bilinear_value(s, t, r0[x1], r0[x1 + 1], r1[x1], r1[x1 + 1]);
+                dst_row[x2] = ref > 255 ? 255 : (vx_uint8)ref;
+            }
+            else if (bilinear_border_pixel(c, x1, y1, s, t, &v) == vx_true_e)
+            {
+                if (c->format == VX_DF_IMAGE_U1)
+                    dst_row[x2 / 8] = (dst_row[x2 / 8] & ~(1 << (x2 % 8))) | (v << (x2 % 8));
+                else if (c->format == VX_DF_IMAGE_U8)
+                    dst_row[x2] = v;
+            }
+        }
+    }
 }
 
-static vx_status vxBilinearScaling(vx_image src_image, vx_image dst_image, const vx_border_t *borders)
+static vx_status vxResampleImage(vx_image src_image, vx_image dst_image, const vx_border_t *borders, vx_enum type,
+                                 void *cache, vx_size cache_size)
 {
     vx_status status = VX_SUCCESS;
-    vx_int32 x2, y2;
     void *src_base = NULL, *dst_base = NULL;
     vx_rectangle_t src_rect, dst_rect;
     vx_imagepatch_addressing_t src_addr, dst_addr;
     vx_uint32 w1 = 0, h1 = 0, w2 = 0, h2 = 0;
-    vx_float32 wr, hr;
     vx_df_image format = 0;
+    void *heap = NULL;
+    scale_t c;
 
     vxQueryImage(src_image, VX_IMAGE_WIDTH, &w1, sizeof(w1));
     vxQueryImage(src_image, VX_IMAGE_HEIGHT, &h1, sizeof(h1));
@@ -248,6 +374,14 @@ static vx_status vxBilinearScaling(vx_image src_image, vx_image dst_image, const
     vxQueryImage(dst_image, VX_IMAGE_WIDTH, &w2, sizeof(w2));
     vxQueryImage(dst_image, VX_IMAGE_HEIGHT, &h2, sizeof(h2));
 
+    if (cache == NULL || cache_size < ScaleImageCacheSizeImpl(w2, h2))
+    {
+        heap = calloc(1, ScaleImageCacheSizeImpl(w2, h2));
+        if (heap == NULL)
+            return VX_ERROR_NO_MEMORY;
+        cache = heap;
+    }
+
     dst_rect.start_x = dst_rect.start_y = 0;
     dst_rect.end_x = w2;
     dst_rect.end_y = h2;
@@ -257,89 +391,37 @@ static vx_status vxBilinearScaling(vx_image src_image, vx_image dst_image, const
     status |= vxAccessImagePatch(src_image, &src_rect, 0, &src_addr, &src_base, VX_READ_ONLY);
     status |= vxAccessImagePatch(dst_image, &dst_rect, 0, &dst_addr, &dst_base, VX_WRITE_ONLY);
 
-    wr = (vx_float32)w1/(vx_float32)w2;
-    hr = (vx_float32)h1/(vx_float32)h2;
-
-    for (y2 = 0; y2 < (vx_int32)h2; y2++)
+    if (status == VX_SUCCESS)
     {
-        for (x2 = 0; x2 < (vx_int32)w2; x2++)
+        vx_uint32 key[10] = { w1, h1, w2, h2, src_rect.start_x, src_rect.start_y, src_addr.dim_x, src_addr.dim_y,
+                              (vx_uint32)format, (vx_uint32)type };
+        vx_bool whole = (src_rect.start_x == 0 && src_rect.start_y == 0 &&
+                         src_addr.dim_x == w1 && src_addr.dim_y == h1) ? vx_true_e : vx_false_e;
+
+        scale_build((scale_tables_t *)cache, key, w1, h1, w2, h2, &src_rect, format, type);
+        c.src_base = src_base;
+        c.src_addr = &src_addr;
+        c.dst_base = dst_base;
+        c.dst_addr = &dst_addr;
+        c.borders = borders;
+        c.format = format;
+        c.shift_x_u1 = src_rect.start_x % 8;
+        c.w2 = w2;
+        c.tables = (const scale_tables_t *)cache;
+        c.kx = c.ky = 0;
+        if (type == VX_INTERPOLATION_BILINEAR && format == VX_DF_IMAGE_U8 && whole &&
+            (w1 == 2 * w2 || w1 == 4 * w2) && (h1 == 2 * h2 || h1 == 4 * h2) && dst_addr.stride_x == 1)
         {
-            vx_uint8 tl = 0, tr = 0, bl = 0, br = 0;
-            vx_uint8 *dst = (vx_uint8*)vxFormatImagePatchAddress2d(dst_base, x2, y2, &dst_addr);
-            vx_float32 x_src = ((vx_float32)x2+0.5f)*wr - 0.5f;
-            vx_float32 y_src = ((vx_float32)y2+0.5f)*hr - 0.5f;
-
-            // Switch to coordinates in the mapped image patch
-            x_src = x_src - src_rect.start_x + (format == VX_DF_IMAGE_U1 ? src_rect.start_x % 8 : 0);
-            y_src = y_src - src_rect.start_y;
-            vx_float32 x_min = floorf(x_src);
-            vx_float32 y_min = floorf(y_src);
-            vx_int32 x1 = (vx_int32)x_min;
-            vx_int32 y1 = (vx_int32)y_min;
-            vx_float32 s = x_src - x_min;
-            vx_float32 t = y_src - y_min;
-
-            vx_bool defined_tl, defined_tr, defined_bl, defined_br;
-            if (format == VX_DF_IMAGE_U1)
-            {
-                defined_tl = read_pixel_1u(src_base, &src_addr, x1 + 0, y1 + 0, borders, &tl, src_rect.start_x % 8);
-                defined_tr = read_pixel_1u(src_base, &src_addr, x1 + 1, y1 + 0, borders, &tr, src_rect.start_x % 8);
-                defined_bl = read_pixel_1u(src_base, &src_addr, x1 + 0, y1 + 1, borders, &bl, src_rect.start_x % 8);
-                defined_br = read_pixel_1u(src_base, &src_addr, x1 + 1, y1 + 1, borders, &br, src_rect.start_x % 8);
-            }
-            else
-            {
-                defined_tl = read_pixel_8u(src_base, &src_addr, x1 + 0, y1 + 0, borders, &tl);
-                defined_tr = read_pixel_8u(src_base, &src_addr, x1 + 1, y1 + 0, borders, &tr);
-                defined_bl = read_pixel_8u(src_base, &src_addr, x1 + 0, y1 + 1, borders, &bl);
-                defined_br = read_pixel_8u(src_base, &src_addr, x1 + 1, y1 + 1, borders, &br);
-            }
-            vx_bool defined = defined_tl & defined_tr & defined_bl & defined_br;
-            if (defined == vx_false_e)
-            {
-                vx_bool defined_any = defined_tl | defined_tr | defined_bl | defined_br;
-                if (defined_any)
-                {
-                    if ((defined_tl == vx_false_e || defined_tr == vx_false_e) && fabs(t - 1.0) <= 0.001)
-                        defined_tl = defined_tr = vx_true_e;
-                    else if ((defined_bl == vx_false_e || defined_br == vx_false_e) && fabs(t - 0.0) <= 0.001)
-                        defined_bl = defined_br = vx_true_e;
-                    if ((defined_tl == vx_false_e || defined_bl == vx_false_e) && fabs(s - 1.0) <= 0.001)
-                        defined_tl = defined_bl = vx_true_e;
-                    else if ((defined_tr == vx_false_e || defined_br == vx_false_e) && fabs(s - 0.0) <= 0.001)
-                        defined_tr = defined_br = vx_true_e;
-                    defined = defined_tl & defined_tr & defined_bl & defined_br;
-                }
-            }
-
-            if (defined == vx_true_e)
-            {
-                vx_float32 ref =
-                        (1 - s) * (1 - t) * tl +
-                        (    s) * (1 - t) * tr +
-                        (1 - s) * (    t) * bl +
-                        (    s) * (    t) * br;
-                vx_uint8 ref_8u;
-                if (format == VX_DF_IMAGE_U1)   // Rounding instead of thresholding for U1 images
-                    ref = ref + 0.5f;
-
-                if (format == VX_DF_IMAGE_U8 && ref > 255)
-                    ref_8u = 255;
-                else if (format == VX_DF_IMAGE_U1 && ref > 1)
-                    ref_8u = 1;
-                else
-                    ref_8u = (vx_uint8)ref;
-
-                if (dst && format == VX_DF_IMAGE_U1)
-                    *dst = (*dst & ~(1 << (x2 % 8))) | (ref_8u << (x2 % 8));
-                else if (dst && format == VX_DF_IMAGE_U8)
-                    *dst = ref_8u;
-            }
+            c.kx = w1 / w2;
+            c.ky = h1 / h2;
         }
+        ParallelForImpl(h2, SCALE_ROWS_PER_THREAD,
+                        type == VX_INTERPOLATION_BILINEAR ? scale_bilinear_rows : scale_nearest_rows, &c);
     }
 
     status |= vxCommitImagePatch(src_image, NULL, 0, &src_addr, src_base);
     status |= vxCommitImagePatch(dst_image, &dst_rect, 0, &dst_addr, dst_base);
+    free(heap);
 
     return VX_SUCCESS;
 }
@@ -457,36 +539,28 @@ static vx_status vxAreaScaling(vx_image src_image, vx_image dst_image, const vx_
 #endif
 
 // nodeless version of the ScaleImage kernel
-vx_status vxScaleImage(vx_image src_image, vx_image dst_image, vx_scalar stype, vx_border_t *bordermode, vx_float64 *interm, vx_size size)
+vx_status vxScaleImage(vx_image src_image, vx_image dst_image, vx_scalar stype, vx_border_t *bordermode, void *cache, vx_size size)
 {
     vx_status status = VX_FAILURE;
     vx_enum type = 0;
 
     vxCopyScalar(stype, &type, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
-    if (interm && size)
+    if (type == VX_INTERPOLATION_BILINEAR)
+    {
+        status = vxResampleImage(src_image, dst_image, bordermode, VX_INTERPOLATION_BILINEAR, cache, size);
+    }
+    else if (type == VX_INTERPOLATION_AREA)
     {
-        if (type == VX_INTERPOLATION_BILINEAR)
-        {
-            status = vxBilinearScaling(src_image, dst_image, bordermode);
-        }
-        else if (type == VX_INTERPOLATION_AREA)
-        {
 #if AREA_SCALE_ENABLE // TODO FIX THIS
-            status = vxAreaScaling(src_image, dst_image, bordermode, interm, size);
+        status = vxAreaScaling(src_image, dst_image, bordermode, (vx_float64 *)cache, size);
 #else
-            status = vxNearestScaling(src_image, dst_image, bordermode);
+        status = vxResampleImage(src_image, dst_image, bordermode, VX_INTERPOLATION_NEAREST_NEIGHBOR, cache, size);
 #endif
-        }
-        else if (type == VX_INTERPOLATION_NEAREST_NEIGHBOR)
-        {
-            status = vxNearestScaling(src_image, dst_image, bordermode);
-        }
     }
-    else
+    else if (type == VX_INTERPOLATION_NEAREST_NEIGHBOR)
     {
-        status = VX_ERROR_NO_RESOURCES;
+        status = vxResampleImage(src_image, dst_image, bordermode, VX_INTERPOLATION_NEAREST_NEIGHBOR, cache, size);
     }
 
     return status;
 }
-
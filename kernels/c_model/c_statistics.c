@@ -16,8 +16,100 @@
  */
 
 #include <c_model.h>
+#include <stdlib.h>
+#include <string.h>
 #include <vx_debug.h>
 
+/*! \brief Rows of the image each thread takes at a time. */
+#define STATISTICS_ROWS_PER_BAND (16)
+
+typedef struct _meanstddev_band_t {
+    vx_uint64 sum;
+    vx_uint64 sum_sqrs;
+    vx_uint32 hist[256];    /* U1 and U8 are counted by value */
+} meanstddev_band_t;
+
+typedef struct _meanstddev_t {
+    const vx_uint8 *base;
+    vx_imagepatch_addressing_t *addrs;
+    vx_df_image format;
+    vx_uint32 width;
+    vx_uint32 height;
+    vx_uint32 shift_x_u1;
+    meanstddev_band_t *bands;
+} meanstddev_t;
+
+static void meanstddev_bands(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    meanstddev_t *m = (meanstddev_t *)arg;
+    vx_uint32 b, x, y;
+
+    for (b = start; b < end; b++)
+    {
+        meanstddev_band_t *band = &m->bands[b];
+        vx_uint32 y0 = b * STATISTICS_ROWS_PER_BAND;
+        vx_uint32 y1 = y0 + STATISTICS_ROWS_PER_BAND < m->height ? y0 + STATISTICS_ROWS_PER_BAND : m->height;
+
+        for (y = y0; y < y1; y++)
+        {
+            const vx_uint8 *row = m->base + y * m->addrs->stride_y;
+            if (m->format == VX_DF_IMAGE_U1)
+            {
+                vx_uint32 ones = 0;
+                for (x = 0; x < m->width; x++)
+                {
+                    vx_uint32 bit = x + m->shift_x_u1;
+                    ones += (row[bit / 8] >> (bit % 8)) & 1;
+                }
+                band->hist[1] += ones;
+                band->hist[0] += m->width - ones;
+            }
+            else if (m->format == VX_DF_IMAGE_U8)
+            {
+                for (x = 0; x < m->width; x++)
+                    band->hist[row[x]]++;
+            }
+            else if (m->format == VX_DF_IMAGE_U16)
+            {
+                const vx_uint16 *pixels = (const vx_uint16 *)row;
+                vx_uint64 sum = 0, sum_sqrs = 0;
+                for (x = 0; x < m->width; x++)
+                {
+                    vx_uint32 v = pixels[x];
+                    sum += v;
+                    sum_sqrs += (vx_uint64)(v * v);
+                }
+                band->sum += sum;
+                band->sum_sqrs += sum_sqrs;
+            }
+        }
+    }
+}
+
+/* a * b as a 128 bit number hi:lo */
+static void meanstddev_mul64(vx_uint64 a, vx_uint64 b, vx_uint64 *hi, vx_uint64 *lo)
+{
+    vx_uint64 a0 = a & 0xFFFFFFFFu, a1 = a >> 32;
+    vx_uint64 b0 = b & 0xFFFFFFFFu, b1 = b >> 32;
+    vx_uint64 p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    vx_uint64 mid = (p00 >> 32) + (p01 & 0xFFFFFFFFu) + (p10 & 0xFFFFFFFFu);
+
+    *lo = (mid << 32) | (p00 & 0xFFFFFFFFu);
+    *hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+/* n^2 times the variance, n sum(p^2) - sum(p)^2, worked out exactly before it is rounded */
+static vx_float64 meanstddev_scaled_variance(vx_uint64 n, vx_uint64 sum, vx_uint64 sum_sqrs)
+{
+    vx_uint64 hi1, lo1, hi2, lo2, hi, lo;
+
+    meanstddev_mul64(n, sum_sqrs, &hi1, &lo1);
+    meanstddev_mul64(sum, sum, &hi2, &lo2);
+    lo = lo1 - lo2;
+    hi = hi1 - hi2 - (lo1 < lo2 ? 1 : 0);
+    return (vx_float64)hi * 18446744073709551616.0 + (vx_float64)lo;
+}
+
 // nodeless version of the MeanStdDev kernel
 vx_status vxMeanStdDev(vx_image input, vx_scalar mean, vx_scalar stddev)
 {
@@ -27,62 +119,66 @@ vx_status vxMeanStdDev(vx_image input, vx_scalar mean, vx_scalar stddev)
     vx_imagepatch_addressing_t addrs = VX_IMAGEPATCH_ADDR_INIT;
     vx_map_id map_id = 0;
     void *base_ptr = NULL;
-    vx_uint32 x, y, width, height, shift_x_u1;
+    vx_uint32 b, v, width, height, num_bands;
+    vx_uint32 hist[256] = { 0 };
+    vx_uint64 isum = 0, isum_sqrs = 0;
+    meanstddev_t m;
     vx_status status  = VX_SUCCESS;
 
     status  = vxQueryImage(input, VX_IMAGE_FORMAT, &format, sizeof(format));
     status |= vxGetValidRegionImage(input, &rect);
-    status |= vxMapImagePatch(input, &rect, 0, &map_id, &addrs, &base_ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0);
-    //VX_PRINT(VX_ZONE_INFO, "Rectangle = {%u,%u x %u,%u}\n",rect.start_x, rect.start_y, rect.end_x, rect.end_y);
+    status |= vxMapImagePatch(input, &rect, 0, &map_id, &addrs, &base_ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (status != VX_SUCCESS)
+        return status;
 
     width  = rect.end_x - rect.start_x;
     height = rect.end_y - rect.start_y;
-    shift_x_u1 = rect.start_x % 8;    // Bit shift for U1 valid regions
+    num_bands = (height + STATISTICS_ROWS_PER_BAND - 1) / STATISTICS_ROWS_PER_BAND;
 
-    for (y = 0; y < height; y++)
+    /* one pass gathers exact integer moments (or a histogram for U1 and U8) per band */
+    m.base = (const vx_uint8 *)base_ptr;
+    m.addrs = &addrs;
+    m.format = format;
+    m.width = width;
+    m.height = height;
+    m.shift_x_u1 = rect.start_x % 8;    // Bit shift for U1 valid regions
+    m.bands = (meanstddev_band_t *)calloc(num_bands ? num_bands : 1, sizeof(meanstddev_band_t));
+    if (m.bands == NULL)
     {
-        for (x = 0; x < width; x++)
-        {
-            if (format == VX_DF_IMAGE_U1)
-            {
-                vx_uint8 *pixels = vxFormatImagePatchAddress2d(base_ptr, x + shift_x_u1, y, &addrs);
-                sum += (*pixels & (1 << (x + shift_x_u1) % 8)) >> (x + shift_x_u1) % 8;
-            }
-            else if (format == VX_DF_IMAGE_U8)
-            {
-                vx_uint8 *pixel = vxFormatImagePatchAddress2d(base_ptr, x, y, &addrs);
-                sum += *pixel;
-            }
-            else if (format == VX_DF_IMAGE_U16)
-            {
-                vx_uint16 *pixel = vxFormatImagePatchAddress2d(base_ptr, x, y, &addrs);
-                sum += *pixel;
-            }
-        }
+        vxUnmapImagePatch(input, map_id);
+        return VX_ERROR_NO_MEMORY;
     }
-    fmean = (vx_float32)(sum / (width * height));
-    for (y = 0; y < height; y++)
+    ParallelForImpl(num_bands, 1, meanstddev_bands, &m);
+
+    for (b = 0; b < num_bands; b++)
     {
-        for (x = 0; x < width; x++)
+        isum += m.bands[b].sum;
+        isum_sqrs += m.bands[b].sum_sqrs;
+        for (v = 0; v < 256; v++)
+            hist[v] += m.bands[b].hist[v];
+    }
+    free(m.bands);
+
+    if (format == VX_DF_IMAGE_U1 || format == VX_DF_IMAGE_U8)
+    {
+        for (v = 0; v < 256; v++)
+            isum += (vx_uint64)hist[v] * v;
+        sum = (vx_float64)isum;
+        fmean = (vx_float32)(sum / (width * height));
+        for (v = 0; v < 256; v++)
         {
-            if (format == VX_DF_IMAGE_U1)
-            {
-                vx_uint8 *pixels = vxFormatImagePatchAddress2d(base_ptr, x + shift_x_u1, y, &addrs);
-                vx_uint8  pixel  = (*pixels & (1 << (x + shift_x_u1) % 8)) >> (x + shift_x_u1) % 8;
-                sum_diff_sqrs += pow((vx_float64)pixel - fmean, 2);
-            }
-            else if (format == VX_DF_IMAGE_U8)
-            {
-                vx_uint8 *pixel = vxFormatImagePatchAddress2d(base_ptr, x, y, &addrs);
-                sum_diff_sqrs += pow((vx_float64)(*pixel) - fmean, 2);
-            }
-            else if (format == VX_DF_IMAGE_U16)
-            {
-                vx_uint16 *pixel = vxFormatImagePatchAddress2d(base_ptr, x, y, &addrs);
-                sum_diff_sqrs += pow((vx_float64)(*pixel) - fmean, 2);
-            }
+            if (hist[v])
+                sum_diff_sqrs += hist[v] * pow((vx_float64)v - fmean, 2);
         }
     }
+    else if (format == VX_DF_IMAGE_U16)
+    {
+        vx_uint64 n = (vx_uint64)width * height;
+        sum = (vx_float64)isum;
+        fmean = (vx_float32)(sum / (width * height));
+        /* sum((p - m)^2) = (n sum(p^2) - sum(p)^2) / n, with no cancellation */
+        sum_diff_sqrs = meanstddev_scaled_variance(n, isum, isum_sqrs) / (vx_float64)n;
+    }
 
     fstddev = (vx_float32)sqrt(sum_diff_sqrs / (width * height));
 
@@ -94,63 +190,196 @@ vx_status vxMeanStdDev(vx_image input, vx_scalar mean, vx_scalar stddev)
     return status;
 }
 
-// nodeless version of the MinMaxLoc kernel
-static void analyzeMinMaxValue(vx_uint32 x, vx_uint32 y, vx_int64 v,
-                               vx_int64 *pMinVal, vx_int64 *pMaxVal,
-                               vx_uint32 *pMinCount, vx_uint32 *pMaxCount,
-                               vx_array minLoc, vx_array maxLoc)
-{
-    vx_coordinates2d_t loc;
-    vx_size minLocCapacity = 0, maxLocCapacity = 0;
+typedef struct _minmaxloc_band_t {
+    vx_int64 min_val;
+    vx_int64 max_val;
+    vx_uint32 min_count;
+    vx_uint32 max_count;
+    vx_size min_capacity;
+    vx_size max_capacity;
+    vx_coordinates2d_t *min_loc;    /* the first locations, up to the array capacity */
+    vx_coordinates2d_t *max_loc;
+} minmaxloc_band_t;
 
-    loc.x = x;
-    loc.y = y;
+typedef struct _minmaxloc_t {
+    const vx_uint8 *base;
+    vx_imagepatch_addressing_t *addrs;
+    vx_df_image format;
+    vx_size min_capacity;
+    vx_size max_capacity;
+    minmaxloc_band_t *bands;
+} minmaxloc_t;
 
-    vxQueryArray(minLoc, VX_ARRAY_CAPACITY, &minLocCapacity, sizeof(minLocCapacity));
-    vxQueryArray(maxLoc, VX_ARRAY_CAPACITY, &maxLocCapacity, sizeof(maxLocCapacity));
+/* lays out the bands of a width x height region and their location lists in scratch,
+ * and returns the bytes they take; with no scratch only the size is worked out */
+static vx_size minmaxloc_layout(minmaxloc_t *m, vx_uint32 width, vx_uint32 height, void *scratch)
+{
+    vx_uint32 b, num_bands = (height + STATISTICS_ROWS_PER_BAND - 1) / STATISTICS_ROWS_PER_BAND;
+    vx_size size = (num_bands ? num_bands : 1) * sizeof(minmaxloc_band_t);
+    vx_uint8 *ptr = (vx_uint8 *)scratch;
 
-    if (v > *pMaxVal)
+    if (ptr)
     {
-        *pMaxVal = v;
-        *pMaxCount = 1;
-        if (maxLoc)
-        {
-            vxTruncateArray(maxLoc, 0);
-            vxAddArrayItems(maxLoc, 1, &loc, sizeof(loc));
-        }
+        m->bands = (minmaxloc_band_t *)ptr;
+        memset(m->bands, 0, size);
     }
-    else if (v == *pMaxVal)
+    for (b = 0; b < num_bands; b++)
     {
-        if (maxLoc && *pMaxCount < maxLocCapacity)
+        vx_uint32 rows = height - b * STATISTICS_ROWS_PER_BAND;
+        vx_size pixels = (vx_size)(rows < STATISTICS_ROWS_PER_BAND ? rows : STATISTICS_ROWS_PER_BAND) * width;
+        vx_size min_capacity = m->min_capacity < pixels ? m->min_capacity : pixels;
+        vx_size max_capacity = m->max_capacity < pixels ? m->max_capacity : pixels;
+
+        if (ptr)
         {
-            vxAddArrayItems(maxLoc, 1, &loc, sizeof(loc));
+            m->bands[b].min_capacity = min_capacity;
+            m->bands[b].max_capacity = max_capacity;
+            m->bands[b].min_loc = (vx_coordinates2d_t *)(ptr + size);
+            m->bands[b].max_loc = m->bands[b].min_loc + min_capacity;
         }
-        ++(*pMaxCount);
+        size += (min_capacity + max_capacity) * sizeof(vx_coordinates2d_t);
     }
+    return size;
+}
+
+vx_size MinMaxLocScratchSizeImpl(vx_uint32 width, vx_uint32 height, vx_size min_capacity, vx_size max_capacity)
+{
+    minmaxloc_t m;
+
+    m.min_capacity = min_capacity;
+    m.max_capacity = max_capacity;
+    return minmaxloc_layout(&m, width, height, NULL);
+}
 
-    if (v < *pMinVal)
+#define MINMAXLOC_ROW_RANGE(type) \
+    { \
+        const type *p = (const type *)row; \
+        type lo = p[0], hi = p[0]; \
+        for (x = 1; x < width; x++) \
+        { \
+            lo = p[x] < lo ? p[x] : lo; \
+            hi = p[x] > hi ? p[x] : hi; \
+        } \
+        *pMin = lo; \
+        *pMax = hi; \
+    }
+
+/* the extremes of a row, in a loop the compiler can vectorize */
+static void minmaxloc_row_range(const vx_uint8 *row, vx_df_image format, vx_uint32 width, vx_int64 *pMin, vx_int64 *pMax)
+{
+    vx_uint32 x;
+    switch (format)
+    {
+        case VX_DF_IMAGE_U8:  MINMAXLOC_ROW_RANGE(vx_uint8);  break;
+        case VX_DF_IMAGE_U16: MINMAXLOC_ROW_RANGE(vx_uint16); break;
+        case VX_DF_IMAGE_U32: MINMAXLOC_ROW_RANGE(vx_uint32); break;
+        case VX_DF_IMAGE_S16: MINMAXLOC_ROW_RANGE(vx_int16);  break;
+        case VX_DF_IMAGE_S32: MINMAXLOC_ROW_RANGE(vx_int32);  break;
+        default: break;
+    }
+}
+
+static vx_int64 minmaxloc_value(const vx_uint8 *row, vx_df_image format, vx_uint32 x)
+{
+    switch (format)
+    {
+        case VX_DF_IMAGE_U8:  return ((const vx_uint8 *)row)[x];
+        case VX_DF_IMAGE_U16: return ((const vx_uint16 *)row)[x];
+        case VX_DF_IMAGE_U32: return ((const vx_uint32 *)row)[x];
+        case VX_DF_IMAGE_S16: return ((const vx_int16 *)row)[x];
+        case VX_DF_IMAGE_S32: return ((const vx_int32 *)row)[x];
+        default: return 0;
+    }
+}
+
+/* appends the locations of v in a row, after the count already found */
+static vx_uint32 minmaxloc_collect(const vx_uint8 *row, vx_df_image format, vx_uint32 width, vx_uint32 y, vx_int64 v,
+                                   vx_uint32 count, vx_coordinates2d_t *loc, vx_size capacity)
+{
+    vx_uint32 x;
+    for (x = 0; x < width; x++)
     {
-        *pMinVal = v;
-        *pMinCount = 1;
-        if (minLoc)
+        if (minmaxloc_value(row, format, x) == v)
         {
-            vxTruncateArray(minLoc, 0);
-            vxAddArrayItems(minLoc, 1, &loc, sizeof(loc));
+            if (loc && count < capacity)
+            {
+                loc[count].x = x;
+                loc[count].y = y;
+            }
+            count++;
         }
     }
-    else if (v == *pMinVal)
+    return count;
+}
+
+static void minmaxloc_bands(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    minmaxloc_t *m = (minmaxloc_t *)arg;
+    vx_uint32 b, y;
+
+    for (b = start; b < end; b++)
     {
-        if (minLoc && *pMinCount < minLocCapacity)
+        minmaxloc_band_t *band = &m->bands[b];
+        vx_uint32 y0 = b * STATISTICS_ROWS_PER_BAND;
+        vx_uint32 y1 = y0 + STATISTICS_ROWS_PER_BAND < m->addrs->dim_y ? y0 + STATISTICS_ROWS_PER_BAND : m->addrs->dim_y;
+        vx_uint32 width = m->addrs->dim_x;
+
+        band->min_val = INT64_MAX;
+        band->max_val = INT64_MIN;
+
+        for (y = y0; y < y1; y++)
         {
-            vxAddArrayItems(minLoc, 1, &loc, sizeof(loc));
+            const vx_uint8 *row = m->base + y * m->addrs->stride_y;
+            vx_int64 lo = 0, hi = 0;
+
+            minmaxloc_row_range(row, m->format, width, &lo, &hi);
+
+            /* only rows holding an extreme are looked at again */
+            if (lo < band->min_val)
+            {
+                band->min_val = lo;
+                band->min_count = 0;
+            }
+            if (lo == band->min_val)
+                band->min_count = minmaxloc_collect(row, m->format, width, y, lo, band->min_count, band->min_loc, band->min_capacity);
+            if (hi > band->max_val)
+            {
+                band->max_val = hi;
+                band->max_count = 0;
+            }
+            if (hi == band->max_val)
+                band->max_count = minmaxloc_collect(row, m->format, width, y, hi, band->max_count, band->max_loc, band->max_capacity);
         }
-        ++(*pMinCount);
     }
 }
 
-vx_status vxMinMaxLoc(vx_image input, vx_scalar minVal, vx_scalar maxVal, vx_array minLoc, vx_array maxLoc, vx_scalar minCount, vx_scalar maxCount)
+/* the bands are merged in raster order, so the first locations kept are the same as a serial scan */
+static vx_status minmaxloc_merge(vx_array array, const minmaxloc_t *m, vx_uint32 num_bands, vx_bool is_min, vx_int64 val)
+{
+    vx_status status = VX_SUCCESS;
+    vx_size capacity = is_min ? m->min_capacity : m->max_capacity;
+    vx_size count = 0;
+    vx_uint32 b;
+
+    status |= vxTruncateArray(array, 0);
+    for (b = 0; b < num_bands && count < capacity; b++)
+    {
+        const minmaxloc_band_t *band = &m->bands[b];
+        vx_size found = is_min ? band->min_count : band->max_count;
+        if ((is_min ? band->min_val : band->max_val) != val)
+            continue;
+        if (found > capacity - count)
+            found = capacity - count;
+        if (found)
+            status |= vxAddArrayItems(array, found, is_min ? band->min_loc : band->max_loc, sizeof(vx_coordinates2d_t));
+        count += found;
+    }
+    return status;
+}
+
+vx_status vxMinMaxLoc(vx_image input, vx_scalar minVal, vx_scalar maxVal, vx_array minLoc, vx_array maxLoc, vx_scalar minCount, vx_scalar maxCount,
+                      void *scratch, vx_size scratch_size)
 {
-    vx_uint32 y, x;
     void *src_base = NULL;
     vx_imagepatch_addressing_t src_addr = VX_IMAGEPATCH_ADDR_INIT;
     vx_rectangle_t rect;
@@ -159,45 +388,68 @@ vx_status vxMinMaxLoc(vx_image input, vx_scalar minVal, vx_scalar maxVal, vx_arr
     vx_int64 iMaxVal = INT64_MIN;
     vx_uint32 iMinCount = 0;
     vx_uint32 iMaxCount = 0;
+    vx_uint32 b, num_bands;
+    vx_size size;
+    void *heap = NULL;
     vx_map_id map_id = 0;
+    minmaxloc_t m;
     vx_status status = VX_SUCCESS;
 
     status |= vxQueryImage(input, VX_IMAGE_FORMAT, &format, sizeof(format));
     status |= vxGetValidRegionImage(input, &rect);
-    status |= vxMapImagePatch(input, &rect, 0, &map_id, &src_addr, (void **)&src_base, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0);
-    for (y = 0; y < src_addr.dim_y; y++)
+    status |= vxMapImagePatch(input, &rect, 0, &map_id, &src_addr, (void **)&src_base, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (status != VX_SUCCESS)
+        return status;
+
+    m.base = (const vx_uint8 *)src_base;
+    m.addrs = &src_addr;
+    m.format = format;
+    m.min_capacity = 0;
+    m.max_capacity = 0;
+    if (minLoc)
+        status |= vxQueryArray(minLoc, VX_ARRAY_CAPACITY, &m.min_capacity, sizeof(m.min_capacity));
+    if (maxLoc)
+        status |= vxQueryArray(maxLoc, VX_ARRAY_CAPACITY, &m.max_capacity, sizeof(m.max_capacity));
+
+    num_bands = (src_addr.dim_y + STATISTICS_ROWS_PER_BAND - 1) / STATISTICS_ROWS_PER_BAND;
+    if (src_addr.dim_x == 0)
+        num_bands = 0;
+
+    /* the array capacities may have been changed since the node was initialized */
+    size = minmaxloc_layout(&m, src_addr.dim_x, src_addr.dim_y, NULL);
+    if (status == VX_SUCCESS && (scratch == NULL || scratch_size < size))
+    {
+        heap = malloc(size);
+        if (heap == NULL)
+            status = VX_ERROR_NO_MEMORY;
+        scratch = heap;
+    }
+
+    if (status == VX_SUCCESS)
     {
-        for (x = 0; x < src_addr.dim_x; x++)
+        minmaxloc_layout(&m, src_addr.dim_x, src_addr.dim_y, scratch);
+        ParallelForImpl(num_bands, 1, minmaxloc_bands, &m);
+
+        for (b = 0; b < num_bands; b++)
         {
-            void *src = vxFormatImagePatchAddress2d(src_base, x, y, &src_addr);
-            if (format == VX_DF_IMAGE_U8)
-            {
-                vx_uint8 v = *(vx_uint8 *)src;
-                analyzeMinMaxValue(x, y, v, &iMinVal, &iMaxVal, &iMinCount, &iMaxCount, minLoc, maxLoc);
-            }
-            else if (format == VX_DF_IMAGE_U16)
-            {
-                vx_uint16 v = *(vx_uint16 *)src;
-                analyzeMinMaxValue(x, y, v, &iMinVal, &iMaxVal, &iMinCount, &iMaxCount, minLoc, maxLoc);
-            }
-            else if (format == VX_DF_IMAGE_U32)
-            {
-                vx_uint32 v = *(vx_uint32 *)src;
-                analyzeMinMaxValue(x, y, v, &iMinVal, &iMaxVal, &iMinCount, &iMaxCount, minLoc, maxLoc);
-            }
-            else if (format == VX_DF_IMAGE_S16)
-            {
-                vx_int16 v = *(vx_int16 *)src;
-                analyzeMinMaxValue(x, y, v, &iMinVal, &iMaxVal, &iMinCount, &iMaxCount, minLoc, maxLoc);
-            }
-            else if (format == VX_DF_IMAGE_S32)
-            {
-                vx_int32 v = *(vx_int32 *)src;
-                analyzeMinMaxValue(x, y, v, &iMinVal, &iMaxVal, &iMinCount, &iMaxCount, minLoc, maxLoc);
-            }
+            iMinVal = m.bands[b].min_val < iMinVal ? m.bands[b].min_val : iMinVal;
+            iMaxVal = m.bands[b].max_val > iMaxVal ? m.bands[b].max_val : iMaxVal;
         }
+        for (b = 0; b < num_bands; b++)
+        {
+            if (m.bands[b].min_val == iMinVal)
+                iMinCount += m.bands[b].min_count;
+            if (m.bands[b].max_val == iMaxVal)
+                iMaxCount += m.bands[b].max_count;
+        }
+        if (status == VX_SUCCESS && minLoc && num_bands)
+            status |= minmaxloc_merge(minLoc, &m, num_bands, vx_true_e, iMinVal);
+        if (status == VX_SUCCESS && maxLoc && num_bands)
+            status |= minmaxloc_merge(maxLoc, &m, num_bands, vx_false_e, iMaxVal);
     }
 
+    free(heap);
+
     VX_PRINT(VX_ZONE_INFO, "Min = %ld Max = %ld\n", iMinVal, iMaxVal);
     status |= vxUnmapImagePatch(input, map_id);
 
@@ -9,12 +9,6 @@
 
 #include <assert.h>
 
-
-// The following example supports both an arbitrary dim num and a somewhat,
-// hopefully faster, hardcoded amount of loops to MAX_NUM_OF_DIMENSIONS.
-// Set the following to 0 for the hardcoded loop count.
-#define SUPPORT_ARBITRARY_DIM_NUM 0
-
 #define MAX_NUM_OF_DIMENSIONS   6
 
 #define Q78_FIXED_POINT_POSITION 8
@@ -23,36 +17,6 @@
 #define CLAMP(val, lower, upper) MAX((lower), MIN((val), (upper)))
 
 
-////TODO: move this together with ComputeGlobalPositionsFromIndex
-////TODO: does it have to return byte offset?...
-//static C_KERNEL_INLINE size_t getFlatTensorByteOffsetWithBroadcast(
-//        size_t index,
-//        vx_size dim_num,
-//        const vx_size * in_dims,
-//        const vx_size * in_strides,
-//        const vx_size * out_dims)
-//{
-//    size_t res = 0;
-//
-//    for (vx_size d = 0; d < dim_num; ++d)
-//    {
-//#if 1   // support broadcast
-////        assert (out_dims[d]);
-////        assert (in_dims[d] == 1 || in_dims[d] == out_dims[d]);
-//
-//        if (in_dims[d] == out_dims[d])
-//            res += in_strides[d] * (index % out_dims[d]);
-//
-//        index /= out_dims[d];
-//#else   // ignore broadcast (possible out-of-bounds access if broadcast's present)
-//        res += in_strides[d] * (index % in_dims[d]);
-//        index /= in_dims[d];
-//#endif
-//    }
-//
-//    return res;
-//}
-
 static C_KERNEL_INLINE size_t getBaseTypeSize(enum TensorCFmt fmt)
 {
     switch(fmt)
@@ -64,116 +28,87 @@ static C_KERNEL_INLINE size_t getBaseTypeSize(enum TensorCFmt fmt)
     }
 }
 
-void ElementwiseTensorOpImpl(
-        enum ElementwiseTensorMathOp op,
-        enum TensorCFmt fmt,
-        const void * input0_ptr, tensor_desc_t input0,
-        const void * input1_ptr, tensor_desc_t input1,
-        float scale,
-        bool wrap,  // true for wrap, sat otherwise
-        bool to_ne,  // true for to_ne, to_zero, otherwise (only usef for MUL)
-        void * output_ptr, tensor_desc_t output)
-{
-
-    assert (input0.dim_num > 0);
-    assert (input1.dim_num == input0.dim_num);
-    assert (output.dim_num == input0.dim_num);
-
-    for (size_t i = 0; i < input0.dim_num; ++i)
-    {
-        assert (output.dims[i] == input0.dims[i] || input0.dims[i] == 1);
-        assert (output.dims[i] == input1.dims[i] || input1.dims[i] == 1);
-
-        //Note: We also support here having both inputs dim equal to "1" and
-        //      the output being something else, even though the spec doesn't
-        //      require it. Implementations are free to additionally limit
-        //      their support in the following manner,
-        // assert(output.dims[i] == MAX(input0.dims[i], input1.dims[i]));
-        
-
-    }
-
-    // Since we calc offsets manually and cast to (int16_t *), we expect the-
-    // alignment to be correct already.
-    {
-        const size_t base_type_size = getBaseTypeSize(fmt);
-
-        for (size_t i = 0; i < input0.dim_num; ++i) 
-        {
-            assert(input0.strides[i] % base_type_size == 0);
-            assert(input1.strides[i] % base_type_size == 0);
-            assert(output.strides[i] % base_type_size == 0);
-        }
-    }
-
-#if SUPPORT_ARBITRARY_DIM_NUM
-    vx_size out_size = ComputeNumberOfElements(output.dims, output.dim_num);
-
-#define OP_TEMPLATE(VX_TYPE_, EXPR_) \
-    for (vx_size i = 0; i < out_size; ++i) \
-    { \
-        vx_size in0_byte_offset = getFlatTensorByteOffsetWithBroadcast(i, input0.dim_num, input0.dims, input0.strides, output.dims); \
-        vx_size in1_byte_offset = getFlatTensorByteOffsetWithBroadcast(i, input1.dim_num, input1.dims, input1.strides, output.dims); \
-        vx_size out_byte_offset = ComputeGlobalPositionsFromIndex(i, output.dims, output.strides, output.dim_num, &out_byte_offset); \
-        \
-        VX_TYPE_ in0_val = *(VX_TYPE_ *)((char *)input0_ptr + in0_byte_offset); \
-        VX_TYPE_ in1_val = *(VX_TYPE_ *)((char *)input1_ptr + in1_byte_offset); \
-        VX_TYPE_ * res_ptr = (VX_TYPE_ *)((char *)output_ptr + out_byte_offset); \
-        \
-        do { EXPR_ } while(0); \
-    }
-
-#else   // SUPPORT_ARBITRARY_DIM_NUM
-
-    const size_t output_dim0 = output.dims[0];
-    const size_t output_dim1 = output.dim_num > 1 ? output.dims[1]: 1;
-    const size_t output_dim2 = output.dim_num > 2 ? output.dims[2]: 1;
-    const size_t output_dim3 = output.dim_num > 3 ? output.dims[3]: 1;
-    const size_t output_dim4 = output.dim_num > 4 ? output.dims[4]: 1;
-    const size_t output_dim5 = output.dim_num > 5 ? output.dims[5]: 1;
-
-    // Note: It make make sense to seperate the cases per dim_num,
-    //       to avoid repeated by 0 multiplication in the offset calculation.
-
-    // Instead of using something like
-    // input_byte_offset == ... + (input0.dims[3] > 1 ? i3 * input0.strides[3] : 0) + ...
-    // We create an extra array of strides containning 0s if the input dim is
-    // being broadcasted here, to avoid the extra contionals in the loop
-    size_t in0_strides[MAX_NUM_OF_DIMENSIONS] = { 0 };
-    size_t in1_strides[MAX_NUM_OF_DIMENSIONS] = { 0 };
-    for (size_t i = 0; i < input0.dim_num; ++i)
-    {
-        if (input0.dims[i] > 1) in0_strides[i] = input0.strides[i];
-        if (input1.dims[i] > 1) in1_strides[i] = input1.strides[i];
-    }
-
-    
+// Elementwise ops run over the output as rows: dimensions that all three
+// tensors walk contiguously (or all broadcast alike) are merged, so equal-shape
+// packed tensors become a single row and per-channel broadcast becomes rows with
+// a scalar input. Long rows are cut into chunks, which ParallelForImpl spreads
+// over threads it starts for each call.
+#define ELEMENTWISE_CHUNK           (4096)
+#define ELEMENTWISE_MIN_PER_THREAD  (16384)
+
+typedef struct {
+    enum ElementwiseTensorMathOp op;
+    enum TensorCFmt fmt;
+    float scale;
+    bool wrap;
+    bool to_ne;
+    const char * in0;
+    const char * in1;
+    char * out;
+    size_t elem;
+    size_t dim_num;
+    size_t dims[MAX_NUM_OF_DIMENSIONS];
+    size_t in0_strides[MAX_NUM_OF_DIMENSIONS];     // in elements, 0 where broadcast
+    size_t in1_strides[MAX_NUM_OF_DIMENSIONS];
+    size_t out_strides[MAX_NUM_OF_DIMENSIONS];
+    size_t chunks;      // chunks per row
+} elementwise_t;
+
+// One loop per input step pattern; unit and broadcast steps keep plain
+// indexing so the compiler can vectorize the common cases.
 #define OP_TEMPLATE(VX_TYPE_, EXPR_) \
-    for (vx_size i5 = 0; i5 < output_dim5; ++i5) \
-    for (vx_size i4 = 0; i4 < output_dim4; ++i4) \
-    for (vx_size i3 = 0; i3 < output_dim3; ++i3) \
-    for (vx_size i2 = 0; i2 < output_dim2; ++i2) \
-    for (vx_size i1 = 0; i1 < output_dim1; ++i1) \
-    for (vx_size i0 = 0; i0 < output_dim0; ++i0) \
     { \
-        vx_size in0_byte_offset = \
-            in0_strides[5] * i5 + in0_strides[4] * i4 + in0_strides[3] * i3 + \
-            in0_strides[2] * i2 + in0_strides[1] * i1 + in0_strides[0] * i0; \
-        vx_size in1_byte_offset = \
-            in1_strides[5] * i5 + in1_strides[4] * i4 + in1_strides[3] * i3 + \
-            in1_strides[2] * i2 + in1_strides[1] * i1 + in1_strides[0] * i0; \
-        vx_size out_byte_offset = \
-            output.strides[5] * i5 + output.strides[4] * i4 + output.strides[3] * i3 + \
-            output.strides[2] * i2 + output.strides[1] * i1 + output.strides[0] * i0; \
-        \
-        VX_TYPE_ in0_val = *(VX_TYPE_ *)((char *)input0_ptr + in0_byte_offset); \
-        VX_TYPE_ in1_val = *(VX_TYPE_ *)((char *)input1_ptr + in1_byte_offset); \
-        VX_TYPE_ * res_ptr = (VX_TYPE_ *)((char *)output_ptr + out_byte_offset); \
-        \
-        do { EXPR_ } while(0); \
+        const VX_TYPE_ * in0 = (const VX_TYPE_ *)in0_ptr; \
+        const VX_TYPE_ * in1 = (const VX_TYPE_ *)in1_ptr; \
+        VX_TYPE_ * res = (VX_TYPE_ *)out_ptr; \
+        if (out_step == 1 && in0_step == 1 && in1_step == 1) \
+        { \
+            for (size_t i = 0; i < n; ++i) \
+            { \
+                VX_TYPE_ in0_val = in0[i]; \
+                VX_TYPE_ in1_val = in1[i]; \
+                VX_TYPE_ * res_ptr = res + i; \
+                do { EXPR_ } while(0); \
+            } \
+        } \
+        else if (out_step == 1 && in0_step == 1 && in1_step == 0) \
+        { \
+            const VX_TYPE_ in1_val = in1[0]; \
+            for (size_t i = 0; i < n; ++i) \
+            { \
+                VX_TYPE_ in0_val = in0[i]; \
+                VX_TYPE_ * res_ptr = res + i; \
+                do { EXPR_ } while(0); \
+            } \
+        } \
+        else if (out_step == 1 && in0_step == 0 && in1_step == 1) \
+        { \
+            const VX_TYPE_ in0_val = in0[0]; \
+            for (size_t i = 0; i < n; ++i) \
+            { \
+                VX_TYPE_ in1_val = in1[i]; \
+                VX_TYPE_ * res_ptr = res + i; \
+                do { EXPR_ } while(0); \
+            } \
+        } \
+        else \
+        { \
+            for (size_t i = 0; i < n; ++i) \
+            { \
+                VX_TYPE_ in0_val = in0[i * in0_step]; \
+                VX_TYPE_ in1_val = in1[i * in1_step]; \
+                VX_TYPE_ * res_ptr = res + i * out_step; \
+                do { EXPR_ } while(0); \
+            } \
+        } \
     }
 
-#endif  // SUPPORT_ARBITRARY_DIM_NUM
+static void elementwise_row(const elementwise_t * e,
+        const void * in0_ptr, size_t in0_step,
+        const void * in1_ptr, size_t in1_step,
+        void * out_ptr, size_t out_step, size_t n)
+{
+    const float scale = e->scale;
 
     //TODO: Conversion to signed int from an out of bounds value as used in
     //      wrap, is impl-defined! This shoudl be fixed by doing it through
@@ -182,32 +117,32 @@ void ElementwiseTensorOpImpl(
     //      (Is this the correct way to do it portably in C?)
     //      (This is mostly relevant for Q78)
 
-    switch (fmt)
+    switch (e->fmt)
     {
     case TENSOR_C_FMT_Q78:
         {
-            switch (op)
+            switch (e->op)
             {
             case ELEMENTWISE_TENSOR_ADD:
-                if (wrap) { OP_TEMPLATE(int16_t, { *res_ptr = (int16_t)(in0_val + in1_val); }); }       //TODO: cast issue?
+                if (e->wrap) { OP_TEMPLATE(int16_t, { *res_ptr = (int16_t)(in0_val + in1_val); }); }       //TODO: cast issue?
                 else { OP_TEMPLATE(int16_t, { *res_ptr = conversion_24_8(in0_val + in1_val); }); }
                 break;
             case ELEMENTWISE_TENSOR_SUB:
-                if (wrap) { OP_TEMPLATE(int16_t, { *res_ptr = (int16_t)(in0_val - in1_val); }); }       //TODO: cast issue?
+                if (e->wrap) { OP_TEMPLATE(int16_t, { *res_ptr = (int16_t)(in0_val - in1_val); }); }       //TODO: cast issue?
                 else { OP_TEMPLATE(int16_t, { *res_ptr = conversion_24_8(in0_val - in1_val); }); }
                 break;
             case ELEMENTWISE_TENSOR_MUL:
                 {
                     double new_scale = (double)scale / (1 << Q78_FIXED_POINT_POSITION);
 
-                    if (wrap)
+                    if (e->wrap)
                     {
-                        if (to_ne) { OP_TEMPLATE(vx_int16, { *res_ptr = (int16_t)nearbyint(in0_val * in1_val * new_scale); }); }    //TODO: cast issue?
+                        if (e->to_ne) { OP_TEMPLATE(vx_int16, { *res_ptr = (int16_t)nearbyint(in0_val * in1_val * new_scale); }); }    //TODO: cast issue?
                         else { OP_TEMPLATE(vx_int16, { *res_ptr = (int16_t)trunc(in0_val * in1_val * new_scale); }); }              //TODO: cast issue?
                     }
                     else  // using "uint32_t" will fail the CTS test on Rasberry Pi
                     {
-                        if (to_ne) { OP_TEMPLATE(vx_int16, { *res_ptr = (vx_int16)conversion_24_8(nearbyint(in0_val * in1_val * new_scale)); }); }
+                        if (e->to_ne) { OP_TEMPLATE(vx_int16, { *res_ptr = (vx_int16)conversion_24_8(nearbyint(in0_val * in1_val * new_scale)); }); }
                         else { OP_TEMPLATE(vx_int16, { *res_ptr = (vx_int16)conversion_24_8(trunc(in0_val * in1_val * new_scale)); }); }
                     }
                 }
@@ -218,25 +153,25 @@ void ElementwiseTensorOpImpl(
         break;
     case TENSOR_C_FMT_U8:
         {
-            switch (op)
+            switch (e->op)
             {
             case ELEMENTWISE_TENSOR_ADD:
-                if (wrap) { OP_TEMPLATE(uint8_t, { *res_ptr = in0_val + in1_val; }); }
+                if (e->wrap) { OP_TEMPLATE(uint8_t, { *res_ptr = in0_val + in1_val; }); }
                 else { OP_TEMPLATE(uint8_t, { *res_ptr = CLAMP(in0_val + in1_val, 0, UINT8_MAX); }); }
                 break;
             case ELEMENTWISE_TENSOR_SUB:
-                if (wrap) { OP_TEMPLATE(uint8_t, { *res_ptr = in0_val - in1_val; }); }
+                if (e->wrap) { OP_TEMPLATE(uint8_t, { *res_ptr = in0_val - in1_val; }); }
                 else { OP_TEMPLATE(uint8_t, { *res_ptr = CLAMP(in0_val - in1_val, 0, UINT8_MAX); }); }
                 break;
             case ELEMENTWISE_TENSOR_MUL:
-                if (wrap)
+                if (e->wrap)
                 {
-                    if (to_ne) { OP_TEMPLATE(uint8_t, { *res_ptr = (uint8_t)nearbyint(in0_val * in1_val * scale); }); }
+                    if (e->to_ne) { OP_TEMPLATE(uint8_t, { *res_ptr = (uint8_t)nearbyint(in0_val * in1_val * scale); }); }
                     else { OP_TEMPLATE(uint8_t, { *res_ptr = (uint8_t)trunc(in0_val * in1_val * scale); }); }
                 }
                 else
                 {
-                    if (to_ne) { OP_TEMPLATE(uint8_t, { *res_ptr = (uint8_t)CLAMP(nearbyint(in0_val * in1_val * scale), 0, UINT8_MAX); }); }
+                    if (e->to_ne) { OP_TEMPLATE(uint8_t, { *res_ptr = (uint8_t)CLAMP(nearbyint(in0_val * in1_val * scale), 0, UINT8_MAX); }); }
                     else { OP_TEMPLATE(uint8_t, { *res_ptr = (uint8_t) CLAMP(trunc(in0_val * in1_val * scale), 0, UINT8_MAX); }); }
                 }
                 break;
@@ -246,25 +181,25 @@ void ElementwiseTensorOpImpl(
         break;
     case TENSOR_C_FMT_S8:
         {
-            switch (op)
+            switch (e->op)
             {
             case ELEMENTWISE_TENSOR_ADD:
-                if (wrap) { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)(in0_val + in1_val); }); }         //TODO: cast issue?
+                if (e->wrap) { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)(in0_val + in1_val); }); }         //TODO: cast issue?
                 else { OP_TEMPLATE(int8_t, { *res_ptr = CLAMP(in0_val + in1_val, INT8_MIN, INT8_MAX); }); }
                 break;
             case ELEMENTWISE_TENSOR_SUB:
-                if (wrap) { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)(in0_val - in1_val); }); }         //TODO: cast issue?
+                if (e->wrap) { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)(in0_val - in1_val); }); }         //TODO: cast issue?
                 else { OP_TEMPLATE(int8_t, { *res_ptr = CLAMP(in0_val - in1_val, INT8_MIN, INT8_MAX); }); }
                 break;
             case ELEMENTWISE_TENSOR_MUL:
-                if (wrap)
+                if (e->wrap)
                 {
-                    if (to_ne) { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)nearbyint(in0_val * in1_val * scale); }); }   //TODO: cast issue?
+                    if (e->to_ne) { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)nearbyint(in0_val * in1_val * scale); }); }   //TODO: cast issue?
                     else { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)trunc(in0_val * in1_val * scale); }); }             //TODO: cast issue?
                 }
                 else
                 {
-                    if (to_ne) { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)CLAMP(nearbyint(in0_val * in1_val * scale), INT8_MIN, INT8_MAX); }); }
+                    if (e->to_ne) { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)CLAMP(nearbyint(in0_val * in1_val * scale), INT8_MIN, INT8_MAX); }); }
                     else { OP_TEMPLATE(int8_t, { *res_ptr = (int8_t)CLAMP(trunc(in0_val * in1_val * scale), INT8_MIN, INT8_MAX); }); }
                 }
                 break;
@@ -274,7 +209,125 @@ void ElementwiseTensorOpImpl(
         break;
     default: assert(0);
     }
+}
 #undef OP_TEMPLATE
+
+static void elementwise_chunks(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const elementwise_t * e = (const elementwise_t *)arg;
+
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        size_t row = item / e->chunks;
+        size_t x = (item % e->chunks) * ELEMENTWISE_CHUNK;
+        size_t n = MIN(ELEMENTWISE_CHUNK, e->dims[0] - x);
+        size_t in0_pos = x * e->in0_strides[0];
+        size_t in1_pos = x * e->in1_strides[0];
+        size_t out_pos = x * e->out_strides[0];
+
+        for (size_t d = 1; d < e->dim_num; ++d)
+        {
+            size_t i = row % e->dims[d];
+            row /= e->dims[d];
+            in0_pos += i * e->in0_strides[d];
+            in1_pos += i * e->in1_strides[d];
+            out_pos += i * e->out_strides[d];
+        }
+
+        elementwise_row(e,
+                e->in0 + in0_pos * e->elem, e->in0_strides[0],
+                e->in1 + in1_pos * e->elem, e->in1_strides[0],
+                e->out + out_pos * e->elem, e->out_strides[0], n);
+    }
+}
+
+void ElementwiseTensorOpImpl(
+        enum ElementwiseTensorMathOp op,
+        enum TensorCFmt fmt,
+        const void * input0_ptr, tensor_desc_t input0,
+        const void * input1_ptr, tensor_desc_t input1,
+        float scale,
+        bool wrap,  // true for wrap, sat otherwise
+        bool to_ne,  // true for to_ne, to_zero, otherwise (only usef for MUL)
+        void * output_ptr, tensor_desc_t output)
+{
+
+    assert (input0.dim_num > 0);
+    assert (input1.dim_num == input0.dim_num);
+    assert (output.dim_num == input0.dim_num);
+
+    for (size_t i = 0; i < input0.dim_num; ++i)
+    {
+        assert (output.dims[i] == input0.dims[i] || input0.dims[i] == 1);
+        assert (output.dims[i] == input1.dims[i] || input1.dims[i] == 1);
+
+        //Note: We also support here having both inputs dim equal to "1" and
+        //      the output being something else, even though the spec doesn't
+        //      require it. Implementations are free to additionally limit
+        //      their support in the following manner,
+        // assert(output.dims[i] == MAX(input0.dims[i], input1.dims[i]));
+        
+
+    }
+
+    // Since we calc offsets manually and cast to (int16_t *), we expect the-
+    // alignment to be correct already.
+    const size_t base_type_size = getBaseTypeSize(fmt);
+
+    for (size_t i = 0; i < input0.dim_num; ++i) 
+    {
+        assert(input0.strides[i] % base_type_size == 0);
+        assert(input1.strides[i] % base_type_size == 0);
+        assert(output.strides[i] % base_type_size == 0);
+    }
+
+    elementwise_t e = { op, fmt, scale, wrap, to_ne, input0_ptr, input1_ptr, output_ptr, base_type_size };
+
+    // Element strides, with 0 for a broadcast input dim. Output dims of 1 are
+    // dropped and a dim is merged into the previous one whenever all three
+    // tensors continue it without a gap.
+    for (size_t i = 0; i < output.dim_num; ++i)
+    {
+        size_t s0 = input0.dims[i] > 1 ? input0.strides[i] / base_type_size : 0;
+        size_t s1 = input1.dims[i] > 1 ? input1.strides[i] / base_type_size : 0;
+        size_t so = output.strides[i] / base_type_size;
+
+        if (output.dims[i] <= 1)
+            continue;
+
+        if (e.dim_num > 0)
+        {
+            size_t d = e.dim_num - 1;
+            if (s0 == e.in0_strides[d] * e.dims[d] &&
+                s1 == e.in1_strides[d] * e.dims[d] &&
+                so == e.out_strides[d] * e.dims[d])
+            {
+                e.dims[d] *= output.dims[i];
+                continue;
+            }
+        }
+        e.dims[e.dim_num] = output.dims[i];
+        e.in0_strides[e.dim_num] = s0;
+        e.in1_strides[e.dim_num] = s1;
+        e.out_strides[e.dim_num] = so;
+        e.dim_num++;
+    }
+    if (e.dim_num == 0)
+    {
+        // a single element
+        e.dims[0] = 1;
+        e.dim_num = 1;
+    }
+
+    size_t rows = 1;
+    for (size_t d = 1; d < e.dim_num; ++d)
+        rows *= e.dims[d];
+    e.chunks = (e.dims[0] + ELEMENTWISE_CHUNK - 1) / ELEMENTWISE_CHUNK;
+
+    const size_t chunk_len = MIN(e.dims[0], ELEMENTWISE_CHUNK);
+    const vx_uint32 grain = (vx_uint32)((ELEMENTWISE_MIN_PER_THREAD + chunk_len - 1) / chunk_len);
+
+    ParallelForImpl((vx_uint32)(rows * e.chunks), grain, elementwise_chunks, &e);
 }
 
 static C_KERNEL_INLINE void singleValueDepthConvert(
@@ -346,20 +399,6 @@ void TensorConvertDepthKernelImpl(
 
     const float scale = 1.f / norm;
 
-#if SUPPORT_ARBITRARY_DIM_NUM
-    const size_t count = ComputeNumberOfElements(input.dims, input.dim_num);
-
-    for (size_t i = 0; i < count; ++i)
-    {
-        size_t input_byte_offset = ComputeGlobalPositionsFromIndex(i, input.dims, input.strides, input.dim_num, &input_byte_offset);
-        size_t output_byte_offset = ComputeGlobalPositionsFromIndex(i, output.dims, output.strides, output.dim_num, &output_byte_offset);
-
-        const void * in = (char *)input_ptr + input_byte_offset;
-        const void * out = (char *)output_ptr + output_byte_offset;
-
-        singleValueDepthConvert(in, src_fmt, wrap, scale, offset, out, dst_fmt);
-    }
-#else
     const size_t output_dim0 = output.dims[0];
     const size_t output_dim1 = output.dim_num > 1 ? output.dims[1]: 1;
     const size_t output_dim2 = output.dim_num > 2 ? output.dims[2]: 1;
@@ -386,5 +425,4 @@ void TensorConvertDepthKernelImpl(
 
         singleValueDepthConvert(in, src_fmt, wrap, scale, offset, out, dst_fmt);
     }
-#endif
 }
@@ -8,61 +8,212 @@
 #include <VX/vx_types.h>
 
 #include <assert.h>
-//#include <stdio.h> //TODO: remove me
 
-vx_status TransposeTensorKernelImpl(
+// Side of the square tiles a transpose is copied in, in elements. Both the
+// source and the destination tile stay in L1 for all supported formats.
+#define PERMUTE_TILE                (32)
+#define PERMUTE_MIN_PER_THREAD      (16384)
+
+typedef struct {
+    const vx_uint8 * in;
+    vx_uint8 * out;
+    vx_size el_size;
+    vx_size dim_num;
+    vx_size dims[MAX_NUM_OF_DIMENSIONS];         // in output order, merged
+    vx_size in_strides[MAX_NUM_OF_DIMENSIONS];   // bytes, along each output dim
+    vx_size out_strides[MAX_NUM_OF_DIMENSIONS];
+    vx_size inner;      // output dim the input is packed along, 0 for plain runs
+    vx_size blocks;     // tiles along dims[inner]
+} permute_t;
+
+#define PERMUTE_COPY(TYPE_, n, dst, dst_step, src, src_step) \
+    for (vx_size k = 0; k < (n); ++k) \
+        ((TYPE_ *)(dst))[k * (dst_step)] = ((const TYPE_ *)(src))[k * (src_step)]
+
+static void permute_line(vx_size el_size, vx_size n,
+        vx_uint8 * dst, vx_size dst_stride, const vx_uint8 * src, vx_size src_stride)
+{
+    if (dst_stride == el_size && src_stride == el_size)
+    {
+        memcpy(dst, src, n * el_size);
+        return;
+    }
+    switch (el_size)
+    {
+    case 1: PERMUTE_COPY(vx_uint8, n, dst, dst_stride, src, src_stride); break;
+    case 2: PERMUTE_COPY(vx_uint16, n, dst, dst_stride / 2, src, src_stride / 2); break;
+    case 4: PERMUTE_COPY(vx_uint32, n, dst, dst_stride / 4, src, src_stride / 4); break;
+    default:
+        for (vx_size k = 0; k < n; ++k)
+            memcpy(dst + k * dst_stride, src + k * src_stride, el_size);
+        break;
+    }
+}
+
+// Offsets of an outer index, leaving out dim 0 and p->inner.
+static void permute_offsets(const permute_t * p, vx_size index, vx_size * in_pos, vx_size * out_pos)
+{
+    *in_pos = 0;
+    *out_pos = 0;
+    for (vx_size d = 1; d < p->dim_num; ++d)
+    {
+        if (p->inner != 0 && d == p->inner)
+            continue;
+        vx_size i = index % p->dims[d];
+        index /= p->dims[d];
+        *in_pos += i * p->in_strides[d];
+        *out_pos += i * p->out_strides[d];
+    }
+}
+
+static void permute_runs(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const permute_t * p = (const permute_t *)arg;
+
+    for (vx_uint32 row = start; row < end; ++row)
+    {
+        vx_size in_pos, out_pos;
+        permute_offsets(p, row, &in_pos, &out_pos);
+        permute_line(p->el_size, p->dims[0], p->out + out_pos, p->out_strides[0], p->in + in_pos, p->in_strides[0]);
+    }
+}
+
+// Each item is one band of PERMUTE_TILE positions along dims[inner], for one
+// outer index, copied tile by tile across dims[0].
+static void permute_tiles(void * arg, vx_uint32 start, vx_uint32 end)
+{
+    const permute_t * p = (const permute_t *)arg;
+    const vx_size j = p->inner;
+
+    for (vx_uint32 item = start; item < end; ++item)
+    {
+        vx_size in_pos, out_pos;
+        vx_size y0 = (item % p->blocks) * PERMUTE_TILE;
+        vx_size y1 = y0 + PERMUTE_TILE < p->dims[j] ? y0 + PERMUTE_TILE : p->dims[j];
+        permute_offsets(p, item / p->blocks, &in_pos, &out_pos);
+
+        for (vx_size x0 = 0; x0 < p->dims[0]; x0 += PERMUTE_TILE)
+        {
+            vx_size n = x0 + PERMUTE_TILE < p->dims[0] ? PERMUTE_TILE : p->dims[0] - x0;
+            for (vx_size y = y0; y < y1; ++y)
+            {
+                permute_line(p->el_size, n,
+                        p->out + out_pos + y * p->out_strides[j] + x0 * p->out_strides[0], p->out_strides[0],
+                        p->in + in_pos + y * p->in_strides[j] + x0 * p->in_strides[0], p->in_strides[0]);
+            }
+        }
+    }
+}
+
+// Copies in1 into out with its dims reordered, out dim k being in1 dim perm[k].
+// Dims left in place are copied as runs and a transposed pair is copied in tiles.
+static vx_status PermuteTensorKernelImpl(
         vx_tensor in1,
-        vx_scalar sc_dim1,
-        vx_scalar sc_dim2,
+        const vx_size * perm,
         vx_tensor out,
         vx_size el_size)
 {
-
     vx_status status = VX_SUCCESS;
 
     void* in1_data = NULL;
     void* out_data = NULL;
 
-
-    vx_size dim1, dim2;
-    //TODO: do we want to assert all 3 formats match here?
-
     vx_size in1_dim_num = 0, in1_dims[MAX_NUM_OF_DIMENSIONS] = {0}, in1_strides[MAX_NUM_OF_DIMENSIONS] = {0};
     vx_size out_dim_num = 0, out_dims[MAX_NUM_OF_DIMENSIONS] = {0}, out_strides[MAX_NUM_OF_DIMENSIONS] = {0};
 
     status |= AllocatePatch(in1, &in1_dim_num, in1_dims, in1_strides, &in1_data, VX_READ_ONLY);
     status |= AllocatePatch(out, &out_dim_num, out_dims, out_strides, &out_data, VX_WRITE_ONLY);
 
-    status |= vxCopyScalar(sc_dim1, &dim1, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
-    status |= vxCopyScalar(sc_dim2, &dim2, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
-    vx_size out_size = ComputeNumberOfElements(out_dims, out_dim_num);
-
-    //TODO: check params values! overfloat (and rounding for MUL) are ignored atm!!!
-    
-    // This doesn't apply to a JIT/ parametrized AOT like OCL but,
-    // The #if below compares the naive version with hoisting the conditions out of the loop.
-    // Further splitting can be done for the no-broadcast case (equal dims) and especially for the
-    // flat memory case which would make it possible to sub it with a simple simd array op.
-
-    int tmp = (int)out_strides[dim1];
-    out_strides[dim1] = out_strides[dim2];
-    out_strides[dim2] = tmp;
-    for (vx_size i = 0; i < out_size; ++i)
+    if (status == VX_SUCCESS)
     {
-        vx_size in1_pos0 = 0, out_pos0 = 0;
-        vx_size in1_pos = ComputeGlobalPositionsFromIndex(i, in1_dims, in1_strides, in1_dim_num, &in1_pos0);
-
-        vx_size out_pos = ComputeGlobalPositionsFromIndex(i, in1_dims, out_strides, in1_dim_num, &out_pos0);
-
-        memcpy ((vx_uint8*)out_data+out_pos, (vx_uint8*)in1_data+in1_pos, el_size);
-
+        permute_t p = { (const vx_uint8 *)in1_data, (vx_uint8 *)out_data, el_size, 0 };
+        vx_size count = 1;
+
+        // Walk in output order. Dims of size 1 are dropped and a dim is merged
+        // into the previous one when both tensors continue it without a gap,
+        // so dims left in place end up as runs copied with memcpy.
+        for (vx_size k = 0; k < in1_dim_num; ++k)
+        {
+            vx_size size = in1_dims[perm[k]];
+            vx_size in_stride = in1_strides[perm[k]];
+
+            if (size <= 1)
+                continue;
+            if (p.dim_num > 0 &&
+                in_stride == p.in_strides[p.dim_num - 1] * p.dims[p.dim_num - 1] &&
+                out_strides[k] == p.out_strides[p.dim_num - 1] * p.dims[p.dim_num - 1])
+            {
+                p.dims[p.dim_num - 1] *= size;
+                continue;
+            }
+            p.dims[p.dim_num] = size;
+            p.in_strides[p.dim_num] = in_stride;
+            p.out_strides[p.dim_num] = out_strides[k];
+            p.dim_num++;
+        }
+        if (p.dim_num == 0)
+        {
+            p.dims[0] = 1;
+            p.in_strides[0] = p.out_strides[0] = el_size;
+            p.dim_num = 1;
+        }
+        for (vx_size d = 1; d < p.dim_num; ++d)
+            count *= p.dims[d];
+
+        // When the output is packed along dims[0] but the input is packed along
+        // another dim, that pair is a transpose and is copied in tiles.
+        for (vx_size d = 1; d < p.dim_num; ++d)
+        {
+            if (p.in_strides[d] < p.in_strides[0] &&
+                (p.inner == 0 || p.in_strides[d] < p.in_strides[p.inner]))
+                p.inner = d;
+        }
+        if (p.out_strides[0] != el_size)
+            p.inner = 0;
+
+        if (p.inner == 0)
+        {
+            vx_uint32 grain = (vx_uint32)((PERMUTE_MIN_PER_THREAD + p.dims[0] - 1) / p.dims[0]);
+            ParallelForImpl((vx_uint32)count, grain, permute_runs, &p);
+        }
+        else
+        {
+            vx_size band = PERMUTE_TILE * p.dims[0];
+            p.blocks = (p.dims[p.inner] + PERMUTE_TILE - 1) / PERMUTE_TILE;
+            count = count / p.dims[p.inner] * p.blocks;
+            ParallelForImpl((vx_uint32)count, (vx_uint32)((PERMUTE_MIN_PER_THREAD + band - 1) / band), permute_tiles, &p);
+        }
     }
-    tmp = (int)out_strides[dim1];
-    out_strides[dim1] = out_strides[dim2];
-    out_strides[dim2] = tmp;
+
     status |= ReleasePatch (in1, in1_dim_num, in1_dims, in1_strides, &in1_data, VX_READ_ONLY);
     status |= ReleasePatch (out, out_dim_num, out_dims, out_strides, &out_data, VX_WRITE_ONLY);
 
     return status;
 }
 
+vx_status TransposeTensorKernelImpl(
+        vx_tensor in1,
+        vx_scalar sc_dim1,
+        vx_scalar sc_dim2,
+        vx_tensor out,
+        vx_size el_size)
+{
+
+    vx_status status = VX_SUCCESS;
+    vx_size dim1, dim2;
+    vx_size perm[MAX_NUM_OF_DIMENSIONS];
+    //TODO: do we want to assert all 3 formats match here?
+
+    status |= vxCopyScalar(sc_dim1, &dim1, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxCopyScalar(sc_dim2, &dim2, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+    if (status != VX_SUCCESS || dim1 >= MAX_NUM_OF_DIMENSIONS || dim2 >= MAX_NUM_OF_DIMENSIONS)
+        return VX_ERROR_INVALID_PARAMETERS;
+
+    // A transpose is the permutation swapping dim1 and dim2
+    for (vx_size i = 0; i < MAX_NUM_OF_DIMENSIONS; ++i)
+        perm[i] = i;
+    perm[dim1] = dim2;
+    perm[dim2] = dim1;
+
+    return PermuteTensorKernelImpl(in1, perm, out, el_size);
+}
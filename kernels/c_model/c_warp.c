@@ -87,6 +87,245 @@ static void transform_perspective(vx_uint32 dst_x, vx_uint32 dst_y, const vx_flo
     *src_y = (dst_x * m[1] + dst_y * m[4] + m[7]) / z;
 }
 
+/*! \brief The number of destination pixels whose source coordinates are computed together. */
+#define WARP_BLOCK (64)
+
+/*! \brief The least number of rows worth a thread of their own. */
+#define WARP_ROWS_PER_THREAD (16)
+
+typedef struct _warp_8u_t {
+    void *src_base;
+    vx_imagepatch_addressing_t *src_addr;
+    void *dst_base;
+    vx_imagepatch_addressing_t *dst_addr;
+    const vx_float32 *m;
+    vx_bool perspective;
+    vx_enum type;
+    const vx_border_t *borders;
+    vx_float32 start_x;
+    vx_float32 start_y;
+} warp_8u_t;
+
+/*! \brief Whether every tap of a source coordinate is inside the source, using the same
+ * comparisons as read_pixel_8u_C1 so that both paths agree on each pixel.
+ */
+static C_KERNEL_INLINE vx_bool warp_inside(const warp_8u_t *w, vx_float32 xf, vx_float32 yf)
+{
+    vx_float32 dim_x = (vx_float32)w->src_addr->dim_x;
+    vx_float32 dim_y = (vx_float32)w->src_addr->dim_y;
+    if (w->type == VX_INTERPOLATION_NEAREST_NEIGHBOR)
+        return (xf >= 0 && yf >= 0 && xf < dim_x && yf < dim_y) ? vx_true_e : vx_false_e;
+    else
+        return (xf >= 0 && yf >= 0 && floorf(xf) + 1 < dim_x && floorf(yf) + 1 < dim_y) ? vx_true_e : vx_false_e;
+}
+
+/*! \brief The source coordinates of destination pixels [x0, x0 + n) of row y. The expressions
+ * keep the association of transform_affine and transform_perspective, so the coordinates are
+ * bit identical to them; only the row terms are hoisted.
+ */
+static void warp_coords(const warp_8u_t *w, vx_uint32 x0, vx_uint32 n, vx_uint32 y, vx_float32 xs[], vx_float32 ys[])
+{
+    const vx_float32 *m = w->m;
+    vx_uint32 i;
+
+    if (w->perspective)
+    {
+        vx_float32 yz = y * m[5];
+        vx_float32 yx = y * m[3];
+        vx_float32 yy = y * m[4];
+        for (i = 0; i < n; i++)
+        {
+            vx_uint32 x = x0 + i;
+            vx_float32 z = x * m[2] + yz + m[8];
+            xs[i] = (x * m[0] + yx + m[6]) / z - w->start_x;
+            ys[i] = (x * m[1] + yy + m[7]) / z - w->start_y;
+        }
+    }
+    else
+    {
+        vx_float32 yx = y * m[2];
+        vx_float32 yy = y * m[3];
+        for (i = 0; i < n; i++)
+        {
+            vx_uint32 x = x0 + i;
+            xs[i] = x * m[0] + yx + m[4] - w->start_x;
+            ys[i] = x * m[1] + yy + m[5] - w->start_y;
+        }
+    }
+}
+
+/*! \brief The span [*x0, *x1) of an affine row whose taps are all inside the source.
+ * The coordinates are monotonic along a row even after float rounding, so the span is
+ * estimated in double and then its end points are checked exactly.
+ */
+static void warp_affine_span(const warp_8u_t *w, vx_uint32 y, vx_uint32 width, vx_uint32 *x0, vx_uint32 *x1)
+{
+    const vx_float32 *m = w->m;
+    vx_float64 lo = 0.0, hi = (vx_float64)width;
+    vx_float64 limits[2] = {(vx_float64)w->src_addr->dim_x, (vx_float64)w->src_addr->dim_y};
+    vx_float64 steps[2] = {m[0], m[1]};
+    vx_float64 bases[2] = {(vx_float64)y * m[2] + m[4] - w->start_x, (vx_float64)y * m[3] + m[5] - w->start_y};
+    vx_uint32 c, a, b;
+
+    for (c = 0; c < 2; c++)
+    {
+        vx_float64 upper = (w->type == VX_INTERPOLATION_NEAREST_NEIGHBOR) ? limits[c] : limits[c] - 1.0;
+        if (steps[c] == 0.0)
+        {
+            if (bases[c] < 0.0 || bases[c] >= upper)
+                hi = lo;
+        }
+        else
+        {
+            vx_float64 t0 = (0.0 - bases[c]) / steps[c];
+            vx_float64 t1 = (upper - bases[c]) / steps[c];
+            if (t0 > t1)
+            {
+                vx_float64 t = t0; t0 = t1; t1 = t;
+            }
+            if (t0 > lo)
+                lo = t0;
+            if (t1 + 1.0 < hi)
+                hi = t1 + 1.0;
+        }
+    }
+    if (hi <= lo)
+    {
+        *x0 = *x1 = 0;
+        return;
+    }
+    a = (vx_uint32)ceil(lo);
+    b = (vx_uint32)hi;
+    if (b > width)
+        b = width;
+    while (a < b)
+    {
+        vx_float32 xs[1], ys[1];
+        warp_coords(w, a, 1, y, xs, ys);
+        if (warp_inside(w, xs[0], ys[0]))
+            break;
+        a++;
+    }
+    while (b > a)
+    {
+        vx_float32 xs[1], ys[1];
+        warp_coords(w, b - 1, 1, y, xs, ys);
+        if (warp_inside(w, xs[0], ys[0]))
+            break;
+        b--;
+    }
+    *x0 = a;
+    *x1 = b;
+}
+
+static void warp_block_inside(const warp_8u_t *w, vx_uint8 *dst, const vx_float32 xs[], const vx_float32 ys[], vx_uint32 n)
+{
+    const vx_uint8 *src = (const vx_uint8 *)w->src_base;
+    vx_int32 stride_y = w->src_addr->stride_y;
+    vx_int32 stride_x = w->src_addr->stride_x;
+    vx_int32 dst_stride_x = w->dst_addr->stride_x;
+    vx_uint32 i;
+
+    if (w->type == VX_INTERPOLATION_NEAREST_NEIGHBOR)
+    {
+        for (i = 0; i < n; i++)
+        {
+            dst[i * dst_stride_x] = src[(vx_uint32)ys[i] * stride_y + (vx_uint32)xs[i] * stride_x];
+        }
+    }
+    else
+    {
+        for (i = 0; i < n; i++)
+        {
+            vx_float32 fx = floorf(xs[i]);
+            vx_float32 fy = floorf(ys[i]);
+            const vx_uint8 *p = src + (vx_int32)fy * stride_y + (vx_int32)fx * stride_x;
+            vx_uint8 tl = p[0], tr = p[stride_x], bl = p[stride_y], br = p[stride_y + stride_x];
+            vx_float32 ar = xs[i] - fx;
+            vx_float32 ab = ys[i] - fy;
+            vx_float32 al = 1.0f - ar;
+            vx_float32 at = 1.0f - ab;
+            dst[i * dst_stride_x] = (vx_uint8)(tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab);
+        }
+    }
+}
+
+static void warp_block_border(const warp_8u_t *w, vx_uint8 *dst, const vx_float32 xs[], const vx_float32 ys[], vx_uint32 n)
+{
+    vx_int32 dst_stride_x = w->dst_addr->stride_x;
+    vx_uint32 i;
+
+    for (i = 0; i < n; i++)
+    {
+        vx_float32 xf = xs[i];
+        vx_float32 yf = ys[i];
+        if (w->type == VX_INTERPOLATION_NEAREST_NEIGHBOR)
+        {
+            read_pixel_8u_C1(w->src_base, w->src_addr, xf, yf, w->borders, &dst[i * dst_stride_x]);
+        }
+        else
+        {
+            vx_uint8 tl = 0, tr = 0, bl = 0, br = 0;
+            vx_bool defined = vx_true_e;
+            defined &= read_pixel_8u_C1(w->src_base, w->src_addr, floorf(xf), floorf(yf), w->borders, &tl);
+            defined &= read_pixel_8u_C1(w->src_base, w->src_addr, floorf(xf) + 1, floorf(yf), w->borders, &tr);
+            defined &= read_pixel_8u_C1(w->src_base, w->src_addr, floorf(xf), floorf(yf) + 1, w->borders, &bl);
+            defined &= read_pixel_8u_C1(w->src_base, w->src_addr, floorf(xf) + 1, floorf(yf) + 1, w->borders, &br);
+            if (defined)
+            {
+                vx_float32 ar = xf - floorf(xf);
+                vx_float32 ab = yf - floorf(yf);
+                vx_float32 al = 1.0f - ar;
+                vx_float32 at = 1.0f - ab;
+                dst[i * dst_stride_x] = (vx_uint8)(tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab);
+            }
+        }
+    }
+}
+
+/*! \brief Warps destination rows [start, end). Affine rows take the unchecked path over their
+ * interior span; perspective rows are classified block by block.
+ */
+static void warp_rows_8u(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const warp_8u_t *w = (const warp_8u_t *)arg;
+    vx_uint32 width = w->dst_addr->dim_x;
+    vx_float32 xs[WARP_BLOCK];
+    vx_float32 ys[WARP_BLOCK];
+    vx_uint32 x, y;
+
+    for (y = start; y < end; y++)
+    {
+        vx_uint32 span0 = 0, span1 = 0;
+        if (w->perspective == vx_false_e)
+            warp_affine_span(w, y, width, &span0, &span1);
+
+        for (x = 0; x < width; x += WARP_BLOCK)
+        {
+            vx_uint32 n = (width - x < WARP_BLOCK) ? width - x : WARP_BLOCK;
+            vx_uint8 *dst = (vx_uint8 *)vxFormatImagePatchAddress2d(w->dst_base, x, y, w->dst_addr);
+            vx_bool inside;
+
+            warp_coords(w, x, n, y, xs, ys);
+            if (w->perspective == vx_false_e)
+            {
+                inside = (x >= span0 && x + n <= span1) ? vx_true_e : vx_false_e;
+            }
+            else
+            {
+                vx_uint32 i;
+                inside = vx_true_e;
+                for (i = 0; (i < n) && inside; i++)
+                    inside = warp_inside(w, xs[i], ys[i]);
+            }
+            if (inside)
+                warp_block_inside(w, dst, xs, ys, n);
+            else
+                warp_block_border(w, dst, xs, ys, n);
+        }
+    }
+}
+
 static vx_status vxWarpGeneric(vx_image src_image, vx_matrix matrix, vx_scalar stype, vx_image dst_image,
                                const vx_border_t *borders, transform_f transform)
 {
@@ -128,7 +367,23 @@ static vx_status vxWarpGeneric(vx_image src_image, vx_matrix matrix, vx_scalar s
     status |= vxCopyMatrix(matrix, m, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
     status |= vxCopyScalar(stype, &type, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
 
-    if (status == VX_SUCCESS)
+    if ((status == VX_SUCCESS) && (format != VX_DF_IMAGE_U1) &&
+        ((type == VX_INTERPOLATION_NEAREST_NEIGHBOR) || (type == VX_INTERPOLATION_BILINEAR)))
+    {
+        warp_8u_t w;
+        w.src_base = src_base;
+        w.src_addr = &src_addr;
+        w.dst_base = dst_base;
+        w.dst_addr = &dst_addr;
+        w.m = m;
+        w.perspective = (transform == transform_perspective) ? vx_true_e : vx_false_e;
+        w.type = type;
+        w.borders = borders;
+        w.start_x = (vx_float32)src_rect.start_x;
+        w.start_y = (vx_float32)src_rect.start_y;
+        ParallelForImpl(dst_addr.dim_y, WARP_ROWS_PER_THREAD, warp_rows_8u, &w);
+    }
+    else if (status == VX_SUCCESS && format == VX_DF_IMAGE_U1)
     {
         for (y = 0u; y < dst_addr.dim_y; y++)
         {
@@ -141,34 +396,20 @@ static vx_status vxWarpGeneric(vx_image src_image, vx_matrix matrix, vx_scalar s
                 transform(x, y, m, &xf, &yf);
                 xf -= (vx_float32)src_rect.start_x;
                 yf -= (vx_float32)src_rect.start_y;
-                if (format == VX_DF_IMAGE_U1)   // Add bit-shift offset
-                    xf += shift_x_u1;
+                xf += shift_x_u1;   // Add bit-shift offset
 
                 if (type == VX_INTERPOLATION_NEAREST_NEIGHBOR)
                 {
-                    if (format == VX_DF_IMAGE_U1)
-                        read_pixel_1u_C1(src_base, &src_addr, xf, yf, borders, dst, x, shift_x_u1);
-                    else
-                        read_pixel_8u_C1(src_base, &src_addr, xf, yf, borders, dst);
+                    read_pixel_1u_C1(src_base, &src_addr, xf, yf, borders, dst, x, shift_x_u1);
                 }
                 else if (type == VX_INTERPOLATION_BILINEAR)
                 {
                     vx_uint8 tl = 0, tr = 0, bl = 0, br = 0;
                     vx_bool defined = vx_true_e;
-                    if (format == VX_DF_IMAGE_U1)
-                    {
-                        defined &= read_pixel_1u_C1(src_base, &src_addr, floorf(xf), floorf(yf), borders, &tl, 0, shift_x_u1);
-                        defined &= read_pixel_1u_C1(src_base, &src_addr, floorf(xf) + 1, floorf(yf), borders, &tr, 0, shift_x_u1);
-                        defined &= read_pixel_1u_C1(src_base, &src_addr, floorf(xf), floorf(yf) + 1, borders, &bl, 0, shift_x_u1);
-                        defined &= read_pixel_1u_C1(src_base, &src_addr, floorf(xf) + 1, floorf(yf) + 1, borders, &br, 0, shift_x_u1);
-                    }
-                    else
-                    {
-                        defined &= read_pixel_8u_C1(src_base, &src_addr, floorf(xf), floorf(yf), borders, &tl);
-                        defined &= read_pixel_8u_C1(src_base, &src_addr, floorf(xf) + 1, floorf(yf), borders, &tr);
-                        defined &= read_pixel_8u_C1(src_base, &src_addr, floorf(xf), floorf(yf) + 1, borders, &bl);
-                        defined &= read_pixel_8u_C1(src_base, &src_addr, floorf(xf) + 1, floorf(yf) + 1, borders, &br);
-                    }
+                    defined &= read_pixel_1u_C1(src_base, &src_addr, floorf(xf), floorf(yf), borders, &tl, 0, shift_x_u1);
+                    defined &= read_pixel_1u_C1(src_base, &src_addr, floorf(xf) + 1, floorf(yf), borders, &tr, 0, shift_x_u1);
+                    defined &= read_pixel_1u_C1(src_base, &src_addr, floorf(xf), floorf(yf) + 1, borders, &bl, 0, shift_x_u1);
+                    defined &= read_pixel_1u_C1(src_base, &src_addr, floorf(xf) + 1, floorf(yf) + 1, borders, &br, 0, shift_x_u1);
 
                     if (defined)
                     {
@@ -177,16 +418,9 @@ static vx_status vxWarpGeneric(vx_image src_image, vx_matrix matrix, vx_scalar s
                         vx_float32 al = 1.0f - ar;
                         vx_float32 at = 1.0f - ab;
 
-                        if (format == VX_DF_IMAGE_U1)
-                        {
-                            // Arithmetic rounding instead of truncation for U1 images
-                            vx_uint8 dst_val = (vx_uint8)(tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab + 0.5);
-                            *dst = (*dst & ~(1 << (x % 8))) | (dst_val << (x % 8));
-                        }
-                        else
-                        {
-                            *dst = (vx_uint8)(tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab);
-                        }
+                        // Arithmetic rounding instead of truncation for U1 images
+                        vx_uint8 dst_val = (vx_uint8)(tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab + 0.5);
+                        *dst = (*dst & ~(1 << (x % 8))) | (dst_val << (x % 8));
                     }
                 }
             }
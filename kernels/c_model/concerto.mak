@@ -21,7 +21,7 @@ include $(PRELUDE)
 TARGET      := openvx-c_model-lib
 TARGETTYPE  := library
 CSOURCES    := $(call all-c-files)
-IDIRS       := $(HOST_ROOT)/debug $(HOST_ROOT)/utils
+IDIRS       := $(HOST_ROOT)/$(OPENVX_SRC)/include $(HOST_ROOT)/debug $(HOST_ROOT)/utils
 SHARED_LIBS := openvx
 include $(FINALE)
 
@@ -31,6 +31,11 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 
 #define NUM_OF_LAYERS_OVERFEAT           18
@@ -120,6 +125,25 @@ float short2float(int16_t val) {
 }
 
 
+// The duration of the last network graph run, see GetLastProcessTime.
+static vx_uint64 last_process_time = 0;
+
+// Runs a network graph and records how long vxProcessGraph alone took.
+static vx_status ProcessNetworkGraph(vx_graph graph) {
+    vx_perf_t perf;
+    vx_status status = vxProcessGraph(graph);
+
+    last_process_time = 0;
+    if (status == VX_SUCCESS &&
+            vxQueryGraph(graph, VX_GRAPH_PERFORMANCE, &perf, sizeof(perf)) == VX_SUCCESS)
+        last_process_time = perf.tmp;
+    return status;
+}
+
+vx_uint64 GetLastProcessTime(void) {
+    return last_process_time;
+}
+
 void dumpToFile(vx_tensor md_data, int id, std::string name = "")
 {
 #ifdef _CNN_DUMP_
@@ -467,10 +491,22 @@ void preprocessOrigImageAlexnet(vx_context context, uint8_t *pinput,
 }
 
 
-int Overfeat(int16_t** ppdata, vx_enum format, vx_int8 fp_pos, bool raw,
-        int16_t *output) {
-    vx_bool dump = vx_false_e;
-
+// The Overfeat graph and the tensors it owns. With batch 0 the tensors are
+// created without a batch dimension, otherwise they all get a last dimension
+// of batch.
+typedef struct _overfeat_network
+{
+    vx_graph graph;
+    vx_tensor in;
+    vx_tensor out;
+    vx_tensor wt_data[NUM_OF_LAYERS_OVERFEAT];
+    vx_tensor bs_data[NUM_OF_LAYERS_OVERFEAT];
+    vx_tensor out_data[NUM_OF_LAYERS_OVERFEAT];
+    std::vector<vx_node> nodes;
+} overfeat_network;
+
+static vx_status CreateOverfeatNetwork(vx_context context, int16_t *pInt16Params,
+        vx_enum format, vx_int8 fp_pos, vx_size batch, overfeat_network *net) {
     // Definitions
     vx_size wt_dims[NUM_OF_LAYERS_OVERFEAT][6] = { { 11, 11, 3, 96, 0, 0 }, {0,0,0,0,0,0}, {0,0,0,0,0,0},
             {5, 5, 96, 256, 0, 0 }, {0,0,0,0,0,0}, {0,0,0,0,0,0},
@@ -495,54 +531,20 @@ int Overfeat(int16_t** ppdata, vx_enum format, vx_int8 fp_pos, bool raw,
             { 4096, 0, 0, 0, 0, 0 }, { 4096, 0, 0, 0, 0, 0 },
             { 1000, 0, 0, 0, 0, 0 }, };
 
-    // Get input
-    uint8_t *pInput = *(uint8_t**) ppdata;
-
-    // Get weights
-    int16_t *pInt16Params = (int16_t *) *(ppdata + 1);
-
     size_t offset = 0;
-
-    // Building overfeat network
-    // Edges
     vx_status status = VX_SUCCESS;
-    vx_context context = vxCreateContext();
 
     vx_size dim_max = 0;
     vxQueryContext(context, VX_CONTEXT_MAX_TENSOR_DIMS, &dim_max,
             sizeof(dim_max));
-    vx_graph graph;
-    graph = vxCreateGraph(context);
 
-    void *ptr = NULL;
+    memset(net->wt_data, 0, sizeof(net->wt_data));
+    memset(net->bs_data, 0, sizeof(net->bs_data));
+    memset(net->out_data, 0, sizeof(net->out_data));
+    net->graph = vxCreateGraph(context);
 
-    vx_tensor wt_data[NUM_OF_LAYERS_OVERFEAT] = { 0 };
-    vx_tensor bs_data[NUM_OF_LAYERS_OVERFEAT] = { 0 };
-    vx_tensor out_data[NUM_OF_LAYERS_OVERFEAT] = { 0 };
-
-    printf("Building MD Datas\n");
-    vx_size sizes[3] = { 231, 231, 3 };
-    vx_tensor in = vxCreateTensor(context, 3, sizes, format, fp_pos);
-    void *base = NULL;
-    if (raw) {
-        if (format == VX_TYPE_INT16) {
-            // if patch was not preprocessed yet - preprocess it
-            vx_rectangle_t rect = { 0, 0, 231, 231 };
-            vx_object_array inImgs = vxCreateImageObjectArrayFromTensor(in,
-                    &rect, 3, 1, VX_DF_IMAGE_S16);
-            preprocessImageNetQ78(context, pInput, 231, inImgs);
-            vxReleaseObjectArray(&inImgs);
-        }
-#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
-        else if (format == VX_TYPE_FLOAT16) {
-            preprocessImageNetF16(context, pInput, in);
-        }
-#endif
-    } else {
-        status |= (CopyToFromTensor(context, in, (int16_t*) pInput, -1,
-                VX_WRITE_ONLY) <= 0);
-        // We received a preprocessed patch - use as is
-    }
+    vx_size sizes[4] = { 231, 231, 3, batch };
+    net->in = vxCreateTensor(context, batch ? 4 : 3, sizes, format, fp_pos);
 
     int out_dim = 0;
     int wo_wt = 0;
@@ -561,13 +563,13 @@ int Overfeat(int16_t** ppdata, vx_enum format, vx_int8 fp_pos, bool raw,
         }
 
         if (wt_dim > 0) {
-            wt_data[i-wo_wt] = vxCreateTensor(context, wt_dim, wt_dims[i], format,
+            net->wt_data[i-wo_wt] = vxCreateTensor(context, wt_dim, wt_dims[i], format,
                     fp_pos);
-            offset += CopyToFromTensor(context, wt_data[i-wo_wt],
+            offset += CopyToFromTensor(context, net->wt_data[i-wo_wt],
                     pInt16Params + offset, wt_size, VX_WRITE_ONLY);
-            bs_data[i-wo_wt] = vxCreateTensor(context, 1, &wt_dims[i][wt_dim - 1],
+            net->bs_data[i-wo_wt] = vxCreateTensor(context, 1, &wt_dims[i][wt_dim - 1],
                     format, fp_pos);
-            offset += CopyToFromTensor(context, bs_data[i-wo_wt],
+            offset += CopyToFromTensor(context, net->bs_data[i-wo_wt],
                     pInt16Params + offset, 2*wt_dims[i][wt_dim - 1],
                     VX_WRITE_ONLY);
         } else {
@@ -575,20 +577,24 @@ int Overfeat(int16_t** ppdata, vx_enum format, vx_int8 fp_pos, bool raw,
         }
 
         if (out_dim > 0) {
-            out_data[i] = vxCreateTensor(context, out_dim, out_dims[i],
+            if (batch)
+                out_dims[i][out_dim++] = batch;
+            net->out_data[i] = vxCreateTensor(context, out_dim, out_dims[i],
                     format, fp_pos);
             //          out_data[i] = vxCreateVirtualTensor(graph, out_dim, out_dims[i],
             //                  format, fp_pos);
         }
     }
 
-    vx_tensor out = vxCreateTensor(context, out_dim,
+    net->out = vxCreateTensor(context, out_dim,
             out_dims[NUM_OF_LAYERS_OVERFEAT - 1], format, fp_pos);
 
-
-
-    printf("MD Datas ready\n");
-    printf("Building and processing graph.\n");
+    vx_graph graph = net->graph;
+    vx_tensor in = net->in;
+    vx_tensor out = net->out;
+    vx_tensor *wt_data = net->wt_data;
+    vx_tensor *bs_data = net->bs_data;
+    vx_tensor *out_data = net->out_data;
 
     //Nodes
     if (graph) {
@@ -635,46 +641,275 @@ int Overfeat(int16_t** ppdata, vx_enum format, vx_int8 fp_pos, bool raw,
                 // Softmax
                 vxSoftmaxLayer(graph, out_data[17], out), };
 
-        vx_status status = vxVerifyGraph(graph);
+        net->nodes.assign(cnn_nodes, cnn_nodes + sizeof(cnn_nodes) / sizeof(cnn_nodes[0]));
+    } else {
+        status = VX_FAILURE;
+    }
+
+    return status;
+}
+
+static void ReleaseOverfeatNetwork(overfeat_network *net) {
+    for (size_t n = 0; n < net->nodes.size(); n++) {
+        vxReleaseNode(&net->nodes[n]);
+    }
+    net->nodes.clear();
+
+    if (net->graph)
+        vxReleaseGraph(&net->graph);
+    if (net->in)
+        vxReleaseTensor(&net->in);
+    if (net->out)
+        vxReleaseTensor(&net->out);
+    for (int i = 0; i < NUM_OF_LAYERS_OVERFEAT; i++) {
+        if (net->wt_data[i])
+            vxReleaseTensor(&net->wt_data[i]);
+        if (net->bs_data[i])
+            vxReleaseTensor(&net->bs_data[i]);
+        if (net->out_data[i])
+            vxReleaseTensor(&net->out_data[i]);
+    }
+}
+
+int Overfeat(int16_t** ppdata, vx_enum format, vx_int8 fp_pos, bool raw,
+        int16_t *output) {
+    last_process_time = 0;
+    vx_bool dump = vx_false_e;
+
+    // Get input
+    uint8_t *pInput = *(uint8_t**) ppdata;
+
+    // Get weights
+    int16_t *pInt16Params = (int16_t *) *(ppdata + 1);
+
+    // Building overfeat network
+    // Edges
+    vx_context context = vxCreateContext();
+    overfeat_network net;
+
+    printf("Building MD Datas\n");
+    vx_status status = CreateOverfeatNetwork(context, pInt16Params, format, fp_pos, 0, &net);
+
+    if (raw) {
+        if (format == VX_TYPE_INT16) {
+            // if patch was not preprocessed yet - preprocess it
+            vx_rectangle_t rect = { 0, 0, 231, 231 };
+            vx_object_array inImgs = vxCreateImageObjectArrayFromTensor(net.in,
+                    &rect, 3, 1, VX_DF_IMAGE_S16);
+            preprocessImageNetQ78(context, pInput, 231, inImgs);
+            vxReleaseObjectArray(&inImgs);
+        }
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+        else if (format == VX_TYPE_FLOAT16) {
+            preprocessImageNetF16(context, pInput, net.in);
+        }
+#endif
+    } else {
+        status |= (CopyToFromTensor(context, net.in, (int16_t*) pInput, -1,
+                VX_WRITE_ONLY) <= 0);
+        // We received a preprocessed patch - use as is
+    }
+
+    printf("MD Datas ready\n");
+    printf("Building and processing graph.\n");
+
+    if (status == VX_SUCCESS) {
+        vx_status status = vxVerifyGraph(net.graph);
         if (status == VX_SUCCESS) {
-            status = vxProcessGraph(graph);
+            status = ProcessNetworkGraph(net.graph);
         }
 
         if (status == VX_SUCCESS) {
             for (int i = 0; i < 8; i++)
                 if (dump)
-                    dumpToFile(out_data[i], i);
-            CopyToFromTensor(context, out, output, -1, VX_READ_ONLY);
+                    dumpToFile(net.out_data[i], i);
+            CopyToFromTensor(context, net.out, output, -1, VX_READ_ONLY);
+        }
+    }
+
+    ReleaseOverfeatNetwork(&net);
+
+    if (status == VX_SUCCESS)
+        return 0;
+    else
+        return -1;
+}
+
+// A batched Overfeat: the graph is built once for batch_size patches and
+// requests queued by RunBatchRequest fill its batch slots. A batch runs once
+// it is full, or once the oldest request has waited flush_timeout_ms, on a
+// worker thread which then hands each request its own output.
+typedef struct _batch_request
+{
+    const int16_t *input;
+    int16_t *output;
+    std::chrono::steady_clock::time_point queued_at;
+    vx_status status;
+    bool done;
+} batch_request;
+
+struct _cnn_batch_runner
+{
+    vx_context context;
+    overfeat_network net;
+    vx_size batch_size;
+    std::chrono::milliseconds flush_timeout;
+
+    std::mutex lock;
+    std::condition_variable queued;
+    std::condition_variable finished;
+    std::deque<batch_request *> requests;
+    bool stopping;
+    std::thread worker;
+};
+
+// Copies one request to or from its slot of a tensor whose last dimension
+// is the batch
+static vx_status CopyBatchSlot(vx_tensor tensor, vx_size slot, int16_t *buffer,
+        vx_accessor_e accessor) {
+    vx_size numDims = 0;
+    vx_status status = vxQueryTensor(tensor, VX_TENSOR_NUMBER_OF_DIMS, &numDims, sizeof(numDims));
+    std::vector<vx_size> start(numDims, 0);
+    std::vector<vx_size> end(numDims);
+    std::vector<vx_size> strides(numDims);
+    status |= vxQueryTensor(tensor, VX_TENSOR_DIMS, &end[0], end.size()*sizeof(vx_size));
+    if (status != VX_SUCCESS)
+        return status;
+
+    start[numDims - 1] = slot;
+    end[numDims - 1] = slot + 1;
+    for (vx_size i = 0; i < numDims; i++) {
+        strides[i] = (i == 0) ? sizeof(int16_t) : strides[i - 1] * end[i - 1];
+    }
+
+    return vxCopyTensorPatch(tensor, numDims, &start[0], &end[0], &strides[0], buffer,
+            accessor, VX_MEMORY_TYPE_HOST);
+}
+
+static vx_status RunBatch(cnn_batch_runner runner, batch_request **batch, vx_size count) {
+    vx_status status = VX_SUCCESS;
+
+    // Slots past count keep the previous batch's patches, their results are dropped
+    for (vx_size i = 0; i < count && status == VX_SUCCESS; i++) {
+        status = CopyBatchSlot(runner->net.in, i, (int16_t *)batch[i]->input, VX_WRITE_ONLY);
+    }
+    if (status == VX_SUCCESS) {
+        status = vxProcessGraph(runner->net.graph);
+    }
+    for (vx_size i = 0; i < count && status == VX_SUCCESS; i++) {
+        status = CopyBatchSlot(runner->net.out, i, batch[i]->output, VX_READ_ONLY);
+    }
+    return status;
+}
+
+static void BatchRunnerWorker(cnn_batch_runner runner) {
+    std::vector<batch_request *> batch(runner->batch_size);
+    std::unique_lock<std::mutex> guard(runner->lock);
+
+    for (;;) {
+        while (!runner->stopping && runner->requests.empty())
+            runner->queued.wait(guard);
+        if (runner->requests.empty())
+            break;
+
+        // Wait for the batch to fill, up to the timeout of its oldest request
+        const std::chrono::steady_clock::time_point deadline =
+                runner->requests.front()->queued_at + runner->flush_timeout;
+        while (!runner->stopping && runner->requests.size() < runner->batch_size &&
+                runner->queued.wait_until(guard, deadline) != std::cv_status::timeout)
+            ;
+
+        vx_size count = 0;
+        while (count < runner->batch_size && !runner->requests.empty()) {
+            batch[count++] = runner->requests.front();
+            runner->requests.pop_front();
         }
 
-        for (int n = 0; n < sizeof(cnn_nodes) / sizeof(cnn_nodes[0]); n++) {
-            vxReleaseNode(&cnn_nodes[n]);
+        guard.unlock();
+        vx_status status = RunBatch(runner, &batch[0], count);
+        guard.lock();
+
+        for (vx_size i = 0; i < count; i++) {
+            batch[i]->status = status;
+            batch[i]->done = true;
         }
+        runner->finished.notify_all();
+    }
+}
+
+cnn_batch_runner CreateOverfeatBatchRunner(int16_t** ppdata, vx_enum format,
+        vx_int8 fp_pos, vx_size batch_size, vx_uint32 flush_timeout_ms) {
+    if (batch_size == 0)
+        return NULL;
 
-        vxReleaseGraph(&graph);
+    // Get weights
+    int16_t *pInt16Params = (int16_t *) *(ppdata + 1);
+
+    cnn_batch_runner runner = new _cnn_batch_runner();
+    runner->context = vxCreateContext();
+    runner->batch_size = batch_size;
+    runner->flush_timeout = std::chrono::milliseconds(flush_timeout_ms);
+    runner->stopping = false;
+
+    vx_status status = vxGetStatus((vx_reference)runner->context);
+    if (status == VX_SUCCESS) {
+        status = CreateOverfeatNetwork(runner->context, pInt16Params, format, fp_pos,
+                batch_size, &runner->net);
+        if (status == VX_SUCCESS)
+            status = vxVerifyGraph(runner->net.graph);
+        if (status != VX_SUCCESS)
+            ReleaseOverfeatNetwork(&runner->net);
     }
 
-    if (in)
-        vxReleaseTensor(&in);
-    if (out)
-        vxReleaseTensor(&out);
-    for (int i = 0; i < NUM_OF_LAYERS_OVERFEAT; i++) {
-        if (wt_data[i])
-            vxReleaseTensor(&wt_data[i]);
-        if (bs_data[i])
-            vxReleaseTensor(&bs_data[i]);
-        if (out_data[i])
-            vxReleaseTensor(&out_data[i]);
+    if (status != VX_SUCCESS) {
+        printf("Failed to build the batched network\n");
+        vxReleaseContext(&runner->context);
+        delete runner;
+        return NULL;
     }
 
+    runner->worker = std::thread(BatchRunnerWorker, runner);
+    return runner;
+}
 
-    if (status == VX_SUCCESS)
-        return 0;
-    else
+int RunBatchRequest(cnn_batch_runner runner, const int16_t *input, int16_t *output) {
+    if (runner == NULL || input == NULL || output == NULL)
         return -1;
+
+    batch_request request = { input, output, std::chrono::steady_clock::now(), VX_SUCCESS, false };
+    std::unique_lock<std::mutex> guard(runner->lock);
+
+    if (runner->stopping)
+        return -1;
+    runner->requests.push_back(&request);
+    runner->queued.notify_one();
+
+    while (!request.done)
+        runner->finished.wait(guard);
+
+    return (request.status == VX_SUCCESS) ? 0 : -1;
+}
+
+void ReleaseBatchRunner(cnn_batch_runner *runner) {
+    if (runner == NULL || *runner == NULL)
+        return;
+
+    // Requests already queued still run
+    {
+        std::lock_guard<std::mutex> guard((*runner)->lock);
+        (*runner)->stopping = true;
+    }
+    (*runner)->queued.notify_one();
+    (*runner)->worker.join();
+
+    ReleaseOverfeatNetwork(&(*runner)->net);
+    vxReleaseContext(&(*runner)->context);
+    delete *runner;
+    *runner = NULL;
 }
 
 int Alexnet(int16_t** ppdata, bool raw, int16_t *output) {
+    last_process_time = 0;
     vx_bool dump = vx_true_e;
 
     // Definitions
@@ -953,7 +1188,7 @@ int Alexnet(int16_t** ppdata, bool raw, int16_t *output) {
 
                     status = vxVerifyGraph(graph);
                     if (status == VX_SUCCESS) {
-                        status = vxProcessGraph(graph);
+                        status = ProcessNetworkGraph(graph);
                     }
                     else
                     {
@@ -1314,6 +1549,7 @@ int Alexnet(int16_t** ppdata, bool raw, int16_t *output) {
 
 int Googlenet2(int16_t** ppdata, vx_enum format, vx_uint8 fp_pos, bool raw,
         bool immediate, int16_t *output) {
+    last_process_time = 0;
     /*  vx_bool dump = vx_false_e;
 
     vx_size wt_dims[NUM_OF_LAYERS_GOOGLENET2][6] = { { 7, 7, 3, 64, 0, 0 }, { 3,
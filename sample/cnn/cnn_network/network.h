@@ -33,6 +33,22 @@ int Overfeat(int16_t** ppdata, vx_enum format, vx_int8 fp_pos, bool raw,
 		int16_t *output);
 int Alexnet(int16_t** ppdata, bool raw, int16_t *output);
 int Googlenet2(int16_t** ppdata, vx_enum format, vx_uint8 fp_pos, bool raw, bool immediate, int16_t *output);
+/* Nanoseconds spent in vxProcessGraph by the last Overfeat, Alexnet or
+ * Googlenet2 call, excluding context creation and graph build/verify; 0 if
+ * that call did not process its graph. */
+vx_uint64 GetLastProcessTime(void);
+
+/* Batched Overfeat: the network is built once for batch_size preprocessed
+ * patches (as passed to Overfeat with raw false). RunBatchRequest queues one
+ * patch and blocks until its 1000 outputs are written; a batch runs once
+ * batch_size requests are queued or flush_timeout_ms after the oldest one.
+ * RunBatchRequest may be called from any number of threads. */
+typedef struct _cnn_batch_runner *cnn_batch_runner;
+
+cnn_batch_runner CreateOverfeatBatchRunner(int16_t** ppdata, vx_enum format, vx_int8 fp_pos,
+		vx_size batch_size, vx_uint32 flush_timeout_ms);
+int RunBatchRequest(cnn_batch_runner runner, const int16_t *input, int16_t *output);
+void ReleaseBatchRunner(cnn_batch_runner *runner);
 //int BDS(int16_t** ppdata, bool raw, bool immediate, int16_t *output);
 //int Test();
 
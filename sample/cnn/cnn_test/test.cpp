@@ -18,6 +18,7 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <thread>
 #include <stdint.h>
 #include "network.h"
 #include <half/sip_ml_fp16.hpp>
@@ -246,6 +247,64 @@ int verifyResult(const char *network, vx_enum format, int16_t *ptr,
 	return result;
 }
 
+#define BATCH_TEST_SIZE			4
+#define BATCH_TEST_REQUESTS		6	// a full batch, then one flushed by the timeout
+#define BATCH_TEST_TIMEOUT_MS	100
+
+// Queues BATCH_TEST_REQUESTS variants of the input patch on a batched Overfeat
+// from as many threads, and checks each output against a single-image Overfeat
+// run on the same patch.
+int verifyBatch(int16_t** ppdata, vx_enum format, vx_int8 pos, size_t inputSize) {
+	std::vector<std::vector<int16_t> > inputs(BATCH_TEST_REQUESTS, std::vector<int16_t>(inputSize));
+	std::vector<std::vector<int16_t> > outputs(BATCH_TEST_REQUESTS, std::vector<int16_t>(1000));
+	std::vector<int> results(BATCH_TEST_REQUESTS, -1);
+	std::vector<std::thread> clients;
+	int result = 0;
+
+	for (int r = 0; r < BATCH_TEST_REQUESTS; r++) {
+		// Shift every variant by its own offset so that no two share an output
+		for (size_t j = 0; j < inputSize; j++) {
+			int v = ppdata[0][j] + r * 16;
+			inputs[r][j] = (int16_t)(v > INT16_MAX ? INT16_MAX : v);
+		}
+	}
+
+	cnn_batch_runner runner = CreateOverfeatBatchRunner(ppdata, format, pos,
+			BATCH_TEST_SIZE, BATCH_TEST_TIMEOUT_MS);
+	if (runner == NULL) {
+		printf("Test Failed!!! Couldn't create the batch runner.\n");
+		return -1;
+	}
+	for (int r = 0; r < BATCH_TEST_REQUESTS; r++) {
+		clients.push_back(std::thread([&, r]() {
+			results[r] = RunBatchRequest(runner, &inputs[r][0], &outputs[r][0]);
+		}));
+	}
+	for (size_t r = 0; r < clients.size(); r++) {
+		clients[r].join();
+	}
+	ReleaseBatchRunner(&runner);
+
+	for (int r = 0; r < BATCH_TEST_REQUESTS; r++) {
+		std::vector<int16_t> expected(1000);
+		int16_t* single[2] = { &inputs[r][0], ppdata[1] };
+
+		if (results[r] != 0) {
+			printf("Request %d failed\n", r);
+			result = -1;
+		} else if (Overfeat(single, format, pos, false, &expected[0]) != 0) {
+			printf("Single-image Overfeat failed for request %d\n", r);
+			result = -1;
+		} else if (memcmp(&expected[0], &outputs[r][0], 1000 * sizeof(int16_t)) != 0) {
+			printf("Request %d differs from single-image Overfeat\n", r);
+			result = -1;
+		}
+	}
+
+	printf(result == 0 ? "Test Passed!!!\n" : "Test Failed!!! Batched results differ.\n");
+	return result;
+}
+
 int main(int argc, char* argv[]) {
 	//const char *networkType = "overfeat";//"alexnet";//"char-rnn";
 	char *networkType = argv[1];
@@ -266,7 +325,7 @@ int main(int argc, char* argv[]) {
 		goto error;
 	}
 
-	if (strcmp(networkType, "overfeat") == 0) {
+	if (strcmp(networkType, "overfeat") == 0 || strcmp(networkType, "overfeat_batch") == 0) {
 		output = (int16_t*) malloc(1000 * sizeof(int16_t));
 		inputSize = 160083;
 		if (argc > 2 && argv[2] != NULL) {
@@ -322,7 +381,7 @@ int main(int argc, char* argv[]) {
 	else //if (strcmp(networkType, "test") != 0)
 	{
 		printf(
-				"Unsupported CNN type. Supported networks are overfeat, alexnet, googlenet2.\n");
+				"Unsupported CNN type. Supported networks are overfeat, overfeat_batch, alexnet, googlenet2.\n");
 		goto error;
 	}
 
@@ -365,6 +424,8 @@ int main(int argc, char* argv[]) {
 				return verifyResult(networkType, format, output, 1000);
 			}
 		}
+	} else if (strcmp(networkType, "overfeat_batch") == 0) {
+		return verifyBatch(data, format, pos, inputSize);
 	} else if (strcmp(networkType, "alexnet") == 0) {
 		if (Alexnet(data, false, output) == 0) {
 			if (argc > 4 && argv[4] != NULL) {
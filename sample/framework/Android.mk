@@ -46,7 +46,8 @@ LOCAL_SRC_FILES := \
 	vx_remap.c \
 	vx_scalar.c \
 	vx_target.c \
-	vx_threshold.c
+	vx_threshold.c \
+	vx_trace.c
 LOCAL_C_INCLUDES := $(OPENVX_INC) $(OPENVX_TOP)/$(OPENVX_SRC)/include $(OPENVX_TOP)/debug
 LOCAL_WHOLE_STATIC_LIBRARIES := libopenvx-helper libopenvx-debug
 LOCAL_SHARED_LIBRARIES := libdl libutils libcutils libbinder libhardware libion libgui libui
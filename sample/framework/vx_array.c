@@ -884,6 +884,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyArrayRange(vx_array arr, vx_size start,
                                                     void *ptr, vx_enum usage, vx_enum mem_type)
 {
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
     /* bad references */
     if (vxIsValidArray(arr) == vx_false_e)
     {
@@ -919,7 +920,9 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyArrayRange(vx_array arr, vx_size start,
     }
 #endif
 
+    trace_start = ownTraceTime(arr->base.context);
     status = ownCopyArrayRangeInt(arr, start, end, stride, ptr, usage, mem_type);
+    ownTraceComplete(arr->base.context, VX_TRACE_CATEGORY_MEMORY, "vxCopyArrayRange", arr, trace_start);
 
 #ifdef OPENVX_USE_OPENCL_INTEROP
     if (mem_type_given == VX_MEMORY_TYPE_OPENCL_BUFFER)
@@ -937,6 +940,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapArrayRange(vx_array arr, vx_size start,
                                                    void **ptr, vx_enum usage, vx_enum mem_type, vx_uint32 flags)
 {
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
     /* bad references */
     if (vxIsValidArray(arr) == vx_false_e)
     {
@@ -952,7 +956,9 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapArrayRange(vx_array arr, vx_size start,
     }
 #endif
 
+    trace_start = ownTraceTime(arr->base.context);
     status = ownMapArrayRangeInt(arr, start, end, map_id, stride, ptr, usage, mem_type, flags);
+    ownTraceComplete(arr->base.context, VX_TRACE_CATEGORY_MEMORY, "vxMapArrayRange", arr, trace_start);
 
 #ifdef OPENVX_USE_OPENCL_INTEROP
     vx_size size = (end - start) * *stride;
@@ -985,6 +991,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapArrayRange(vx_array arr, vx_size start,
 VX_API_ENTRY vx_status VX_API_CALL vxUnmapArrayRange(vx_array arr, vx_map_id map_id)
 {
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
     /* bad references */
     if (vxIsValidArray(arr) == vx_false_e)
     {
@@ -1008,7 +1015,9 @@ VX_API_ENTRY vx_status VX_API_CALL vxUnmapArrayRange(vx_array arr, vx_map_id map
     }
 #endif
 
+    trace_start = ownTraceTime(arr->base.context);
     status = ownUnmapArrayRangeInt(arr, map_id);
+    ownTraceComplete(arr->base.context, VX_TRACE_CATEGORY_MEMORY, "vxUnmapArrayRange", arr, trace_start);
 
     return status;
 }
@@ -70,7 +70,9 @@ static vx_bool vxWorkerNode(vx_threadpool_worker_t *worker)
     }
 
     VX_PRINT(VX_ZONE_GRAPH, "Executing %s on target %s\n", node->kernel->name, target->name);
+    ownTraceBegin(node->base.context, VX_TRACE_CATEGORY_NODE, node->kernel->name, node);
     action = target->funcs.process(target, &node, 0, 1);
+    ownTraceEnd(node->base.context, VX_TRACE_CATEGORY_NODE, node->kernel->name, node);
     VX_PRINT(VX_ZONE_GRAPH, "Executed %s on target %s with action %d returned\n", node->kernel->name, target->name, action);
 
     /* turn on access to virtual memory */
@@ -479,6 +481,7 @@ VX_API_ENTRY vx_context VX_API_CALL vxCreateContext(void)
             context->next_dynamic_user_kernel_id = 0;
             context->next_dynamic_user_library_id = 1;
             context->perf_enabled = vx_false_e;
+            ownInitTrace(context);
             ownInitReference(&context->base, NULL, VX_TYPE_CONTEXT, NULL);
 #if !DISABLE_ICD_COMPATIBILITY
             context->base.platform = platform;
@@ -509,6 +512,7 @@ VX_API_ENTRY vx_context VX_API_CALL vxCreateContext(void)
             if (context->num_targets == 0)
             {
                 VX_PRINT(VX_ZONE_ERROR, "No targets loaded!\n");
+                ownDestroySem(&context->trace_lock);
                 free(context);
                 ownSemPost(&context_lock);
                 return 0;
@@ -612,6 +616,9 @@ VX_API_ENTRY vx_status VX_API_CALL vxReleaseContext(vx_context *c)
             ownDeinitQueue(&context->proc.output);
             ownDeinitQueue(&context->proc.input);
 
+            /* all threads are joined, so the trace is complete */
+            ownDeinitTrace(context);
+
             /* Deregister any log callbacks if there is any registered */
             vxRegisterLogCallback(context, NULL, vx_false_e);
 
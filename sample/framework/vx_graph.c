@@ -235,6 +235,60 @@ void ownClearExecution(vx_graph graph)
         graph->nodes[n]->executed = vx_false_e;
 }
 
+static vx_uint32 vxHashBytes(vx_uint32 hash, const void *data, vx_size size)
+{
+    /* FNV-1a */
+    const vx_uint8 *bytes = (const vx_uint8 *)data;
+    vx_size i;
+    for (i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+vx_uint32 ownGraphStructureHash(vx_graph graph, vx_uint32 seed)
+{
+    vx_uint32 hash = vxHashBytes(2166136261u, &seed, sizeof(seed));
+    vx_uint32 n, p, n1, p1;
+
+    hash = vxHashBytes(hash, &graph->numNodes, sizeof(graph->numNodes));
+    for (n = 0; n < graph->numNodes; n++)
+    {
+        vx_node node = graph->nodes[n];
+        vx_target_t *target = &graph->base.context->targets[node->affinity];
+
+        hash = vxHashBytes(hash, node->kernel->name, strnlen(node->kernel->name, VX_MAX_KERNEL_NAME));
+        hash = vxHashBytes(hash, target->name, strnlen(target->name, VX_MAX_TARGET_NAME));
+        for (p = 0; p < node->kernel->signature.num_parameters; p++)
+        {
+            /* identify each parameter by the first (node, parameter) pair that references
+               it, so the hash describes the connectivity rather than the addresses */
+            vx_uint32 first[2] = {0xFFFFFFFF, 0xFFFFFFFF};
+            if (node->parameters[p])
+            {
+                for (n1 = 0; n1 <= n && first[0] == 0xFFFFFFFF; n1++)
+                {
+                    vx_uint32 np = (n1 == n) ? p + 1 : graph->nodes[n1]->kernel->signature.num_parameters;
+                    for (p1 = 0; p1 < np; p1++)
+                    {
+                        if (graph->nodes[n1]->parameters[p1] == node->parameters[p])
+                        {
+                            first[0] = n1;
+                            first[1] = p1;
+                            break;
+                        }
+                    }
+                }
+            }
+            hash = vxHashBytes(hash, &node->kernel->signature.directions[p], sizeof(vx_enum));
+            hash = vxHashBytes(hash, first, sizeof(first));
+        }
+    }
+    return hash;
+}
+
 vx_status ownTraverseGraph(vx_graph graph,
                           vx_uint32 parentIndex,
                           vx_uint32 childIndex)
@@ -1749,8 +1803,11 @@ VX_API_ENTRY vx_status VX_API_CALL vxVerifyGraph(vx_graph graph)
     vx_status status = VX_SUCCESS;
     vx_uint32 num_errors = 0u;
     vx_bool first_time_verify = ((graph->verified == vx_false_e) && (graph->reverify == vx_false_e)) ? vx_true_e : vx_false_e;
+    /* an adopted execution plan only covers the verification immediately following the import */
+    vx_bool planned = graph->planned;
 
     graph->verified = vx_false_e;
+    graph->planned = vx_false_e;
 
     if (ownIsValidReference(&graph->base) == vx_true_e)
     {
@@ -1765,9 +1822,11 @@ VX_API_ENTRY vx_status VX_API_CALL vxVerifyGraph(vx_graph graph)
           are inspected and their dependent attributes -such as geometry
           and type- are propagated. */
         VX_PRINT(VX_ZONE_GRAPH,"###########################\n");
-        VX_PRINT(VX_ZONE_GRAPH,"Topological Sort Phase\n");
+        VX_PRINT(VX_ZONE_GRAPH,"Topological Sort Phase%s\n", planned ? " (planned)" : "");
         VX_PRINT(VX_ZONE_GRAPH,"###########################\n");
-        vxTopologicalSort(graph, graph->nodes, graph->numNodes);
+        /* a planned graph was rebuilt in the order it was exported, which was already sorted */
+        if (planned == vx_false_e)
+            vxTopologicalSort(graph, graph->nodes, graph->numNodes);
 
         VX_PRINT(VX_ZONE_GRAPH,"###########################\n");
         VX_PRINT(VX_ZONE_GRAPH,"User Kernel Preprocess Phase! (%d)\n", status);
@@ -1989,7 +2048,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxVerifyGraph(vx_graph graph)
         VX_PRINT(VX_ZONE_GRAPH,"Single Writer Phase! (%d)\n", status);
         VX_PRINT(VX_ZONE_GRAPH,"####################\n");
 
-        for (n = 0; (n < graph->numNodes) && (status == VX_SUCCESS); n++)
+        for (n = 0; (n < graph->numNodes) && (status == VX_SUCCESS) && (planned == vx_false_e); n++)
         {
             for (p = 0; p < graph->nodes[n]->kernel->signature.num_parameters; p++)
             {
@@ -2115,11 +2174,15 @@ VX_API_ENTRY vx_status VX_API_CALL vxVerifyGraph(vx_graph graph)
         VX_PRINT(VX_ZONE_GRAPH,"Head Nodes Determination Phase! (%d)\n", status);
         VX_PRINT(VX_ZONE_GRAPH,"###############################\n");
 
-        memset(graph->heads, 0, sizeof(graph->heads));
-        graph->numHeads = 0;
+        /* the head list of a planned graph was restored by the importer */
+        if (planned == vx_false_e)
+        {
+            memset(graph->heads, 0, sizeof(graph->heads));
+            graph->numHeads = 0;
+        }
 
         /* now traverse the graph and put nodes with no predecessor in the head list */
-        for (n = 0; (n < graph->numNodes) && (status == VX_SUCCESS); n++)
+        for (n = 0; (n < graph->numNodes) && (status == VX_SUCCESS) && (planned == vx_false_e); n++)
         {
             uint32_t n1,p1;
             vx_bool isAHead = vx_true_e; /* assume every node is a head until proven otherwise */
@@ -2173,7 +2236,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxVerifyGraph(vx_graph graph)
         ownClearVisitation(graph);
 
         /* cycle checking by traversal of the graph from heads to tails */
-        for (h = 0; h < graph->numHeads; h++)
+        for (h = 0; (h < graph->numHeads) && (planned == vx_false_e); h++)
         {
             vx_status cycle_status = ownTraverseGraph(graph, VX_INT_MAX_NODES, graph->heads[h]);
             if (cycle_status != VX_SUCCESS)
@@ -2189,7 +2252,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxVerifyGraph(vx_graph graph)
         VX_PRINT(VX_ZONE_GRAPH,"Checking for Unvisited Nodes (%d)\n", status);
         VX_PRINT(VX_ZONE_GRAPH,"############################\n");
 
-        for (n = 0; (n < graph->numNodes) && (status == VX_SUCCESS); n++)
+        for (n = 0; (n < graph->numNodes) && (status == VX_SUCCESS) && (planned == vx_false_e); n++)
         {
             if (graph->nodes[n]->visited == vx_false_e)
             {
@@ -2380,6 +2443,7 @@ static vx_status vxExecuteGraph(vx_graph graph, vx_uint32 depth)
     {
         ownStartCapture(&graph->perf);
     }
+    ownTraceBegin(context, VX_TRACE_CATEGORY_GRAPH, "graph", graph);
     /* initialize the next_nodes as the graph heads */
     memcpy(next_nodes, graph->heads, graph->numHeads * sizeof(vx_uint32));
     numNext = graph->numHeads;
@@ -2425,7 +2489,9 @@ static vx_status vxExecuteGraph(vx_graph graph, vx_uint32 depth)
                              next_nodes[n],
                              target->name, node->kernel->name);
 
+                    ownTraceBegin(context, VX_TRACE_CATEGORY_NODE, node->kernel->name, node);
                     action = target->funcs.process(target, &node, 0, 1);
+                    ownTraceEnd(context, VX_TRACE_CATEGORY_NODE, node->kernel->name, node);
 
                     VX_PRINT(VX_ZONE_GRAPH, "Returned Node[%u] %s:%s Action %d\n",
                              next_nodes[n],
@@ -2456,11 +2522,19 @@ static vx_status vxExecuteGraph(vx_graph graph, vx_uint32 depth)
 #if defined(OPENVX_USE_SMP)
         if (depth == 1 && graph->should_serialize == vx_false_e)
         {
-            if (ownIssueThreadpool(graph->base.context->workers, workitems, numNext) == vx_true_e)
+            vx_bool issued;
+            ownTraceBegin(context, VX_TRACE_CATEGORY_THREADPOOL, "issue", graph);
+            issued = ownIssueThreadpool(graph->base.context->workers, workitems, numNext);
+            ownTraceEnd(context, VX_TRACE_CATEGORY_THREADPOOL, "issue", graph);
+            if (issued == vx_true_e)
             {
+                vx_bool completed;
                 /* do a blocking complete */
                 VX_PRINT(VX_ZONE_GRAPH, "Issued %u work items!\n", numNext);
-                if (ownCompleteThreadpool(graph->base.context->workers, vx_true_e) == vx_true_e)
+                ownTraceBegin(context, VX_TRACE_CATEGORY_THREADPOOL, "wait", graph);
+                completed = ownCompleteThreadpool(graph->base.context->workers, vx_true_e);
+                ownTraceEnd(context, VX_TRACE_CATEGORY_THREADPOOL, "wait", graph);
+                if (completed == vx_true_e)
                 {
                     VX_PRINT(VX_ZONE_GRAPH, "Processed %u items in threadpool!\n", numNext);
                 }
@@ -2497,6 +2571,7 @@ static vx_status vxExecuteGraph(vx_graph graph, vx_uint32 depth)
     {
         status = VX_ERROR_GRAPH_ABANDONED;
     }
+    ownTraceEnd(context, VX_TRACE_CATEGORY_GRAPH, "graph", graph);
     if (context->perf_enabled)
     {
         ownStopCapture(&graph->perf);
@@ -2745,6 +2820,30 @@ VX_API_ENTRY vx_parameter VX_API_CALL vxGetGraphParameterByIndex(vx_graph graph,
     return parameter;
 }
 
+VX_API_ENTRY vx_node VX_API_CALL vxGetGraphNodeByIndex(vx_graph graph, vx_uint32 index, vx_char kernel_name[VX_MAX_KERNEL_NAME])
+{
+    vx_node node = 0;
+    if (ownIsValidSpecificReference(&graph->base, VX_TYPE_GRAPH) == vx_true_e)
+    {
+        if (index < graph->numNodes)
+        {
+            node = graph->nodes[index];
+            ownIncrementReference(&node->base, VX_EXTERNAL);
+            if (kernel_name)
+            {
+                strncpy(kernel_name, node->kernel->name, VX_MAX_KERNEL_NAME - 1);
+                kernel_name[VX_MAX_KERNEL_NAME - 1] = '\0';
+            }
+        }
+    }
+    else
+    {
+        VX_PRINT(VX_ZONE_ERROR, "Invalid Graph!\n");
+        vxAddLogEntry(&graph->base, VX_ERROR_INVALID_REFERENCE, "Invalid Graph given to %s\n", __FUNCTION__);
+    }
+    return node;
+}
+
 VX_API_ENTRY vx_bool VX_API_CALL vxIsGraphVerified(vx_graph graph)
 {
     vx_bool verified = vx_false_e;
@@ -2046,6 +2046,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyImagePatch(
     vx_enum mem_type)
 {
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
 
     vx_uint32 start_x = rect ? rect->start_x : 0u;
     vx_uint32 start_y = rect ? rect->start_y : 0u;
@@ -2067,6 +2068,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyImagePatch(
         status = VX_ERROR_INVALID_REFERENCE;
         goto exit;
     }
+    trace_start = ownTraceTime(image->base.context);
 
     /* determine if virtual before checking for memory */
     if (image->base.is_virtual == vx_true_e)
@@ -2361,6 +2363,10 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyImagePatch(
     status = VX_SUCCESS;
 
 exit:
+    if (trace_start != 0u)
+    {
+        ownTraceComplete(image->base.context, VX_TRACE_CATEGORY_MEMORY, "vxCopyImagePatch", image, trace_start);
+    }
 
     VX_PRINT(VX_ZONE_API, "returned %d\n", status);
 
@@ -2393,6 +2399,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapImagePatch(
     vx_uint32 end_y   = rect ? rect->end_y : 0u;
     vx_bool zero_area = ((((end_x - start_x) == 0) || ((end_y - start_y) == 0)) ? vx_true_e : vx_false_e);
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
 
     /* bad parameters */
     if ( (rect == NULL) || (map_id == NULL) || (addr == NULL) || (ptr == NULL) )
@@ -2407,6 +2414,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapImagePatch(
         status = VX_ERROR_INVALID_REFERENCE;
         goto exit;
     }
+    trace_start = ownTraceTime(image->base.context);
 
     /* determine if virtual before checking for memory */
     if (image->base.is_virtual == vx_true_e)
@@ -2588,6 +2596,10 @@ exit:
     }
 #endif
 
+    if (trace_start != 0u)
+    {
+        ownTraceComplete(image->base.context, VX_TRACE_CATEGORY_MEMORY, "vxMapImagePatch", image, trace_start);
+    }
     VX_PRINT(VX_ZONE_API, "return %d\n", status);
 
     return status;
@@ -2596,6 +2608,7 @@ exit:
 VX_API_ENTRY vx_status VX_API_CALL vxUnmapImagePatch(vx_image image, vx_map_id map_id)
 {
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
 
     /* bad references */
     if (ownIsValidImage(image) == vx_false_e)
@@ -2603,6 +2616,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxUnmapImagePatch(vx_image image, vx_map_id m
         status = VX_ERROR_INVALID_REFERENCE;
         goto exit;
     }
+    trace_start = ownTraceTime(image->base.context);
 
     /* bad parameters */
     if (ownFindMemoryMap(image->base.context, (vx_reference)image, map_id) != vx_true_e)
@@ -2737,6 +2751,10 @@ VX_API_ENTRY vx_status VX_API_CALL vxUnmapImagePatch(vx_image image, vx_map_id m
     }
 
 exit:
+    if (trace_start != 0u)
+    {
+        ownTraceComplete(image->base.context, VX_TRACE_CATEGORY_MEMORY, "vxUnmapImagePatch", image, trace_start);
+    }
     VX_PRINT(VX_ZONE_API, "return %d\n", status);
 
     return status;
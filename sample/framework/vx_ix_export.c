@@ -47,7 +47,9 @@ This implementation requires that the exporting and importing implementations ha
 
 */
 #define VX_IX_ID (0x1234C0DE)           /* To identify an export and make sure endian matches etc. */
-#define VX_IX_VERSION ((VX_VERSION << 8) + 1)
+#define VX_IX_VERSION ((VX_VERSION << 8) + 3)   /* Revision 2 adds the execution plan trailer, 3 aligns tensor data */
+#define VX_IX_PAYLOAD_ALIGNMENT (64)    /* Alignment of tensor data from the start of the blob */
+#define VX_IX_PLAN_ID (0x504C414E)      /* 'PLAN', marks the start of the execution plan section */
 
 struct VXBinHeaderS {                   /* What should be at the start of the binary blob */
     vx_uint32 vx_ix_id;                 /* Unique ID */
@@ -464,6 +466,15 @@ static vx_status funcname(VXBinExport *xport, const datatype *data, int calcSize
     return exportBytes(xport, data, sizeof(*data), calcSize); \
 }
 
+static vx_status exportAlign(VXBinExport *xport, int calcSize)
+{
+    /* Pad with zeros so that the next byte exported is aligned to VX_IX_PAYLOAD_ALIGNMENT from the start of the
+       blob, which allows an importer that maps the blob from a file to use the data in place */
+    static const vx_uint8 zeros[VX_IX_PAYLOAD_ALIGNMENT] = {0};
+    vx_size offset = calcSize ? xport->export_length : (vx_size)(xport->curptr - xport->export_buffer);
+    return exportBytes(xport, zeros, (VX_IX_PAYLOAD_ALIGNMENT - offset % VX_IX_PAYLOAD_ALIGNMENT) % VX_IX_PAYLOAD_ALIGNMENT, calcSize);
+}
+
 EXPORT_FUNCTION(exportVxUint64, vx_uint64)
 /* EXPORT_FUNCTION(exportVxInt64, vx_int64) */
 /* EXPORT_FUNCTION(exportVxFloat64, vx_float64) */
@@ -1063,6 +1074,7 @@ static vx_status exportTensor(VXBinExport *xport, const vx_size i, int calcSize)
             vx_uint32 size = tensor->dimensions[tensor->number_of_dimensions - 1] *
                              tensor->stride[tensor->number_of_dimensions - 1];
             status = exportVxUint32(xport, size, calcSize);                        /* Size of data following */
+            status |= exportAlign(xport, calcSize);                                 /* Padding before the data */
             if (calcSize)
             {
                 xport->export_length += size;
@@ -1264,6 +1276,46 @@ static vx_status exportPyramid(VXBinExport *xport, vx_size i, int calcSize)
     return status;
 }
 
+static vx_status exportPlans(VXBinExport *xport, int calcSize)
+{
+    /* Export the execution plan of each graph: the node order (implicit, since the nodes of a
+       verified graph are already topologically sorted and are exported in that order) and the
+       head list, keyed by a hash of the graph structure. The offset of the section is exported
+       last, just before the checksum, so that the importer can find it from the end of the blob. */
+    vx_status status = VX_SUCCESS;
+    vx_uint64 start = xport->curptr - xport->export_buffer;
+    vx_uint32 num_plans = 0;
+    vx_size i;
+    for (i = 0; i < xport->actual_numrefs; ++i)
+    {
+        if (VX_TYPE_GRAPH == xport->ref_table[i].ref->type &&
+            OBJECT_DUPLICATE != xport->ref_table[i].status &&
+            ((vx_graph)xport->ref_table[i].ref)->verified)
+            ++num_plans;
+    }
+    status |= exportVxUint32(xport, (vx_uint32)VX_IX_PLAN_ID, calcSize);
+    status |= exportVxUint32(xport, num_plans, calcSize);
+    for (i = 0; i < xport->actual_numrefs && VX_SUCCESS == status; ++i)
+    {
+        vx_graph g = (vx_graph)xport->ref_table[i].ref;
+        if (VX_TYPE_GRAPH == g->base.type &&
+            OBJECT_DUPLICATE != xport->ref_table[i].status &&
+            g->verified)
+        {
+            vx_uint32 h;
+            status |= exportVxUint32(xport, (vx_uint32)i, calcSize);
+            status |= exportVxUint32(xport, ownGraphStructureHash(g, (vx_uint32)VX_IX_VERSION), calcSize);
+            status |= exportVxUint32(xport, g->numHeads, calcSize);
+            for (h = 0; h < g->numHeads; ++h)
+            {
+                status |= exportVxUint32(xport, g->heads[h], calcSize);
+            }
+        }
+    }
+    status |= exportVxUint64(xport, start, calcSize);
+    return status;
+}
+
 static vx_status exportObjects(VXBinExport *xport, int calcSize)
 {
     vx_size i;      /* for enumerating the references */
@@ -1296,6 +1348,10 @@ static vx_status exportObjects(VXBinExport *xport, int calcSize)
             }
         }
     }
+    if (VX_SUCCESS == status)
+    {
+        status = exportPlans(xport, calcSize);
+    }
     return status;
 }
 
@@ -18,6 +18,15 @@
 
 #include <vx_internal.h>
 #include <VX/vx_khr_nn.h>
+#include <fcntl.h>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
 #ifndef VX_IX_USE_IMPORT_AS_KERNEL
 #define VX_IX_USE_IMPORT_AS_KERNEL (VX_ENUM_BASE(VX_ID_KHRONOS, VX_ENUM_IX_USE) + 0x3) /*!< \brief Graph exported as user kernel. */
 #endif
@@ -170,8 +179,14 @@ static vx_kernel createGraphKernel(vx_context context, vx_graph graph)
 }
 
 #define VX_IX_ID (0x1234C0DE)           /* To identify an export and make sure endian matches etc. */
-#define VX_IX_VERSION ((VX_VERSION << 8) + 1)
+#define VX_IX_VERSION ((VX_VERSION << 8) + 3)
+#define VX_IX_VERSION_CHECKSUM ((VX_VERSION << 8) + 1)  /* First revision with a checksum */
+#define VX_IX_VERSION_PLAN ((VX_VERSION << 8) + 2)      /* First revision with an execution plan */
+#define VX_IX_VERSION_ALIGNED ((VX_VERSION << 8) + 3)   /* First revision with aligned tensor data */
+#define VX_IX_PAYLOAD_ALIGNMENT (64)    /* Alignment of tensor data from the start of the blob */
+#define MAX_CONCURRENT_IMPORTS (10)     /* Arbitrary limit on number of file imports at any one time */
 #define VX_IX_VERSION_1_2 (VX_VERSION_1_2 << 8)
+#define VX_IX_PLAN_ID (0x504C414E)      /* 'PLAN', marks the start of the execution plan section */
 
 #define IMAGE_SUB_TYPE_NORMAL (0)       /* Code to indicate 'normal' image */
 #define IMAGE_SUB_TYPE_UNIFORM (1)      /* Code to indicate uniform image */
@@ -212,6 +227,46 @@ typedef struct VXBinObjectHeaderS VXBinObjectHeader;
 #define checkIndex(ptr, index) (index < getHeader(ptr)->actual_numrefs)
 #define checkSize(ptr, curptr, length) (curptr && (curptr + length <= getEnd(ptr)))
 
+/* File mappings of blobs currently being imported, so that objects can be backed by them.
+   Imports may run concurrently, so the table is only touched under the context lock. */
+static vx_file_mapping_t *mappings[MAX_CONCURRENT_IMPORTS] = {NULL};
+
+static vx_uint32 registerMapping(vx_context context, vx_file_mapping_t *mapping)
+{
+    vx_uint32 slot;
+    ownSemWait(&context->base.lock);
+    for (slot = 0; slot < MAX_CONCURRENT_IMPORTS && mappings[slot]; ++slot)
+        ;
+    if (slot < MAX_CONCURRENT_IMPORTS)
+        mappings[slot] = mapping;
+    ownSemPost(&context->base.lock);
+    return slot;
+}
+
+static void unregisterMapping(vx_context context, vx_uint32 slot)
+{
+    if (slot < MAX_CONCURRENT_IMPORTS)
+    {
+        ownSemWait(&context->base.lock);
+        mappings[slot] = NULL;
+        ownSemPost(&context->base.lock);
+    }
+}
+
+static vx_file_mapping_t *findMapping(vx_context context, const vx_uint8 *ptr)
+{
+    vx_file_mapping_t *mapping = NULL;
+    vx_uint32 i;
+    ownSemWait(&context->base.lock);
+    for (i = 0; i < MAX_CONCURRENT_IMPORTS && NULL == mapping; ++i)
+    {
+        if (mappings[i] && ptr == mappings[i]->base)
+            mapping = mappings[i];
+    }
+    ownSemPost(&context->base.lock);
+    return mapping;
+}
+
 static vx_enum getObjectType(const vx_uint8 *ptr, vx_uint32 index)
 {
     return checkIndex(ptr, index) ?
@@ -1362,6 +1417,12 @@ static vx_status importTensor(vx_context context, const vx_uint8 *ptr, vx_refere
             stride[dim] = dim_stride;
         }
         importVxUint32(&header, &size);
+        if (size && header.curptr && getHeader(ptr)->version >= VX_IX_VERSION_ALIGNED)
+        {
+            /* skip the padding that aligns the data */
+            vx_size offset = header.curptr - ptr;
+            header.curptr += (VX_IX_PAYLOAD_ALIGNMENT - offset % VX_IX_PAYLOAD_ALIGNMENT) % VX_IX_PAYLOAD_ALIGNMENT;
+        }
         if (NULL == ref_table[n])
         {
             /* Now check to see if this is a tensor from view */
@@ -1421,10 +1482,31 @@ static vx_status importTensor(vx_context context, const vx_uint8 *ptr, vx_refere
             }
         }
         if (VX_SUCCESS == status && size && !header.is_virtual)
-        {   /* read data */
-            vx_size starts[VX_MAX_TENSOR_DIMENSIONS] = {0};
-            status = vxCopyTensorPatch((vx_tensor)ref_table[n], number_of_dimensions, starts, dimensions,
-                                        stride, (void *)header.curptr, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+        {   /* read data, or if the blob is mapped from a file and the layout matches, use it in place */
+            vx_tensor tensor = (vx_tensor)ref_table[n];
+            vx_file_mapping_t *mapping = findMapping(context, ptr);
+            vx_bool in_place = (mapping && NULL == tensor->addr && NULL == tensor->parent &&
+                                checkSize(ptr, header.curptr, size) &&
+                                0 == ((vx_size)header.curptr % VX_IX_PAYLOAD_ALIGNMENT) &&
+                                size == dimensions[number_of_dimensions - 1] * stride[number_of_dimensions - 1]) ?
+                                vx_true_e : vx_false_e;
+            for (dim = 0; dim < number_of_dimensions && in_place; ++dim)
+            {
+                if (tensor->stride[dim] != stride[dim])
+                    in_place = vx_false_e;
+            }
+            if (in_place)
+            {
+                tensor->addr = (void *)header.curptr;
+                tensor->mapping = mapping;
+                ownRetainFileMapping(mapping);
+            }
+            else
+            {
+                vx_size starts[VX_MAX_TENSOR_DIMENSIONS] = {0};
+                status = vxCopyTensorPatch(tensor, number_of_dimensions, starts, dimensions,
+                                            stride, (void *)header.curptr, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+            }
         }
     }
     return header.curptr ? status : VX_FAILURE;
@@ -1622,6 +1704,75 @@ static vx_status importObjectArraysFromTensor(vx_context context, const vx_uint8
     return status;
 }
 
+static void adoptPlans(const vx_uint8 *ptr, vx_reference *ref_table)
+{
+    /* Restore the head list of each graph from the execution plan section, if there is one.
+       The node order is implicit as the graphs were rebuilt in their exported (sorted) order.
+       A plan is only adopted if the structure hash matches that of the rebuilt graph, which
+       also covers the target assignments and this library's format version; otherwise the
+       graph is simply verified in full. Format:
+            vx_uint32 plan_id
+            vx_uint32 num_plans
+            struct
+                vx_uint32 graph_index
+                vx_uint32 hash
+                vx_uint32 num_heads
+                vx_uint32 heads[num_heads]
+            end_struct plans[num_plans]
+            vx_uint64 plan_offset
+    */
+    VXBinObjectHeader header;
+    vx_uint64 plan_offset;
+    vx_uint32 plan_id = 0, num_plans = 0, c;
+    if (getHeader(ptr)->version < VX_IX_VERSION_PLAN)
+        return;
+    header.ptr = ptr;
+    header.curptr = getEnd(ptr) - sizeof(vx_uint32) - sizeof(vx_uint64);
+    importBytes(&header, &plan_offset, sizeof(plan_offset));
+    if (NULL == header.curptr || plan_offset >= getHeader(ptr)->length)
+        return;
+    header.curptr = ptr + plan_offset;
+    importVxUint32(&header, &plan_id);
+    importVxUint32(&header, &num_plans);
+    if (VX_IX_PLAN_ID != plan_id)
+        return;
+    for (c = 0; c < num_plans && header.curptr; ++c)
+    {
+        vx_uint32 graph_ix = 0, hash = 0, num_heads = 0, h;
+        vx_graph g = NULL;
+        importVxUint32(&header, &graph_ix);
+        importVxUint32(&header, &hash);
+        importVxUint32(&header, &num_heads);
+        if (NULL == header.curptr || num_heads > VX_INT_MAX_REF)
+            break;
+        if (checkIndex(ptr, graph_ix) &&
+            ref_table[graph_ix] &&
+            VX_TYPE_GRAPH == ref_table[graph_ix]->type &&
+            num_heads &&
+            hash == ownGraphStructureHash((vx_graph)ref_table[graph_ix], (vx_uint32)VX_IX_VERSION))
+        {
+            g = (vx_graph)ref_table[graph_ix];
+            g->planned = vx_true_e;
+        }
+        for (h = 0; h < num_heads; ++h)
+        {
+            vx_uint32 head = 0;
+            importVxUint32(&header, &head);
+            if (g)
+            {
+                g->heads[h] = head;
+                if (NULL == header.curptr || head >= g->numNodes)
+                    g->planned = vx_false_e;     /* verification will find the heads again */
+            }
+        }
+        if (g && g->planned)
+        {
+            g->numHeads = num_heads;
+            DEBUGPRINTF("Adopted execution plan for graph %u\n", graph_ix);
+        }
+    }
+}
+
 static vx_status buildGraphs(vx_context context, const vx_uint8 *ptr, vx_reference *ref_table)
 {
     /* All data objects have been created; ref_table is (or should be) full */
@@ -1786,6 +1937,11 @@ static vx_status buildGraphs(vx_context context, const vx_uint8 *ptr, vx_referen
             }
         }
     }
+    /* Restore any exported execution plans so that verification may skip the sort, single writer,
+       head and cycle checks; parameter validation, allocation and kernel initialisation still run.
+     */
+    if (VX_SUCCESS == status)
+        adoptPlans(ptr, ref_table);
     /* Now verify all the graphs and create any graph kernels
        In this sample implementation verification is necessary, but for other implementations
        we hope that in fact we have an immutable graph, and here we just call validation
@@ -1848,7 +2004,7 @@ VX_API_ENTRY vx_import VX_API_CALL vxImportObjectsFromMemory(
     {
         checksum += *curptr;
     }
-    if ((VX_IX_VERSION == header->version && checksum != *(vx_uint32 *)curptr) ||   /* only check checksum if version match */
+    if ((VX_IX_VERSION_CHECKSUM <= header->version && checksum != *(vx_uint32 *)curptr) ||   /* only check checksum if there is one */
         VX_SUCCESS != vxGetStatus((vx_reference)context) ||
         NULL == refs ||
         NULL == uses ||
@@ -1960,5 +2116,55 @@ VX_API_ENTRY vx_import VX_API_CALL vxImportObjectsFromMemory(
     return import;
 }
 
-#endif
+VX_API_ENTRY vx_import VX_API_CALL vxImportObjectsFromDescriptor(
+    vx_context context,
+    vx_size numrefs,
+    vx_reference *refs,
+    const vx_enum * uses,
+    int fd)
+{
+    vx_import import = NULL;
+    vx_file_mapping_t *mapping = NULL;
+    vx_uint32 slot;
+    if (VX_SUCCESS != vxGetStatus((vx_reference)context))
+        return NULL;
+    mapping = ownMapFile(fd);
+    if (NULL == mapping || mapping->length <= sizeof(VXBinHeader))
+    {
+        DEBUGPRINTF("Failed to map file\n");
+        ownReleaseFileMapping(&mapping);
+        return (vx_import)ownGetErrorObject(context, VX_ERROR_INVALID_PARAMETERS);
+    }
+    /* Register the mapping so that tensors can be backed by it; if there is no room
+       the import still works but copies the data */
+    slot = registerMapping(context, mapping);
+    import = vxImportObjectsFromMemory(context, numrefs, refs, uses, mapping->base, mapping->length);
+    unregisterMapping(context, slot);
+    /* Objects using the mapping hold their own count, so this only unmaps if there are none */
+    ownReleaseFileMapping(&mapping);
+    return import;
+}
 
+VX_API_ENTRY vx_import VX_API_CALL vxImportObjectsFromFile(
+    vx_context context,
+    vx_size numrefs,
+    vx_reference *refs,
+    const vx_enum * uses,
+    const vx_char *filename)
+{
+    vx_import import = NULL;
+    int fd;
+    if (VX_SUCCESS != vxGetStatus((vx_reference)context))
+        return NULL;
+    fd = (filename) ? open(filename, O_RDONLY | O_BINARY) : -1;
+    if (fd < 0)
+    {
+        DEBUGPRINTF("Failed to open %s\n", filename ? filename : "(null)");
+        return (vx_import)ownGetErrorObject(context, VX_ERROR_INVALID_PARAMETERS);
+    }
+    import = vxImportObjectsFromDescriptor(context, numrefs, refs, uses, fd);
+    close(fd);
+    return import;
+}
+
+#endif
@@ -71,22 +71,124 @@ static inline void copy_dims(const vx_int32 *dims, vx_int32 num_dims, vx_size *d
     }
 }
 
+/*! \brief The imported NNEF graph kept in the kernel's local data.
+ * \ref graph stays as loaded and is never allocated, so it can always be copied. \ref shared
+ * is copied from it and allocated once, then lent to one node at a time; nodes initialized
+ * while it is lent take their own copy. \ref shared_in_use is guarded by the kernel's lock.
+ */
+typedef struct _vx_nnef_kernel_t {
+    nnef_graph_t graph;
+    nnef_graph_t shared;
+    vx_bool shared_in_use;
+    vx_uint32 input_num;
+    vx_uint32 output_num;
+    const vx_char **names;      /* input names followed by output names */
+} vx_nnef_kernel_t;
+
+/*! \brief The per node state, resolved once at initialize time. */
+typedef struct _vx_nnef_node_t {
+    nnef_graph_t graph;
+    vx_bool borrowed;
+    vx_uint32 num;
+    void **data;                /* NNEF tensor storage of each parameter */
+    vx_size *sizes;             /* bytes copied in or out of each parameter */
+} vx_nnef_node_t;
+
+static void releaseNNEFNode(vx_kernel kernel, vx_nnef_node_t *nnef_node)
+{
+    vx_nnef_kernel_t *nnef_kernel = kernel->attributes.localDataPtr;
+
+    if (nnef_node->borrowed == vx_true_e)
+    {
+        ownSemWait(&kernel->base.lock);
+        nnef_kernel->shared_in_use = vx_false_e;
+        ownSemPost(&kernel->base.lock);
+    }
+    else if (nnef_node->graph)
+    {
+        nnef_graph_release(nnef_node->graph);
+    }
+    free(nnef_node->data);
+    free(nnef_node->sizes);
+    free(nnef_node);
+}
+
 static vx_status VX_CALLBACK vxNNEFInitializer(vx_node node, const vx_reference parameters[], vx_uint32 num)
 {
     vx_char perror[MAXLEN] = "";
+    vx_uint32 i = 0;
 
     vx_status status = VX_SUCCESS;
 
-    // copy NNEF graph to node
-    node->attributes.localDataPtr = nnef_graph_copy(node->kernel->attributes.localDataPtr);
-   
-    if (!nnef_graph_allocate_buffers(node->attributes.localDataPtr, perror))
+    vx_nnef_kernel_t *nnef_kernel = node->kernel->attributes.localDataPtr;
+    vx_nnef_node_t *nnef_node = (vx_nnef_node_t *)calloc(1, sizeof(vx_nnef_node_t));
+
+    if (nnef_node == NULL)
+        return VX_ERROR_NO_MEMORY;
+
+    // borrow the kernel's shared graph if no other node holds it, allocating it the first time
+    ownSemWait(&node->kernel->base.lock);
+    if (nnef_kernel->shared_in_use == vx_false_e)
     {
-        //nnef allocate buffers failed
-        printf("[nnef_graph_allocate_buffers] error:%s\n", perror);
-        status = VX_FAILURE;
+        if (nnef_kernel->shared == NULL)
+        {
+            nnef_graph_t shared = nnef_graph_copy(nnef_kernel->graph);
+            if (shared && !nnef_graph_allocate_buffers(shared, perror))
+            {
+                printf("[nnef_graph_allocate_buffers] error:%s\n", perror);
+                nnef_graph_release(shared);
+                shared = NULL;
+            }
+            nnef_kernel->shared = shared;
+        }
+        if (nnef_kernel->shared)
+        {
+            nnef_kernel->shared_in_use = vx_true_e;
+            nnef_node->graph = nnef_kernel->shared;
+            nnef_node->borrowed = vx_true_e;
+        }
+    }
+    ownSemPost(&node->kernel->base.lock);
+
+    nnef_node->num = num;
+    nnef_node->data = (void **)calloc(num, sizeof(void *));
+    nnef_node->sizes = (vx_size *)calloc(num, sizeof(vx_size));
+    if (nnef_node->data == NULL || nnef_node->sizes == NULL)
+    {
+        releaseNNEFNode(node->kernel, nnef_node);
+        return VX_ERROR_NO_MEMORY;
+    }
+
+    // otherwise take an own copy of the unallocated graph
+    if (nnef_node->borrowed == vx_false_e)
+    {
+        nnef_node->graph = nnef_graph_copy(nnef_kernel->graph);
+        if (nnef_node->graph == NULL)
+        {
+            releaseNNEFNode(node->kernel, nnef_node);
+            return VX_ERROR_NO_MEMORY;
+        }
+        if (!nnef_graph_allocate_buffers(nnef_node->graph, perror))
+        {
+            //nnef allocate buffers failed
+            printf("[nnef_graph_allocate_buffers] error:%s\n", perror);
+            releaseNNEFNode(node->kernel, nnef_node);
+            return VX_FAILURE;
+        }
+    }
+
+    // the NNEF buffers don't move once allocated, so look them up only once
+    for (i = 0; i < num; i++)
+    {
+        vx_tensor tensor = (vx_tensor)parameters[i];
+
+        nnef_node->data[i] = nnef_tensor_data(nnef_graph_find_tensor(nnef_node->graph, nnef_kernel->names[i]));
+        nnef_node->sizes[i] = compute_patch_size(tensor->dimensions, tensor->number_of_dimensions) *
+                              sizeof_tensor_type(tensor->data_type);
     }
 
+    node->attributes.localDataPtr = nnef_node;
+
     return status;
 }
 
@@ -102,7 +204,8 @@ static vx_status VX_CALLBACK vxNNEFDeinitializer(vx_node node, const vx_referenc
         ownReleaseMetaFormat(&meta[i]);
     }
     // destroy NNEF graph in node 
-    nnef_graph_release(node->attributes.localDataPtr);
+    if (node->attributes.localDataPtr)
+        releaseNNEFNode(node->kernel, node->attributes.localDataPtr);
     
     node->attributes.localDataPtr = NULL;
  
@@ -113,8 +216,17 @@ static vx_status VX_CALLBACK vxNNEFKernelDeinitializer(vx_kernel nn_kernel)
 {
     vx_status status = VX_SUCCESS;
 
-    // destroy NNEF graph in kernel 
-    nnef_graph_release(nn_kernel->attributes.localDataPtr);
+    vx_nnef_kernel_t *nnef_kernel = nn_kernel->attributes.localDataPtr;
+
+    // destroy NNEF graphs in kernel 
+    if (nnef_kernel)
+    {
+        if (nnef_kernel->shared)
+            nnef_graph_release(nnef_kernel->shared);
+        nnef_graph_release(nnef_kernel->graph);
+        free(nnef_kernel->names);
+        free(nnef_kernel);
+    }
 
     nn_kernel->attributes.localDataPtr = NULL;
 
@@ -139,71 +251,45 @@ static vx_status VX_CALLBACK vxNNEFValidator(vx_node node, const vx_reference pa
 
 static vx_status VX_CALLBACK vxNNEFKernel(vx_node node, const vx_reference *parameters, vx_uint32 num)
 {
-    vx_uint32 i = 0, j = 0, input_num = 0, output_num = 0;
+    vx_uint32 i = 0;
     vx_char perror[MAXLEN] = "";
     vx_status status = VX_SUCCESS;
-    const vx_char** inputs = NULL, **outputs = NULL;
-
-    // Get NNEF graph from kernel attributes
-    nnef_graph_t nnef_graph_node = node->attributes.localDataPtr;
 
-    input_num = nnef_graph_input_names(nnef_graph_node, NULL);
-    output_num = nnef_graph_output_names(nnef_graph_node, NULL);
+    vx_nnef_kernel_t *nnef_kernel = node->kernel->attributes.localDataPtr;
+    vx_nnef_node_t *nnef_node = node->attributes.localDataPtr;
 
-    // alloc memory according to input and output number
-    inputs = (const vx_char **)malloc(sizeof(const vx_char *) * input_num);
-    outputs = (const vx_char **)malloc(sizeof(const vx_char *) * output_num);
-
-    // get inputs and outputs
-    nnef_graph_input_names(nnef_graph_node, inputs);
-    nnef_graph_output_names(nnef_graph_node, outputs);
+    if (nnef_node == NULL || num != nnef_node->num)
+        return VX_ERROR_INVALID_NODE;
 
-    vx_tensor *tensors = (vx_tensor *)malloc(sizeof(vx_tensor) * num);
-
-    if (tensors == NULL)
+    // set vx_tensors into NNEF graph tensor
+    for (i = 0; i < nnef_kernel->input_num; i++)
     {
-        status = VX_ERROR_NO_MEMORY;
-        return status;
-    }
+        vx_tensor tensor = (vx_tensor)parameters[i];
 
-    // get input vx_tensors and set vx_tensors into NNEF graph tensor
-    for (i = 0; i < input_num; i++)
-    {
-        tensors[i] = (vx_tensor)parameters[i];
-
-        size_t input_tensor_data_size = compute_patch_size(tensors[i]->dimensions, tensors[i]->number_of_dimensions) * 
-                                                           sizeof_tensor_type(tensors[i]->data_type);
-        
-        memcpy(nnef_tensor_data(nnef_graph_find_tensor(nnef_graph_node, inputs[i])), tensors[i]->addr, input_tensor_data_size);
+        if (tensor->addr)
+            memcpy(nnef_node->data[i], tensor->addr, nnef_node->sizes[i]);
+        else
+            memset(nnef_node->data[i], 0, nnef_node->sizes[i]);
     }
 
     //Execute nnef kernel
-    if (!nnef_graph_execute(nnef_graph_node, perror))
+    if (!nnef_graph_execute(nnef_node->graph, perror))
     {
         printf("[nnef_graph_execute] error:%s\n", perror);
         status = VX_FAILURE;
     }
 
-    // get output vx_tensors
-    for (i = input_num, j = 0; i < num; i++, j++)
+    // get output vx_tensors, writing into the memory they already own
+    for (i = nnef_kernel->input_num; i < num && status == VX_SUCCESS; i++)
     {
-        tensors[i] = (vx_tensor)parameters[i];
-
-        size_t output_tensor_data_size = compute_patch_size(tensors[i]->dimensions, tensors[i]->number_of_dimensions) * 
-                                                            sizeof_tensor_type(tensors[i]->data_type);
+        vx_tensor tensor = (vx_tensor)parameters[i];
 
-        tensors[i]->addr = malloc(output_tensor_data_size);
-
-        memcpy(tensors[i]->addr, nnef_tensor_data(nnef_graph_find_tensor(nnef_graph_node, outputs[j])), output_tensor_data_size);
+        if (ownAllocateTensorMemory(tensor) == NULL)
+            status = VX_ERROR_NO_MEMORY;
+        else
+            memcpy(tensor->addr, nnef_node->data[i], nnef_node->sizes[i]);
     }
 
-    if (NULL != tensors)
-        free(tensors);
-    if (NULL != inputs)
-        free(inputs);
-    if (NULL != outputs)
-        free(outputs);
-    
     return status;
 }
 
@@ -310,14 +396,14 @@ static vx_status vxSetMetaFormatNNEF(void *nnef_graph, vx_meta_format meta, cons
 VX_API_ENTRY vx_kernel VX_API_CALL vxImportKernelFromURL(vx_context context, const vx_char * type, const vx_char * url)
 {
     vx_kernel kernel = NULL;
-    vx_int32 i = 0, j = 0;
+    vx_int32 i = 0;
 
     vx_char perror[MAXLEN] = "";
     vx_char kernel_name[MAXLEN] = "";
     static vx_int32 counter = 1;
 
     vx_int32 input_num = 0, output_num = 0, num = 0;
-    const vx_char** inputs = NULL, **outputs = NULL;
+    vx_nnef_kernel_t *nnef_kernel = NULL;
 
     nnef_graph_t nnef_graph = nnef_graph_load(url, perror);
 
@@ -340,19 +426,32 @@ VX_API_ENTRY vx_kernel VX_API_CALL vxImportKernelFromURL(vx_context context, con
     output_num = nnef_graph_output_names(nnef_graph, NULL);
     num = input_num + output_num;
 
-    // alloc memory according to input and output number
-    inputs = (const vx_char **)malloc(sizeof(const vx_char *) * input_num);
-    outputs = (const vx_char **)malloc(sizeof(const vx_char *) * output_num);
+    // the names are kept with the kernel so executions don't need to query them
+    nnef_kernel = (vx_nnef_kernel_t *)calloc(1, sizeof(vx_nnef_kernel_t));
+    if (nnef_kernel)
+        nnef_kernel->names = (const vx_char **)malloc(sizeof(const vx_char *) * (num > 0 ? num : 1));
+    if (nnef_kernel == NULL || nnef_kernel->names == NULL)
+    {
+        printf("Failed to allocate the nnef kernel data\n");
+        free(nnef_kernel);
+        nnef_graph_release(nnef_graph);
+        return NULL;
+    }
+    nnef_kernel->graph = nnef_graph;
+    nnef_kernel->shared = NULL;
+    nnef_kernel->shared_in_use = vx_false_e;
+    nnef_kernel->input_num = input_num;
+    nnef_kernel->output_num = output_num;
 
     // get inputs and outputs
-    nnef_graph_input_names(nnef_graph, inputs);
-    nnef_graph_output_names(nnef_graph, outputs);
+    nnef_graph_input_names(nnef_graph, nnef_kernel->names);
+    nnef_graph_output_names(nnef_graph, nnef_kernel->names + input_num);
 
     sprintf(kernel_name, "nnef.import.%d", counter++);
 
     kernel = CreateNNEFKernel(context, input_num, output_num, kernel_name);
     
-    kernel->attributes.localDataPtr = nnef_graph;
+    kernel->attributes.localDataPtr = nnef_kernel;
 
     vx_meta_format *meta;
 
@@ -364,15 +463,8 @@ VX_API_ENTRY vx_kernel VX_API_CALL vxImportKernelFromURL(vx_context context, con
         meta[i]->type = VX_TYPE_TENSOR;
     }
 
-    for (i = 0; i < input_num; i++)
-        vxSetMetaFormatNNEF(nnef_graph, meta[i], inputs[i]);
-    for (i = input_num, j = 0; i < num; i++, j++)
-        vxSetMetaFormatNNEF(nnef_graph, meta[i], outputs[j]);
-
-    if (NULL != inputs)
-        free(inputs);
-    if (NULL != outputs)
-        free(outputs);
+    for (i = 0; i < num; i++)
+        vxSetMetaFormatNNEF(nnef_graph, meta[i], nnef_kernel->names[i]);
 
     return kernel;
 }
@@ -17,6 +17,14 @@
 
 #include "vx_internal.h"
 #include "vx_osal.h"
+#if defined(__linux__) || defined(__ANDROID__) || defined(__QNX__) || defined(__CYGWIN__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(_WIN32) || defined(UNDER_CE)
+#include <io.h>
+#include <sys/stat.h>
+#endif
 
 #define BILLION (1000000000)
 
@@ -366,6 +374,7 @@ static vx_value_t vxWorkerThreadpool(void *arg)
     ownStopCapture(&pool_worker->perf);
 
     VX_PRINT(VX_ZONE_OSAL, "Threadpool worker %p active, waiting on queue!\n", arg);
+    ownTraceNameThread(context, "threadpool worker");
 
     /*! \bug assign this thread to the next available core */
     //thread_nextaffinity();
@@ -380,7 +389,9 @@ static vx_value_t vxWorkerThreadpool(void *arg)
         VX_PRINT(VX_ZONE_OSAL, "Worker received workitem!\n");
         pool_worker->active = vx_true_e;
         ownStopCapture(&pool_worker->perf);
+        ownTraceBegin(context, VX_TRACE_CATEGORY_THREADPOOL, "work item", pool_worker->data);
         ret = function(pool_worker); /* <=== WORK IS DONE HERE */
+        ownTraceEnd(context, VX_TRACE_CATEGORY_THREADPOOL, "work item", pool_worker->data);
         ownSemWait(&pool_worker->pool->sem);
         pool_worker->pool->numCurrentItems--;
         if (pool_worker->pool->numCurrentItems <= 0)
@@ -766,6 +777,88 @@ vx_symbol_t ownGetSymbol(vx_module_handle_t mod, vx_char *name)
 #endif
 }
 
+vx_file_mapping_t *ownMapFile(int fd)
+{
+    vx_file_mapping_t *mapping = (vx_file_mapping_t *)calloc(1, sizeof(vx_file_mapping_t));
+    if (mapping == NULL)
+        return NULL;
+#if defined(__linux__) || defined(__ANDROID__) || defined(__QNX__) || defined(__CYGWIN__) || defined(__APPLE__)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (base != MAP_FAILED)
+            {
+                mapping->base = (vx_uint8 *)base;
+                mapping->length = (vx_size)st.st_size;
+            }
+            else
+            {
+                VX_PRINT(VX_ZONE_ERROR, "Failed to map file: %s\n", strerror(errno));
+            }
+        }
+    }
+#elif defined(_WIN32) || defined(UNDER_CE)
+    {
+        /* no shared mapping here, read the file into an allocation instead */
+        struct _stat st;
+        if (_fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            mapping->base = (vx_uint8 *)malloc((size_t)st.st_size);
+            if (mapping->base && _read(fd, mapping->base, (unsigned int)st.st_size) == st.st_size)
+            {
+                mapping->length = (vx_size)st.st_size;
+            }
+            else
+            {
+                free(mapping->base);
+                mapping->base = NULL;
+            }
+        }
+    }
+#endif
+    if (mapping->base == NULL)
+    {
+        free(mapping);
+        return NULL;
+    }
+    mapping->count = 1;
+    ownCreateSem(&mapping->lock, 1);
+    VX_PRINT(VX_ZONE_INFO, "Mapped "VX_FMT_SIZE" bytes at %p\n", mapping->length, mapping->base);
+    return mapping;
+}
+
+void ownRetainFileMapping(vx_file_mapping_t *mapping)
+{
+    ownSemWait(&mapping->lock);
+    mapping->count++;
+    ownSemPost(&mapping->lock);
+}
+
+void ownReleaseFileMapping(vx_file_mapping_t **pmapping)
+{
+    vx_file_mapping_t *mapping = *pmapping;
+    vx_uint32 count;
+    if (mapping == NULL)
+        return;
+    ownSemWait(&mapping->lock);
+    count = --mapping->count;
+    ownSemPost(&mapping->lock);
+    if (count == 0)
+    {
+        VX_PRINT(VX_ZONE_INFO, "Unmapping %p\n", mapping->base);
+#if defined(__linux__) || defined(__ANDROID__) || defined(__QNX__) || defined(__CYGWIN__) || defined(__APPLE__)
+        munmap(mapping->base, mapping->length);
+#elif defined(_WIN32) || defined(UNDER_CE)
+        free(mapping->base);
+#endif
+        ownDestroySem(&mapping->lock);
+        free(mapping);
+    }
+    *pmapping = NULL;
+}
+
 /******************************************************************************/
 // EXTERNAL API (NO COMMENTS HERE, SEE HEADER FILES)
 /******************************************************************************/
@@ -54,12 +54,151 @@ VX_API_ENTRY vx_remap VX_API_CALL vxCreateRemap(vx_context context,
     return remap;
 }
 
+static void vxFreeCompiledRemap(vx_remap_compiled_t *compiled)
+{
+    if (compiled)
+    {
+        free(compiled->points);
+        free(compiled->inside);
+        free(compiled->order);
+        free(compiled);
+    }
+}
+
 void ownDestructRemap(vx_reference ref)
 {
     vx_remap remap = (vx_remap_t *)ref;
+    vxFreeCompiledRemap(remap->compiled);
+    remap->compiled = NULL;
     ownFreeMemory(remap->base.context, &remap->memory);
 }
 
+typedef struct _vx_remap_tile_key_t {
+    vx_uint32 key;
+    vx_uint32 index;
+} vx_remap_tile_key_t;
+
+static int vxCompareRemapTiles(const void *a, const void *b)
+{
+    const vx_remap_tile_key_t *ta = (const vx_remap_tile_key_t *)a;
+    const vx_remap_tile_key_t *tb = (const vx_remap_tile_key_t *)b;
+    if (ta->key != tb->key)
+        return ta->key < tb->key ? -1 : 1;
+    return ta->index < tb->index ? -1 : (ta->index > tb->index ? 1 : 0);
+}
+
+static vx_remap_compiled_t *vxBuildCompiledRemap(vx_remap remap)
+{
+    const vx_float32 one = (vx_float32)(1 << VX_INT_REMAP_FRAC_BITS);
+    const vx_int32 mask = (1 << VX_INT_REMAP_FRAC_BITS) - 1;
+    vx_remap_compiled_t *compiled = VX_CALLOC(vx_remap_compiled_t);
+    vx_remap_tile_key_t *keys = NULL;
+    vx_uint32 num_tiles, t, x, y;
+
+    if (compiled == NULL)
+        return NULL;
+    compiled->write_count = remap->base.write_count;
+    compiled->tiles_x = (remap->dst_width + VX_INT_REMAP_TILE_WIDTH - 1) / VX_INT_REMAP_TILE_WIDTH;
+    compiled->tiles_y = (remap->dst_height + VX_INT_REMAP_TILE_HEIGHT - 1) / VX_INT_REMAP_TILE_HEIGHT;
+    num_tiles = compiled->tiles_x * compiled->tiles_y;
+    compiled->points = (vx_remap_point_t *)malloc((vx_size)remap->dst_width * remap->dst_height * sizeof(vx_remap_point_t));
+    compiled->inside = (vx_uint8 *)malloc(num_tiles * sizeof(vx_uint8));
+    compiled->order = (vx_uint32 *)malloc(num_tiles * sizeof(vx_uint32));
+    keys = (vx_remap_tile_key_t *)malloc(num_tiles * sizeof(vx_remap_tile_key_t));
+    if (compiled->points == NULL || compiled->inside == NULL || compiled->order == NULL || keys == NULL)
+    {
+        VX_PRINT(VX_ZONE_ERROR, "Failed to allocate the compiled remap!\n");
+        vxFreeCompiledRemap(compiled);
+        free(keys);
+        return NULL;
+    }
+    for (t = 0; t < num_tiles; t++)
+    {
+        compiled->inside[t] = 1;
+        keys[t].key = 0xFFFFFFFF;
+        keys[t].index = t;
+    }
+
+    for (y = 0; y < remap->dst_height; y++)
+    {
+        vx_remap_point_t *point = &compiled->points[(vx_size)y * remap->dst_width];
+        vx_uint32 row_tile = (y / VX_INT_REMAP_TILE_HEIGHT) * compiled->tiles_x;
+        for (x = 0; x < remap->dst_width; x++, point++)
+        {
+            vx_float32 src_x = *(vx_float32 *)ownFormatMemoryPtr(&remap->memory, 0, x, y, 0);
+            vx_float32 src_y = *(vx_float32 *)ownFormatMemoryPtr(&remap->memory, 1, x, y, 0);
+            vx_uint32 tile = row_tile + x / VX_INT_REMAP_TILE_WIDTH;
+            vx_int32 fixed_x, fixed_y;
+            vx_uint32 key;
+
+            /* beyond two pixels outside of the source every coordinate reads the same border,
+             * the negated comparisons also catch NaN */
+            if (!(src_x >= -2.0f))
+                src_x = -2.0f;
+            if (!(src_x <= (vx_float32)remap->src_width + 1.0f))
+                src_x = (vx_float32)remap->src_width + 1.0f;
+            if (!(src_y >= -2.0f))
+                src_y = -2.0f;
+            if (!(src_y <= (vx_float32)remap->src_height + 1.0f))
+                src_y = (vx_float32)remap->src_height + 1.0f;
+
+            fixed_x = (vx_int32)floorf(src_x * one + 0.5f);
+            fixed_y = (vx_int32)floorf(src_y * one + 0.5f);
+            point->fx = (vx_uint8)(fixed_x & mask);
+            point->fy = (vx_uint8)(fixed_y & mask);
+            point->x = (vx_int16)((fixed_x - (fixed_x & mask)) / (mask + 1));
+            point->y = (vx_int16)((fixed_y - (fixed_y & mask)) / (mask + 1));
+            /* as the float path, which rounds then truncates the decimal side */
+            point->nx = (vx_int16)floorf(src_x + 0.5f);
+            point->ny = (vx_int16)floorf(src_y + 0.5f);
+
+            if (point->x < 0 || point->y < 0 ||
+                point->x + 1 >= (vx_int32)remap->src_width ||
+                point->y + 1 >= (vx_int32)remap->src_height)
+            {
+                compiled->inside[tile] = 0;
+            }
+            /* order the tiles by the first source row they read, then by column */
+            key = ((vx_uint32)(point->y + 2) << 16) | (vx_uint32)(point->x + 2);
+            if (key < keys[tile].key)
+                keys[tile].key = key;
+        }
+    }
+
+    qsort(keys, num_tiles, sizeof(vx_remap_tile_key_t), vxCompareRemapTiles);
+    for (t = 0; t < num_tiles; t++)
+    {
+        compiled->order[t] = keys[t].index;
+    }
+    free(keys);
+    return compiled;
+}
+
+vx_remap_compiled_t *ownCompileRemap(vx_remap remap)
+{
+    vx_remap_compiled_t *compiled = NULL;
+
+    /* the 16 bit coordinates hold a pixel or two beyond the source, larger
+     * sources are remapped from the float coordinates instead */
+    if (remap->src_width > 32765u || remap->src_height > 32765u)
+    {
+        return NULL;
+    }
+    ownSemWait(&remap->base.lock);
+    if (remap->compiled && remap->compiled->write_count == remap->base.write_count)
+    {
+        compiled = remap->compiled;
+    }
+    else if (ownAllocateMemory(remap->base.context, &remap->memory) == vx_true_e)
+    {
+        vxFreeCompiledRemap(remap->compiled);
+        remap->compiled = vxBuildCompiledRemap(remap);
+        compiled = remap->compiled;
+    }
+    ownSemPost(&remap->base.lock);
+    return compiled;
+}
+
 VX_API_ENTRY vx_status VX_API_CALL vxReleaseRemap(vx_remap *r)
 {
     return ownReleaseReferenceInt((vx_reference *)r, VX_TYPE_REMAP, VX_EXTERNAL, NULL);
@@ -430,6 +569,13 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyRemapPatch(vx_remap remap,
     }
     status = VX_SUCCESS;
 
+    /* a table written as a whole is compiled now rather than on the first frame,
+     * a failure here is reported by the node which uses it */
+    if ((usage == VX_WRITE_ONLY) && (zero_area == vx_false_e))
+    {
+        ownCompileRemap(remap);
+    }
+
 #ifdef OPENVX_USE_OPENCL_INTEROP
     if (user_mem_type_given == VX_MEMORY_TYPE_OPENCL_BUFFER)
     {
@@ -668,6 +814,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxUnmapRemapPatch(vx_remap remap, vx_map_id m
 
             ownMemoryUnmap(context, (vx_uint32)map_id);
             ownDecrementReference(&remap->base, VX_EXTERNAL);
+            ownCompileRemap(remap);
             status = VX_SUCCESS;
         }
         else
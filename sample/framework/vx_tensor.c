@@ -221,8 +221,9 @@ VX_API_ENTRY vx_status VX_API_CALL vxSwapTensorHandle(vx_tensor tensor, void* ne
 
             if (prev_ptr != NULL && tensor->parent == NULL)
             {
-                /* return previous tensor handles */
-                *prev_ptr = tensor->addr;
+                /* return previous tensor handles, but not the pages of an imported file,
+                   which are unmapped below */
+                *prev_ptr = tensor->mapping ? NULL : tensor->addr;
             }
 
             for (i = 0; i < VX_INT_MAX_REF; i++)
@@ -239,6 +240,13 @@ VX_API_ENTRY vx_status VX_API_CALL vxSwapTensorHandle(vx_tensor tensor, void* ne
                 }
             }
 
+            /* the tensor no longer uses the file it was imported from, and must not
+               release it when the new handle is freed */
+            if (tensor->mapping)
+            {
+                ownReleaseFileMapping(&tensor->mapping);
+            }
+
             /* reclaim previous and set new handles for this tensor */
             if (new_ptr == NULL)
             {
@@ -577,6 +585,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapTensorPatch(vx_tensor tensor, vx_size nu
     vx_map_id * map_id, vx_size * stride, void ** ptr, vx_enum usage, vx_enum mem_type)
 {
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
     vx_uint8 *buf = NULL;
     vx_size size;
     vx_memory_map_extra extra;
@@ -595,6 +604,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapTensorPatch(vx_tensor tensor, vx_size nu
         status = VX_ERROR_INVALID_REFERENCE;
         goto exit;
     }
+    trace_start = ownTraceTime(tensor->base.context);
 
     /* determine if virtual before checking for memory */
     if (tensor->base.is_virtual == vx_true_e)
@@ -648,7 +658,14 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapTensorPatch(vx_tensor tensor, vx_size nu
     if (VX_MEMORY_TYPE_HOST  == mem_type &&
         vx_true_e == ownMemoryMap(tensor->base.context, (vx_reference)tensor, 0, usage, mem_type, 0, (void *)&extra, (void **)&buf, map_id))
     {
-        *ptr = tensor->addr;
+        /* host maps alias the tensor memory, so they report its own strides */
+        vx_uint8 *tensor_ptr = (vx_uint8 *)tensor->addr;
+        for (vx_uint32 i = 0; i < number_of_dims; i++)
+        {
+            tensor_ptr += view_start[i] * tensor->stride[i];
+            stride[i] = tensor->stride[i];
+        }
+        *ptr = tensor_ptr;
 
         ownIncrementReference(&tensor->base, VX_EXTERNAL);
 
@@ -677,6 +694,10 @@ VX_API_ENTRY vx_status VX_API_CALL vxMapTensorPatch(vx_tensor tensor, vx_size nu
     }
 
 exit:
+    if (trace_start != 0u)
+    {
+        ownTraceComplete(tensor->base.context, VX_TRACE_CATEGORY_MEMORY, "vxMapTensorPatch", tensor, trace_start);
+    }
     VX_PRINT(VX_ZONE_API, "returned %d\n", status);
     return status;
 }
@@ -684,6 +705,7 @@ exit:
 VX_API_ENTRY vx_status VX_API_CALL vxUnmapTensorPatch(vx_tensor tensor, vx_map_id map_id)
 {
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
 
     /* bad references */
     if (ownIsValidTensor(tensor) == vx_false_e)
@@ -691,6 +713,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxUnmapTensorPatch(vx_tensor tensor, vx_map_i
         status = VX_ERROR_INVALID_REFERENCE;
         goto exit;
     }
+    trace_start = ownTraceTime(tensor->base.context);
 
     /* bad parameters */
     if (ownFindMemoryMap(tensor->base.context, (vx_reference)tensor, map_id) != vx_true_e)
@@ -753,6 +776,10 @@ VX_API_ENTRY vx_status VX_API_CALL vxUnmapTensorPatch(vx_tensor tensor, vx_map_i
     }
 
 exit:
+    if (trace_start != 0u)
+    {
+        ownTraceComplete(tensor->base.context, VX_TRACE_CATEGORY_MEMORY, "vxUnmapTensorPatch", tensor, trace_start);
+    }
     VX_PRINT(VX_ZONE_API, "return %d\n", status);
 
     return status;
@@ -762,6 +789,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyTensorPatch(vx_tensor tensor, vx_size n
         const vx_size * user_stride, void * user_ptr, vx_enum usage, vx_enum user_memory_type)
 {
     vx_status status = VX_FAILURE;
+    vx_uint64 trace_start = 0u;
     (void)user_memory_type;
 
     /* bad parameters */
@@ -777,6 +805,7 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyTensorPatch(vx_tensor tensor, vx_size n
         status = VX_ERROR_INVALID_REFERENCE;
         goto exit;
     }
+    trace_start = ownTraceTime(tensor->base.context);
 
     /* determine if virtual before checking for memory */
     if (tensor->base.is_virtual == vx_true_e && tensor->base.is_accessible == vx_false_e)
@@ -866,13 +895,20 @@ VX_API_ENTRY vx_status VX_API_CALL vxCopyTensorPatch(vx_tensor tensor, vx_size n
 #endif
 
 exit:
+    if (trace_start != 0u)
+    {
+        ownTraceComplete(tensor->base.context, VX_TRACE_CATEGORY_MEMORY, "vxCopyTensorPatch", tensor, trace_start);
+    }
     VX_PRINT(VX_ZONE_API, "returned %d\n", status);
     return status;
 }
 
 void ownFreeTensor(vx_tensor tensor)
 {
-    free (tensor->addr);
+    if (tensor->mapping)
+        ownReleaseFileMapping(&tensor->mapping);
+    else
+        free (tensor->addr);
     tensor->addr = NULL;
 }
 
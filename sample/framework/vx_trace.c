@@ -0,0 +1,321 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vx_internal.h"
+#include "vx_trace.h"
+
+#if defined(_WIN32) || defined(UNDER_CE)
+#define VX_THREAD_LOCAL __declspec(thread)
+#else
+#define VX_THREAD_LOCAL __thread
+#endif
+
+static const vx_char *trace_categories[] = {
+    "graph",
+    "node",
+    "tile",
+    "threadpool",
+    "memory",
+};
+
+/*! \brief Bumped whenever the buffers are freed, so threads know their cached buffer is stale. */
+static vx_uint32 trace_generation = 1u;
+
+static VX_THREAD_LOCAL vx_trace_buffer_t *local_buffer = NULL;
+static VX_THREAD_LOCAL vx_uint32 local_generation = 0u;
+static VX_THREAD_LOCAL const vx_char *local_name = NULL;
+
+static void vxFreeTraceBuffers(vx_context context)
+{
+    vx_trace_buffer_t *buffer;
+
+    ownSemWait(&context->trace_lock);
+    buffer = context->trace_buffers;
+    while (buffer)
+    {
+        vx_trace_buffer_t *next = buffer->next;
+        free(buffer);
+        buffer = next;
+    }
+    context->trace_buffers = NULL;
+    context->trace_threads = 0u;
+    trace_generation++;
+    ownSemPost(&context->trace_lock);
+}
+
+/* Other threads may be writing to their buffers, so they are kept and only the events so far are dropped */
+static void vxRestartTraceBuffers(vx_context context)
+{
+    vx_trace_buffer_t *buffer;
+
+    ownSemWait(&context->trace_lock);
+    for (buffer = context->trace_buffers; buffer; buffer = buffer->next)
+    {
+        buffer->first = buffer->count;
+    }
+    ownSemPost(&context->trace_lock);
+}
+
+static vx_uint64 vxOldestTraceEvent(const vx_trace_buffer_t *buffer)
+{
+    vx_uint64 oldest = (buffer->count > VX_INT_TRACE_EVENTS) ? buffer->count - VX_INT_TRACE_EVENTS : 0u;
+    return (buffer->first > oldest) ? buffer->first : oldest;
+}
+
+static vx_trace_buffer_t *vxGetTraceBuffer(vx_context context)
+{
+    vx_trace_buffer_t *buffer = local_buffer;
+
+    if ((buffer == NULL) || (local_generation != trace_generation))
+    {
+        buffer = VX_CALLOC(vx_trace_buffer_t);
+        if (buffer)
+        {
+            buffer->name = local_name;
+            ownSemWait(&context->trace_lock);
+            buffer->tid = context->trace_threads++;
+            buffer->next = context->trace_buffers;
+            context->trace_buffers = buffer;
+            ownSemPost(&context->trace_lock);
+        }
+        else
+        {
+            VX_PRINT(VX_ZONE_ERROR, "Failed to allocate a trace buffer!\n");
+        }
+        local_buffer = buffer;
+        local_generation = trace_generation;
+    }
+    return buffer;
+}
+
+static void vxRecordTraceEvent(vx_context context, vx_enum category, vx_char phase,
+                               const vx_char *name, const void *object,
+                               vx_uint64 timestamp, vx_uint64 duration)
+{
+    vx_trace_buffer_t *buffer = vxGetTraceBuffer(context);
+    if (buffer)
+    {
+        vx_trace_event_t *event = &buffer->events[buffer->count % VX_INT_TRACE_EVENTS];
+        event->timestamp = timestamp;
+        event->duration = duration;
+        event->name = name;
+        event->object = object;
+        event->category = category;
+        event->phase = phase;
+        buffer->count++;
+    }
+}
+
+void ownInitTrace(vx_context context)
+{
+    const char *filename = getenv(VX_TRACE_FILE_ENV);
+
+    ownCreateSem(&context->trace_lock, 1);
+    context->trace_buffers = NULL;
+    context->trace_threads = 0u;
+    context->trace_enabled = vx_false_e;
+    if (filename && filename[0] != '\0')
+    {
+        strncpy(context->trace_file, filename, sizeof(context->trace_file) - 1);
+        context->trace_enabled = vx_true_e;
+        VX_PRINT(VX_ZONE_INFO, "Tracing to %s\n", context->trace_file);
+    }
+}
+
+void ownTraceNameThread(vx_context context, const vx_char *name)
+{
+    local_name = name;
+    if (context->trace_enabled == vx_true_e && local_buffer && local_generation == trace_generation)
+    {
+        local_buffer->name = name;
+    }
+}
+
+void ownTraceBegin(vx_context context, vx_enum category, const vx_char *name, const void *object)
+{
+    if (context->trace_enabled == vx_true_e)
+    {
+        vxRecordTraceEvent(context, category, 'B', name, object, ownCaptureTime(), 0u);
+    }
+}
+
+void ownTraceEnd(vx_context context, vx_enum category, const vx_char *name, const void *object)
+{
+    if (context->trace_enabled == vx_true_e)
+    {
+        vxRecordTraceEvent(context, category, 'E', name, object, ownCaptureTime(), 0u);
+    }
+}
+
+vx_uint64 ownTraceTime(vx_context context)
+{
+    return (context->trace_enabled == vx_true_e) ? ownCaptureTime() : 0u;
+}
+
+void ownTraceComplete(vx_context context, vx_enum category, const vx_char *name, const void *object, vx_uint64 start)
+{
+    if (context->trace_enabled == vx_true_e && start != 0u)
+    {
+        vx_uint64 end = ownCaptureTime();
+        vxRecordTraceEvent(context, category, 'X', name, object, start, end - start);
+    }
+}
+
+static void vxWriteTraceString(FILE *fp, const vx_char *str)
+{
+    fputc('"', fp);
+    for (; str && *str != '\0'; str++)
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            fputc('\\', fp);
+        }
+        if ((vx_uint8)*str >= 0x20)
+        {
+            fputc(*str, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static vx_status vxWriteTrace(vx_context context, const vx_char *filename)
+{
+    vx_trace_buffer_t *buffer;
+    vx_uint64 base = 0u;
+    vx_float64 us_per_tick = 1000000.0 / (vx_float64)ownGetClockRate();
+    vx_bool first = vx_true_e;
+    FILE *fp = fopen(filename, "w");
+
+    if (fp == NULL)
+    {
+        VX_PRINT(VX_ZONE_ERROR, "Failed to open %s for the trace\n", filename);
+        return VX_FAILURE;
+    }
+
+    ownSemWait(&context->trace_lock);
+
+    /* timestamps are written relative to the oldest event kept */
+    for (buffer = context->trace_buffers; buffer; buffer = buffer->next)
+    {
+        vx_uint64 oldest = vxOldestTraceEvent(buffer);
+        if (buffer->count > oldest)
+        {
+            vx_uint64 t = buffer->events[oldest % VX_INT_TRACE_EVENTS].timestamp;
+            if (base == 0u || t < base)
+                base = t;
+        }
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (buffer = context->trace_buffers; buffer; buffer = buffer->next)
+    {
+        vx_uint64 e = vxOldestTraceEvent(buffer);
+        vx_uint32 depth = 0u;
+
+        if (buffer->name)
+        {
+            fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                    first ? "" : ",\n", buffer->tid);
+            vxWriteTraceString(fp, buffer->name);
+            fprintf(fp, "}}");
+            first = vx_false_e;
+        }
+        for (; e < buffer->count; e++)
+        {
+            vx_trace_event_t *event = &buffer->events[e % VX_INT_TRACE_EVENTS];
+
+            /* the ring may have dropped the beginning of spans which end in it */
+            if (event->phase == 'B')
+            {
+                depth++;
+            }
+            else if (event->phase == 'E')
+            {
+                if (depth == 0u)
+                    continue;
+                depth--;
+            }
+
+            fprintf(fp, "%s{\"name\":", first ? "" : ",\n");
+            vxWriteTraceString(fp, event->name);
+            fprintf(fp, ",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f",
+                    trace_categories[event->category], event->phase, buffer->tid,
+                    (vx_float64)(event->timestamp - base) * us_per_tick);
+            if (event->phase == 'X')
+            {
+                fprintf(fp, ",\"dur\":%.3f", (vx_float64)event->duration * us_per_tick);
+            }
+            fprintf(fp, ",\"args\":{\"object\":\"%p\"}}", event->object);
+            first = vx_false_e;
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    ownSemPost(&context->trace_lock);
+    fclose(fp);
+    return VX_SUCCESS;
+}
+
+void ownDeinitTrace(vx_context context)
+{
+    if (context->trace_file[0] != '\0')
+    {
+        vxWriteTrace(context, context->trace_file);
+    }
+    context->trace_enabled = vx_false_e;
+    vxFreeTraceBuffers(context);
+    ownDestroySem(&context->trace_lock);
+}
+
+VX_API_ENTRY vx_status VX_API_CALL vxEnableTrace(vx_context context, vx_bool enable)
+{
+    vx_status status = VX_SUCCESS;
+
+    if (ownIsValidContext(context) == vx_false_e)
+    {
+        status = VX_ERROR_INVALID_REFERENCE;
+    }
+    else if (enable == vx_true_e)
+    {
+        vxRestartTraceBuffers(context);
+        context->trace_enabled = vx_true_e;
+    }
+    else
+    {
+        context->trace_enabled = vx_false_e;
+    }
+    return status;
+}
+
+VX_API_ENTRY vx_status VX_API_CALL vxExportTraceToFile(vx_context context, const vx_char *filename)
+{
+    vx_status status = VX_SUCCESS;
+
+    if (ownIsValidContext(context) == vx_false_e)
+    {
+        status = VX_ERROR_INVALID_REFERENCE;
+    }
+    else if (filename == NULL)
+    {
+        status = VX_ERROR_INVALID_PARAMETERS;
+    }
+    else
+    {
+        status = vxWriteTrace(context, filename);
+    }
+    return status;
+}
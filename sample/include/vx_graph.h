@@ -110,6 +110,14 @@ void ownFindNextNodes(vx_graph graph,
  */
 void ownContaminateGraphs(vx_reference ref);
 
+/*! \brief Computes a hash of the structure of a graph: the kernels, their targets and the
+ * way in which node parameters are shared between nodes, in node order.
+ * \param [in] graph The graph to hash.
+ * \param [in] seed A value folded into the hash, such as a format or library version.
+ * \ingroup group_int_graph
+ */
+vx_uint32 ownGraphStructureHash(vx_graph graph, vx_uint32 seed);
+
 /*! \brief Destroys a Graph.
  * \ingroup group_int_graph
  */
@@ -76,8 +76,11 @@
 #include <VX/vx_khr_xml.h>
 #endif
 #include <VX/vx_lib_extras.h>
+#include <VX/vx_ext_trace.h>
+#include <VX/vx_ext_graph.h>
 #if defined(OPENVX_USE_IX)
 #include <VX/vx_khr_ix.h>
+#include <VX/vx_ext_ix_file.h>
 #endif
 #ifdef OPENVX_USE_OPENCL_INTEROP
 #include <VX/vx_khr_opencl_interop.h>
@@ -176,6 +179,11 @@
  */
 #define VX_INT_MAX_QUEUE_DEPTH (32)
 
+/*! \brief The number of timeline events kept per thread while tracing.
+ * \ingroup group_int_defines
+ */
+#define VX_INT_TRACE_EVENTS (16384)
+
 /*! \brief The value to use in event waiting which never returns.
  * \ingroup group_int_defines
  */
@@ -186,6 +194,18 @@
  */
 #define VX_INT_HOST_CORES (TARGET_NUM_CORES)
 
+/*! \brief The fraction bits of a compiled remap coordinate. Bilinear remaps from the
+ * compiled table are within 1 of the float coordinates' result; nearest neighbour is exact.
+ * \ingroup group_int_defines
+ */
+#define VX_INT_REMAP_FRAC_BITS (8)
+
+/*! \brief The destination tile size a compiled remap is executed in.
+ * \ingroup group_int_defines
+ */
+#define VX_INT_REMAP_TILE_WIDTH  (64)
+#define VX_INT_REMAP_TILE_HEIGHT (16)
+
 /*! \brief The largest optical flow pyr LK window.
  * \ingroup group_int_defines
  */
@@ -399,6 +419,57 @@ typedef struct _vx_processor_t {
     vx_bool running;
 } vx_processor_t;
 
+/*! \brief A private (copy-on-write) mapping of a file, shared by reference count
+ * between the objects whose memory it backs.
+ * \ingroup group_int_osal
+ */
+typedef struct _vx_file_mapping_t {
+    /*! \brief The start of the mapped file */
+    vx_uint8 *base;
+    /*! \brief The length of the mapped file in bytes */
+    vx_size length;
+    /*! \brief The number of users of the mapping */
+    vx_uint32 count;
+    /*! \brief Protects the count */
+    vx_sem_t lock;
+} vx_file_mapping_t;
+
+/*! \brief A single event on the execution timeline.
+ * \ingroup group_int_trace
+ */
+typedef struct _vx_trace_event_t {
+    /*! \brief The time of the event, from \ref ownCaptureTime */
+    vx_uint64 timestamp;
+    /*! \brief The duration of a complete event, in the same units */
+    vx_uint64 duration;
+    /*! \brief The name of the event, which must outlive the trace */
+    const vx_char *name;
+    /*! \brief The object the event concerns */
+    const void *object;
+    /*! \brief The \ref vx_trace_category_e of the event */
+    vx_enum category;
+    /*! \brief The Chrome trace phase; 'B'egin, 'E'nd or 'X' for complete */
+    vx_char phase;
+} vx_trace_event_t;
+
+/*! \brief The ring of events recorded by one thread.
+ * \ingroup group_int_trace
+ */
+typedef struct _vx_trace_buffer_t {
+    /*! \brief The next buffer in the context's list */
+    struct _vx_trace_buffer_t *next;
+    /*! \brief The thread id used in the exported trace */
+    vx_uint32 tid;
+    /*! \brief The name of the thread, if it was given one */
+    const vx_char *name;
+    /*! \brief The number of events recorded, of which the last \ref VX_INT_TRACE_EVENTS are kept */
+    vx_uint64 count;
+    /*! \brief The count when tracing was last turned on; events before it are not exported */
+    vx_uint64 first;
+    /*! \brief The ring of events */
+    vx_trace_event_t events[VX_INT_TRACE_EVENTS];
+} vx_trace_buffer_t;
+
 // forward declarations
 struct _vx_threadpool_t;
 struct _vx_threadpool_worker_t;
@@ -622,6 +693,8 @@ typedef struct _vx_tensor_t {
     //vx_tensor  parent;
     struct _vx_tensor_t* parent;
     vx_image  subimages[VX_INT_MAX_REF];
+    /*! \brief If non-NULL, addr points into this file mapping rather than allocated memory. */
+    vx_file_mapping_t *mapping;
 } vx_tensor_t;
 /*! \brief The internal representation of the attributes associated with a run-time parameter.
  * \ingroup group_int_kernel
@@ -1023,6 +1096,16 @@ typedef struct _vx_context {
     vx_bool             log_reentrant;
     /*! \brief The performance counter enable toggle. */
     vx_bool             perf_enabled;
+    /*! \brief The timeline trace enable toggle. */
+    vx_bool             trace_enabled;
+    /*! \brief Protects the list of trace buffers */
+    vx_sem_t            trace_lock;
+    /*! \brief The trace buffers of the threads which have recorded events */
+    vx_trace_buffer_t  *trace_buffers;
+    /*! \brief The number of trace buffers, used to number threads */
+    vx_uint32           trace_threads;
+    /*! \brief The file the trace is written to on release, from \ref VX_TRACE_FILE_ENV */
+    vx_char             trace_file[VX_INT_MAX_PATH];
     /*! \brief The list of externally accessed references */
     vx_external_t       accessors[VX_INT_MAX_REF];
     /*! \brief The memory mapping table lock */
@@ -1165,6 +1248,9 @@ typedef struct _vx_graph {
     vx_graph       parentGraph;
     /*! \brief The array of all delays in this graph */
     vx_delay       delays[VX_INT_MAX_REF];
+    /*! \brief [hidden] Set when the node order and heads were restored from an imported
+     * execution plan; the next verification skips the structural phases. */
+    vx_bool        planned;
 } vx_graph_t;
 
 /*! \brief The dimensions enumeration, also stride enumerations.
@@ -1345,6 +1431,43 @@ typedef struct _vx_delay {
  */
 typedef vx_array_t vx_lut_t;
 
+/*! \brief A remap coordinate in fixed point. The integer part is clamped to a pixel or two
+ * beyond the source, which reads the same border as any further coordinate.
+ * \ingroup group_int_remap
+ */
+typedef struct _vx_remap_point_t {
+    /*! \brief The integer part of the source x */
+    vx_int16 x;
+    /*! \brief The integer part of the source y */
+    vx_int16 y;
+    /*! \brief The fraction of x in 1/(1 << VX_INT_REMAP_FRAC_BITS) */
+    vx_uint8 fx;
+    /*! \brief The fraction of y in 1/(1 << VX_INT_REMAP_FRAC_BITS) */
+    vx_uint8 fy;
+    /*! \brief The nearest source x, rounded from the float coordinate so that nearest neighbour stays exact */
+    vx_int16 nx;
+    /*! \brief The nearest source y, rounded from the float coordinate */
+    vx_int16 ny;
+} vx_remap_point_t;
+
+/*! \brief The coordinates of a remap compiled for execution.
+ * \ingroup group_int_remap
+ */
+typedef struct _vx_remap_compiled_t {
+    /*! \brief The write count of the remap this was compiled from */
+    vx_uint32 write_count;
+    /*! \brief One point per destination pixel, in rows of dst_width */
+    vx_remap_point_t *points;
+    /*! \brief The number of destination tiles across */
+    vx_uint32 tiles_x;
+    /*! \brief The number of destination tiles down */
+    vx_uint32 tiles_y;
+    /*! \brief Per tile, whether every bilinear tap lies inside the source */
+    vx_uint8 *inside;
+    /*! \brief The tile indices, ordered by the source rows they read */
+    vx_uint32 *order;
+} vx_remap_compiled_t;
+
 /*! \brief A remap is a 2D image of float32 pairs.
  * \ingroup group_int_remap
  */
@@ -1361,6 +1484,8 @@ typedef struct _vx_remap {
     vx_uint32 dst_width;
     /*! \brief Output Height */
     vx_uint32 dst_height;
+    /*! \brief The coordinates compiled by ownCompileRemap, or NULL */
+    vx_remap_compiled_t *compiled;
 } vx_remap_t;
 
 /*! \brief A histogram.
@@ -1605,6 +1730,7 @@ typedef struct _vx_meta_format
 #include "vx_log.h"
 #include "vx_node.h"
 #include "vx_osal.h"
+#include "vx_trace.h"
 #include "vx_parameter.h"
 #include "vx_reference.h"
 #include "vx_scalar.h"
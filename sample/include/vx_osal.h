@@ -176,6 +176,24 @@ void ownUnloadModule(vx_module_handle_t mod);
  */
 vx_symbol_t ownGetSymbol(vx_module_handle_t mod, vx_char * name);
 
+/*! \brief Maps the whole of an open file privately into memory. Pages are shared
+ * with the page cache until written; writes are never carried back to the file.
+ * \param [in] fd The file descriptor, which may be closed once the mapping is made.
+ * \return The mapping with a count of one, or NULL on failure.
+ * \ingroup group_int_osal
+ */
+vx_file_mapping_t *ownMapFile(int fd);
+
+/*! \brief Adds a user to a file mapping.
+ * \ingroup group_int_osal
+ */
+void ownRetainFileMapping(vx_file_mapping_t *mapping);
+
+/*! \brief Removes a user from a file mapping, unmapping it when there are none left.
+ * \ingroup group_int_osal
+ */
+void ownReleaseFileMapping(vx_file_mapping_t **mapping);
+
 /*! \brief Converts a vx_uint64 to a float in milliseconds.
  * \ingroup group_int_osal
  */
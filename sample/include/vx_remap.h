@@ -35,5 +35,14 @@
  */
 void ownDestructRemap(vx_reference ref);
 
+/*! \brief Compiles the coordinates of a remap into fixed point source positions, per tile
+ * border flags and a tile order, unless the compiled table is already up to date.
+ * \param [in] remap The remap to compile.
+ * \return The compiled table, valid until the remap is written again, or NULL if the source
+ * is too large for 16 bit coordinates or there is no memory.
+ * \ingroup group_int_remap
+ */
+vx_remap_compiled_t *ownCompileRemap(vx_remap remap);
+
 #endif
 
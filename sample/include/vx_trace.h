@@ -0,0 +1,82 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _OPENVX_INT_TRACE_H_
+#define _OPENVX_INT_TRACE_H_
+
+#include <VX/vx.h>
+#include "vx_internal.h"
+
+/*! \file
+ * \brief Defines an API for recording the execution timeline.
+ *
+ * \defgroup group_int_trace Internal Trace API.
+ * \ingroup group_internal
+ * \brief The Internal Trace API. Each thread appends to a ring buffer of its own,
+ * so recording an event takes no lock once the thread has its buffer.
+ */
+
+/*! \brief The categories of trace events.
+ * \ingroup group_int_trace
+ */
+enum vx_trace_category_e {
+    VX_TRACE_CATEGORY_GRAPH = 0,
+    VX_TRACE_CATEGORY_NODE,
+    VX_TRACE_CATEGORY_TILE,
+    VX_TRACE_CATEGORY_THREADPOOL,
+    VX_TRACE_CATEGORY_MEMORY,
+};
+
+/*! \brief Sets up tracing for a new context, enabling it if \ref VX_TRACE_FILE_ENV is set.
+ * \ingroup group_int_trace
+ */
+void ownInitTrace(vx_context context);
+
+/*! \brief Writes the trace to the file named by \ref VX_TRACE_FILE_ENV, if any, and frees the buffers.
+ * \ingroup group_int_trace
+ */
+void ownDeinitTrace(vx_context context);
+
+/*! \brief Names the calling thread in the exported trace.
+ * \param [in] name A string which outlives the trace.
+ * \ingroup group_int_trace
+ */
+void ownTraceNameThread(vx_context context, const vx_char *name);
+
+/*! \brief Records the start of a span on the calling thread.
+ * \param [in] name A string which outlives the trace.
+ * \ingroup group_int_trace
+ */
+void ownTraceBegin(vx_context context, vx_enum category, const vx_char *name, const void *object);
+
+/*! \brief Records the end of the span last begun on the calling thread.
+ * \ingroup group_int_trace
+ */
+void ownTraceEnd(vx_context context, vx_enum category, const vx_char *name, const void *object);
+
+/*! \brief Returns the start time for \ref ownTraceComplete, or 0 when tracing is off.
+ * \ingroup group_int_trace
+ */
+vx_uint64 ownTraceTime(vx_context context);
+
+/*! \brief Records a span from start to now, for calls with several exits.
+ * \param [in] start The value of \ref ownTraceTime on entry. Nothing is recorded if it is 0.
+ * \ingroup group_int_trace
+ */
+void ownTraceComplete(vx_context context, vx_enum category, const vx_char *name, const void *object, vx_uint64 start);
+
+#endif
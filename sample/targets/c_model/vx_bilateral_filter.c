@@ -61,6 +61,10 @@ static vx_status VX_CALLBACK vxBilateralFilterKernel(vx_node node, const vx_refe
         vx_size dims[VX_MAX_TENSOR_DIMENSIONS];
         vx_size stride[VX_MAX_TENSOR_DIMENSIONS];
         void *out_ptr;
+        void *cache = NULL;
+        vx_size cache_size = 0;
+        status |= vxQueryNode(node, VX_NODE_LOCAL_DATA_PTR, &cache, sizeof(cache));
+        status |= vxQueryNode(node, VX_NODE_LOCAL_DATA_SIZE, &cache_size, sizeof(cache_size));
         if (status == VX_SUCCESS)
         {
 
@@ -68,7 +72,7 @@ static vx_status VX_CALLBACK vxBilateralFilterKernel(vx_node node, const vx_refe
 
             status |= vxBilateralFilter(src_tensor->addr, src_tensor->stride, src_tensor->dimensions, src_tensor->number_of_dimensions,
                     diameter, sigmaSpace, sigmaValues, out_ptr, dst_tensor->stride, dst_tensor->data_type,
-                    &bordermode);
+                    &bordermode, cache, cache_size);
 
             status |= ReleasePatch(dst_tensor, dims_num, dims, stride, &out_ptr, VX_WRITE_ONLY);
         }
@@ -155,6 +159,32 @@ static vx_status VX_CALLBACK vxBilateralFilterValidator(vx_node node, const vx_r
 }
 
 
+static vx_status VX_CALLBACK vxBilateralFilterInitializer(vx_node node, const vx_reference parameters[], vx_uint32 num)
+{
+    vx_status status = VX_ERROR_INVALID_PARAMETERS;
+    if (num == BILATERAL_FILTER_PARAMS_NUMBER)
+    {
+        vx_tensor src_tensor = (vx_tensor)parameters[BILATERAL_FILTER_PARAM_SRC];
+        vx_int32 diameter = 0;
+        vx_enum format = VX_TYPE_INVALID;
+        vx_size num_of_dims = 0;
+        vx_size kernel_data_size = 0;
+
+        status = vxCopyScalar((vx_scalar)parameters[BILATERAL_FILTER_PARAM_DIAMETER], &diameter, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+        status |= vxQueryTensor(src_tensor, VX_TENSOR_DATA_TYPE, &format, sizeof(format));
+        status |= vxQueryTensor(src_tensor, VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof(num_of_dims));
+        status |= vxQueryKernel(node->kernel, VX_KERNEL_LOCAL_DATA_SIZE, &kernel_data_size, sizeof(kernel_data_size));
+
+        /* room for the weight tables, which are filled on the first run and kept
+         * for as long as the diameter and sigmas stay the same */
+        if (status == VX_SUCCESS && kernel_data_size == 0)
+        {
+            node->attributes.localDataSize = BilateralFilterCacheSizeImpl(diameter, format, num_of_dims);
+        }
+    }
+    return status;
+}
+
 vx_kernel_description_t bilateral_filter_kernel  = {
      VX_KERNEL_BILATERAL_FILTER,
     "org.khronos.openvx.bilateral_filter",
@@ -163,7 +193,7 @@ vx_kernel_description_t bilateral_filter_kernel  = {
     vxBilateralFilterValidator,
     NULL,
     NULL,
-    NULL,
+    vxBilateralFilterInitializer,
     NULL,
 };
 
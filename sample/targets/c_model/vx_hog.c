@@ -34,8 +34,6 @@
 
 static vx_status VX_CALLBACK vxHogCellsKernel(vx_node node, const vx_reference *parameters, vx_uint32 num)
 {
-    (void)node;
-
     vx_status status = VX_ERROR_INVALID_PARAMETERS;
     if (num == 6)
     {
@@ -45,7 +43,12 @@ static vx_status VX_CALLBACK vxHogCellsKernel(vx_node node, const vx_reference *
         vx_scalar num_bins = (vx_scalar)parameters[3];
         vx_tensor magnitudes = (vx_tensor)parameters[4];
         vx_tensor bins = (vx_tensor)parameters[5];
-        status = vxHogCells(img, cell_width, cell_height, num_bins, magnitudes, bins);
+        void *cache = NULL;
+        vx_size cache_size = 0;
+        status = vxQueryNode(node, VX_NODE_LOCAL_DATA_PTR, &cache, sizeof(cache));
+        status |= vxQueryNode(node, VX_NODE_LOCAL_DATA_SIZE, &cache_size, sizeof(cache_size));
+        if (status == VX_SUCCESS)
+            status = vxHogCells(img, cell_width, cell_height, num_bins, magnitudes, bins, cache, cache_size);
     }
     return status;
 }
@@ -154,6 +157,25 @@ static vx_param_description_t hogcells_kernel_params[] = {
     { VX_OUTPUT, VX_TYPE_TENSOR, VX_PARAMETER_STATE_REQUIRED },
 };
 
+static vx_status VX_CALLBACK vxHogCellsInitializer(vx_node node, const vx_reference parameters[], vx_uint32 num)
+{
+    vx_status status = VX_ERROR_INVALID_PARAMETERS;
+    (void)parameters;
+    if (num == 6)
+    {
+        vx_size kernel_data_size = 0;
+
+        status = vxQueryKernel(node->kernel, VX_KERNEL_LOCAL_DATA_SIZE, &kernel_data_size, sizeof(kernel_data_size));
+
+        /* room for the orientation bin of every gradient, filled on the first run */
+        if (status == VX_SUCCESS && kernel_data_size == 0)
+        {
+            node->attributes.localDataSize = HogCellsCacheSizeImpl();
+        }
+    }
+    return status;
+}
+
 vx_kernel_description_t hogcells_kernel = {
     VX_KERNEL_HOG_CELLS,
     "org.khronos.openvx.hog_cells",
@@ -162,7 +184,7 @@ vx_kernel_description_t hogcells_kernel = {
     NULL,
     vxHogCellsInputValidator,
     vxHogCellsOutputValidator,
-    NULL,
+    vxHogCellsInitializer,
     NULL,
 };
 
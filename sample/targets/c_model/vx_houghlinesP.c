@@ -30,7 +30,6 @@
 static vx_status VX_CALLBACK vxHoughLinesPKernel(vx_node node, const vx_reference *parameters, vx_uint32 num)
 {
     vx_status status = VX_ERROR_INVALID_PARAMETERS;
-    (void)node;
 
     if (num == 4)
     {
@@ -38,7 +37,44 @@ static vx_status VX_CALLBACK vxHoughLinesPKernel(vx_node node, const vx_referenc
         vx_array param_hough_lines = (vx_array)parameters[1];
         vx_array lines_array = (vx_array)parameters[2];
         vx_scalar num_lines = (vx_scalar)parameters[3];
-        status = vxHoughLinesP(img, param_hough_lines, lines_array, num_lines);
+        void *scratch = NULL;
+        vx_size size = 0ul;
+
+        vxQueryNode(node, VX_NODE_LOCAL_DATA_PTR, &scratch, sizeof(scratch));
+        vxQueryNode(node, VX_NODE_LOCAL_DATA_SIZE, &size, sizeof(size));
+
+        status = vxHoughLinesP(img, param_hough_lines, lines_array, num_lines, scratch, size);
+    }
+    return status;
+}
+
+static vx_status VX_CALLBACK vxHoughLinesPInitializer(vx_node node, const vx_reference parameters[], vx_uint32 num)
+{
+    vx_status status = VX_ERROR_INVALID_PARAMETERS;
+    if (num == 4)
+    {
+        vx_image img = (vx_image)parameters[0];
+        vx_array param_hough_lines = (vx_array)parameters[1];
+        vx_hough_lines_p_t params;
+        vx_uint32 width = 0, height = 0;
+        vx_size num_params = 0;
+        vx_size kernel_data_size = 0;
+
+        status = vxQueryImage(img, VX_IMAGE_WIDTH, &width, sizeof(width));
+        status |= vxQueryImage(img, VX_IMAGE_HEIGHT, &height, sizeof(height));
+        status |= vxQueryArray(param_hough_lines, VX_ARRAY_NUMITEMS, &num_params, sizeof(num_params));
+
+        /* the accumulator, mask and point list are sized once here instead of on every run;
+         * without parameters yet the kernel falls back to a buffer of its own */
+        if (status == VX_SUCCESS && num_params > 0)
+        {
+            status = vxCopyArrayRange(param_hough_lines, 0, 1, sizeof(params), &params, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+            vxQueryKernel(node->kernel, VX_KERNEL_LOCAL_DATA_SIZE, &kernel_data_size, sizeof(kernel_data_size));
+            if (status == VX_SUCCESS && kernel_data_size == 0)
+            {
+                node->attributes.localDataSize = HoughLinesPScratchSizeImpl(width, height, &params);
+            }
+        }
     }
     return status;
 }
@@ -122,6 +158,6 @@ vx_kernel_description_t houghlinesp_kernel = {
     NULL,
     vxHoughLinesPInputValidator,
     vxHoughLinesPOutputValidator,
-    NULL,
+    vxHoughLinesPInitializer,
     NULL,
 };
@@ -133,12 +133,14 @@ vx_status vxTargetInit(vx_target target)
     {
         strncpy(target->name, name, VX_MAX_TARGET_NAME);
         target->priority = VX_TARGET_PRIORITY_C_MODEL;
+        ParallelForInit(target->base.context);
     }
     return ownInitializeTarget(target, target_kernels, num_target_kernels);
 }
 
 vx_status vxTargetDeinit(vx_target target)
 {
+    ParallelForDeinit();
     return ownDeinitializeTarget(target);
 }
 
@@ -53,6 +53,17 @@ static VX_INLINE int validFormat(vx_enum data_type, vx_uint8 fixed_point_pos)
         (data_type == VX_TYPE_INT8 && !fixed_point_pos);                                // S8
 }
 
+// The formats of convolution, pooling, fully connected, softmax and activation,
+// which also run F16 when the platform supports it
+static VX_INLINE int validNNFormat(vx_enum data_type, vx_uint8 fixed_point_pos)
+{
+    return
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+        (data_type == VX_TYPE_FLOAT16 && !fixed_point_pos) ||                           // F16
+#endif
+        validFormat(data_type, fixed_point_pos);
+}
+
 static VX_INLINE enum TensorCFmt getTensorCFmt(vx_tensor tensor)
 {
     if (tensor->data_type == VX_TYPE_INT16 && tensor->fixed_point_position == Q78_FIXED_POINT_POSITION)
@@ -64,6 +75,11 @@ static VX_INLINE enum TensorCFmt getTensorCFmt(vx_tensor tensor)
     if (tensor->data_type == VX_TYPE_INT8 && !tensor->fixed_point_position)
         return TENSOR_C_FMT_S8;
 
+#ifdef EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT
+    if (tensor->data_type == VX_TYPE_FLOAT16 && !tensor->fixed_point_position)
+        return TENSOR_C_FMT_F16;
+#endif
+
     assert(0);
     return TENSOR_C_FMT_U8;
 }
@@ -300,7 +316,7 @@ static vx_status VX_CALLBACK nnConvolutionInputValidator(vx_node node, vx_uint32
             vxQueryTensor(data, VX_TENSOR_DATA_TYPE, &data_format, sizeof(data_format));
             vxQueryTensor(data, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof(fixed_point_pos));
             if ((num_of_dims == 3 || num_of_dims == 4) &&
-                validFormat(data_format, fixed_point_pos))
+                validNNFormat(data_format, fixed_point_pos))
             {
                 status = VX_SUCCESS;
             }
@@ -317,7 +333,7 @@ static vx_status VX_CALLBACK nnConvolutionInputValidator(vx_node node, vx_uint32
             vxQueryTensor(data, VX_TENSOR_DATA_TYPE, &data_type, sizeof(data_type));
             vxQueryTensor(data, VX_TENSOR_DATA_TYPE, &data_format, sizeof(data_format));
             vxQueryTensor(data, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof(fixed_point_pos));
-            if (num_of_dims == 4 && validFormat(data_format, fixed_point_pos))
+            if (num_of_dims == 4 && validNNFormat(data_format, fixed_point_pos))
             {
                 status = VX_SUCCESS;
             }
@@ -597,7 +613,7 @@ static vx_status VX_CALLBACK nnPoolingInputValidator(vx_node node, vx_uint32 ind
         vxQueryTensor(input, VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims_in, sizeof(num_of_dims_in));
         vxQueryTensor(input, VX_TENSOR_DATA_TYPE, &data_format, sizeof(data_format));
         vxQueryTensor(input, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof(fixed_point_pos));
-        if ((num_of_dims_in == 3 || num_of_dims_in == 4) && validFormat(data_format, fixed_point_pos))
+        if ((num_of_dims_in == 3 || num_of_dims_in == 4) && validNNFormat(data_format, fixed_point_pos))
         {
             status = VX_SUCCESS;
         }
@@ -876,7 +892,7 @@ static vx_status VX_CALLBACK nnFullyConnectedInputValidator(vx_node node, vx_uin
         vxQueryTensor(in, VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof(num_of_dims));
         vxQueryTensor(in, VX_TENSOR_DATA_TYPE, &data_type, sizeof(data_type));
         vxQueryTensor(in, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof(fixed_point_pos));
-        if (num_of_dims >= 1 && validFormat(data_type, fixed_point_pos))
+        if (num_of_dims >= 1 && validNNFormat(data_type, fixed_point_pos))
         {
             status = VX_SUCCESS;
         }
@@ -898,7 +914,7 @@ static vx_status VX_CALLBACK nnFullyConnectedInputValidator(vx_node node, vx_uin
         vxQueryTensor(out, VX_TENSOR_DIMS, &out_dims, sizeof(out_dims));
         vxQueryTensor(wt, VX_TENSOR_DATA_TYPE, &data_type, sizeof(data_type));
         vxQueryTensor(wt, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof(fixed_point_pos));
-        if (validFormat(data_type, fixed_point_pos))
+        if (validNNFormat(data_type, fixed_point_pos))
         {
             status = VX_ERROR_INVALID_PARAMETERS;
 
@@ -1019,7 +1035,7 @@ static vx_status VX_CALLBACK nnFullyConnectedOutputValidator(vx_node node, vx_ui
                 vxSetMetaFormatAttribute(meta, VX_TENSOR_DIMS, &dims_out, sizeof(dims_out));
                 vxSetMetaFormatAttribute(meta, VX_TENSOR_DATA_TYPE, &data_type, sizeof(data_type));
                 vxSetMetaFormatAttribute(meta, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof(fixed_point_pos));
-                if (validFormat(data_type, fixed_point_pos))
+                if (validNNFormat(data_type, fixed_point_pos))
                 {
                     status = VX_SUCCESS;
                 }
@@ -1129,7 +1145,7 @@ static vx_status VX_CALLBACK nnSoftmaxInputValidator(vx_node node, vx_uint32 ind
         if (data) {
             vxQueryTensor(data, VX_TENSOR_DATA_TYPE, &data_type, sizeof(data_type));
             vxQueryTensor(data, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof(fixed_point_pos));
-            if (validFormat(data_type, fixed_point_pos))
+            if (validNNFormat(data_type, fixed_point_pos))
             {
                 status = VX_SUCCESS;
             }
@@ -1166,7 +1182,7 @@ static vx_status VX_CALLBACK nnSoftmaxOutputValidator(vx_node node, vx_uint32 in
                 vxQueryTensor(data, VX_TENSOR_DIMS, &dims, sizeof(dims));
                 vxQueryTensor(data, VX_TENSOR_DATA_TYPE, &data_type, sizeof(data_type));
                 vxQueryTensor(data, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof(fixed_point_pos));
-                if (validFormat(data_type, fixed_point_pos))
+                if (validNNFormat(data_type, fixed_point_pos))
                 {
                     vxSetMetaFormatAttribute(meta, VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof(num_of_dims));
                     vxSetMetaFormatAttribute(meta, VX_TENSOR_DIMS, &dims, sizeof(dims));
@@ -1220,7 +1236,6 @@ typedef enum _norm_params_e {
 static vx_status VX_CALLBACK nnNormalizationKernel(vx_node node, const vx_reference *parameters, vx_uint32 num)
 {
     vx_status status = VX_ERROR_INVALID_PARAMETERS;
-    (void)node;
 
     if (num == NORM_PARAMS_NUMBER)
     {
@@ -1230,7 +1245,41 @@ static vx_status VX_CALLBACK nnNormalizationKernel(vx_node node, const vx_refere
         vx_scalar alpha = (vx_scalar)parameters[NORM_PARAM_ALPHA];
         vx_scalar beta = (vx_scalar)parameters[NORM_PARAM_BETA];
         vx_tensor outputs = (vx_tensor)parameters[NORM_PARAM_TENSOR_OUT];
-        status = NNNormalizationKernelImpl(inputs, type, normalization_size, alpha, beta, outputs);
+        void *cache = NULL;
+        vx_size cache_size = 0;
+        status = vxQueryNode(node, VX_NODE_LOCAL_DATA_PTR, &cache, sizeof(cache));
+        status |= vxQueryNode(node, VX_NODE_LOCAL_DATA_SIZE, &cache_size, sizeof(cache_size));
+        if (status == VX_SUCCESS)
+        {
+            status = NNNormalizationKernelImpl(inputs, type, normalization_size, alpha, beta, outputs, cache, cache_size);
+        }
+    }
+    return status;
+}
+
+static vx_status VX_CALLBACK nnNormalizationInitializer(vx_node node, const vx_reference parameters[], vx_uint32 num)
+{
+    vx_status status = VX_ERROR_INVALID_PARAMETERS;
+
+    if (num == NORM_PARAMS_NUMBER)
+    {
+        vx_size kernel_data_size = 0;
+        status = vxQueryKernel(node->kernel, VX_KERNEL_LOCAL_DATA_SIZE, &kernel_data_size, sizeof(kernel_data_size));
+
+        /* the PWL table is built here rather than on the first run, and is only
+         * rebuilt if the normalization parameters change after verification */
+        if (status == VX_SUCCESS && kernel_data_size == 0)
+        {
+            node->attributes.localDataSize = NNNormalizationCacheSizeImpl();
+            if (node->attributes.localDataPtr == NULL)
+                node->attributes.localDataPtr = calloc(1, node->attributes.localDataSize);
+            if (node->attributes.localDataPtr == NULL)
+                status = VX_ERROR_NO_MEMORY;
+            else
+                status = NNNormalizationCacheInitImpl((vx_scalar)parameters[NORM_PARAM_TYPE], (vx_scalar)parameters[NORM_PARAM_SIZE],
+                                                      (vx_scalar)parameters[NORM_PARAM_ALPHA], (vx_scalar)parameters[NORM_PARAM_BETA],
+                                                      node->attributes.localDataPtr, node->attributes.localDataSize);
+        }
     }
     return status;
 }
@@ -1343,7 +1392,7 @@ vx_kernel_description_t nn_norm_kernel = {
 	NULL,
     nnNormalizationInputValidator,
     nnNormalizationOutputValidator,
-    NULL,
+    nnNormalizationInitializer,
     NULL,
 };
 
@@ -1481,11 +1530,9 @@ static vx_status VX_CALLBACK nnActivationValidator(
     VX_CALL(vxQueryTensor(input, VX_TENSOR_FIXED_POINT_POSITION, &i_fpp, sizeof(i_fpp)));
     VX_CALL(vxQueryTensor(output, VX_TENSOR_FIXED_POINT_POSITION, &o_fpp, sizeof(o_fpp)));
 
-    UNLESS ((o_dt == VX_TYPE_INT16 && o_fpp == Q78_FIXED_POINT_POSITION) ||
-            (o_dt == VX_TYPE_INT8 && !o_fpp) ||
-            (o_dt == VX_TYPE_UINT8 && !o_fpp))
+    UNLESS (validNNFormat(o_dt, o_fpp))
     {
-        VX_PRINT(VX_ZONE_ERROR, "Activation layer only supports Q78, U8 and S8 formats");
+        VX_PRINT(VX_ZONE_ERROR, "Activation layer only supports Q78, U8 and S8 formats, and F16 where the platform supports it");
         return VX_ERROR_INVALID_FORMAT;
     }
 
@@ -29,8 +29,6 @@
 
 static vx_status VX_CALLBACK vxMinMaxLocKernel(vx_node node, const vx_reference *parameters, vx_uint32 num)
 {
-    (void)node;
-
     if (num == 7)
     {
         vx_image input = (vx_image)parameters[0];
@@ -40,11 +38,46 @@ static vx_status VX_CALLBACK vxMinMaxLocKernel(vx_node node, const vx_reference
         vx_array maxLoc = (vx_array)parameters[4];
         vx_scalar minCount = (vx_scalar)parameters[5];
         vx_scalar maxCount = (vx_scalar)parameters[6];
-        return vxMinMaxLoc(input, minVal, maxVal, minLoc, maxLoc, minCount, maxCount);
+        void *scratch = NULL;
+        vx_size size = 0ul;
+
+        vxQueryNode(node, VX_NODE_LOCAL_DATA_PTR, &scratch, sizeof(scratch));
+        vxQueryNode(node, VX_NODE_LOCAL_DATA_SIZE, &size, sizeof(size));
+
+        return vxMinMaxLoc(input, minVal, maxVal, minLoc, maxLoc, minCount, maxCount, scratch, size);
     }
     return VX_ERROR_INVALID_PARAMETERS;
 }
 
+static vx_status VX_CALLBACK vxMinMaxLocInitializer(vx_node node, const vx_reference parameters[], vx_uint32 num)
+{
+    vx_status status = VX_ERROR_INVALID_PARAMETERS;
+    if (num == 7)
+    {
+        vx_image input = (vx_image)parameters[0];
+        vx_array minLoc = (vx_array)parameters[3];
+        vx_array maxLoc = (vx_array)parameters[4];
+        vx_uint32 width = 0, height = 0;
+        vx_size min_capacity = 0, max_capacity = 0;
+        vx_size kernel_data_size = 0;
+
+        status = vxQueryImage(input, VX_IMAGE_WIDTH, &width, sizeof(width));
+        status |= vxQueryImage(input, VX_IMAGE_HEIGHT, &height, sizeof(height));
+        if (minLoc)
+            status |= vxQueryArray(minLoc, VX_ARRAY_CAPACITY, &min_capacity, sizeof(min_capacity));
+        if (maxLoc)
+            status |= vxQueryArray(maxLoc, VX_ARRAY_CAPACITY, &max_capacity, sizeof(max_capacity));
+
+        /* the bands and their location lists are sized once here instead of on every run */
+        vxQueryKernel(node->kernel, VX_KERNEL_LOCAL_DATA_SIZE, &kernel_data_size, sizeof(kernel_data_size));
+        if (status == VX_SUCCESS && kernel_data_size == 0)
+        {
+            node->attributes.localDataSize = MinMaxLocScratchSizeImpl(width, height, min_capacity, max_capacity);
+        }
+    }
+    return status;
+}
+
 static vx_status VX_CALLBACK vxMinMaxLocInputValidator(vx_node node, vx_uint32 index)
 {
     vx_status status = VX_ERROR_INVALID_PARAMETERS;
@@ -160,7 +193,7 @@ vx_kernel_description_t minmaxloc_kernel = {
     NULL,
     vxMinMaxLocInputValidator,
     vxMinMaxLocOutputValidator,
-    NULL,
+    vxMinMaxLocInitializer,
     NULL,
 };
 
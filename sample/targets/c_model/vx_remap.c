@@ -24,9 +24,137 @@
 #include <VX/vx.h>
 #include <VX/vx_helper.h>
 #include "vx_internal.h"
+#include <c_model.h>
+
+/*! \brief The least number of tiles worth a thread of its own. */
+#define VX_REMAP_TILES_PER_THREAD (16)
+
+typedef struct _vx_remap_job_t {
+    const vx_remap_compiled_t *compiled;
+    const vx_uint8 *src;
+    vx_int32 src_stride;
+    vx_int32 src_width;
+    vx_int32 src_height;
+    vx_uint8 *dst;
+    vx_int32 dst_stride;
+    vx_uint32 dst_width;
+    vx_uint32 dst_height;
+    vx_enum policy;
+    vx_border_t borders;
+} vx_remap_job_t;
 
 static
-vx_bool read_pixel(void* base, vx_imagepatch_addressing_t* addr,
+vx_bool read_pixel(const vx_remap_job_t *job, vx_int32 x, vx_int32 y, vx_uint32 *pixel)
+{
+    if (x < 0 || y < 0 || x >= job->src_width || y >= job->src_height)
+    {
+        if (job->borders.mode == VX_BORDER_UNDEFINED)
+            return vx_false_e;
+
+        if (job->borders.mode == VX_BORDER_CONSTANT)
+        {
+            *pixel = job->borders.constant_value.U8;
+            return vx_true_e;
+        }
+
+        // bounded x/y
+        x = x < 0 ? 0 : x >= job->src_width ? job->src_width - 1 : x;
+        y = y < 0 ? 0 : y >= job->src_height ? job->src_height - 1 : y;
+    }
+    *pixel = job->src[y * job->src_stride + x];
+    return vx_true_e;
+}
+
+/*! \brief Remaps the pixels of a tile whose taps may leave the source. */
+static void vxRemapTileBorder(const vx_remap_job_t *job, vx_uint32 x0, vx_uint32 y0, vx_uint32 x1, vx_uint32 y1)
+{
+    const vx_uint32 one = 1u << VX_INT_REMAP_FRAC_BITS;
+    vx_uint32 x, y;
+
+    for (y = y0; y < y1; y++)
+    {
+        const vx_remap_point_t *point = &job->compiled->points[(vx_size)y * job->dst_width + x0];
+        vx_uint8 *dst = job->dst + y * job->dst_stride + x0;
+        for (x = x0; x < x1; x++, point++, dst++)
+        {
+            if (job->policy == VX_INTERPOLATION_NEAREST_NEIGHBOR)
+            {
+                vx_uint32 pixel = 0;
+                if (read_pixel(job, point->nx, point->ny, &pixel))
+                    *dst = (vx_uint8)pixel;
+            }
+            else
+            {
+                vx_uint32 tl = 0, tr = 0, bl = 0, br = 0;
+                vx_bool defined = vx_true_e;
+                defined &= read_pixel(job, point->x + 0, point->y + 0, &tl);
+                defined &= read_pixel(job, point->x + 1, point->y + 0, &tr);
+                defined &= read_pixel(job, point->x + 0, point->y + 1, &bl);
+                defined &= read_pixel(job, point->x + 1, point->y + 1, &br);
+                if (defined)
+                {
+                    vx_uint32 top = tl * (one - point->fx) + tr * point->fx;
+                    vx_uint32 bottom = bl * (one - point->fx) + br * point->fx;
+                    *dst = (vx_uint8)((top * (one - point->fy) + bottom * point->fy) >> (2 * VX_INT_REMAP_FRAC_BITS));
+                }
+            }
+        }
+    }
+}
+
+/*! \brief Remaps the pixels of a tile whose taps are all inside the source. */
+static void vxRemapTileInside(const vx_remap_job_t *job, vx_uint32 x0, vx_uint32 y0, vx_uint32 x1, vx_uint32 y1)
+{
+    const vx_uint32 one = 1u << VX_INT_REMAP_FRAC_BITS;
+    const vx_int32 stride = job->src_stride;
+    vx_uint32 x, y;
+
+    for (y = y0; y < y1; y++)
+    {
+        const vx_remap_point_t *point = &job->compiled->points[(vx_size)y * job->dst_width + x0];
+        vx_uint8 *dst = job->dst + y * job->dst_stride + x0;
+        if (job->policy == VX_INTERPOLATION_NEAREST_NEIGHBOR)
+        {
+            for (x = x0; x < x1; x++, point++)
+            {
+                *dst++ = job->src[point->ny * stride + point->nx];
+            }
+        }
+        else
+        {
+            for (x = x0; x < x1; x++, point++)
+            {
+                const vx_uint8 *src = job->src + point->y * stride + point->x;
+                vx_uint32 top = src[0] * (one - point->fx) + src[1] * point->fx;
+                vx_uint32 bottom = src[stride] * (one - point->fx) + src[stride + 1] * point->fx;
+                *dst++ = (vx_uint8)((top * (one - point->fy) + bottom * point->fy) >> (2 * VX_INT_REMAP_FRAC_BITS));
+            }
+        }
+    }
+}
+
+static void vxRemapTiles(void *arg, vx_uint32 start, vx_uint32 end)
+{
+    const vx_remap_job_t *job = (const vx_remap_job_t *)arg;
+    vx_uint32 i;
+
+    for (i = start; i < end; i++)
+    {
+        vx_uint32 tile = job->compiled->order[i];
+        vx_uint32 x0 = (tile % job->compiled->tiles_x) * VX_INT_REMAP_TILE_WIDTH;
+        vx_uint32 y0 = (tile / job->compiled->tiles_x) * VX_INT_REMAP_TILE_HEIGHT;
+        vx_uint32 x1 = x0 + VX_INT_REMAP_TILE_WIDTH < job->dst_width ? x0 + VX_INT_REMAP_TILE_WIDTH : job->dst_width;
+        vx_uint32 y1 = y0 + VX_INT_REMAP_TILE_HEIGHT < job->dst_height ? y0 + VX_INT_REMAP_TILE_HEIGHT : job->dst_height;
+
+        if (job->compiled->inside[tile])
+            vxRemapTileInside(job, x0, y0, x1, y1);
+        else
+            vxRemapTileBorder(job, x0, y0, x1, y1);
+    }
+}
+
+static
+vx_bool read_pixel_float(void* base, vx_imagepatch_addressing_t* addr,
     vx_float32 x, vx_float32 y, const vx_border_t* borders, vx_uint8* pixel)
 {
     vx_bool out_of_bounds = (x < 0 || y < 0 || x >= addr->dim_x || y >= addr->dim_y);
@@ -55,6 +183,62 @@ vx_bool read_pixel(void* base, vx_imagepatch_addressing_t* addr,
     return vx_true_e;
 }
 
+/*! \brief Remaps from the float coordinates, for tables which could not be compiled. */
+static vx_status vxRemapFloat(vx_remap table, vx_enum policy, const vx_border_t *borders,
+                              void *src_base, vx_imagepatch_addressing_t *src_addr,
+                              void *dst_base, vx_imagepatch_addressing_t *dst_addr,
+                              vx_uint32 width, vx_uint32 height)
+{
+    vx_status status = VX_SUCCESS;
+    vx_uint32 x, y;
+
+    for (y = 0u; y < height; y++)
+    {
+        for (x = 0u; x < width; x++)
+        {
+            vx_float32 src_x = 0.0f;
+            vx_float32 src_y = 0.0f;
+
+            vx_uint8 *dst = vxFormatImagePatchAddress2d(dst_base, x, y, dst_addr);
+
+            status = vxGetRemapPoint(table, x, y, &src_x, &src_y);
+            if (policy == VX_INTERPOLATION_NEAREST_NEIGHBOR)
+            {
+                /* this rounds then truncates the decimal side */
+                read_pixel_float(src_base, src_addr, src_x + 0.5f, src_y + 0.5f, borders, dst);
+            }
+            else if (policy == VX_INTERPOLATION_BILINEAR)
+            {
+                vx_uint8 tl = 0;
+                vx_uint8 tr = 0;
+                vx_uint8 bl = 0;
+                vx_uint8 br = 0;
+                vx_float32 xf = floorf(src_x);
+                vx_float32 yf = floorf(src_y);
+                vx_float32 dx = src_x - xf;
+                vx_float32 dy = src_y - yf;
+                vx_float32 a[] =
+                {
+                    (1.0f - dx) * (1.0f - dy),
+                    (1.0f - dx) * (dy),
+                    (dx)* (1.0f - dy),
+                    (dx)* (dy),
+                };
+                vx_bool defined = vx_true_e;
+                defined &= read_pixel_float(src_base, src_addr, xf + 0, yf + 0, borders, &tl);
+                defined &= read_pixel_float(src_base, src_addr, xf + 1, yf + 0, borders, &tr);
+                defined &= read_pixel_float(src_base, src_addr, xf + 0, yf + 1, borders, &bl);
+                defined &= read_pixel_float(src_base, src_addr, xf + 1, yf + 1, borders, &br);
+                if (defined)
+                {
+                    *dst = (vx_uint8)(a[0]*tl + a[2]*tr + a[1]*bl + a[3]*br);
+                }
+            }
+        }
+    }
+    return status;
+}
+
 static
 vx_param_description_t remap_kernel_params[] =
 {
@@ -78,18 +262,17 @@ static vx_status VX_CALLBACK vxRemapKernel(vx_node node, const vx_reference para
         vx_enum policy     = 0;
         void *src_base     = NULL;
         void *dst_base     = NULL;
-        vx_uint32 y        = 0u;
-        vx_uint32 x        = 0u;
         vx_uint32 width    = 0u;
         vx_uint32 height   = 0u;
         vx_imagepatch_addressing_t src_addr = VX_IMAGEPATCH_ADDR_INIT;
         vx_imagepatch_addressing_t dst_addr = VX_IMAGEPATCH_ADDR_INIT;
         vx_rectangle_t src_rect;
         vx_rectangle_t dst_rect;
-        vx_border_t    borders;
         vx_map_id      src_map_id;
         vx_map_id      dst_map_id;
+        vx_remap_job_t job;
 
+        memset(&job, 0, sizeof(job));
         vxCopyScalar(stype, &policy, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
 
         vxQueryImage(src_image, VX_IMAGE_WIDTH, &width, sizeof(width));
@@ -108,60 +291,35 @@ static vx_status VX_CALLBACK vxRemapKernel(vx_node node, const vx_reference para
         dst_rect.end_x   = width;
         dst_rect.end_y   = height;
 
-        vxQueryNode(node, VX_NODE_BORDER, &borders, sizeof(borders));
+        vxQueryNode(node, VX_NODE_BORDER, &job.borders, sizeof(job.borders));
+
+        /* compiled once per table write, normally by vxCopyRemapPatch or vxUnmapRemapPatch,
+         * tables which cannot be compiled are remapped from their float coordinates */
+        job.compiled = ownCompileRemap(table);
 
         status = VX_SUCCESS;
 
         status |= vxMapImagePatch(src_image, &src_rect, 0, &src_map_id, &src_addr, &src_base, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0);
         status |= vxMapImagePatch(dst_image, &dst_rect, 0, &dst_map_id, &dst_addr, &dst_base, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, 0);
-        if (status == VX_SUCCESS)
+        if (status == VX_SUCCESS && job.compiled == NULL)
         {
-            /* iterate over the destination image */
-            for (y = 0u; y < height; y++)
-            {
-                for (x = 0u; x < width; x++)
-                {
-                    vx_float32 src_x = 0.0f;
-                    vx_float32 src_y = 0.0f;
-
-                    vx_uint8 *dst = vxFormatImagePatchAddress2d(dst_base, x, y, &dst_addr);
+            status = vxRemapFloat(table, policy, &job.borders, src_base, &src_addr, dst_base, &dst_addr, width, height);
+        }
+        else if (status == VX_SUCCESS)
+        {
+            job.src = (const vx_uint8 *)src_base;
+            job.src_stride = src_addr.stride_y;
+            job.src_width = (vx_int32)src_rect.end_x;
+            job.src_height = (vx_int32)src_rect.end_y;
+            job.dst = (vx_uint8 *)dst_base;
+            job.dst_stride = dst_addr.stride_y;
+            job.dst_width = width;
+            job.dst_height = height;
+            job.policy = policy;
 
-                    status = vxGetRemapPoint(table, x, y, &src_x, &src_y);
-                    //printf("Remapping %lf,%lf to %lu,%lu\n",src_x, src_y, x, y);
-                    if (policy == VX_INTERPOLATION_NEAREST_NEIGHBOR)
-                    {
-                        /* this rounds then truncates the decimal side */
-                        read_pixel(src_base, &src_addr, src_x + 0.5f, src_y + 0.5f, &borders, dst);
-                    }
-                    else if (policy == VX_INTERPOLATION_BILINEAR)
-                    {
-                        vx_uint8 tl = 0;
-                        vx_uint8 tr = 0;
-                        vx_uint8 bl = 0;
-                        vx_uint8 br = 0;
-                        vx_float32 xf = floorf(src_x);
-                        vx_float32 yf = floorf(src_y);
-                        vx_float32 dx = src_x - xf;
-                        vx_float32 dy = src_y - yf;
-                        vx_float32 a[] =
-                        {
-                            (1.0f - dx) * (1.0f - dy),
-                            (1.0f - dx) * (dy),
-                            (dx)* (1.0f - dy),
-                            (dx)* (dy),
-                        };
-                        vx_bool defined = vx_true_e;
-                        defined &= read_pixel(src_base, &src_addr, xf + 0, yf + 0, &borders, &tl);
-                        defined &= read_pixel(src_base, &src_addr, xf + 1, yf + 0, &borders, &tr);
-                        defined &= read_pixel(src_base, &src_addr, xf + 0, yf + 1, &borders, &bl);
-                        defined &= read_pixel(src_base, &src_addr, xf + 1, yf + 1, &borders, &br);
-                        if (defined)
-                        {
-                            *dst = (vx_uint8)(a[0]*tl + a[2]*tr + a[1]*bl + a[3]*br);
-                        }
-                     }
-                }
-            }
+            /* each thread takes a contiguous run of the ordered tiles, so it reads
+             * a band of the source rather than the whole of it */
+            ParallelForImpl(job.compiled->tiles_x * job.compiled->tiles_y, VX_REMAP_TILES_PER_THREAD, vxRemapTiles, &job);
         }
 
         status |= vxUnmapImagePatch(src_image, src_map_id);
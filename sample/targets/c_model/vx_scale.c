@@ -57,14 +57,14 @@ static vx_status VX_CALLBACK vxScaleImageKernel(vx_node node, const vx_reference
         vx_image  dst_image = (vx_image)parameters[1];
         vx_scalar stype     = (vx_scalar)parameters[2];
         vx_border_t bordermode = { VX_BORDER_UNDEFINED, {{ 0 }} };
-        vx_float64 *interm = NULL;
+        void *cache = NULL;
         vx_size size = 0ul;
 
         vxQueryNode(node, VX_NODE_BORDER, &bordermode, sizeof(bordermode));
-        vxQueryNode(node, VX_NODE_LOCAL_DATA_PTR, &interm, sizeof(interm));
+        vxQueryNode(node, VX_NODE_LOCAL_DATA_PTR, &cache, sizeof(cache));
         vxQueryNode(node, VX_NODE_LOCAL_DATA_SIZE, &size, sizeof(size));
 
-        return vxScaleImage(src_image, dst_image, stype, &bordermode, interm, size);
+        return vxScaleImage(src_image, dst_image, stype, &bordermode, cache, size);
     }
     return VX_ERROR_INVALID_PARAMETERS;
 }
@@ -223,20 +223,20 @@ static vx_status VX_CALLBACK vxScaleImageInitializer(vx_node node, const vx_refe
         vxQueryImage(dst, VX_IMAGE_WIDTH, &w2, sizeof(w2));
         vxQueryImage(dst, VX_IMAGE_HEIGHT, &h2, sizeof(h2));
 
-        /* AREA interpolation requires a scratch buffer, however, if AREA
-        * implementation is disabled, then no scratch buffer is required, and
-        * size can be 0 (setting to 1 so that checks can pass in the kernel) */
+        /* room for the source coordinates of every destination column and row */
+        size = ScaleImageCacheSizeImpl(w2, h2);
+
+        /* AREA interpolation requires a scratch buffer */
 #if AREA_SCALE_ENABLE
         gcd_w = math_gcd(w1, w2);
         gcd_h = math_gcd(h1, h2);
         /* printf("%ux%u => %ux%u :: GCD_w %u GCD_h %u\n", w1,h1, w2,h2, gcd_w, gcd_h); */
-        if (gcd_w != 0 && gcd_h != 0)
+        if (gcd_w != 0 && gcd_h != 0 &&
+            (w1 / gcd_w) * (w2 / gcd_w) * (h1 / gcd_h) * (h2 / gcd_h) * sizeof(vx_float64) > size)
         {
             size = (w1 / gcd_w) * (w2 / gcd_w) * (h1 / gcd_h) * (h2 / gcd_h) * sizeof(vx_float64);
         }
         /* printf("Requesting "VX_FMT_SIZE" bytes for resizer\n", size); */
-#else
-        size = 1;
 #endif
         vxQueryKernel(node->kernel, VX_KERNEL_LOCAL_DATA_SIZE, &kernel_data_size, sizeof(kernel_data_size));
         if (kernel_data_size == 0)
@@ -816,6 +816,8 @@ vx_status VX_CALLBACK vxTilingKernel(vx_node node, const vx_reference parameters
     {
         for (ty = 0u; (ty < blkCntY) && (status == VX_SUCCESS); ty += tile_size_y)
         {
+            /* one event per row of tiles keeps the trace ring from flooding */
+            ownTraceBegin(node->base.context, VX_TRACE_CATEGORY_TILE, "tile row", node);
             for (tx = 0u; tx < blkCntX; tx += tile_size_x)
             {
                 for (p = 0u; p < num; p++)
@@ -829,6 +831,7 @@ vx_status VX_CALLBACK vxTilingKernel(vx_node node, const vx_reference parameters
                 tile_memory = ((vx_node_t *)node)->attributes.tileDataPtr;
                 ((vx_node_t *)node)->kernel->tilingfast_function(params, tile_memory, size);
             }
+            ownTraceEnd(node->base.context, VX_TRACE_CATEGORY_TILE, "tile row", node);
         }
     
         if (((vx_node_t *)node)->kernel->tilingflexible_function && ((blkCntY < height) || (blkCntX < width)))
@@ -842,7 +845,9 @@ vx_status VX_CALLBACK vxTilingKernel(vx_node node, const vx_reference parameters
                 }
             }
             tile_memory = ((vx_node_t *)node)->attributes.tileDataPtr;
+            ownTraceBegin(node->base.context, VX_TRACE_CATEGORY_TILE, "tile remainder", node);
             ((vx_node_t *)node)->kernel->tilingflexible_function(params, tile_memory, size);
+            ownTraceEnd(node->base.context, VX_TRACE_CATEGORY_TILE, "tile remainder", node);
         }
     }
     //tiling flexible function  
@@ -857,7 +862,9 @@ vx_status VX_CALLBACK vxTilingKernel(vx_node node, const vx_reference parameters
             }
         }
         tile_memory = ((vx_node_t *)node)->attributes.tileDataPtr;
+        ownTraceBegin(node->base.context, VX_TRACE_CATEGORY_TILE, "tile", node);
         ((vx_node_t *)node)->kernel->tilingflexible_function(params, tile_memory, size);
+        ownTraceEnd(node->base.context, VX_TRACE_CATEGORY_TILE, "tile", node);
     }
 
     for (p = 0u; p < num; p++)
@@ -68,6 +68,19 @@ TESTOPTS    :=
 TESTPATH    := raw
 include $(FINALE)
 
+_MODULE     := vx_f16_test
+include $(PRELUDE)
+TARGET      := vx_f16_test
+TARGETTYPE  := exe
+CSOURCES    := $(TARGET).c
+SHARED_LIBS := openvx vxu
+STATIC_LIBS := utils-lib
+IDIRS       += $(HOST_ROOT)/utils $(HOST_ROOT)/$(OPENVX_SRC)/include
+TESTPRGM    := $(TARGET)
+TESTOPTS    := 
+TESTPATH    := raw
+include $(FINALE)
+
 ifeq ($(TARGET_OS),LINUX)
 _MODULE     := vx_cam_test
 include $(PRELUDE)
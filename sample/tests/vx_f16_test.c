@@ -0,0 +1,635 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ Description : Checks the half float conversions of conversion_utils against a reference
+               decoded bit by bit, and the row conversions (F16C or NEON when the build
+               enables them) against the scalar ones. When the platform supports F16
+               tensors, also runs the F16 convolution, fully connected, pooling, softmax
+               and activation layers against a double precision reference computed from
+               the same half inputs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+#include <VX/vx.h>
+#if defined(OPENVX_USE_NN)
+#include <VX/vx_khr_nn.h>
+#endif
+#include <conversion_utils.h>
+
+#define MAX_REPORTED_FAILURES   (20)
+#define RANDOM_FLOATS           (1 << 20)
+
+static int failures = 0;
+
+static void fail(const char *test, const char *what, double value, uint32_t got, uint32_t expected)
+{
+    if (failures++ < MAX_REPORTED_FAILURES)
+        printf("%s: %s %.9g gave 0x%x, expected 0x%x\n", test, what, value, got, expected);
+}
+
+static uint32_t floatBits(float f)
+{
+    union { float f; uint32_t u; } v;
+    v.f = f;
+    return v.u;
+}
+
+static float bitsFloat(uint32_t u)
+{
+    union { float f; uint32_t u; } v;
+    v.u = u;
+    return v.f;
+}
+
+static uint32_t nextRandom(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state;
+}
+
+/* The value of a half, decoded without half2float */
+static double refHalfValue(uint16_t h)
+{
+    const int exponent = (h >> 10) & 0x1F;
+    const int mantissa = h & 0x3FF;
+    double v;
+
+    if (exponent == 0)
+        v = ldexp(mantissa, -24);
+    else if (exponent == 0x1F)
+        v = mantissa ? NAN : INFINITY;
+    else
+        v = ldexp(mantissa + 1024, exponent - 25);
+    return (h & 0x8000) ? -v : v;
+}
+
+/* The half nearest to a non-NaN float, ties to even, by a search over the finite halves */
+static uint16_t refFloat2Half(float x)
+{
+    const uint16_t sign = signbit(x) ? 0x8000 : 0;
+    const double a = fabs((double)x);
+    uint16_t lo = 0, hi = 0x7BFF;
+
+    // 65520 is halfway between the largest half and the next power of two
+    if (a >= 65520.0)
+        return sign | 0x7C00;
+    while (lo < hi)
+    {
+        uint16_t mid = (uint16_t)((lo + hi + 1) / 2);
+        if (refHalfValue(mid) <= a)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    if (lo < 0x7BFF)
+    {
+        double below = a - refHalfValue(lo), above = refHalfValue(lo + 1) - a;
+        if (above < below || (above == below && (lo & 1)))
+            lo++;
+    }
+    return sign | lo;
+}
+
+static void checkFloat2Half(const char *what, float x)
+{
+    uint16_t got = float2half(x), expected = refFloat2Half(x);
+    if (got != expected)
+        fail("float2half", what, x, got, expected);
+}
+
+static void testHalf2Float(void)
+{
+    uint32_t h;
+
+    for (h = 0; h <= 0xFFFF; h++)
+    {
+        float f = half2float((uint16_t)h);
+        double ref = refHalfValue((uint16_t)h);
+
+        if (isnan(ref))
+        {
+            // NaNs keep their sign and payload
+            if (!isnan(f) || (floatBits(f) >> 31) != (h >> 15) || ((floatBits(f) >> 13) & 0x3FF) != (h & 0x3FF))
+                fail("half2float", "NaN", ref, floatBits(f), (h & 0x8000) << 16 | 0x7F800000 | (h & 0x3FF) << 13);
+        }
+        else if (floatBits(f) != floatBits((float)ref))
+        {
+            fail("half2float", "half", ref, floatBits(f), floatBits((float)ref));
+        }
+    }
+}
+
+static void testFloat2Half(void)
+{
+    static const struct { const char *what; float value; uint16_t expected; } cases[] = {
+        {"one",                          1.0f,                                 0x3C00},
+        {"tie rounds down to even",      1.0f + 0x1p-11f,                      0x3C00},
+        {"tie rounds up to even",        1.0f + 0x3p-11f,                      0x3C02},
+        {"just above a tie",             1.0f + 0x1p-11f + 0x1p-23f,           0x3C01},
+        {"largest half",                 65504.0f,                             0x7BFF},
+        {"just below overflow",          65519.0f,                             0x7BFF},
+        {"overflow",                     65520.0f,                             0x7C00},
+        {"huge",                         1e10f,                                0x7C00},
+        {"smallest normal",              0x1p-14f,                             0x0400},
+        {"smallest subnormal",           0x1p-24f,                             0x0001},
+        {"subnormal tie to zero",        0x1p-25f,                             0x0000},
+        {"just above the zero tie",      0x1p-25f + 0x1p-40f,                  0x0001},
+        {"subnormal tie up to even",     0x3p-25f,                             0x0002},
+        {"subnormal rounds to normal",   0x3FFp-24f + 0x1p-25f,                0x0400},
+        {"underflow",                    1e-10f,                               0x0000},
+        {"negative underflow",           -1e-10f,                              0x8000},
+        {"negative zero",                -0.0f,                                0x8000},
+        {"negative tie",                 -(1.0f + 0x3p-11f),                   0xBC02},
+        {"infinity",                     INFINITY,                             0x7C00},
+        {"negative infinity",            -INFINITY,                            0xFC00},
+    };
+    static const uint32_t nans[] = { 0x7FC00000, 0x7F800001, 0x7FBFFFFF, 0x7FFFE000, 0xFFC00000, 0xFF800001 };
+    uint32_t i, state = 1;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        uint16_t got = float2half(cases[i].value);
+        if (got != cases[i].expected)
+            fail("float2half", cases[i].what, cases[i].value, got, cases[i].expected);
+        checkFloat2Half(cases[i].what, cases[i].value);
+    }
+
+    // NaNs, quiet and signalling, stay NaNs of the same sign
+    for (i = 0; i < sizeof(nans) / sizeof(nans[0]); i++)
+    {
+        uint16_t got = float2half(bitsFloat(nans[i]));
+        if ((got & 0x7C00) != 0x7C00 || (got & 0x3FF) == 0 || (got >> 15) != (nans[i] >> 31))
+            fail("float2half", "NaN", bitsFloat(nans[i]), got, (nans[i] >> 16 & 0x8000) | 0x7E00);
+    }
+
+    // every finite half, the midpoint to the next one and the floats either side of it
+    for (i = 0; i < 0x7BFF; i++)
+    {
+        float value = (float)refHalfValue((uint16_t)i);
+        float midpoint = (float)((refHalfValue((uint16_t)i) + refHalfValue((uint16_t)(i + 1))) / 2);
+
+        checkFloat2Half("half", value);
+        checkFloat2Half("half", -value);
+        checkFloat2Half("midpoint", midpoint);
+        checkFloat2Half("midpoint", -midpoint);
+        checkFloat2Half("below midpoint", nextafterf(midpoint, 0.0f));
+        checkFloat2Half("above midpoint", nextafterf(midpoint, INFINITY));
+    }
+
+    // and floats from below the subnormals to past the largest half
+    for (i = 0; i < RANDOM_FLOATS; i++)
+    {
+        uint32_t bits = 0x32000000u + nextRandom(&state) % (0x48000000u - 0x32000000u);
+        checkFloat2Half("float", bitsFloat(bits | (i & 1) << 31));
+    }
+}
+
+/* The row versions may quiet signalling NaNs, so NaNs only need to stay NaNs of the same sign */
+static int sameConversion(uint32_t got, uint32_t expected, uint32_t exponent_mask, uint32_t sign_shift)
+{
+    const uint32_t mantissa_mask = ~(exponent_mask | 1u << sign_shift) & ((1u << sign_shift) - 1);
+
+    if ((expected & exponent_mask) == exponent_mask && (expected & mantissa_mask) != 0)
+        return (got & exponent_mask) == exponent_mask && (got & mantissa_mask) != 0 &&
+               (got >> sign_shift) == (expected >> sign_shift);
+    return got == expected;
+}
+
+static void testRows(void)
+{
+    const size_t count = 0x10000;
+    uint16_t *halves = (uint16_t *)malloc(count * sizeof(uint16_t));
+    uint16_t *converted = (uint16_t *)malloc(count * sizeof(uint16_t));
+    float *floats = (float *)malloc(count * sizeof(float));
+    size_t i, offset;
+    uint32_t state = 7;
+
+    if (halves == NULL || converted == NULL || floats == NULL)
+    {
+        fail("rows", "allocation", 0, 0, 0);
+        free(halves);
+        free(converted);
+        free(floats);
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+        halves[i] = (uint16_t)i;
+
+    // from the start and from an odd offset, so that both the vector body and its tail run
+    for (offset = 0; offset < 2; offset++)
+    {
+        half2floatRow(halves + offset, count - 2 * offset, floats + offset);
+        for (i = offset; i < count - offset; i++)
+        {
+            uint32_t expected = floatBits(half2float(halves[i]));
+            if (!sameConversion(floatBits(floats[i]), expected, 0x7F800000, 31))
+                fail("half2floatRow", "half", half2float(halves[i]), floatBits(floats[i]), expected);
+        }
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t bits = (i & 3) == 0 ? floatBits(half2float((uint16_t)(i >> 2))) :
+                        0x32000000u + nextRandom(&state) % (0x48000000u - 0x32000000u);
+        floats[i] = bitsFloat(bits | (uint32_t)(i & 2) << 30);
+    }
+    floats[1] = NAN;
+    floats[2] = INFINITY;
+    floats[3] = -0.0f;
+    floats[5] = bitsFloat(0x7F800001);
+    for (offset = 0; offset < 2; offset++)
+    {
+        float2halfRow(floats + offset, count - 2 * offset, converted + offset);
+        for (i = offset; i < count - offset; i++)
+        {
+            uint16_t expected = float2half(floats[i]);
+            if (!sameConversion(converted[i], expected, 0x7C00, 15))
+                fail("float2halfRow", "float", floats[i], converted[i], expected);
+        }
+    }
+
+    free(halves);
+    free(converted);
+    free(floats);
+}
+
+#if defined(OPENVX_USE_NN) && defined(EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT)
+
+#define MAX_TEST_DIMS   (4)
+
+/*! \brief A host copy of an F16 tensor, and the tensor */
+typedef struct _test_tensor_t {
+    vx_size num_dims;
+    vx_size dims[MAX_TEST_DIMS];
+    vx_size count;
+    uint16_t *data;
+    vx_tensor tensor;
+} test_tensor_t;
+
+static vx_status testCreateTensor(vx_context context, test_tensor_t *t, vx_size num_dims, const vx_size *dims,
+                                  float range, uint32_t *state)
+{
+    vx_size i;
+
+    t->num_dims = num_dims;
+    t->count = 1;
+    for (i = 0; i < num_dims; i++)
+    {
+        t->dims[i] = dims[i];
+        t->count *= dims[i];
+    }
+    t->data = (uint16_t *)calloc(t->count, sizeof(uint16_t));
+    t->tensor = vxCreateTensor(context, num_dims, dims, VX_TYPE_FLOAT16, 0);
+    if (t->data == NULL)
+        return VX_ERROR_NO_MEMORY;
+    if (range == 0.0f)
+        return vxGetStatus((vx_reference)t->tensor);
+
+    for (i = 0; i < t->count; i++)
+        t->data[i] = float2half(range * ((vx_float32)(nextRandom(state) >> 8) / (vx_float32)(1 << 23) - 1.0f));
+    return vxGetStatus((vx_reference)t->tensor);
+}
+
+static vx_status testCopyTensor(test_tensor_t *t, vx_enum usage)
+{
+    vx_size start[MAX_TEST_DIMS] = {0};
+    vx_size strides[MAX_TEST_DIMS];
+    vx_size i;
+
+    for (i = 0; i < t->num_dims; i++)
+        strides[i] = i ? strides[i - 1] * t->dims[i - 1] : sizeof(uint16_t);
+    return vxCopyTensorPatch(t->tensor, t->num_dims, start, t->dims, strides, t->data, usage, VX_MEMORY_TYPE_HOST);
+}
+
+static void testReleaseTensor(test_tensor_t *t)
+{
+    if (t->tensor)
+        vxReleaseTensor(&t->tensor);
+    free(t->data);
+    t->data = NULL;
+}
+
+static double in(const test_tensor_t *t, vx_size i)
+{
+    return half2float(t->data[i]);
+}
+
+/* Verifies and runs a single node graph, then reads back its output */
+static vx_status testRun(vx_graph graph, vx_node node, test_tensor_t *output)
+{
+    vx_status status = vxGetStatus((vx_reference)node);
+    if (status == VX_SUCCESS)
+        status = vxVerifyGraph(graph);
+    if (status == VX_SUCCESS)
+        status = vxProcessGraph(graph);
+    if (status == VX_SUCCESS)
+        status = testCopyTensor(output, VX_READ_ONLY);
+    if (node)
+        vxReleaseNode(&node);
+    return status;
+}
+
+/* The output matches if it is within one half ulp of the reference, plus the error a float
+ * accumulation of terms terms adding up to magnitude can make */
+static void testCompare(const char *test, vx_size index, uint16_t got, double ref, vx_size terms, double magnitude)
+{
+    double a = fabs(ref);
+    double ulp = a < 0x1p-14 ? 0x1p-24 : ldexp(1.0, (int)floor(log2(a)) - 10);
+    double allowed = ulp + (double)terms * FLT_EPSILON * magnitude;
+
+    if (!(fabs(half2float(got) - ref) <= allowed))
+    {
+        if (failures++ < MAX_REPORTED_FAILURES)
+            printf("%s: output %u is %.9g, expected %.9g\n", test, (vx_uint32)index, half2float(got), ref);
+    }
+}
+
+static void testConvolution(vx_context context, vx_size out_w, vx_size out_h)
+{
+    const vx_size in_dims[] = {7, 6, 5, 2}, w_dims[] = {3, 3, 5, 4}, b_dims[] = {4};
+    const vx_size out_dims[] = {out_w, out_h, 4, 2};
+    const vx_size pad = 1;
+    vx_nn_convolution_params_t params = {pad, pad, VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
+                                         VX_NN_DS_SIZE_ROUNDING_FLOOR, 0, 0};
+    const vx_size stride_x = (in_dims[0] + 2 * pad - w_dims[0]) / (out_w - 1);
+    const vx_size stride_y = (in_dims[1] + 2 * pad - w_dims[1]) / (out_h - 1);
+    test_tensor_t input, weights, biases, output;
+    vx_graph graph = vxCreateGraph(context);
+    vx_uint32 state = 11;
+    vx_status status = VX_SUCCESS;
+    vx_size b, ofm, x, y, c, kx, ky;
+
+    status |= testCreateTensor(context, &input, 4, in_dims, 4.0f, &state);
+    status |= testCreateTensor(context, &weights, 4, w_dims, 1.0f, &state);
+    status |= testCreateTensor(context, &biases, 1, b_dims, 2.0f, &state);
+    status |= testCreateTensor(context, &output, 4, out_dims, 0.0f, &state);
+    status |= testCopyTensor(&input, VX_WRITE_ONLY);
+    status |= testCopyTensor(&weights, VX_WRITE_ONLY);
+    status |= testCopyTensor(&biases, VX_WRITE_ONLY);
+    if (status == VX_SUCCESS)
+        status = testRun(graph, vxConvolutionLayer(graph, input.tensor, weights.tensor, biases.tensor,
+                                                   &params, sizeof(params), output.tensor), &output);
+    if (status != VX_SUCCESS)
+        fail("convolution", "status", 0, (uint32_t)status, VX_SUCCESS);
+
+    for (b = 0; b < out_dims[3] && status == VX_SUCCESS; b++)
+    for (ofm = 0; ofm < out_dims[2]; ofm++)
+    for (y = 0; y < out_h; y++)
+    for (x = 0; x < out_w; x++)
+    {
+        double sum = in(&biases, ofm), magnitude = fabs(sum);
+        vx_size index = x + out_w * (y + out_h * (ofm + out_dims[2] * b));
+
+        for (c = 0; c < in_dims[2]; c++)
+        for (ky = 0; ky < w_dims[1]; ky++)
+        for (kx = 0; kx < w_dims[0]; kx++)
+        {
+            vx_size ix = x * stride_x + kx, iy = y * stride_y + ky;
+            if (ix < pad || iy < pad || ix - pad >= in_dims[0] || iy - pad >= in_dims[1])
+                continue;
+            {
+                double term = in(&input, ix - pad + in_dims[0] * (iy - pad + in_dims[1] * (c + in_dims[2] * b))) *
+                              in(&weights, kx + w_dims[0] * (ky + w_dims[1] * (c + w_dims[2] * ofm)));
+                sum += term;
+                magnitude += fabs(term);
+            }
+        }
+        testCompare("convolution", index, output.data[index], sum, in_dims[2] * w_dims[0] * w_dims[1] + 1, magnitude);
+    }
+
+    testReleaseTensor(&input);
+    testReleaseTensor(&weights);
+    testReleaseTensor(&biases);
+    testReleaseTensor(&output);
+    vxReleaseGraph(&graph);
+}
+
+static void testFullyConnected(vx_context context)
+{
+    const vx_size in_dims[] = {30, 3}, w_dims[] = {30, 7}, b_dims[] = {7}, out_dims[] = {7, 3};
+    test_tensor_t input, weights, biases, output;
+    vx_graph graph = vxCreateGraph(context);
+    vx_uint32 state = 13;
+    vx_status status = VX_SUCCESS;
+    vx_size b, ofm, k;
+
+    status |= testCreateTensor(context, &input, 2, in_dims, 4.0f, &state);
+    status |= testCreateTensor(context, &weights, 2, w_dims, 1.0f, &state);
+    status |= testCreateTensor(context, &biases, 1, b_dims, 2.0f, &state);
+    status |= testCreateTensor(context, &output, 2, out_dims, 0.0f, &state);
+    status |= testCopyTensor(&input, VX_WRITE_ONLY);
+    status |= testCopyTensor(&weights, VX_WRITE_ONLY);
+    status |= testCopyTensor(&biases, VX_WRITE_ONLY);
+    if (status == VX_SUCCESS)
+        status = testRun(graph, vxFullyConnectedLayer(graph, input.tensor, weights.tensor, biases.tensor,
+                                                      VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
+                                                      output.tensor), &output);
+    if (status != VX_SUCCESS)
+        fail("fully connected", "status", 0, (uint32_t)status, VX_SUCCESS);
+
+    for (b = 0; b < out_dims[1] && status == VX_SUCCESS; b++)
+    for (ofm = 0; ofm < out_dims[0]; ofm++)
+    {
+        double sum = in(&biases, ofm), magnitude = fabs(sum);
+        for (k = 0; k < in_dims[0]; k++)
+        {
+            double term = in(&input, k + in_dims[0] * b) * in(&weights, k + w_dims[0] * ofm);
+            sum += term;
+            magnitude += fabs(term);
+        }
+        testCompare("fully connected", ofm + out_dims[0] * b, output.data[ofm + out_dims[0] * b], sum, in_dims[0] + 1, magnitude);
+    }
+
+    testReleaseTensor(&input);
+    testReleaseTensor(&weights);
+    testReleaseTensor(&biases);
+    testReleaseTensor(&output);
+    vxReleaseGraph(&graph);
+}
+
+static void testPooling(vx_context context, vx_enum type)
+{
+    const vx_size in_dims[] = {7, 6, 3, 2}, out_dims[] = {4, 3, 3, 2};
+    const vx_size size = 3, pad = 1, stride = 2;
+    const char *test = type == VX_NN_POOLING_MAX ? "max pooling" : "avg pooling";
+    test_tensor_t input, output;
+    vx_graph graph = vxCreateGraph(context);
+    vx_uint32 state = 17;
+    vx_status status = VX_SUCCESS;
+    vx_size b, c, x, y, kx, ky;
+
+    status |= testCreateTensor(context, &input, 4, in_dims, 8.0f, &state);
+    status |= testCreateTensor(context, &output, 4, out_dims, 0.0f, &state);
+    status |= testCopyTensor(&input, VX_WRITE_ONLY);
+    if (status == VX_SUCCESS)
+        status = testRun(graph, vxPoolingLayer(graph, input.tensor, type, size, size, pad, pad,
+                                               VX_NN_DS_SIZE_ROUNDING_FLOOR, output.tensor), &output);
+    if (status != VX_SUCCESS)
+        fail(test, "status", 0, (uint32_t)status, VX_SUCCESS);
+
+    for (b = 0; b < out_dims[3] && status == VX_SUCCESS; b++)
+    for (c = 0; c < out_dims[2]; c++)
+    for (y = 0; y < out_dims[1]; y++)
+    for (x = 0; x < out_dims[0]; x++)
+    {
+        double result = type == VX_NN_POOLING_MAX ? -INFINITY : 0.0, magnitude = 0.0;
+        vx_size index = x + out_dims[0] * (y + out_dims[1] * (c + out_dims[2] * b));
+
+        for (ky = 0; ky < size; ky++)
+        for (kx = 0; kx < size; kx++)
+        {
+            vx_size ix = x * stride + kx, iy = y * stride + ky;
+            double value;
+            if (ix < pad || iy < pad || ix - pad >= in_dims[0] || iy - pad >= in_dims[1])
+                continue;
+            value = in(&input, ix - pad + in_dims[0] * (iy - pad + in_dims[1] * (c + in_dims[2] * b)));
+            result = type == VX_NN_POOLING_MAX ? fmax(result, value) : result + value;
+            magnitude += fabs(value);
+        }
+        // AVG divides by the full window, padding included
+        if (type == VX_NN_POOLING_AVG)
+            result /= (double)(size * size);
+        testCompare(test, index, output.data[index], result, size * size + 1, magnitude);
+    }
+
+    testReleaseTensor(&input);
+    testReleaseTensor(&output);
+    vxReleaseGraph(&graph);
+}
+
+static void testSoftmax(vx_context context, vx_size num_dims, const vx_size *dims)
+{
+    // the key dim is the third one, or the first for fewer than three dims
+    const vx_size key = num_dims > 2 ? 2 : 0;
+    const vx_size key_stride = key ? dims[0] * dims[1] : 1;
+    test_tensor_t input, output;
+    vx_graph graph = vxCreateGraph(context);
+    vx_uint32 state = 19;
+    vx_status status = VX_SUCCESS;
+    vx_size i, k;
+
+    status |= testCreateTensor(context, &input, num_dims, dims, 8.0f, &state);
+    status |= testCreateTensor(context, &output, num_dims, dims, 0.0f, &state);
+    status |= testCopyTensor(&input, VX_WRITE_ONLY);
+    if (status == VX_SUCCESS)
+        status = testRun(graph, vxSoftmaxLayer(graph, input.tensor, output.tensor), &output);
+    if (status != VX_SUCCESS)
+        fail("softmax", "status", 0, (uint32_t)status, VX_SUCCESS);
+
+    for (i = 0; i < input.count && status == VX_SUCCESS; i++)
+    {
+        // the first element of the row i is in
+        vx_size first = i - ((i / key_stride) % dims[key]) * key_stride;
+        double max_val = -INFINITY, sum = 0.0;
+
+        for (k = 0; k < dims[key]; k++)
+            max_val = fmax(max_val, in(&input, first + k * key_stride));
+        for (k = 0; k < dims[key]; k++)
+            sum += exp(in(&input, first + k * key_stride) - max_val);
+        testCompare("softmax", i, output.data[i], exp(in(&input, i) - max_val) / sum, dims[key], 1.0);
+    }
+
+    testReleaseTensor(&input);
+    testReleaseTensor(&output);
+    vxReleaseGraph(&graph);
+}
+
+static void testActivation(vx_context context, vx_enum function)
+{
+    const vx_size dims[] = {5, 4, 3};
+    test_tensor_t input, output;
+    vx_graph graph = vxCreateGraph(context);
+    vx_uint32 state = 23;
+    vx_status status = VX_SUCCESS;
+    vx_size i;
+
+    status |= testCreateTensor(context, &input, 3, dims, 6.0f, &state);
+    status |= testCreateTensor(context, &output, 3, dims, 0.0f, &state);
+    status |= testCopyTensor(&input, VX_WRITE_ONLY);
+    if (status == VX_SUCCESS)
+        status = testRun(graph, vxActivationLayer(graph, input.tensor, function, 1.0f, 1.0f, output.tensor), &output);
+    if (status != VX_SUCCESS)
+        fail("activation", "status", 0, (uint32_t)status, VX_SUCCESS);
+
+    for (i = 0; i < input.count && status == VX_SUCCESS; i++)
+    {
+        double x = in(&input, i), ref;
+        if (function == VX_NN_ACTIVATION_RELU)
+            ref = x > 0.0 ? x : 0.0;
+        else if (function == VX_NN_ACTIVATION_LOGISTIC)
+            ref = 1.0 / (1.0 + exp(-x));
+        else
+            ref = tanh(x);
+        testCompare("activation", i, output.data[i], ref, 1, 1.0);
+    }
+
+    testReleaseTensor(&input);
+    testReleaseTensor(&output);
+    vxReleaseGraph(&graph);
+}
+
+static void testLayers(void)
+{
+    vx_context context = vxCreateContext();
+    const vx_size softmax_rows[] = {10}, softmax_maps[] = {5, 3, 8};
+
+    if (vxGetStatus((vx_reference)context) != VX_SUCCESS)
+    {
+        fail("layers", "context", 0, (uint32_t)vxGetStatus((vx_reference)context), VX_SUCCESS);
+        return;
+    }
+    testConvolution(context, 7, 6);
+    testConvolution(context, 4, 3);
+    testFullyConnected(context);
+    testPooling(context, VX_NN_POOLING_MAX);
+    testPooling(context, VX_NN_POOLING_AVG);
+    testSoftmax(context, 1, softmax_rows);
+    testSoftmax(context, 3, softmax_maps);
+    testActivation(context, VX_NN_ACTIVATION_RELU);
+    testActivation(context, VX_NN_ACTIVATION_LOGISTIC);
+    testActivation(context, VX_NN_ACTIVATION_HYPERBOLIC_TAN);
+    vxReleaseContext(&context);
+}
+
+#endif
+
+int main(void)
+{
+    testHalf2Float();
+    testFloat2Half();
+    testRows();
+#if defined(OPENVX_USE_NN) && defined(EXPERIMENTAL_PLATFORM_SUPPORTS_16_FLOAT)
+    testLayers();
+#else
+    printf("F16 tensors are not supported by this build, only the conversions were checked\n");
+#endif
+
+    if (failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All F16 checks passed\n");
+    return 0;
+}
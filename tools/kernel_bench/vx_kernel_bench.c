@@ -0,0 +1,787 @@
+/*
+
+ * Copyright (c) 2012-2017 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file
+ * \brief Times each kernel of the context in a single node graph on every target which
+ * publishes it, over a sweep of image formats and sizes, and reports the throughput next
+ * to the copy bandwidth of the machine.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <VX/vx.h>
+#include <VX/vx_helper.h>
+#if defined(__linux__) || defined(__ANDROID__) || defined(__QNX__) || defined(__APPLE__) || defined(__CYGWIN__)
+#include <time.h>
+#elif defined(_WIN32) || defined(UNDER_CE)
+#include <windows.h>
+#endif
+
+#define VX_KBENCH_MAX_IMAGES    (3)
+#define VX_KBENCH_MAX_FORMATS   (8)
+#define VX_KBENCH_MAX_FILTERS   (8)
+#define VX_KBENCH_ARRAY_ITEMS   (16384)
+#define VX_KBENCH_COPY_SIZE     (64u * 1024u * 1024u)
+#define VX_KBENCH_COPY_RUNS     (8u)
+
+/*! \brief Creates the node of a kernel on images made by the benchmark. Any other
+ * parameters are created and released here, the node keeps them alive.
+ */
+typedef vx_node (*vx_kbench_create_f)(vx_graph graph, vx_image in[], vx_image out[]);
+
+typedef struct _vx_kbench_format_t {
+    vx_df_image in;
+    vx_df_image out;
+} vx_kbench_format_t;
+
+typedef struct _vx_kbench_kernel_t {
+    vx_enum kernel;
+    vx_kbench_create_f create;
+    vx_uint32 num_in;
+    vx_uint32 num_out;
+    vx_kbench_format_t formats[VX_KBENCH_MAX_FORMATS];
+} vx_kbench_kernel_t;
+
+static const vx_char *targets[] = {
+    "khronos.any",
+    "khronos.tiling",
+    "khronos.venum",
+    "pc.opencl",
+};
+
+static const struct {
+    vx_uint32 width;
+    vx_uint32 height;
+} sizes[] = {
+    {640, 480},
+    {1280, 720},
+    {1920, 1080},
+    {3840, 2160},
+    {7680, 4320},
+};
+
+/*! \brief The bytes per second moved by memcpy, which the kernel throughput is compared to. */
+static vx_float64 copy_bandwidth = 0.0;
+
+static vx_context vxKBenchContext(vx_graph graph)
+{
+    return vxGetContext((vx_reference)graph);
+}
+
+static vx_scalar vxKBenchScalar(vx_graph graph, vx_enum type, const void *value)
+{
+    return vxCreateScalar(vxKBenchContext(graph), type, value);
+}
+
+static vx_node vxKBenchBox(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxBox3x3Node(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchGaussian(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxGaussian3x3Node(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchMedian(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxMedian3x3Node(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchDilate(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxDilate3x3Node(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchErode(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxErode3x3Node(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchSobel(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxSobel3x3Node(g, in[0], out[0], out[1]);
+}
+
+static vx_node vxKBenchMagnitude(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxMagnitudeNode(g, in[0], in[1], out[0]);
+}
+
+static vx_node vxKBenchPhase(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxPhaseNode(g, in[0], in[1], out[0]);
+}
+
+static vx_node vxKBenchAdd(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxAddNode(g, in[0], in[1], VX_CONVERT_POLICY_SATURATE, out[0]);
+}
+
+static vx_node vxKBenchSubtract(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxSubtractNode(g, in[0], in[1], VX_CONVERT_POLICY_SATURATE, out[0]);
+}
+
+static vx_node vxKBenchMultiply(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_float32 value = 1.0f / 256.0f;
+    vx_scalar scale = vxKBenchScalar(g, VX_TYPE_FLOAT32, &value);
+    vx_node node = vxMultiplyNode(g, in[0], in[1], scale,
+                                  VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_ZERO, out[0]);
+    vxReleaseScalar(&scale);
+    return node;
+}
+
+static vx_node vxKBenchAnd(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxAndNode(g, in[0], in[1], out[0]);
+}
+
+static vx_node vxKBenchOr(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxOrNode(g, in[0], in[1], out[0]);
+}
+
+static vx_node vxKBenchXor(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxXorNode(g, in[0], in[1], out[0]);
+}
+
+static vx_node vxKBenchNot(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxNotNode(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchAbsDiff(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxAbsDiffNode(g, in[0], in[1], out[0]);
+}
+
+static vx_node vxKBenchConvertDepth(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_int32 value = 0;
+    vx_scalar shift = vxKBenchScalar(g, VX_TYPE_INT32, &value);
+    vx_node node = vxConvertDepthNode(g, in[0], out[0], VX_CONVERT_POLICY_SATURATE, shift);
+    vxReleaseScalar(&shift);
+    return node;
+}
+
+static vx_node vxKBenchColorConvert(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxColorConvertNode(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchChannelExtract(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxChannelExtractNode(g, in[0], VX_CHANNEL_0, out[0]);
+}
+
+static vx_node vxKBenchIntegral(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxIntegralImageNode(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchScale(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxScaleImageNode(g, in[0], out[0], VX_INTERPOLATION_BILINEAR);
+}
+
+static vx_node vxKBenchWarpAffine(vx_graph g, vx_image in[], vx_image out[])
+{
+    /* a small rotation, so every row reads across several source rows */
+    vx_float32 values[3][2] = {{0.98f, 0.17f}, {-0.17f, 0.98f}, {40.0f, -20.0f}};
+    vx_matrix matrix = vxCreateMatrix(vxKBenchContext(g), VX_TYPE_FLOAT32, 2, 3);
+    vx_node node;
+    vxCopyMatrix(matrix, values, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    node = vxWarpAffineNode(g, in[0], matrix, VX_INTERPOLATION_BILINEAR, out[0]);
+    vxReleaseMatrix(&matrix);
+    return node;
+}
+
+static vx_node vxKBenchWarpPerspective(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_float32 values[3][3] = {{0.98f, 0.17f, 0.0f}, {-0.17f, 0.98f, 0.0001f}, {40.0f, -20.0f, 1.0f}};
+    vx_matrix matrix = vxCreateMatrix(vxKBenchContext(g), VX_TYPE_FLOAT32, 3, 3);
+    vx_node node;
+    vxCopyMatrix(matrix, values, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    node = vxWarpPerspectiveNode(g, in[0], matrix, VX_INTERPOLATION_BILINEAR, out[0]);
+    vxReleaseMatrix(&matrix);
+    return node;
+}
+
+static vx_node vxKBenchThreshold(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_pixel_value_t value;
+    vx_threshold thresh = vxCreateThresholdForImage(vxKBenchContext(g), VX_THRESHOLD_TYPE_BINARY,
+                                                    VX_DF_IMAGE_U8, VX_DF_IMAGE_U8);
+    vx_node node;
+    memset(&value, 0, sizeof(value));
+    value.U8 = 128;
+    vxCopyThresholdValue(thresh, &value, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    node = vxThresholdNode(g, in[0], thresh, out[0]);
+    vxReleaseThreshold(&thresh);
+    return node;
+}
+
+static vx_node vxKBenchTableLookup(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_uint8 values[256];
+    vx_lut lut = vxCreateLUT(vxKBenchContext(g), VX_TYPE_UINT8, 256);
+    vx_node node;
+    vx_uint32 i;
+    for (i = 0; i < 256; i++)
+        values[i] = (vx_uint8)(255 - i);
+    vxCopyLUT(lut, values, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    node = vxTableLookupNode(g, in[0], lut, out[0]);
+    vxReleaseLUT(&lut);
+    return node;
+}
+
+static vx_node vxKBenchEqualizeHist(vx_graph g, vx_image in[], vx_image out[])
+{
+    return vxEqualizeHistNode(g, in[0], out[0]);
+}
+
+static vx_node vxKBenchWeightedAverage(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_float32 value = 0.25f;
+    vx_scalar alpha = vxKBenchScalar(g, VX_TYPE_FLOAT32, &value);
+    vx_node node = vxWeightedAverageNode(g, in[0], alpha, in[1], out[0]);
+    vxReleaseScalar(&alpha);
+    return node;
+}
+
+static vx_node vxKBenchCanny(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_pixel_value_t lower, upper;
+    vx_threshold hyst = vxCreateThresholdForImage(vxKBenchContext(g), VX_THRESHOLD_TYPE_RANGE,
+                                                  VX_DF_IMAGE_U8, VX_DF_IMAGE_U8);
+    vx_node node;
+    memset(&lower, 0, sizeof(lower));
+    memset(&upper, 0, sizeof(upper));
+    lower.U8 = 40;
+    upper.U8 = 120;
+    vxCopyThresholdRange(hyst, &lower, &upper, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    node = vxCannyEdgeDetectorNode(g, in[0], hyst, 3, VX_NORM_L1, out[0]);
+    vxReleaseThreshold(&hyst);
+    return node;
+}
+
+static vx_node vxKBenchNonLinearFilter(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_matrix mask = vxCreateMatrixFromPattern(vxKBenchContext(g), VX_PATTERN_BOX, 5, 5);
+    vx_node node = vxNonLinearFilterNode(g, VX_NONLINEAR_FILTER_MEDIAN, in[0], mask, out[0]);
+    vxReleaseMatrix(&mask);
+    return node;
+}
+
+static vx_node vxKBenchConvolve(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_int16 coeffs[5][5] = {
+        {1,  4,  6,  4, 1},
+        {4, 16, 24, 16, 4},
+        {6, 24, 36, 24, 6},
+        {4, 16, 24, 16, 4},
+        {1,  4,  6,  4, 1},
+    };
+    vx_uint32 scale = 256;
+    vx_convolution conv = vxCreateConvolution(vxKBenchContext(g), 5, 5);
+    vx_node node;
+    vxCopyConvolutionCoefficients(conv, coeffs, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    vxSetConvolutionAttribute(conv, VX_CONVOLUTION_SCALE, &scale, sizeof(scale));
+    node = vxConvolveNode(g, in[0], conv, out[0]);
+    vxReleaseConvolution(&conv);
+    return node;
+}
+
+static vx_node vxKBenchMeanStdDev(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_float32 value = 0.0f;
+    vx_scalar mean = vxKBenchScalar(g, VX_TYPE_FLOAT32, &value);
+    vx_scalar stddev = vxKBenchScalar(g, VX_TYPE_FLOAT32, &value);
+    vx_node node = vxMeanStdDevNode(g, in[0], mean, stddev);
+    (void)out;
+    vxReleaseScalar(&mean);
+    vxReleaseScalar(&stddev);
+    return node;
+}
+
+static vx_node vxKBenchMinMaxLoc(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_uint8 value = 0;
+    vx_uint32 count = 0;
+    vx_scalar minv = vxKBenchScalar(g, VX_TYPE_UINT8, &value);
+    vx_scalar maxv = vxKBenchScalar(g, VX_TYPE_UINT8, &value);
+    vx_scalar minc = vxKBenchScalar(g, VX_TYPE_UINT32, &count);
+    vx_scalar maxc = vxKBenchScalar(g, VX_TYPE_UINT32, &count);
+    vx_node node = vxMinMaxLocNode(g, in[0], minv, maxv, NULL, NULL, minc, maxc);
+    (void)out;
+    vxReleaseScalar(&minv);
+    vxReleaseScalar(&maxv);
+    vxReleaseScalar(&minc);
+    vxReleaseScalar(&maxc);
+    return node;
+}
+
+static vx_node vxKBenchHistogram(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_distribution dist = vxCreateDistribution(vxKBenchContext(g), 256, 0, 256);
+    vx_node node = vxHistogramNode(g, in[0], dist);
+    (void)out;
+    vxReleaseDistribution(&dist);
+    return node;
+}
+
+static vx_node vxKBenchFastCorners(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_float32 value = 40.0f;
+    vx_scalar strength = vxKBenchScalar(g, VX_TYPE_FLOAT32, &value);
+    vx_array corners = vxCreateArray(vxKBenchContext(g), VX_TYPE_KEYPOINT, VX_KBENCH_ARRAY_ITEMS);
+    vx_node node = vxFastCornersNode(g, in[0], strength, vx_true_e, corners, NULL);
+    (void)out;
+    vxReleaseScalar(&strength);
+    vxReleaseArray(&corners);
+    return node;
+}
+
+static vx_node vxKBenchHarrisCorners(vx_graph g, vx_image in[], vx_image out[])
+{
+    vx_float32 values[3] = {0.0005f, 5.0f, 0.04f};
+    vx_scalar strength = vxKBenchScalar(g, VX_TYPE_FLOAT32, &values[0]);
+    vx_scalar distance = vxKBenchScalar(g, VX_TYPE_FLOAT32, &values[1]);
+    vx_scalar sensitivity = vxKBenchScalar(g, VX_TYPE_FLOAT32, &values[2]);
+    vx_array corners = vxCreateArray(vxKBenchContext(g), VX_TYPE_KEYPOINT, VX_KBENCH_ARRAY_ITEMS);
+    vx_node node = vxHarrisCornersNode(g, in[0], strength, distance, sensitivity, 3, 3, corners, NULL);
+    (void)out;
+    vxReleaseScalar(&strength);
+    vxReleaseScalar(&distance);
+    vxReleaseScalar(&sensitivity);
+    vxReleaseArray(&corners);
+    return node;
+}
+
+#define U8   VX_DF_IMAGE_U8
+#define S16  VX_DF_IMAGE_S16
+#define VIRT VX_DF_IMAGE_VIRT /* no image output */
+
+/*! \brief The kernels which can be built from images alone, with the formats they accept. */
+static vx_kbench_kernel_t kernels[] = {
+    {VX_KERNEL_BOX_3x3,          vxKBenchBox,            1, 1, {{U8, U8}}},
+    {VX_KERNEL_GAUSSIAN_3x3,     vxKBenchGaussian,       1, 1, {{U8, U8}}},
+    {VX_KERNEL_MEDIAN_3x3,       vxKBenchMedian,         1, 1, {{U8, U8}}},
+    {VX_KERNEL_DILATE_3x3,       vxKBenchDilate,         1, 1, {{U8, U8}}},
+    {VX_KERNEL_ERODE_3x3,        vxKBenchErode,          1, 1, {{U8, U8}}},
+    {VX_KERNEL_SOBEL_3x3,        vxKBenchSobel,          1, 2, {{U8, S16}}},
+    {VX_KERNEL_MAGNITUDE,        vxKBenchMagnitude,      2, 1, {{S16, S16}}},
+    {VX_KERNEL_PHASE,            vxKBenchPhase,          2, 1, {{S16, U8}}},
+    {VX_KERNEL_ADD,              vxKBenchAdd,            2, 1, {{U8, U8}, {U8, S16}, {S16, S16}}},
+    {VX_KERNEL_SUBTRACT,         vxKBenchSubtract,       2, 1, {{U8, U8}, {U8, S16}, {S16, S16}}},
+    {VX_KERNEL_MULTIPLY,         vxKBenchMultiply,       2, 1, {{U8, U8}, {U8, S16}, {S16, S16}}},
+    {VX_KERNEL_AND,              vxKBenchAnd,            2, 1, {{U8, U8}}},
+    {VX_KERNEL_OR,               vxKBenchOr,             2, 1, {{U8, U8}}},
+    {VX_KERNEL_XOR,              vxKBenchXor,            2, 1, {{U8, U8}}},
+    {VX_KERNEL_NOT,              vxKBenchNot,            1, 1, {{U8, U8}}},
+    {VX_KERNEL_ABSDIFF,          vxKBenchAbsDiff,        2, 1, {{U8, U8}, {S16, S16}}},
+    {VX_KERNEL_CONVERTDEPTH,     vxKBenchConvertDepth,   1, 1, {{U8, S16}, {S16, U8}}},
+    {VX_KERNEL_COLOR_CONVERT,    vxKBenchColorConvert,   1, 1, {
+        {VX_DF_IMAGE_RGB, VX_DF_IMAGE_RGBX}, {VX_DF_IMAGE_RGB, VX_DF_IMAGE_IYUV},
+        {VX_DF_IMAGE_RGB, VX_DF_IMAGE_NV12}, {VX_DF_IMAGE_RGB, VX_DF_IMAGE_YUV4},
+        {VX_DF_IMAGE_IYUV, VX_DF_IMAGE_RGB}, {VX_DF_IMAGE_NV12, VX_DF_IMAGE_RGB},
+        {VX_DF_IMAGE_UYVY, VX_DF_IMAGE_RGB}, {VX_DF_IMAGE_YUYV, VX_DF_IMAGE_IYUV}}},
+    {VX_KERNEL_CHANNEL_EXTRACT,  vxKBenchChannelExtract, 1, 1, {
+        {VX_DF_IMAGE_RGB, U8}, {VX_DF_IMAGE_RGBX, U8}, {VX_DF_IMAGE_IYUV, U8}, {VX_DF_IMAGE_YUYV, U8}}},
+    {VX_KERNEL_INTEGRAL_IMAGE,   vxKBenchIntegral,       1, 1, {{U8, VX_DF_IMAGE_U32}}},
+    {VX_KERNEL_SCALE_IMAGE,      vxKBenchScale,          1, 1, {{U8, U8}}},
+    {VX_KERNEL_WARP_AFFINE,      vxKBenchWarpAffine,     1, 1, {{U8, U8}}},
+    {VX_KERNEL_WARP_PERSPECTIVE, vxKBenchWarpPerspective,1, 1, {{U8, U8}}},
+    {VX_KERNEL_THRESHOLD,        vxKBenchThreshold,      1, 1, {{U8, U8}}},
+    {VX_KERNEL_TABLE_LOOKUP,     vxKBenchTableLookup,    1, 1, {{U8, U8}}},
+    {VX_KERNEL_EQUALIZE_HISTOGRAM, vxKBenchEqualizeHist, 1, 1, {{U8, U8}}},
+    {VX_KERNEL_WEIGHTED_AVERAGE, vxKBenchWeightedAverage,2, 1, {{U8, U8}}},
+    {VX_KERNEL_CANNY_EDGE_DETECTOR, vxKBenchCanny,       1, 1, {{U8, U8}}},
+    {VX_KERNEL_NON_LINEAR_FILTER, vxKBenchNonLinearFilter, 1, 1, {{U8, U8}}},
+    {VX_KERNEL_CUSTOM_CONVOLUTION, vxKBenchConvolve,     1, 1, {{U8, U8}, {U8, S16}}},
+    {VX_KERNEL_MEAN_STDDEV,      vxKBenchMeanStdDev,     1, 0, {{U8, VIRT}}},
+    {VX_KERNEL_MINMAXLOC,        vxKBenchMinMaxLoc,      1, 0, {{U8, VIRT}}},
+    {VX_KERNEL_HISTOGRAM,        vxKBenchHistogram,      1, 0, {{U8, VIRT}}},
+    {VX_KERNEL_FAST_CORNERS,     vxKBenchFastCorners,    1, 0, {{U8, VIRT}}},
+    {VX_KERNEL_HARRIS_CORNERS,   vxKBenchHarrisCorners,  1, 0, {{U8, VIRT}}},
+};
+
+#undef U8
+#undef S16
+#undef VIRT
+
+static vx_uint64 vxKBenchTime(void)
+{
+#if defined(__linux__) || defined(__ANDROID__) || defined(__QNX__) || defined(__APPLE__) || defined(__CYGWIN__)
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (vx_uint64)t.tv_sec * 1000000000ull + (vx_uint64)t.tv_nsec;
+#elif defined(_WIN32) || defined(UNDER_CE)
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (vx_uint64)((double)t.QuadPart * 1000000000.0 / (double)f.QuadPart);
+#endif
+}
+
+/*! \brief Measures the bytes per second moved by memcpy, counting the read and the write. */
+static vx_float64 vxKBenchCopyBandwidth(void)
+{
+    vx_float64 bandwidth = 0.0;
+    vx_uint8 *src = (vx_uint8 *)malloc(VX_KBENCH_COPY_SIZE);
+    vx_uint8 *dst = (vx_uint8 *)malloc(VX_KBENCH_COPY_SIZE);
+
+    if (src && dst)
+    {
+        vx_uint64 start, elapsed;
+        vx_uint32 r;
+
+        memset(src, 0x5a, VX_KBENCH_COPY_SIZE);
+        memcpy(dst, src, VX_KBENCH_COPY_SIZE); /* faults in the pages */
+        start = vxKBenchTime();
+        for (r = 0; r < VX_KBENCH_COPY_RUNS; r++)
+        {
+            memcpy(r & 1 ? src : dst, r & 1 ? dst : src, VX_KBENCH_COPY_SIZE);
+        }
+        elapsed = vxKBenchTime() - start;
+        if (elapsed > 0)
+            bandwidth = 2.0 * VX_KBENCH_COPY_SIZE * VX_KBENCH_COPY_RUNS * 1000000000.0 / (vx_float64)elapsed;
+    }
+    free(src);
+    free(dst);
+    return bandwidth;
+}
+
+/*! \brief Fills every plane of an image byte by byte with a textured pattern. */
+static vx_status vxKBenchFillImage(vx_image image)
+{
+    vx_status status = VX_SUCCESS;
+    vx_uint32 width = 0, height = 0;
+    vx_size planes = 0, p;
+
+    status |= vxQueryImage(image, VX_IMAGE_WIDTH, &width, sizeof(width));
+    status |= vxQueryImage(image, VX_IMAGE_HEIGHT, &height, sizeof(height));
+    status |= vxQueryImage(image, VX_IMAGE_PLANES, &planes, sizeof(planes));
+    for (p = 0; (p < planes) && (status == VX_SUCCESS); p++)
+    {
+        vx_rectangle_t rect = {0, 0, width, height};
+        vx_imagepatch_addressing_t addr;
+        vx_map_id map_id;
+        void *base = NULL;
+        vx_uint32 x, y;
+        vx_int32 b;
+
+        status = vxMapImagePatch(image, &rect, (vx_uint32)p, &map_id, &addr, &base,
+                                 VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+        if (status != VX_SUCCESS)
+            break;
+        for (y = 0; y < addr.dim_y; y += addr.step_y)
+        {
+            for (x = 0; x < addr.dim_x; x += addr.step_x)
+            {
+                vx_uint8 *pixel = (vx_uint8 *)vxFormatImagePatchAddress2d(base, x, y, &addr);
+                for (b = 0; b < addr.stride_x; b++)
+                    pixel[b] = (vx_uint8)(((x >> 3) ^ (y >> 3)) & 1 ? 200 + ((x * 7 + y * 13 + b) & 31) : (x * y + b) & 63);
+            }
+        }
+        status = vxUnmapImagePatch(image, map_id);
+    }
+    return status;
+}
+
+static void vxKBenchFourcc(vx_df_image format, vx_char str[5])
+{
+    vx_uint32 i;
+    for (i = 0; i < 4; i++)
+    {
+        vx_char c = (vx_char)((format >> (8 * i)) & 0xFF);
+        str[i] = (c >= 0x20 && c < 0x7f) ? c : '?';
+    }
+    str[4] = '\0';
+}
+
+static int vxKBenchCompare(const void *a, const void *b)
+{
+    vx_uint64 x = *(const vx_uint64 *)a;
+    vx_uint64 y = *(const vx_uint64 *)b;
+    return (x > y) - (x < y);
+}
+
+/*! \brief Runs one kernel on one target at one format and size, and writes its JSON object.
+ * Writes nothing and returns VX_ERROR_NOT_SUPPORTED when the target does not publish the kernel.
+ */
+static vx_status vxKBenchRun(FILE *out, vx_bool *first, vx_context context, vx_kbench_kernel_t *bench,
+                             const vx_char *kernel_name, const vx_char *target, vx_kbench_format_t *format,
+                             vx_uint32 width, vx_uint32 height, vx_uint32 warmup, vx_uint32 iterations)
+{
+    vx_status status = VX_SUCCESS;
+    vx_image in[VX_KBENCH_MAX_IMAGES] = {0};
+    vx_image outs[VX_KBENCH_MAX_IMAGES] = {0};
+    vx_uint64 *samples = NULL;
+    vx_uint64 bytes = 0;
+    vx_uint32 i, count = 0;
+    vx_graph graph = vxCreateGraph(context);
+    vx_node node = 0;
+
+    status = vxGetStatus((vx_reference)graph);
+    for (i = 0; (i < bench->num_in) && (status == VX_SUCCESS); i++)
+    {
+        in[i] = vxCreateImage(context, width, height, format->in);
+        status = vxGetStatus((vx_reference)in[i]);
+        if (status == VX_SUCCESS)
+            status = vxKBenchFillImage(in[i]);
+    }
+    for (i = 0; (i < bench->num_out) && (status == VX_SUCCESS); i++)
+    {
+        outs[i] = vxCreateImage(context, width, height, format->out);
+        status = vxGetStatus((vx_reference)outs[i]);
+    }
+    if (status == VX_SUCCESS)
+    {
+        node = bench->create(graph, in, outs);
+        status = vxGetStatus((vx_reference)node);
+    }
+    if (status == VX_SUCCESS)
+    {
+        status = vxSetNodeTarget(node, VX_TARGET_STRING, target);
+        if (status != VX_SUCCESS)
+            goto exit;
+    }
+
+    if (status == VX_SUCCESS)
+        status = vxVerifyGraph(graph);
+    for (i = 0; (i < warmup) && (status == VX_SUCCESS); i++)
+    {
+        status = vxProcessGraph(graph);
+    }
+    samples = (vx_uint64 *)calloc(iterations, sizeof(vx_uint64));
+    if (samples == NULL)
+        status = VX_ERROR_NO_MEMORY;
+    for (i = 0; (i < iterations) && (status == VX_SUCCESS); i++)
+    {
+        vx_perf_t perf;
+        status = vxProcessGraph(graph);
+        memset(&perf, 0, sizeof(perf));
+        if (status == VX_SUCCESS)
+            status = vxQueryNode(node, VX_NODE_PERFORMANCE, &perf, sizeof(perf));
+        if (status == VX_SUCCESS)
+            samples[count++] = perf.tmp;
+    }
+    for (i = 0; i < bench->num_in; i++)
+    {
+        vx_size size = 0;
+        vxQueryImage(in[i], VX_IMAGE_SIZE, &size, sizeof(size));
+        bytes += size;
+    }
+    for (i = 0; i < bench->num_out; i++)
+    {
+        vx_size size = 0;
+        vxQueryImage(outs[i], VX_IMAGE_SIZE, &size, sizeof(size));
+        bytes += size;
+    }
+
+    {
+        vx_char in_fourcc[5], out_fourcc[5];
+        vxKBenchFourcc(format->in, in_fourcc);
+        vxKBenchFourcc(format->out, out_fourcc);
+        fprintf(out, "%s{\"kernel\":\"%s\",\"target\":\"%s\",\"input\":\"%s\",\"output\":\"%s\","
+                "\"width\":%u,\"height\":%u,\"bytes\":%llu,\"status\":%d",
+                *first ? "" : ",\n", kernel_name, target, in_fourcc,
+                bench->num_out ? out_fourcc : "", width, height, (unsigned long long)bytes, status);
+        *first = vx_false_e;
+    }
+    if (count > 0)
+    {
+        vx_uint64 median;
+        qsort(samples, count, sizeof(vx_uint64), vxKBenchCompare);
+        median = samples[count / 2];
+        fprintf(out, ",\"iterations\":%u,\"median_ms\":%.4f,\"min_ms\":%.4f", count,
+                (vx_float64)median / 1000000.0, (vx_float64)samples[0] / 1000000.0);
+        if (median > 0)
+        {
+            fprintf(out, ",\"mpix_per_s\":%.2f,\"bytes_per_s\":%.0f",
+                    (vx_float64)width * height * 1000.0 / (vx_float64)median,
+                    (vx_float64)bytes * 1000000000.0 / (vx_float64)median);
+            if (copy_bandwidth > 0.0)
+                fprintf(out, ",\"bandwidth_fraction\":%.3f",
+                        (vx_float64)bytes * 1000000000.0 / (vx_float64)median / copy_bandwidth);
+        }
+    }
+    fprintf(out, "}");
+
+exit:
+    free(samples);
+    if (node)
+        vxReleaseNode(&node);
+    for (i = 0; i < VX_KBENCH_MAX_IMAGES; i++)
+    {
+        if (in[i])
+            vxReleaseImage(&in[i]);
+        if (outs[i])
+            vxReleaseImage(&outs[i]);
+    }
+    if (graph)
+        vxReleaseGraph(&graph);
+    return status;
+}
+
+static vx_kbench_kernel_t *vxKBenchFind(vx_enum kernel)
+{
+    vx_uint32 k;
+    for (k = 0; k < dimof(kernels); k++)
+    {
+        if (kernels[k].kernel == kernel)
+            return &kernels[k];
+    }
+    return NULL;
+}
+
+static vx_bool vxKBenchSelected(const vx_char *name, const vx_char *filters[], vx_uint32 num)
+{
+    vx_uint32 f;
+    if (num == 0)
+        return vx_true_e;
+    for (f = 0; f < num; f++)
+    {
+        if (strstr(name, filters[f]) != NULL)
+            return vx_true_e;
+    }
+    return vx_false_e;
+}
+
+static void vxKBenchUsage(void)
+{
+    printf("Usage: vx_kernel_bench [-k kernel]... [-t target]... [-m max-width] [-i iterations]\n"
+           "                       [-u warmup] [-o file.json]\n");
+}
+
+/*! \brief The kernel micro-benchmark. Every kernel which has a builder is timed on every
+ * target which publishes it, the others are listed as skipped.
+ */
+int main(int argc, char *argv[])
+{
+    vx_status status = VX_SUCCESS;
+    const vx_char *kernel_filters[VX_KBENCH_MAX_FILTERS];
+    const vx_char *target_filters[VX_KBENCH_MAX_FILTERS];
+    vx_uint32 num_kernel_filters = 0, num_target_filters = 0;
+    vx_uint32 iterations = 10, warmup = 2, max_width = 7680;
+    const char *filename = NULL;
+    vx_kernel_info_t *table = NULL;
+    vx_size num_kernels = 0;
+    vx_bool first = vx_true_e;
+    vx_context context;
+    FILE *out = stdout;
+    vx_size k;
+    int a;
+
+    for (a = 1; a < argc; a++)
+    {
+        if ((strcmp(argv[a], "-k") == 0) && (a + 1 < argc) && (num_kernel_filters < VX_KBENCH_MAX_FILTERS))
+            kernel_filters[num_kernel_filters++] = argv[++a];
+        else if ((strcmp(argv[a], "-t") == 0) && (a + 1 < argc) && (num_target_filters < VX_KBENCH_MAX_FILTERS))
+            target_filters[num_target_filters++] = argv[++a];
+        else if ((strcmp(argv[a], "-m") == 0) && (a + 1 < argc))
+            max_width = (vx_uint32)atoi(argv[++a]);
+        else if ((strcmp(argv[a], "-i") == 0) && (a + 1 < argc))
+            iterations = (vx_uint32)atoi(argv[++a]);
+        else if ((strcmp(argv[a], "-u") == 0) && (a + 1 < argc))
+            warmup = (vx_uint32)atoi(argv[++a]);
+        else if ((strcmp(argv[a], "-o") == 0) && (a + 1 < argc))
+            filename = argv[++a];
+        else
+        {
+            vxKBenchUsage();
+            return -1;
+        }
+    }
+    if (iterations == 0)
+        iterations = 1;
+    if (filename)
+    {
+        out = fopen(filename, "w");
+        if (out == NULL)
+        {
+            printf("Failed to open %s\n", filename);
+            return -1;
+        }
+    }
+
+    context = vxCreateContext();
+    status = vxGetStatus((vx_reference)context);
+    if (status != VX_SUCCESS)
+    {
+        printf("Failed to create context!\n");
+        return -1;
+    }
+    vxDirective((vx_reference)context, VX_DIRECTIVE_ENABLE_PERFORMANCE);
+    status = vxQueryContext(context, VX_CONTEXT_UNIQUE_KERNELS, &num_kernels, sizeof(num_kernels));
+    if (status == VX_SUCCESS && num_kernels > 0)
+    {
+        table = (vx_kernel_info_t *)calloc(num_kernels, sizeof(vx_kernel_info_t));
+        if (table)
+            status = vxQueryContext(context, VX_CONTEXT_UNIQUE_KERNEL_TABLE, table,
+                                    num_kernels * sizeof(vx_kernel_info_t));
+        else
+            status = VX_ERROR_NO_MEMORY;
+    }
+
+    copy_bandwidth = vxKBenchCopyBandwidth();
+    fprintf(out, "{\"iterations\":%u,\"warmup\":%u,\"copy_bytes_per_s\":%.0f,\"results\":[\n",
+            iterations, warmup, copy_bandwidth);
+    for (k = 0; (k < num_kernels) && (status == VX_SUCCESS); k++)
+    {
+        vx_kbench_kernel_t *bench = vxKBenchFind(table[k].enumeration);
+        vx_uint32 t, f, s;
+
+        if (vxKBenchSelected(table[k].name, kernel_filters, num_kernel_filters) == vx_false_e)
+            continue;
+        if (bench == NULL)
+        {
+            fprintf(out, "%s{\"kernel\":\"%s\",\"skipped\":true}", first ? "" : ",\n", table[k].name);
+            first = vx_false_e;
+            continue;
+        }
+        for (t = 0; t < dimof(targets); t++)
+        {
+            if (vxKBenchSelected(targets[t], target_filters, num_target_filters) == vx_false_e)
+                continue;
+            for (f = 0; (f < VX_KBENCH_MAX_FORMATS) && (bench->formats[f].in != 0); f++)
+            {
+                for (s = 0; (s < dimof(sizes)) && (sizes[s].width <= max_width); s++)
+                {
+                    /* a target which does not publish the kernel is not retried at other sizes */
+                    if (vxKBenchRun(out, &first, context, bench, table[k].name, targets[t], &bench->formats[f],
+                                    sizes[s].width, sizes[s].height, warmup, iterations) == VX_ERROR_NOT_SUPPORTED &&
+                        s == 0)
+                        break;
+                }
+            }
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    free(table);
+    vxReleaseContext(&context);
+    if (out != stdout)
+        fclose(out);
+    return status == VX_SUCCESS ? 0 : -1;
+}
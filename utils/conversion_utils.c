@@ -21,6 +21,14 @@
 #include <VX/vx.h>
 #include <half/sip_ml_fp16.hpp>
 
+#if defined(__F16C__)
+#include <immintrin.h>
+#define CONVERSION_F16C
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || (defined(__ARM_FP) && (__ARM_FP & 2)))
+#include <arm_neon.h>
+#define CONVERSION_NEON_F16
+#endif
+
 float short2float(int16_t val)
 {
     int16_t sign = (val & 0x8000) >> 15;
@@ -223,3 +231,101 @@ double UNQUANTIZE(vx_int16 val)
     return counter;
     */
 }
+
+float half2float(uint16_t val)
+{
+    union { float f; uint32_t u; } out;
+    const uint32_t sign = (uint32_t)(val & 0x8000) << 16;
+    const uint32_t exponent = (val >> 10) & 0x1F;
+    const uint32_t mantissa = val & 0x03FF;
+
+    if (exponent == 0x1F)
+    {
+        out.u = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+        out.u = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    else
+    {
+        // zero or subnormal, mantissa * 2^-24
+        out.f = (float)mantissa * (1.0f / 16777216.0f);
+        out.u |= sign;
+    }
+    return out.f;
+}
+
+uint16_t float2half(float x)
+{
+    union { float f; uint32_t u; } in;
+    uint16_t out;
+    in.f = x;
+
+    const uint32_t sign = in.u & 0x80000000;
+    in.u ^= sign;
+
+    if (in.u >= (127 + 16) << 23)
+    {
+        // too large for a half, or inf/nan
+        out = in.u > 0x7F800000 ? 0x7E00 : 0x7C00;
+    }
+    else if (in.u < (127 - 14) << 23)
+    {
+        // lands in the subnormals: let the float adder round the mantissa
+        // into place, below a bias that leaves it in the low bits
+        union { float f; uint32_t u; } magic;
+        magic.u = (127 - 15 + 23 - 10 + 1) << 23;
+        in.f += magic.f;
+        out = (uint16_t)(in.u - magic.u);
+    }
+    else
+    {
+        // rebias and round to nearest even; a carry out of the mantissa
+        // correctly bumps the exponent, up to inf
+        const uint32_t odd = (in.u >> 13) & 1;
+        in.u += ((uint32_t)(15 - 127) << 23) + 0xFFF + odd;
+        out = (uint16_t)(in.u >> 13);
+    }
+    return out | (uint16_t)(sign >> 16);
+}
+
+void half2floatRow(const uint16_t * src, size_t n, float * dst)
+{
+    size_t i = 0;
+#if defined(CONVERSION_F16C)
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+#elif defined(CONVERSION_NEON_F16)
+    for (; i + 4 <= n; i += 4)
+    {
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        dst[i] = half2float(src[i]);
+    }
+}
+
+void float2halfRow(const float * src, size_t n, uint16_t * dst)
+{
+    size_t i = 0;
+#if defined(CONVERSION_F16C)
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm_storeu_si128((__m128i *)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+#elif defined(CONVERSION_NEON_F16)
+    for (; i + 4 <= n; i += 4)
+    {
+        vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        dst[i] = float2half(src[i]);
+    }
+}
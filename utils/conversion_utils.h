@@ -25,4 +25,11 @@ int16_t conversion_24_8(int32_t acc_value);
 vx_int16 QUANTIZE(double x);
 double UNQUANTIZE(vx_int16 val);
 
+// IEEE half floats, kept as their raw bits. float2half rounds to nearest even.
+// The Row versions use F16C or NEON when the build enables them.
+float half2float(uint16_t val);
+uint16_t float2half(float x);
+void half2floatRow(const uint16_t * src, size_t n, float * dst);
+void float2halfRow(const float * src, size_t n, uint16_t * dst);
+
 #endif /* UTILS_CONVERSION_UTILS_H_ */
@@ -15,9 +15,70 @@
  * limitations under the License.
  */
 #include <stdlib.h>
+#include <string.h>
 #include <VX/vx.h>
 #include "VX/vx_khr_nn.h"
 #include "tensor_utils.h"
+
+#if defined(_WIN32) || defined(UNDER_CE)
+#define TENSOR_THREAD_LOCAL __declspec(thread)
+#else
+#define TENSOR_THREAD_LOCAL __thread
+#endif
+
+/* Patches handed out straight from a host map, so ReleasePatch can unmap
+ * them. A kernel allocates and releases its patches on the same thread. */
+#define MAX_NUM_OF_DIRECT_PATCHES 8
+
+typedef struct _direct_patch_t {
+	vx_tensor tensor;
+	void * ptr;
+	vx_map_id map_id;
+} direct_patch_t;
+
+static TENSOR_THREAD_LOCAL direct_patch_t direct_patches[MAX_NUM_OF_DIRECT_PATCHES];
+
+/* Maps the whole tensor in place when its memory is already laid out like a
+ * packed patch. Returns 0 when the caller has to fall back to a copy. */
+static int MapDirectPatch (vx_tensor tensor, vx_size dims_num, const vx_size* dimensions, const vx_size* stride, void** buffer_ptr, vx_enum usage)
+{
+	vx_size view_start[MAX_NUM_OF_DIMENSIONS] = {0};
+	vx_size map_stride[MAX_NUM_OF_DIMENSIONS] = {0};
+	vx_map_id map_id = 0;
+	void * ptr = NULL;
+	direct_patch_t * slot = NULL;
+
+	for (vx_size i = 0; i < MAX_NUM_OF_DIRECT_PATCHES; i++)
+	{
+		if (direct_patches[i].tensor == NULL)
+		{
+			slot = &direct_patches[i];
+			break;
+		}
+	}
+	if (slot == NULL || dims_num > MAX_NUM_OF_DIMENSIONS ||
+		vxMapTensorPatch(tensor, dims_num, view_start, dimensions, &map_id, map_stride, &ptr, usage, VX_MEMORY_TYPE_HOST) != VX_SUCCESS)
+		return 0;
+
+	for (vx_size i = 0; i < dims_num; i++)
+	{
+		if (map_stride[i] != stride[i])
+		{
+			/* a view into a larger tensor, its rows are not packed */
+			vxUnmapTensorPatch(tensor, map_id);
+			return 0;
+		}
+	}
+	/* kernels add onto their outputs or skip elements, relying on the zeroed patch of the copy path */
+	if (usage == VX_WRITE_ONLY)
+		memset(ptr, 0, dimensions[dims_num - 1] * stride[dims_num - 1]);
+	slot->tensor = tensor;
+	slot->ptr = ptr;
+	slot->map_id = map_id;
+	*buffer_ptr = ptr;
+	return 1;
+}
+
 vx_size ComputeGlobalPositionsFromIndex(vx_size index, const vx_size * dimensions,
 		const vx_size * stride, vx_size number_of_dimensions, vx_size * pos)
 {
@@ -62,6 +123,9 @@ vx_status AllocatePatch (vx_tensor tensor, vx_size* dims_num, vx_size* dimension
     for (vx_size i = 1; i < *dims_num; i++) {
 		stride[i] = dimensions[i-1] * stride[i-1];
 	}
+	if (status == VX_SUCCESS && MapDirectPatch(tensor, *dims_num, dimensions, stride, buffer_ptr, usage))
+		return status;
+
 	*buffer_ptr = calloc(dimensions[*dims_num - 1]*stride[*dims_num - 1], 1);
 	if (*buffer_ptr)
 	{
@@ -77,6 +141,18 @@ vx_status AllocatePatch (vx_tensor tensor, vx_size* dims_num, vx_size* dimension
 vx_status ReleasePatch (vx_tensor tensor, vx_size dims_num, const vx_size* dimensions, const vx_size* stride, void** buffer_ptr, vx_enum usage) {
 	vx_status status = VX_SUCCESS;
 	vx_size view_start[MAX_NUM_OF_DIMENSIONS] = {0};
+	for (vx_size i = 0; *buffer_ptr && i < MAX_NUM_OF_DIRECT_PATCHES; i++)
+	{
+		if (direct_patches[i].tensor == tensor && direct_patches[i].ptr == *buffer_ptr)
+		{
+			/* the kernel worked on the tensor memory itself, nothing to copy back */
+			status = vxUnmapTensorPatch(tensor, direct_patches[i].map_id);
+			direct_patches[i].tensor = NULL;
+			direct_patches[i].ptr = NULL;
+			*buffer_ptr = NULL;
+			return status;
+		}
+	}
 	if (*buffer_ptr )
 	{
 		if (usage == VX_WRITE_ONLY)